@@ -99,7 +99,6 @@ class GFreenectView(Gtk.Window):
         bottom_contents.pack_start(label, fill=False, expand=False, padding=12)
         bottom_contents.pack_start(self.led_combobox, fill=False, expand=False, padding=0)
 
-        self._accel_timeout = 0
         self._accel_x_label = Gtk.Label()
         self._accel_y_label = Gtk.Label()
         self._accel_z_label = Gtk.Label()
@@ -192,6 +191,12 @@ class GFreenectView(Gtk.Window):
         self.kinect.connect("video-frame",
                             self._on_video_frame,
                             None)
+        # Get the accelerometer's values whenever the motor subdevice
+        # is sampled, four times per second
+        self.kinect.set_property("motion-sample-rate", 4)
+        self.kinect.connect("motion-state",
+                            self._on_motion_state,
+                            None)
 
         try:
             # Starts getting information from the depth camera in 11BIT format
@@ -210,7 +215,11 @@ class GFreenectView(Gtk.Window):
             print e.message
             Gtk.main_quit()
 
-        self._get_accel()
+        try:
+            # Starts sampling the accelerometer in the background
+            self.kinect.start_motion_stream()
+        except Exception, e:
+            print e.message
 
         self.depth_texture = Clutter.Texture.new()
         self.depth_texture.set_keep_aspect_ratio(True)
@@ -317,24 +326,13 @@ class GFreenectView(Gtk.Window):
                                  Gtk.ButtonsType.CLOSE,
                                  message)
 
-    def _get_accel(self):
-        '''
-        Gets the accelerometer's values asynchronously.
-        '''
-        self.kinect.get_accel(None, self._on_accel_finish, None)
-
-    def _on_accel_finish(self, kinect, result, user_data):
+    def _on_motion_state(self, kinect, state, user_data):
         '''
-        Called when the accelerometer's value are retrieved
+        Called when the accelerometer's values are sampled
         '''
-        success, x, y, z = kinect.get_accel_finish(result)
-        if success:
-            self._accel_x_label.set_markup('<b>X:</b> %s' % x)
-            self._accel_y_label.set_markup('<b>Y:</b> %s' % y)
-            self._accel_z_label.set_markup('<b>Z:</b> %s' % z)
-        if self._accel_timeout > 0:
-            GObject.source_remove(self._accel_timeout)
-        self._accel_timeout = GObject.timeout_add(250, self._get_accel)
+        self._accel_x_label.set_markup('<b>X:</b> %s' % state.accel_x)
+        self._accel_y_label.set_markup('<b>Y:</b> %s' % state.accel_y)
+        self._accel_z_label.set_markup('<b>Z:</b> %s' % state.accel_z)
 
     def _on_video_format_radio_clicked(self, rgb_radio):
         '''
@@ -358,6 +356,7 @@ class GFreenectView(Gtk.Window):
         video and depth streams and quits the application.
         '''
         if self.kinect:
+            self.kinect.stop_motion_stream()
             self.kinect.stop_video_stream()
             self.kinect.stop_depth_stream()
         Gtk.main_quit()
@@ -0,0 +1,213 @@
+/*
+ * gfreenect-audio-ring.c
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+
+#include <string.h>
+
+#include "gfreenect-audio-ring.h"
+
+#define CHANNELS GFREENECT_AUDIO_CHANNELS
+
+void
+gfreenect_audio_ring_init (GFreenectAudioRing *ring, guint n_frames)
+{
+  g_return_if_fail (n_frames > 0 && (n_frames & (n_frames - 1)) == 0);
+
+  ring->samples = g_new0 (gint32, (gsize) n_frames * CHANNELS);
+  ring->n_frames = n_frames;
+
+  gfreenect_audio_ring_reset (ring);
+}
+
+void
+gfreenect_audio_ring_clear (GFreenectAudioRing *ring)
+{
+  g_free (ring->samples);
+  ring->samples = NULL;
+  ring->n_frames = 0;
+}
+
+/* Only to be called while there is no writer, and before the cursors of
+   the readers are set back to 0. */
+void
+gfreenect_audio_ring_reset (GFreenectAudioRing *ring)
+{
+  g_atomic_int_set (&ring->reserved, 0);
+  g_atomic_int_set (&ring->written, 0);
+
+  g_atomic_int_set (&ring->anchor_seq, 0);
+  ring->anchor_pos = 0;
+  ring->anchor_time = 0;
+}
+
+/* Appends @n_frames frames that arrived at @time. Only one thread may
+   write. */
+void
+gfreenect_audio_ring_write (GFreenectAudioRing *ring,
+                            guint               n_frames,
+                            const gint32       *mic1,
+                            const gint32       *mic2,
+                            const gint32       *mic3,
+                            const gint32       *mic4,
+                            const gint16       *reference,
+                            gint64              time)
+{
+  guint mask = ring->n_frames - 1;
+  guint pos;
+  guint seq;
+  guint i;
+
+  pos = (guint) g_atomic_int_get (&ring->written);
+
+  /* frames older than the ring can't be kept anyway */
+  if (n_frames > ring->n_frames)
+    {
+      guint skip = n_frames - ring->n_frames;
+
+      mic1 += skip;
+      mic2 += skip;
+      mic3 += skip;
+      mic4 += skip;
+      reference += skip;
+      pos += skip;
+      n_frames = ring->n_frames;
+    }
+
+  /* readers drop what they copied from the frames about to be
+     overwritten */
+  g_atomic_int_set (&ring->reserved, (gint) (pos + n_frames));
+
+  for (i = 0; i < n_frames; i++)
+    {
+      gint32 *frame = ring->samples + (gsize) ((pos + i) & mask) * CHANNELS;
+
+      frame[0] = mic1[i];
+      frame[1] = mic2[i];
+      frame[2] = mic3[i];
+      frame[3] = mic4[i];
+      frame[4] = reference[i];
+    }
+
+  seq = (guint) g_atomic_int_get (&ring->anchor_seq);
+  g_atomic_int_set (&ring->anchor_seq, (gint) (seq + 1));
+  ring->anchor_pos = pos + n_frames - 1;
+  ring->anchor_time = time;
+  g_atomic_int_set (&ring->anchor_seq, (gint) (seq + 2));
+
+  g_atomic_int_set (&ring->written, (gint) (pos + n_frames));
+}
+
+/* the arrival time of the frame at @pos, extrapolated from the last block
+   at the nominal sample rate */
+static gint64
+get_frame_time (GFreenectAudioRing *ring, guint pos)
+{
+  guint seq;
+  guint anchor_pos;
+  gint64 anchor_time;
+
+  do
+    {
+      seq = (guint) g_atomic_int_get (&ring->anchor_seq);
+      anchor_pos = ring->anchor_pos;
+      anchor_time = ring->anchor_time;
+    }
+  while ((seq & 1) != 0 ||
+         (guint) g_atomic_int_get (&ring->anchor_seq) != seq);
+
+  return anchor_time -
+    (gint64) (gint) (anchor_pos - pos) * G_USEC_PER_SEC /
+    GFREENECT_AUDIO_SAMPLE_RATE;
+}
+
+/* Copies up to @max_frames frames from @cursor on into @dest, advancing
+   @cursor. Frames the writer overwrote before they could be read are
+   skipped. Returns the number of frames copied, and the arrival time of
+   the first one in @timestamp. */
+guint
+gfreenect_audio_ring_read (GFreenectAudioRing *ring,
+                           guint              *cursor,
+                           gint32             *dest,
+                           guint               max_frames,
+                           gint64             *timestamp)
+{
+  guint mask = ring->n_frames - 1;
+
+  while (TRUE)
+    {
+      guint written;
+      guint reserved;
+      guint pos;
+      guint n;
+      guint first;
+      guint lost;
+
+      written = (guint) g_atomic_int_get (&ring->written);
+
+      pos = *cursor;
+      if (written - pos > ring->n_frames)
+        pos = written - ring->n_frames;
+
+      n = MIN (written - pos, max_frames);
+      if (n == 0)
+        {
+          *cursor = pos;
+          return 0;
+        }
+
+      /* copy in up to two pieces, as the range may wrap around */
+      first = MIN (n, ring->n_frames - (pos & mask));
+      memcpy (dest,
+              ring->samples + (gsize) (pos & mask) * CHANNELS,
+              (gsize) first * CHANNELS * sizeof (gint32));
+      if (first < n)
+        memcpy (dest + (gsize) first * CHANNELS,
+                ring->samples,
+                (gsize) (n - first) * CHANNELS * sizeof (gint32));
+
+      /* drop the frames the writer may have started overwriting */
+      reserved = (guint) g_atomic_int_get (&ring->reserved);
+      lost = reserved - pos > ring->n_frames ?
+        reserved - pos - ring->n_frames : 0;
+
+      if (lost >= n)
+        {
+          *cursor = reserved - ring->n_frames;
+          continue;
+        }
+
+      if (lost > 0)
+        {
+          memmove (dest,
+                   dest + (gsize) lost * CHANNELS,
+                   (gsize) (n - lost) * CHANNELS * sizeof (gint32));
+          pos += lost;
+          n -= lost;
+        }
+
+      if (timestamp != NULL)
+        *timestamp = get_frame_time (ring, pos);
+
+      *cursor = pos + n;
+
+      return n;
+    }
+}
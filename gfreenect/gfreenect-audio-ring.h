@@ -0,0 +1,73 @@
+/*
+ * gfreenect-audio-ring.h
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+
+#ifndef __GFREENECT_AUDIO_RING_H__
+#define __GFREENECT_AUDIO_RING_H__
+
+#include <glib.h>
+
+#include "gfreenect-decls.h"
+
+G_BEGIN_DECLS
+
+/* Preallocated history of interleaved audio frames, of
+   GFREENECT_AUDIO_CHANNELS samples each, with a single writer and any
+   number of readers that never block it. Each reader keeps its own cursor
+   and skips ahead when the writer laps it. Positions count frames since the
+   ring was reset, wrapping. */
+typedef struct
+{
+  gint32 *samples;
+  guint n_frames;               /* capacity, a power of two */
+
+  gint reserved;                /* end of the frames being written */
+  gint written;                 /* end of the frames readable */
+
+  /* arrival time of the frame at anchor_pos, under a sequence lock */
+  gint anchor_seq;
+  guint anchor_pos;
+  gint64 anchor_time;
+} GFreenectAudioRing;
+
+void  gfreenect_audio_ring_init  (GFreenectAudioRing *ring,
+                                  guint               n_frames);
+void  gfreenect_audio_ring_clear (GFreenectAudioRing *ring);
+void  gfreenect_audio_ring_reset (GFreenectAudioRing *ring);
+
+void  gfreenect_audio_ring_write (GFreenectAudioRing *ring,
+                                  guint               n_frames,
+                                  const gint32       *mic1,
+                                  const gint32       *mic2,
+                                  const gint32       *mic3,
+                                  const gint32       *mic4,
+                                  const gint16       *reference,
+                                  gint64              time);
+
+guint gfreenect_audio_ring_read  (GFreenectAudioRing *ring,
+                                  guint              *cursor,
+                                  gint32             *dest,
+                                  guint               max_frames,
+                                  gint64             *timestamp);
+
+G_END_DECLS
+
+#endif /* __GFREENECT_AUDIO_RING_H__ */
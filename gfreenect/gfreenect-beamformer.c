@@ -0,0 +1,630 @@
+/*
+ * gfreenect-beamformer.c
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+
+/**
+ * SECTION:gfreenect-beamformer
+ * @short_description: Steers the microphone array towards a sound source
+ *
+ * A #GFreenectBeamformer turns the frames of the audio stream of
+ * #GFreenectDevice into a single mono stream, by delaying the signal of
+ * each of the four microphones so that sound coming from a given direction
+ * adds up in phase while sound from other directions partly cancels out
+ * (delay-and-sum beamforming). The delays are fractions of a sample, applied
+ * with windowed-sinc interpolation filters.
+ *
+ * Each block of frames passed to gfreenect_beamformer_process() also
+ * yields an estimate of the direction the dominant sound comes from,
+ * retrieved with gfreenect_beamformer_get_direction(). Angles are in
+ * degrees in the horizontal plane, 0 being straight in front of the sensor
+ * and positive angles to its right, as seen from the sensor. With
+ * #GFreenectBeamformer:auto-steer set, the beam follows that estimate;
+ * otherwise it points to #GFreenectBeamformer:steering-angle.
+ **/
+
+#include <string.h>
+#include <math.h>
+
+#include "gfreenect-beamformer.h"
+#include "gfreenect-decls.h"
+
+#define GFREENECT_BEAMFORMER_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), \
+                                               GFREENECT_TYPE_BEAMFORMER, \
+                                               GFreenectBeamformerPrivate))
+
+#define MICS             4
+#define PAIRS            (MICS * (MICS - 1) / 2)
+
+#define SPEED_OF_SOUND   343.0
+
+/* the delays between microphones are at most 10.5 samples, and the
+   interpolation window spans 2 * HALF_WIDTH samples around each delay */
+#define TAPS             32
+#define HALF_WIDTH       8
+#define HISTORY          (TAPS - 1)
+#define MAX_LAG          12
+
+/* pole of the filter removing the DC offset of the microphones */
+#define DC_POLE          0.995
+
+/* resolution of the direction search, and smallest change of direction
+   worth recomputing the filters for, in degrees */
+#define DIRECTION_STEP   1.0
+#define STEER_THRESHOLD  0.5
+
+#define DEFAULT_STEERING_ANGLE 0.0
+
+/* position of the microphones along the X axis of the sensor, in meters */
+static const gdouble mic_position[MICS] = { -0.113, 0.036, 0.076, 0.113 };
+
+/* private data */
+struct _GFreenectBeamformerPrivate
+{
+  gdouble steering_angle;
+  gboolean auto_steer;
+
+  gfloat filters[MICS][TAPS];
+  gdouble filter_angle;
+  gboolean has_filters;
+
+  /* DC-free input of each microphone: HISTORY samples of the previous
+     blocks followed by the current block */
+  gfloat *input[MICS];
+  guint capacity;
+  gdouble dc_in[MICS];
+  gdouble dc_out[MICS];
+
+  gdouble correlation[PAIRS][2 * MAX_LAG + 1];
+  gdouble direction;
+  gboolean has_direction;
+};
+
+/* properties */
+enum
+{
+  PROP_0,
+  PROP_STEERING_ANGLE,
+  PROP_AUTO_STEER
+};
+
+static void     gfreenect_beamformer_class_init         (GFreenectBeamformerClass *class);
+static void     gfreenect_beamformer_init               (GFreenectBeamformer *self);
+static void     gfreenect_beamformer_finalize           (GObject *obj);
+
+static void     gfreenect_beamformer_set_property       (GObject      *obj,
+                                                         guint         prop_id,
+                                                         const GValue *value,
+                                                         GParamSpec   *pspec);
+static void     gfreenect_beamformer_get_property       (GObject    *obj,
+                                                         guint       prop_id,
+                                                         GValue     *value,
+                                                         GParamSpec *pspec);
+
+G_DEFINE_TYPE (GFreenectBeamformer, gfreenect_beamformer, G_TYPE_OBJECT);
+
+static void
+gfreenect_beamformer_class_init (GFreenectBeamformerClass *class)
+{
+  GObjectClass *obj_class;
+
+  obj_class = G_OBJECT_CLASS (class);
+
+  obj_class->finalize = gfreenect_beamformer_finalize;
+  obj_class->get_property = gfreenect_beamformer_get_property;
+  obj_class->set_property = gfreenect_beamformer_set_property;
+
+  /* install properties */
+
+  /**
+   * GFreenectBeamformer:steering-angle
+   *
+   * The direction the beam points to, in degrees, when
+   * #GFreenectBeamformer:auto-steer is not set.
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_STEERING_ANGLE,
+                                   g_param_spec_double ("steering-angle",
+                                                        "Steering angle",
+                                                        "Direction of the beam, in degrees",
+                                                        -90.0,
+                                                        90.0,
+                                                        DEFAULT_STEERING_ANGLE,
+                                                        G_PARAM_READWRITE |
+                                                        G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GFreenectBeamformer:auto-steer
+   *
+   * Whether the beam follows the estimated direction of the dominant
+   * sound of each block, instead of #GFreenectBeamformer:steering-angle.
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_AUTO_STEER,
+                                   g_param_spec_boolean ("auto-steer",
+                                                         "Auto steer",
+                                                         "Whether the beam follows the estimated direction",
+                                                         TRUE,
+                                                         G_PARAM_READWRITE |
+                                                         G_PARAM_STATIC_STRINGS));
+
+  /* add private structure */
+  g_type_class_add_private (obj_class, sizeof (GFreenectBeamformerPrivate));
+}
+
+static void
+gfreenect_beamformer_init (GFreenectBeamformer *self)
+{
+  GFreenectBeamformerPrivate *priv;
+  guint i;
+
+  priv = GFREENECT_BEAMFORMER_GET_PRIVATE (self);
+  self->priv = priv;
+
+  priv->steering_angle = DEFAULT_STEERING_ANGLE;
+  priv->auto_steer = TRUE;
+
+  priv->has_filters = FALSE;
+
+  priv->capacity = 0;
+  for (i = 0; i < MICS; i++)
+    priv->input[i] = NULL;
+
+  gfreenect_beamformer_reset (self);
+}
+
+static void
+gfreenect_beamformer_finalize (GObject *obj)
+{
+  GFreenectBeamformer *self = GFREENECT_BEAMFORMER (obj);
+  guint i;
+
+  for (i = 0; i < MICS; i++)
+    g_free (self->priv->input[i]);
+
+  G_OBJECT_CLASS (gfreenect_beamformer_parent_class)->finalize (obj);
+}
+
+static void
+gfreenect_beamformer_set_property (GObject      *obj,
+                                   guint         prop_id,
+                                   const GValue *value,
+                                   GParamSpec   *pspec)
+{
+  GFreenectBeamformer *self;
+
+  self = GFREENECT_BEAMFORMER (obj);
+
+  switch (prop_id)
+    {
+    case PROP_STEERING_ANGLE:
+      self->priv->steering_angle = g_value_get_double (value);
+      break;
+
+    case PROP_AUTO_STEER:
+      self->priv->auto_steer = g_value_get_boolean (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (obj, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+gfreenect_beamformer_get_property (GObject    *obj,
+                                   guint       prop_id,
+                                   GValue     *value,
+                                   GParamSpec *pspec)
+{
+  GFreenectBeamformer *self;
+
+  self = GFREENECT_BEAMFORMER (obj);
+
+  switch (prop_id)
+    {
+    case PROP_STEERING_ANGLE:
+      g_value_set_double (value, self->priv->steering_angle);
+      break;
+
+    case PROP_AUTO_STEER:
+      g_value_set_boolean (value, self->priv->auto_steer);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (obj, prop_id, pspec);
+      break;
+    }
+}
+
+/* The delay, in samples, sound coming from @angle reaches each microphone
+   with, relative to the first one it reaches. Delaying every microphone by
+   the opposite amount aligns them. */
+static void
+get_delays (gdouble angle, gdouble *delays)
+{
+  gdouble s = sin (angle * G_PI / 180.0);
+  gdouble lead = -G_MAXDOUBLE;
+  guint i;
+
+  for (i = 0; i < MICS; i++)
+    lead = MAX (lead, mic_position[i] * s);
+
+  for (i = 0; i < MICS; i++)
+    delays[i] = (lead - mic_position[i] * s) *
+      GFREENECT_AUDIO_SAMPLE_RATE / SPEED_OF_SOUND;
+}
+
+/* Hann-windowed sinc filters delaying each microphone so that sound from
+   @angle lines up, plus a common latency of HALF_WIDTH samples. The sum of
+   the filters has unit gain. */
+static void
+compute_filters (GFreenectBeamformerPrivate *priv, gdouble angle)
+{
+  gdouble delays[MICS];
+  gdouble latest = 0.0;
+  guint i;
+  guint k;
+
+  get_delays (angle, delays);
+
+  for (i = 0; i < MICS; i++)
+    latest = MAX (latest, delays[i]);
+
+  for (i = 0; i < MICS; i++)
+    {
+      /* the microphone reached first waits the longest */
+      gdouble delay = latest - delays[i];
+      gdouble sum = 0.0;
+
+      for (k = 0; k < TAPS; k++)
+        {
+          gdouble t = k - HALF_WIDTH - delay;
+          gdouble h = 0.0;
+
+          if (fabs (t) < 1e-9)
+            h = 1.0;
+          else if (fabs (t) < HALF_WIDTH)
+            h = sin (G_PI * t) / (G_PI * t) *
+              0.5 * (1.0 + cos (G_PI * t / HALF_WIDTH));
+
+          priv->filters[i][k] = h;
+          sum += h;
+        }
+
+      for (k = 0; k < TAPS; k++)
+        priv->filters[i][k] /= sum * MICS;
+    }
+
+  priv->filter_angle = angle;
+  priv->has_filters = TRUE;
+}
+
+static void
+ensure_capacity (GFreenectBeamformerPrivate *priv, guint n_frames)
+{
+  guint i;
+
+  if (n_frames <= priv->capacity)
+    return;
+
+  for (i = 0; i < MICS; i++)
+    priv->input[i] = g_renew (gfloat, priv->input[i], HISTORY + n_frames);
+
+  if (priv->capacity == 0)
+    for (i = 0; i < MICS; i++)
+      memset (priv->input[i], 0, HISTORY * sizeof (gfloat));
+
+  priv->capacity = n_frames;
+}
+
+/* Copies the microphone channels of @frames after the history of each
+   microphone, removing their DC offset on the way. */
+static void
+load_block (GFreenectBeamformerPrivate *priv,
+            const gint32               *frames,
+            guint                       n_frames)
+{
+  guint i;
+  guint n;
+
+  for (i = 0; i < MICS; i++)
+    {
+      gfloat *dest = priv->input[i] + HISTORY;
+      gdouble last_in = priv->dc_in[i];
+      gdouble last_out = priv->dc_out[i];
+
+      for (n = 0; n < n_frames; n++)
+        {
+          gdouble x = frames[n * GFREENECT_AUDIO_CHANNELS + i];
+
+          last_out = x - last_in + DC_POLE * last_out;
+          last_in = x;
+          dest[n] = last_out;
+        }
+
+      priv->dc_in[i] = last_in;
+      priv->dc_out[i] = last_out;
+    }
+}
+
+/* Cross-correlates every pair of microphones over the block, for lags
+   between -MAX_LAG and MAX_LAG. Returns the energy of the block. */
+static gdouble
+correlate (GFreenectBeamformerPrivate *priv, guint n_frames)
+{
+  gdouble energy = 0.0;
+  guint length = n_frames - MAX_LAG;
+  guint pair = 0;
+  guint i;
+  guint j;
+  guint n;
+  gint lag;
+
+  for (i = 0; i < MICS; i++)
+    {
+      const gfloat *a = priv->input[i] + HISTORY;
+
+      for (n = 0; n < length; n++)
+        energy += a[n] * a[n];
+
+      for (j = i + 1; j < MICS; j++)
+        {
+          for (lag = -MAX_LAG; lag <= MAX_LAG; lag++)
+            {
+              const gfloat *b = priv->input[j] + HISTORY - lag;
+              gfloat sum = 0.0;
+
+              for (n = 0; n < length; n++)
+                sum += a[n] * b[n];
+
+              priv->correlation[pair][lag + MAX_LAG] = sum;
+            }
+
+          pair++;
+        }
+    }
+
+  return energy;
+}
+
+/* Steered response power: adds up, over all pairs of microphones, the
+   correlation at the lag sound from @angle arrives with. */
+static gdouble
+get_response (GFreenectBeamformerPrivate *priv, gdouble angle)
+{
+  gdouble s = sin (angle * G_PI / 180.0);
+  gdouble response = 0.0;
+  guint pair = 0;
+  guint i;
+  guint j;
+
+  for (i = 0; i < MICS; i++)
+    for (j = i + 1; j < MICS; j++)
+      {
+        gdouble lag;
+        gdouble frac;
+        gint index;
+
+        lag = MAX_LAG - (mic_position[i] - mic_position[j]) * s *
+          GFREENECT_AUDIO_SAMPLE_RATE / SPEED_OF_SOUND;
+        index = floor (lag);
+        frac = lag - index;
+
+        response += (1.0 - frac) * priv->correlation[pair][index] +
+          frac * priv->correlation[pair][index + 1];
+
+        pair++;
+      }
+
+  return response;
+}
+
+static void
+estimate_direction (GFreenectBeamformerPrivate *priv, guint n_frames)
+{
+  gdouble best = -G_MAXDOUBLE;
+  gdouble angle;
+
+  /* too short to tell anything, keep the previous estimate */
+  if (n_frames <= 2 * MAX_LAG)
+    return;
+
+  if (correlate (priv, n_frames) < 1.0)
+    {
+      priv->has_direction = FALSE;
+      return;
+    }
+
+  for (angle = -90.0; angle <= 90.0; angle += DIRECTION_STEP)
+    {
+      gdouble response = get_response (priv, angle);
+
+      if (response > best)
+        {
+          best = response;
+          priv->direction = angle;
+        }
+    }
+
+  priv->has_direction = TRUE;
+}
+
+/* Sums the delayed microphones. The loops over samples are left free of
+   dependencies so that the compiler can vectorize them. */
+static void
+beamform (GFreenectBeamformerPrivate *priv,
+          guint                       n_frames,
+          gfloat                     *output)
+{
+  guint i;
+  guint k;
+  guint n;
+
+  memset (output, 0, n_frames * sizeof (gfloat));
+
+  for (i = 0; i < MICS; i++)
+    for (k = 0; k < TAPS; k++)
+      {
+        const gfloat *src = priv->input[i] + HISTORY - k;
+        gfloat h = priv->filters[i][k];
+
+        if (h == 0.0)
+          continue;
+
+        for (n = 0; n < n_frames; n++)
+          output[n] += h * src[n];
+      }
+}
+
+/* public methods */
+
+/**
+ * gfreenect_beamformer_new:
+ *
+ * Creates a new #GFreenectBeamformer.
+ *
+ * Returns: (transfer full): A newly created #GFreenectBeamformer. Use
+ * g_object_unref() to free it.
+ **/
+GFreenectBeamformer *
+gfreenect_beamformer_new (void)
+{
+  return g_object_new (GFREENECT_TYPE_BEAMFORMER, NULL);
+}
+
+/**
+ * gfreenect_beamformer_process:
+ * @self: The #GFreenectBeamformer
+ * @frames: (array): Interleaved audio frames, as delivered by the audio
+ * stream of #GFreenectDevice
+ * @n_frames: The number of frames in @frames
+ * @output: (array) (out caller-allocates): Buffer of @n_frames samples to
+ * store the steered signal in
+ *
+ * Estimates the direction the dominant sound of a block of frames comes
+ * from, and steers the microphones towards it, or towards
+ * #GFreenectBeamformer:steering-angle if #GFreenectBeamformer:auto-steer is
+ * not set. Blocks are expected to follow each other in time, as the filters
+ * carry over the end of each block into the next one; the output lags the
+ * input by 8 to 19 samples, about a millisecond, depending on the
+ * direction.
+ *
+ * Blocks of a few hundred frames give the most reliable directions; the
+ * direction is not updated for blocks of 24 frames or less.
+ **/
+void
+gfreenect_beamformer_process (GFreenectBeamformer *self,
+                              const gint32        *frames,
+                              guint                n_frames,
+                              gfloat              *output)
+{
+  GFreenectBeamformerPrivate *priv;
+  gdouble angle;
+  guint i;
+
+  g_return_if_fail (GFREENECT_IS_BEAMFORMER (self));
+  g_return_if_fail (frames != NULL || n_frames == 0);
+  g_return_if_fail (output != NULL || n_frames == 0);
+
+  if (n_frames == 0)
+    return;
+
+  priv = self->priv;
+
+  ensure_capacity (priv, n_frames);
+  load_block (priv, frames, n_frames);
+
+  estimate_direction (priv, n_frames);
+
+  if (priv->auto_steer && priv->has_direction)
+    angle = priv->direction;
+  else if (priv->auto_steer && priv->has_filters)
+    angle = priv->filter_angle;
+  else
+    angle = priv->steering_angle;
+
+  if (! priv->has_filters || fabs (angle - priv->filter_angle) >= STEER_THRESHOLD)
+    compute_filters (priv, angle);
+
+  beamform (priv, n_frames, output);
+
+  /* keep the end of the block for the next one */
+  for (i = 0; i < MICS; i++)
+    memmove (priv->input[i],
+             priv->input[i] + n_frames,
+             HISTORY * sizeof (gfloat));
+}
+
+/**
+ * gfreenect_beamformer_get_direction:
+ * @self: The #GFreenectBeamformer
+ * @angle: (out) (allow-none): Location to store the direction, in degrees
+ *
+ * Retrieves the direction the dominant sound of the last block processed
+ * came from.
+ *
+ * Returns: %TRUE if a direction was estimated, %FALSE if no block has been
+ * processed yet or the last one was silent
+ **/
+gboolean
+gfreenect_beamformer_get_direction (GFreenectBeamformer *self,
+                                    gdouble             *angle)
+{
+  g_return_val_if_fail (GFREENECT_IS_BEAMFORMER (self), FALSE);
+
+  if (! self->priv->has_direction)
+    return FALSE;
+
+  if (angle != NULL)
+    *angle = self->priv->direction;
+
+  return TRUE;
+}
+
+/**
+ * gfreenect_beamformer_reset:
+ * @self: The #GFreenectBeamformer
+ *
+ * Forgets the samples and the direction of previous blocks, for when the
+ * next block does not follow them, e.g after restarting the audio stream.
+ **/
+void
+gfreenect_beamformer_reset (GFreenectBeamformer *self)
+{
+  GFreenectBeamformerPrivate *priv;
+  guint i;
+
+  g_return_if_fail (GFREENECT_IS_BEAMFORMER (self));
+
+  priv = self->priv;
+
+  for (i = 0; i < MICS; i++)
+    {
+      if (priv->input[i] != NULL)
+        memset (priv->input[i], 0, HISTORY * sizeof (gfloat));
+
+      priv->dc_in[i] = 0.0;
+      priv->dc_out[i] = 0.0;
+    }
+
+  priv->has_direction = FALSE;
+  priv->direction = 0.0;
+}
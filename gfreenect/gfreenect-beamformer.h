@@ -0,0 +1,70 @@
+/*
+ * gfreenect-beamformer.h
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+
+#ifndef __GFREENECT_BEAMFORMER_H__
+#define __GFREENECT_BEAMFORMER_H__
+
+#include <glib.h>
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GFreenectBeamformer GFreenectBeamformer;
+typedef struct _GFreenectBeamformerClass GFreenectBeamformerClass;
+typedef struct _GFreenectBeamformerPrivate GFreenectBeamformerPrivate;
+
+struct _GFreenectBeamformer
+{
+  GObject parent;
+
+  GFreenectBeamformerPrivate *priv;
+};
+
+struct _GFreenectBeamformerClass
+{
+  GObjectClass parent_class;
+};
+
+#define GFREENECT_TYPE_BEAMFORMER           (gfreenect_beamformer_get_type ())
+#define GFREENECT_BEAMFORMER(obj)           (G_TYPE_CHECK_INSTANCE_CAST ((obj), GFREENECT_TYPE_BEAMFORMER, GFreenectBeamformer))
+#define GFREENECT_BEAMFORMER_CLASS(obj)     (G_TYPE_CHECK_CLASS_CAST ((obj), GFREENECT_TYPE_BEAMFORMER, GFreenectBeamformerClass))
+#define GFREENECT_IS_BEAMFORMER(obj)        (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GFREENECT_TYPE_BEAMFORMER))
+#define GFREENECT_IS_BEAMFORMER_CLASS(obj)  (G_TYPE_CHECK_CLASS_TYPE ((obj), GFREENECT_TYPE_BEAMFORMER))
+#define GFREENECT_BEAMFORMER_GET_CLASS(obj) (G_TYPE_INSTANCE_GET_CLASS ((obj), GFREENECT_TYPE_BEAMFORMER, GFreenectBeamformerClass))
+
+GType                 gfreenect_beamformer_get_type      (void) G_GNUC_CONST;
+
+GFreenectBeamformer * gfreenect_beamformer_new           (void);
+
+void                  gfreenect_beamformer_process       (GFreenectBeamformer *self,
+                                                          const gint32        *frames,
+                                                          guint                n_frames,
+                                                          gfloat              *output);
+
+gboolean              gfreenect_beamformer_get_direction (GFreenectBeamformer *self,
+                                                          gdouble             *angle);
+
+void                  gfreenect_beamformer_reset         (GFreenectBeamformer *self);
+
+G_END_DECLS
+
+#endif /* __GFREENECT_BEAMFORMER_H__ */
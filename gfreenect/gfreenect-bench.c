@@ -0,0 +1,1437 @@
+/*
+ * gfreenect-bench.c
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+/* Microbenchmarks of the frame processing kernels, run on fixed synthetic
+   frames at every resolution of the sensor. Built and run by "make bench";
+   see --help for the options. Each kernel is run a few times to warm up,
+   then timed over a number of samples long enough for the clock
+   resolution not to matter. The median of the samples is reported per
+   pixel (or audio frame), as memory throughput and, where a cycle counter
+   is available, in cycles. --output writes the results as JSON, to track
+   regressions across revisions. Concurrent queries of the motor state
+   are measured the same way, against a stand-in for the device. */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#if defined (__x86_64__) || defined (__i386__)
+#include <x86intrin.h>
+#define HAVE_CYCLE_COUNTER 1
+#endif
+
+#include <libfreenect.h>
+#include <libfreenect_registration.h>
+
+#include "gfreenect.h"
+#include "gfreenect-convert.h"
+#include "gfreenect-depth-pyramid.h"
+#include "gfreenect-temporal-filter.h"
+#include "gfreenect-spatial-filter.h"
+#include "gfreenect-motion-detector.h"
+#include "gfreenect-depth-bands.h"
+#include "gfreenect-motion-cache.h"
+
+/* these must match the values libfreenect builds its tables with */
+#define DEPTH_RAW_VALUES       2048
+#define DEPTH_MAX_METRIC_VALUE 10000
+#define REG_X_VAL_SCALE        256
+
+#define DEPTH_INVALID          2047
+
+/* audio frames per call to the beamformer, 32 ms */
+#define AUDIO_BLOCK            512
+
+/* the motor state queries: the time a control transfer to the motor
+   subdevice takes, and the queries of each caller per run */
+#define MOTION_TRANSFER_TIME   1000
+#define MOTION_QUERIES         2
+
+#define DEFAULT_WARMUP         3
+#define DEFAULT_REPEATS        15
+#define DEFAULT_MIN_TIME       20
+
+typedef void (* BenchFunc) (gpointer data);
+
+typedef struct
+{
+  gchar *name;
+  guint width;
+  guint height;
+
+  /* what one run processes, and the frame memory it reads and writes,
+     not counting the internal state of the kernel */
+  const gchar *unit;
+  gsize items;
+  gsize bytes;
+
+  /* whether the kernel splits its work across the worker pool */
+  gboolean parallel;
+
+  BenchFunc func;
+  gpointer data;
+} Bench;
+
+typedef struct
+{
+  guint threads;
+  guint iterations;             /* runs per sample */
+
+  /* nanoseconds per run */
+  gdouble min;
+  gdouble median;
+  gdouble mean;
+  gdouble stddev;
+
+  gdouble cycles;               /* median per run, or < 0 if not measured */
+} BenchResult;
+
+typedef struct
+{
+  guint width;
+  guint height;
+  gsize pixels;
+
+  /* two frames of the same scene with different noise, alternated by the
+     kernels that keep state across frames */
+  guint16 *raw[2];
+  guint16 *mm[2];
+  guint frame;
+
+  guint16 raw_min;
+  guint16 raw_max;
+
+  guint8 *ir;
+  guint8 *rgb;
+
+  GFreenectRegion full;
+  GFreenectRegion roi;          /* the centered quarter of the frame */
+
+  gpointer out;                 /* large enough for any kernel */
+  guint32 *histogram;
+
+  GFreenectTemporalFilterState temporal_average;
+  GFreenectTemporalFilterState temporal_median;
+  GFreenectSpatialFilterState bilateral;
+  GFreenectSpatialFilterState joint_bilateral;
+  GFreenectMotionDetectorState motion_detector;
+  GFreenectDepthBandsState depth_bands;
+
+  /* only at the resolution of the registration tables */
+  GFreenectRegistration *registration;
+  GFreenectBlobDetector *blob_detector;
+  GFreenectFloorEstimator *floor_estimator;
+  GFreenectOccupancyGrid *occupancy_grid;
+} Fixture;
+
+typedef struct
+{
+  GFreenectBeamformer *beamformer;
+  gint32 *frames;
+  gfloat *output;
+} AudioFixture;
+
+/* Concurrent callers querying the state of the motor subdevice, served
+   either by a GFreenectMotionCache refreshed by a single thread, as the
+   device does, or by a control transfer of their own per query. The
+   device is a stand-in that sleeps for the duration of a transfer. */
+typedef struct
+{
+  guint callers;
+  gboolean coalesced;
+
+  GMutex mutex;
+  GCond cond;                   /* wakes up the refreshing thread */
+  GFreenectMotionCache cache;
+  gboolean abort;
+  GThread *refresher;
+} MotionFixture;
+
+static gint warmup = DEFAULT_WARMUP;
+static gint repeats = DEFAULT_REPEATS;
+static gint min_time = DEFAULT_MIN_TIME;
+static gchar *threads_list = NULL;
+static gchar *filter = NULL;
+static gchar *output = NULL;
+static gboolean list_only = FALSE;
+
+static GOptionEntry entries[] =
+{
+  { "warmup", 'w', 0, G_OPTION_ARG_INT, &warmup,
+    "Untimed runs of each kernel before measuring", "N" },
+  { "repeats", 'r', 0, G_OPTION_ARG_INT, &repeats,
+    "Timed samples of each kernel", "N" },
+  { "min-time", 't', 0, G_OPTION_ARG_INT, &min_time,
+    "Minimum duration of each sample, in milliseconds", "MS" },
+  { "threads", 'j', 0, G_OPTION_ARG_STRING, &threads_list,
+    "Comma separated worker pool sizes to run the parallel kernels with", "N,..." },
+  { "filter", 'f', 0, G_OPTION_ARG_STRING, &filter,
+    "Only run the benchmarks whose name matches a glob pattern", "PATTERN" },
+  { "output", 'o', 0, G_OPTION_ARG_FILENAME, &output,
+    "Write the results as JSON to a file", "FILE" },
+  { "list", 'l', 0, G_OPTION_ARG_NONE, &list_only,
+    "List the benchmarks and exit", NULL },
+  { NULL }
+};
+
+static GPtrArray *benches = NULL;
+
+/* synthetic data */
+
+/* the approximation of the depth curve of the sensor by Stéphane
+   Magnenat, close enough to the tables libfreenect builds */
+static guint16
+raw_to_mm_value (guint raw)
+{
+  gdouble mm;
+
+  if (raw >= DEPTH_INVALID)
+    return 0;
+
+  mm = 123.6 * tan (raw / 2842.5 + 1.1863);
+
+  return mm > 0 && mm < DEPTH_MAX_METRIC_VALUE ? (guint16) mm : 0;
+}
+
+static GFreenectRegistration *
+create_registration (void)
+{
+  freenect_registration native;
+  guint16 *raw_to_mm;
+  gint32 *depth_to_rgb_shift;
+  gint32 (*table)[2];
+  GFreenectRegistration *registration;
+  guint x, y, i;
+
+  memset (&native, 0, sizeof (native));
+
+  raw_to_mm = g_new (guint16, DEPTH_RAW_VALUES);
+  for (i = 0; i < DEPTH_RAW_VALUES; i++)
+    raw_to_mm[i] = raw_to_mm_value (i);
+
+  /* the parallax of a 25 mm baseline seen with a 580 px focal length */
+  depth_to_rgb_shift = g_new (gint32, DEPTH_MAX_METRIC_VALUE);
+  for (i = 0; i < DEPTH_MAX_METRIC_VALUE; i++)
+    depth_to_rgb_shift[i] = REG_X_VAL_SCALE * 14500.0 / MAX (i, 300);
+
+  table = g_malloc (GFREENECT_REGISTRATION_WIDTH *
+                    GFREENECT_REGISTRATION_HEIGHT * sizeof (*table));
+  for (y = 0; y < GFREENECT_REGISTRATION_HEIGHT; y++)
+    for (x = 0; x < GFREENECT_REGISTRATION_WIDTH; x++)
+      {
+        table[y * GFREENECT_REGISTRATION_WIDTH + x][0] = x * REG_X_VAL_SCALE;
+        table[y * GFREENECT_REGISTRATION_WIDTH + x][1] = y;
+      }
+
+  native.raw_to_mm_shift = raw_to_mm;
+  native.depth_to_rgb_shift = depth_to_rgb_shift;
+  native.registration_table = table;
+  native.zero_plane_info.reference_distance = 120.0;
+  native.zero_plane_info.reference_pixel_size = 0.1042;
+
+  registration = gfreenect_registration_new_from_native (&native);
+
+  g_free (raw_to_mm);
+  g_free (depth_to_rgb_shift);
+  g_free (table);
+
+  return registration;
+}
+
+/* A room seen by the sensor: a wall at 3 m, the floor receding towards it
+   over the lower part of the image, and a person-sized box at 1.8 m
+   casting an IR shadow on its left. Returns millimeters, 0 for holes. */
+static guint
+scene_depth (guint x, guint y, guint width, guint height)
+{
+  gdouble u = (gdouble) x / width;
+  gdouble v = (gdouble) y / height;
+
+  if (v > 0.2 && v < 0.85)
+    {
+      if (u > 0.4 && u < 0.6)
+        return 1800;
+      if (u > 0.38 && u <= 0.4)
+        return 0;
+    }
+
+  if (v > 0.7)
+    return 450.0 / (v - 0.55);
+
+  return 3000;
+}
+
+static void
+fill_depth_frame (Fixture       *fixture,
+                  GRand         *rand,
+                  const guint16 *mm_to_raw,
+                  guint          index)
+{
+  guint16 *raw = fixture->raw[index];
+  guint16 *mm = fixture->mm[index];
+  guint x, y;
+
+  for (y = 0; y < fixture->height; y++)
+    for (x = 0; x < fixture->width; x++)
+      {
+        gsize i = y * fixture->width + x;
+        gdouble depth;
+
+        depth = scene_depth (x, y, fixture->width, fixture->height);
+
+        /* 1% noise, and 2% of pixels without a reading */
+        if (depth > 0)
+          depth *= 1.0 + g_rand_double_range (rand, -0.01, 0.01);
+        if (g_rand_int_range (rand, 0, 100) < 2)
+          depth = 0;
+
+        raw[i] = depth > 0 ?
+          mm_to_raw[MIN ((guint) depth, DEPTH_MAX_METRIC_VALUE - 1)] :
+          DEPTH_INVALID;
+        mm[i] = raw_to_mm_value (raw[i]);
+      }
+}
+
+static Fixture *
+fixture_new (guint width, guint height)
+{
+  Fixture *fixture;
+  GRand *rand;
+  guint16 *mm_to_raw;
+  guint raw;
+  guint mm;
+  gsize i;
+
+  fixture = g_slice_new0 (Fixture);
+  fixture->width = width;
+  fixture->height = height;
+  fixture->pixels = width * height;
+
+  /* same frames on every run */
+  rand = g_rand_new_with_seed (width * height);
+
+  mm_to_raw = g_new (guint16, DEPTH_MAX_METRIC_VALUE);
+  for (mm = 0, raw = 0; mm < DEPTH_MAX_METRIC_VALUE; mm++)
+    {
+      while (raw < DEPTH_INVALID - 1 &&
+             raw_to_mm_value (raw) != 0 &&
+             raw_to_mm_value (raw) < mm)
+        raw++;
+
+      mm_to_raw[mm] = raw;
+    }
+
+  for (i = 0; i < 2; i++)
+    {
+      fixture->raw[i] = g_new (guint16, fixture->pixels);
+      fixture->mm[i] = g_new (guint16, fixture->pixels);
+      fill_depth_frame (fixture, rand, mm_to_raw, i);
+    }
+
+  fixture->raw_min = G_MAXUINT16;
+  fixture->raw_max = 0;
+  for (i = 0; i < fixture->pixels; i++)
+    if (fixture->raw[0][i] != DEPTH_INVALID)
+      {
+        fixture->raw_min = MIN (fixture->raw_min, fixture->raw[0][i]);
+        fixture->raw_max = MAX (fixture->raw_max, fixture->raw[0][i]);
+      }
+
+  /* IR reflectance falls with distance; the RGB image is tinted from it */
+  fixture->ir = g_new (guint8, fixture->pixels);
+  fixture->rgb = g_new (guint8, fixture->pixels * 3);
+  for (i = 0; i < fixture->pixels; i++)
+    {
+      guint v;
+
+      v = fixture->mm[0][i] > 0 ? 200000 / fixture->mm[0][i] : 0;
+      v += g_rand_int_range (rand, 0, 16);
+
+      fixture->ir[i] = MIN (v, 255);
+      fixture->rgb[i * 3] = fixture->ir[i];
+      fixture->rgb[i * 3 + 1] = (fixture->ir[i] + 64) & 0xff;
+      fixture->rgb[i * 3 + 2] = (fixture->ir[i] * 3) & 0xff;
+    }
+
+  fixture->full.x = 0;
+  fixture->full.y = 0;
+  fixture->full.width = width;
+  fixture->full.height = height;
+
+  fixture->roi.x = width / 4;
+  fixture->roi.y = height / 4;
+  fixture->roi.width = width / 2;
+  fixture->roi.height = height / 2;
+
+  /* 3D points are the largest output, 12 bytes per pixel */
+  fixture->out = g_malloc (fixture->pixels * 3 * sizeof (gfloat));
+  fixture->histogram = g_new (guint32, GFREENECT_DEPTH_STATS_HISTOGRAM_BINS);
+
+  gfreenect_temporal_filter_init (&fixture->temporal_average);
+  fixture->temporal_average.mode = GFREENECT_TEMPORAL_FILTER_AVERAGE;
+  fixture->temporal_average.alpha = 64;
+  fixture->temporal_average.threshold = 32;
+  fixture->temporal_average.frames = 5;
+
+  gfreenect_temporal_filter_init (&fixture->temporal_median);
+  fixture->temporal_median.mode = GFREENECT_TEMPORAL_FILTER_MEDIAN;
+  fixture->temporal_median.alpha = 64;
+  fixture->temporal_median.threshold = 32;
+  fixture->temporal_median.frames = 5;
+
+  gfreenect_spatial_filter_init (&fixture->bilateral);
+  fixture->bilateral.mode = GFREENECT_SPATIAL_FILTER_BILATERAL;
+  fixture->bilateral.radius = 2;
+  fixture->bilateral.sigma = 30;
+  fixture->bilateral.color_sigma = 12;
+
+  gfreenect_spatial_filter_init (&fixture->joint_bilateral);
+  fixture->joint_bilateral.mode = GFREENECT_SPATIAL_FILTER_JOINT_BILATERAL;
+  fixture->joint_bilateral.radius = 2;
+  fixture->joint_bilateral.sigma = 30;
+  fixture->joint_bilateral.color_sigma = 12;
+
+  gfreenect_motion_detector_init (&fixture->motion_detector);
+  fixture->motion_detector.threshold = 50;
+
+  gfreenect_depth_bands_init (&fixture->depth_bands);
+  fixture->depth_bands.n_bands = 4;
+  fixture->depth_bands.near[0] = mm_to_raw[500];
+  fixture->depth_bands.far[0] = mm_to_raw[1000];
+  fixture->depth_bands.near[1] = mm_to_raw[1000];
+  fixture->depth_bands.far[1] = mm_to_raw[1500];
+  fixture->depth_bands.near[2] = mm_to_raw[1500];
+  fixture->depth_bands.far[2] = mm_to_raw[2500];
+  fixture->depth_bands.near[3] = mm_to_raw[2500];
+  fixture->depth_bands.far[3] = mm_to_raw[4000];
+
+  if (width == GFREENECT_REGISTRATION_WIDTH &&
+      height == GFREENECT_REGISTRATION_HEIGHT)
+    {
+      fixture->registration = create_registration ();
+      fixture->blob_detector =
+        gfreenect_blob_detector_new (fixture->registration);
+      fixture->floor_estimator =
+        gfreenect_floor_estimator_new (fixture->registration);
+      fixture->occupancy_grid =
+        gfreenect_occupancy_grid_new (fixture->registration, 50.0, 1 << 20);
+    }
+
+  g_free (mm_to_raw);
+  g_rand_free (rand);
+
+  return fixture;
+}
+
+static void
+fixture_free (Fixture *fixture)
+{
+  gfreenect_temporal_filter_clear (&fixture->temporal_average);
+  gfreenect_temporal_filter_clear (&fixture->temporal_median);
+  gfreenect_spatial_filter_clear (&fixture->bilateral);
+  gfreenect_spatial_filter_clear (&fixture->joint_bilateral);
+  gfreenect_motion_detector_clear (&fixture->motion_detector);
+  gfreenect_depth_bands_clear (&fixture->depth_bands);
+
+  if (fixture->registration != NULL)
+    {
+      g_object_unref (fixture->blob_detector);
+      g_object_unref (fixture->floor_estimator);
+      g_object_unref (fixture->occupancy_grid);
+      gfreenect_registration_unref (fixture->registration);
+    }
+
+  g_free (fixture->raw[0]);
+  g_free (fixture->raw[1]);
+  g_free (fixture->mm[0]);
+  g_free (fixture->mm[1]);
+  g_free (fixture->ir);
+  g_free (fixture->rgb);
+  g_free (fixture->out);
+  g_free (fixture->histogram);
+
+  g_slice_free (Fixture, fixture);
+}
+
+/* a tone reaching each microphone with a different delay, over a noise
+   floor */
+static AudioFixture *
+audio_fixture_new (void)
+{
+  AudioFixture *fixture;
+  GRand *rand;
+  guint i, c;
+
+  fixture = g_slice_new0 (AudioFixture);
+  fixture->beamformer = gfreenect_beamformer_new ();
+  fixture->frames = g_new (gint32, AUDIO_BLOCK * GFREENECT_AUDIO_CHANNELS);
+  fixture->output = g_new (gfloat, AUDIO_BLOCK);
+
+  rand = g_rand_new_with_seed (AUDIO_BLOCK);
+
+  for (i = 0; i < AUDIO_BLOCK; i++)
+    for (c = 0; c < GFREENECT_AUDIO_CHANNELS; c++)
+      {
+        gdouble t = (i - c * 2.5) / GFREENECT_AUDIO_SAMPLE_RATE;
+
+        fixture->frames[i * GFREENECT_AUDIO_CHANNELS + c] =
+          (1 << 20) * sin (2 * G_PI * 700.0 * t) +
+          g_rand_int_range (rand, -(1 << 16), 1 << 16);
+      }
+
+  g_rand_free (rand);
+
+  return fixture;
+}
+
+static void
+audio_fixture_free (AudioFixture *fixture)
+{
+  g_object_unref (fixture->beamformer);
+  g_free (fixture->frames);
+  g_free (fixture->output);
+
+  g_slice_free (AudioFixture, fixture);
+}
+
+/* the stand-in for the motor subdevice; only one transfer at a time is
+   served, so it is called with the fixture mutex held or by the
+   refreshing thread alone */
+static void
+read_motion_source (GFreenectMotionState *state)
+{
+  g_usleep (MOTION_TRANSFER_TIME);
+
+  state->timestamp = g_get_monotonic_time ();
+  state->accel_x = 0.0;
+  state->accel_y = 819.0;
+  state->accel_z = 0.0;
+  state->tilt_angle = 0.0;
+  state->tilt_status = GFREENECT_TILT_STATUS_STOPPED;
+}
+
+/* the dispatch thread of the device, reduced to the state refreshes */
+static gpointer
+motion_refresher_func (gpointer data)
+{
+  MotionFixture *fixture = data;
+  GFreenectMotionState state;
+
+  g_mutex_lock (&fixture->mutex);
+
+  while (TRUE)
+    {
+      while (! fixture->abort && ! fixture->cache.requested)
+        g_cond_wait (&fixture->cond, &fixture->mutex);
+
+      if (fixture->abort)
+        break;
+
+      gfreenect_motion_cache_begin_refresh (&fixture->cache);
+      g_mutex_unlock (&fixture->mutex);
+
+      read_motion_source (&state);
+
+      g_mutex_lock (&fixture->mutex);
+      gfreenect_motion_cache_end_refresh (&fixture->cache, &state);
+    }
+
+  gfreenect_motion_cache_abort (&fixture->cache);
+
+  g_mutex_unlock (&fixture->mutex);
+
+  return NULL;
+}
+
+static MotionFixture *
+motion_fixture_new (guint callers, gboolean coalesced)
+{
+  MotionFixture *fixture;
+
+  fixture = g_slice_new0 (MotionFixture);
+  fixture->callers = callers;
+  fixture->coalesced = coalesced;
+
+  g_mutex_init (&fixture->mutex);
+  g_cond_init (&fixture->cond);
+  gfreenect_motion_cache_init (&fixture->cache);
+
+  if (coalesced)
+    fixture->refresher = g_thread_new ("bench-motion-refresher",
+                                       motion_refresher_func,
+                                       fixture);
+
+  return fixture;
+}
+
+static void
+motion_fixture_free (MotionFixture *fixture)
+{
+  if (fixture->refresher != NULL)
+    {
+      g_mutex_lock (&fixture->mutex);
+      fixture->abort = TRUE;
+      g_cond_signal (&fixture->cond);
+      g_mutex_unlock (&fixture->mutex);
+
+      g_thread_join (fixture->refresher);
+    }
+
+  gfreenect_motion_cache_clear (&fixture->cache);
+  g_cond_clear (&fixture->cond);
+  g_mutex_clear (&fixture->mutex);
+
+  g_slice_free (MotionFixture, fixture);
+}
+
+/* kernels */
+
+static const guint16 *
+next_raw_frame (Fixture *fixture)
+{
+  fixture->frame ^= 1;
+
+  return fixture->raw[fixture->frame];
+}
+
+static const guint16 *
+next_mm_frame (Fixture *fixture)
+{
+  fixture->frame ^= 1;
+
+  return fixture->mm[fixture->frame];
+}
+
+static void
+bench_depth_grayscale (gpointer data)
+{
+  Fixture *f = data;
+
+  gfreenect_convert_depth_grayscale (f->raw[0], f->width, &f->full, f->out);
+}
+
+static void
+bench_depth_grayscale_range (gpointer data)
+{
+  Fixture *f = data;
+
+  gfreenect_convert_depth_grayscale_range (f->raw[0],
+                                           f->width,
+                                           &f->full,
+                                           DEPTH_INVALID,
+                                           f->raw_min,
+                                           f->raw_max,
+                                           f->out);
+}
+
+static void
+bench_depth_grayscale_roi (gpointer data)
+{
+  Fixture *f = data;
+
+  gfreenect_convert_depth_grayscale (f->raw[0], f->width, &f->roi, f->out);
+}
+
+static void
+bench_depth_crop (gpointer data)
+{
+  Fixture *f = data;
+
+  gfreenect_convert_crop ((const guint8 *) f->raw[0],
+                          f->width,
+                          sizeof (guint16),
+                          &f->roi,
+                          f->out);
+}
+
+static void
+bench_ir_rgb (gpointer data)
+{
+  Fixture *f = data;
+
+  gfreenect_convert_gray_rgb (f->ir, f->width, &f->full, f->out);
+}
+
+static void
+bench_ir_rgb_roi (gpointer data)
+{
+  Fixture *f = data;
+
+  gfreenect_convert_gray_rgb (f->ir, f->width, &f->roi, f->out);
+}
+
+static void
+bench_rgb_crop (gpointer data)
+{
+  Fixture *f = data;
+
+  gfreenect_convert_crop (f->rgb, f->width, 3, &f->roi, f->out);
+}
+
+static void
+bench_depth_stats (gpointer data)
+{
+  Fixture *f = data;
+  GFreenectDepthStats stats;
+
+  gfreenect_depth_stats_compute (&stats,
+                                 f->raw[0],
+                                 f->pixels,
+                                 DEPTH_INVALID,
+                                 0,
+                                 f->histogram);
+}
+
+static void
+bench_pyramid_min (gpointer data)
+{
+  Fixture *f = data;
+
+  gfreenect_depth_pyramid_reduce (GFREENECT_DEPTH_PYRAMID_MIN,
+                                  f->raw[0],
+                                  f->width,
+                                  f->height,
+                                  DEPTH_INVALID,
+                                  f->out);
+}
+
+static void
+bench_pyramid_median (gpointer data)
+{
+  Fixture *f = data;
+
+  gfreenect_depth_pyramid_reduce (GFREENECT_DEPTH_PYRAMID_MEDIAN,
+                                  f->raw[0],
+                                  f->width,
+                                  f->height,
+                                  DEPTH_INVALID,
+                                  f->out);
+}
+
+static void
+bench_temporal_average (gpointer data)
+{
+  Fixture *f = data;
+
+  gfreenect_temporal_filter_process (&f->temporal_average,
+                                     next_raw_frame (f),
+                                     f->pixels,
+                                     DEPTH_INVALID);
+}
+
+static void
+bench_temporal_median (gpointer data)
+{
+  Fixture *f = data;
+
+  gfreenect_temporal_filter_process (&f->temporal_median,
+                                     next_raw_frame (f),
+                                     f->pixels,
+                                     DEPTH_INVALID);
+}
+
+static void
+bench_bilateral (gpointer data)
+{
+  Fixture *f = data;
+
+  gfreenect_spatial_filter_process (&f->bilateral,
+                                    f->raw[0],
+                                    f->width,
+                                    f->height,
+                                    DEPTH_INVALID,
+                                    NULL);
+}
+
+static void
+bench_joint_bilateral (gpointer data)
+{
+  Fixture *f = data;
+
+  gfreenect_spatial_filter_process (&f->joint_bilateral,
+                                    f->raw[0],
+                                    f->width,
+                                    f->height,
+                                    DEPTH_INVALID,
+                                    f->rgb);
+}
+
+static void
+bench_depth_bands (gpointer data)
+{
+  Fixture *f = data;
+
+  gfreenect_depth_bands_process (&f->depth_bands,
+                                 f->raw[0],
+                                 f->width,
+                                 f->height,
+                                 DEPTH_INVALID);
+}
+
+static void
+bench_motion_detector (gpointer data)
+{
+  Fixture *f = data;
+  GPtrArray *regions;
+
+  regions = gfreenect_motion_detector_process (&f->motion_detector,
+                                               next_raw_frame (f),
+                                               f->width,
+                                               f->height,
+                                               DEPTH_INVALID);
+  if (regions != NULL)
+    g_ptr_array_unref (regions);
+}
+
+static void
+bench_raw_to_mm (gpointer data)
+{
+  Fixture *f = data;
+
+  gfreenect_registration_raw_to_mm (f->registration,
+                                    f->raw[0],
+                                    f->out,
+                                    f->pixels);
+}
+
+static void
+bench_registration_apply (gpointer data)
+{
+  Fixture *f = data;
+
+  gfreenect_registration_apply (f->registration, f->raw[0], f->out);
+}
+
+static void
+bench_depth_to_points (gpointer data)
+{
+  Fixture *f = data;
+
+  gfreenect_registration_depth_to_points (f->registration, f->mm[0], f->out);
+}
+
+static void
+bench_depth_to_normals (gpointer data)
+{
+  Fixture *f = data;
+
+  gfreenect_registration_depth_to_normals (f->registration,
+                                           f->mm[0],
+                                           5,
+                                           f->out);
+}
+
+static void
+bench_blob_detector (gpointer data)
+{
+  Fixture *f = data;
+
+  g_ptr_array_unref (gfreenect_blob_detector_process (f->blob_detector,
+                                                      f->mm[0],
+                                                      f->width,
+                                                      f->height));
+}
+
+static void
+bench_floor_estimator (gpointer data)
+{
+  Fixture *f = data;
+
+  gfreenect_floor_estimator_process (f->floor_estimator, next_mm_frame (f));
+}
+
+static void
+bench_occupancy_grid (gpointer data)
+{
+  Fixture *f = data;
+
+  gfreenect_occupancy_grid_process (f->occupancy_grid, next_mm_frame (f));
+}
+
+static void
+bench_beamformer (gpointer data)
+{
+  AudioFixture *f = data;
+
+  gfreenect_beamformer_process (f->beamformer,
+                                f->frames,
+                                AUDIO_BLOCK,
+                                f->output);
+}
+
+/* with a max_age of 0, as gfreenect_device_get_tilt_angle_sync() and
+   gfreenect_device_get_accel_sync() query the state */
+static gpointer
+motion_caller_func (gpointer data)
+{
+  MotionFixture *f = data;
+  GFreenectMotionState state;
+  guint i;
+
+  for (i = 0; i < MOTION_QUERIES; i++)
+    {
+      g_mutex_lock (&f->mutex);
+
+      if (! f->coalesced)
+        read_motion_source (&state);
+      else if (! gfreenect_motion_cache_lookup (&f->cache, 0, &state))
+        gfreenect_motion_cache_wait (&f->cache,
+                                     &f->mutex,
+                                     &f->cond,
+                                     &f->abort,
+                                     &state,
+                                     NULL);
+
+      g_mutex_unlock (&f->mutex);
+    }
+
+  return NULL;
+}
+
+static void
+bench_motion_queries (gpointer data)
+{
+  MotionFixture *f = data;
+  GThread **callers;
+  guint i;
+
+  callers = g_newa (GThread *, f->callers);
+  for (i = 0; i < f->callers; i++)
+    callers[i] = g_thread_new ("bench-motion-caller", motion_caller_func, f);
+
+  for (i = 0; i < f->callers; i++)
+    g_thread_join (callers[i]);
+}
+
+/* registry */
+
+static void
+bench_free (Bench *bench)
+{
+  g_free (bench->name);
+  g_slice_free (Bench, bench);
+}
+
+static void
+add_bench (const gchar *name,
+           guint        width,
+           guint        height,
+           const gchar *unit,
+           gsize        items,
+           gsize        bytes,
+           gboolean     parallel,
+           BenchFunc    func,
+           gpointer     data)
+{
+  Bench *bench;
+
+  bench = g_slice_new0 (Bench);
+  if (width > 0)
+    bench->name = g_strdup_printf ("%s@%ux%u", name, width, height);
+  else
+    bench->name = g_strdup (name);
+  bench->width = width;
+  bench->height = height;
+  bench->unit = unit;
+  bench->items = items;
+  bench->bytes = bytes;
+  bench->parallel = parallel;
+  bench->func = func;
+  bench->data = data;
+
+  if (filter == NULL || g_pattern_match_simple (filter, bench->name))
+    g_ptr_array_add (benches, bench);
+  else
+    bench_free (bench);
+}
+
+/* adds the benchmarks of the frame kernels at one resolution */
+static void
+add_frame_benches (Fixture *f)
+{
+  guint w = f->width;
+  guint h = f->height;
+  gsize px = f->pixels;
+  gsize roi = f->roi.width * f->roi.height;
+
+#define ADD(name, items, bytes, parallel, func) \
+  add_bench (name, w, h, "pixel", items, bytes, parallel, func, f)
+
+  ADD ("depth-grayscale/11bit", px, px * 5, TRUE,
+       bench_depth_grayscale);
+  ADD ("depth-grayscale/11bit-auto-range", px, px * 5, TRUE,
+       bench_depth_grayscale_range);
+  ADD ("depth-grayscale/11bit-roi", roi, roi * 5, TRUE,
+       bench_depth_grayscale_roi);
+  ADD ("depth-raw/11bit-roi", roi, roi * 4, FALSE,
+       bench_depth_crop);
+  ADD ("video-rgb/ir-8bit", px, px * 4, TRUE,
+       bench_ir_rgb);
+  ADD ("video-rgb/ir-8bit-roi", roi, roi * 4, TRUE,
+       bench_ir_rgb_roi);
+  ADD ("video-rgb/rgb-roi", roi, roi * 6, FALSE,
+       bench_rgb_crop);
+  ADD ("depth-stats/11bit", px, px * 2, TRUE,
+       bench_depth_stats);
+  ADD ("depth-pyramid/min", px, px * 2 + px / 2, FALSE,
+       bench_pyramid_min);
+  ADD ("depth-pyramid/median", px, px * 2 + px / 2, FALSE,
+       bench_pyramid_median);
+  ADD ("temporal-filter/average", px, px * 4, TRUE,
+       bench_temporal_average);
+  ADD ("temporal-filter/median", px, px * 4, TRUE,
+       bench_temporal_median);
+  ADD ("spatial-filter/bilateral", px, px * 4, TRUE,
+       bench_bilateral);
+  ADD ("spatial-filter/joint-bilateral", px, px * 7, TRUE,
+       bench_joint_bilateral);
+  ADD ("depth-bands/4-bands", px, px * 2 + px / 2, TRUE,
+       bench_depth_bands);
+  ADD ("motion-detector", px, px * 2, FALSE,
+       bench_motion_detector);
+
+  if (f->registration == NULL)
+    return;
+
+  ADD ("lut/raw-to-mm", px, px * 4, FALSE,
+       bench_raw_to_mm);
+  ADD ("registration/apply", px, px * 4, TRUE,
+       bench_registration_apply);
+  ADD ("registration/depth-to-points", px, px * 14, TRUE,
+       bench_depth_to_points);
+  ADD ("registration/depth-to-normals", px, px * 14, TRUE,
+       bench_depth_to_normals);
+  ADD ("blob-detector", px, px * 2, TRUE,
+       bench_blob_detector);
+  ADD ("floor-estimator", px, px * 2, TRUE,
+       bench_floor_estimator);
+  ADD ("occupancy-grid", px, px * 2, TRUE,
+       bench_occupancy_grid);
+
+#undef ADD
+}
+
+/* measurement */
+
+static guint64
+read_cycles (void)
+{
+#ifdef HAVE_CYCLE_COUNTER
+  return __rdtsc ();
+#else
+  return 0;
+#endif
+}
+
+static gint
+compare_doubles (gconstpointer a, gconstpointer b)
+{
+  gdouble x = *(const gdouble *) a;
+  gdouble y = *(const gdouble *) b;
+
+  return x < y ? -1 : x > y ? 1 : 0;
+}
+
+static gdouble
+get_median (gdouble *values, guint n)
+{
+  qsort (values, n, sizeof (gdouble), compare_doubles);
+
+  return n % 2 == 1 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+}
+
+static void
+run_bench (const Bench *bench, guint threads, BenchResult *result)
+{
+  gdouble *samples;
+  gdouble *cycles;
+  guint iterations;
+  gint64 start;
+  gint64 elapsed;
+  guint64 start_cycles;
+  gdouble sum = 0.0;
+  gdouble sum_sq = 0.0;
+  gint i;
+  guint j;
+
+  for (i = 0; i < warmup; i++)
+    bench->func (bench->data);
+
+  /* double the runs per sample until a sample lasts long enough */
+  iterations = 1;
+  for (;;)
+    {
+      start = g_get_monotonic_time ();
+      for (j = 0; j < iterations; j++)
+        bench->func (bench->data);
+      elapsed = g_get_monotonic_time () - start;
+
+      if (elapsed >= (gint64) min_time * 1000 || iterations >= G_MAXUINT / 2)
+        break;
+
+      iterations *= 2;
+    }
+
+  samples = g_new (gdouble, repeats);
+  cycles = g_new (gdouble, repeats);
+
+  for (i = 0; i < repeats; i++)
+    {
+      start_cycles = read_cycles ();
+      start = g_get_monotonic_time ();
+
+      for (j = 0; j < iterations; j++)
+        bench->func (bench->data);
+
+      elapsed = g_get_monotonic_time () - start;
+
+      samples[i] = elapsed * 1000.0 / iterations;
+      cycles[i] = (gdouble) (read_cycles () - start_cycles) / iterations;
+
+      sum += samples[i];
+      sum_sq += samples[i] * samples[i];
+    }
+
+  result->threads = threads;
+  result->iterations = iterations;
+  result->mean = sum / repeats;
+  result->stddev = repeats > 1 ?
+    sqrt (MAX (sum_sq - sum * result->mean, 0.0) / (repeats - 1)) : 0.0;
+  result->median = get_median (samples, repeats);
+  result->min = samples[0];
+
+#ifdef HAVE_CYCLE_COUNTER
+  result->cycles = get_median (cycles, repeats);
+#else
+  result->cycles = -1.0;
+#endif
+
+  g_free (samples);
+  g_free (cycles);
+}
+
+/* reporting */
+
+static void
+append_double (GString *json, const gchar *key, gdouble value)
+{
+  gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+  g_string_append_printf (json,
+                          "\"%s\": %s",
+                          key,
+                          g_ascii_formatd (buf, sizeof (buf), "%.6g", value));
+}
+
+static void
+append_result (GString           *json,
+               const Bench       *bench,
+               const BenchResult *result)
+{
+  g_string_append_printf (json,
+                          "    {\n"
+                          "      \"name\": \"%s\",\n"
+                          "      \"width\": %u,\n"
+                          "      \"height\": %u,\n"
+                          "      \"unit\": \"%s\",\n"
+                          "      \"items\": %" G_GSIZE_FORMAT ",\n"
+                          "      \"bytes\": %" G_GSIZE_FORMAT ",\n"
+                          "      \"threads\": %u,\n"
+                          "      \"iterations\": %u,\n"
+                          "      \"samples\": %d,\n"
+                          "      \"ns_per_run\": { ",
+                          bench->name,
+                          bench->width,
+                          bench->height,
+                          bench->unit,
+                          bench->items,
+                          bench->bytes,
+                          result->threads,
+                          result->iterations,
+                          repeats);
+
+  append_double (json, "min", result->min);
+  g_string_append (json, ", ");
+  append_double (json, "median", result->median);
+  g_string_append (json, ", ");
+  append_double (json, "mean", result->mean);
+  g_string_append (json, ", ");
+  append_double (json, "stddev", result->stddev);
+  g_string_append (json, " },\n      ");
+
+  append_double (json, "ns_per_item", result->median / bench->items);
+  g_string_append (json, ",\n      ");
+
+  /* bytes per nanosecond are GB/s */
+  append_double (json, "gb_per_second", bench->bytes / result->median);
+  g_string_append (json, ",\n      ");
+
+  if (result->cycles >= 0)
+    append_double (json, "cycles_per_item", result->cycles / bench->items);
+  else
+    g_string_append (json, "\"cycles_per_item\": null");
+
+  g_string_append (json, "\n    }");
+}
+
+static void
+print_result (const Bench *bench, const BenchResult *result)
+{
+  gchar cycles[32];
+
+  if (result->cycles >= 0)
+    g_snprintf (cycles, sizeof (cycles), "%.2f", result->cycles / bench->items);
+  else
+    g_strlcpy (cycles, "-", sizeof (cycles));
+
+  g_print ("%-52s %7u %10.3f %8.3f %11s %6.1f%%\n",
+           bench->name,
+           result->threads,
+           result->median / bench->items,
+           bench->bytes / result->median,
+           cycles,
+           result->mean > 0 ? 100.0 * result->stddev / result->mean : 0.0);
+}
+
+static GArray *
+parse_threads (GError **error)
+{
+  GArray *threads;
+  gchar **tokens;
+  guint i;
+
+  threads = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  if (threads_list == NULL)
+    {
+      guint n = gfreenect_worker_pool_get_size ();
+
+      g_array_append_val (threads, n);
+      return threads;
+    }
+
+  tokens = g_strsplit (threads_list, ",", -1);
+
+  for (i = 0; tokens[i] != NULL; i++)
+    {
+      gchar *end;
+      guint64 n;
+      guint value;
+
+      n = g_ascii_strtoull (tokens[i], &end, 10);
+      if (end == tokens[i] || *end != '\0' || n == 0 || n > 1024)
+        {
+          g_set_error (error,
+                       G_OPTION_ERROR,
+                       G_OPTION_ERROR_BAD_VALUE,
+                       "Invalid number of threads '%s'",
+                       tokens[i]);
+          g_strfreev (tokens);
+          g_array_unref (threads);
+          return NULL;
+        }
+
+      value = n;
+      g_array_append_val (threads, value);
+    }
+
+  g_strfreev (tokens);
+
+  return threads;
+}
+
+int
+main (int argc, char *argv[])
+{
+  GOptionContext *context;
+  GError *error = NULL;
+  GArray *threads;
+  Fixture *fixtures[3];
+  AudioFixture *audio;
+  static const guint motion_callers[] = { 1, 4, 16, 64 };
+  MotionFixture *motion[2 * G_N_ELEMENTS (motion_callers)];
+  GString *json;
+  GDateTime *now;
+  gchar *date;
+  guint i, t;
+  gboolean first = TRUE;
+
+  context = g_option_context_new ("- benchmark the frame processing kernels");
+  g_option_context_add_main_entries (context, entries, NULL);
+
+  if (! g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      g_error_free (error);
+      g_option_context_free (context);
+      return 1;
+    }
+
+  g_option_context_free (context);
+
+  if (warmup < 0 || repeats < 1 || min_time < 0)
+    {
+      g_printerr ("--warmup and --min-time cannot be negative, and --repeats "
+                  "must be at least 1\n");
+      return 1;
+    }
+
+  threads = parse_threads (&error);
+  if (threads == NULL)
+    {
+      g_printerr ("%s\n", error->message);
+      g_error_free (error);
+      return 1;
+    }
+
+  benches = g_ptr_array_new_with_free_func ((GDestroyNotify) bench_free);
+
+  /* the resolutions of GFreenectResolution */
+  fixtures[0] = fixture_new (320, 240);
+  fixtures[1] = fixture_new (640, 480);
+  fixtures[2] = fixture_new (1280, 1024);
+
+  for (i = 0; i < G_N_ELEMENTS (fixtures); i++)
+    add_frame_benches (fixtures[i]);
+
+  audio = audio_fixture_new ();
+  add_bench ("beamformer/delay-and-sum", 0, 0, "frame", AUDIO_BLOCK,
+             AUDIO_BLOCK * (GFREENECT_AUDIO_CHANNELS * sizeof (gint32) +
+                            sizeof (gfloat)),
+             FALSE, bench_beamformer, audio);
+
+  for (i = 0; i < G_N_ELEMENTS (motion); i++)
+    {
+      guint callers = motion_callers[i / 2];
+      gboolean coalesced = i % 2 == 0;
+      gchar *name;
+
+      motion[i] = motion_fixture_new (callers, coalesced);
+
+      name = g_strdup_printf ("motion-state/%s-%u-callers",
+                              coalesced ? "coalesced" : "per-query",
+                              callers);
+      add_bench (name, 0, 0, "query", callers * MOTION_QUERIES, 0,
+                 FALSE, bench_motion_queries, motion[i]);
+      g_free (name);
+    }
+
+  if (list_only)
+    {
+      for (i = 0; i < benches->len; i++)
+        g_print ("%s\n", ((Bench *) g_ptr_array_index (benches, i))->name);
+
+      goto out;
+    }
+
+  now = g_date_time_new_now_utc ();
+  date = g_date_time_format (now, "%Y-%m-%dT%H:%M:%SZ");
+  g_date_time_unref (now);
+
+  json = g_string_new (NULL);
+  g_string_append_printf (json,
+                          "{\n"
+                          "  \"version\": \"%s\",\n"
+                          "  \"glib_version\": \"%u.%u.%u\",\n"
+                          "  \"date\": \"%s\",\n"
+                          "  \"processors\": %u,\n"
+                          "  \"warmup\": %d,\n"
+                          "  \"repeats\": %d,\n"
+                          "  \"min_time_ms\": %d,\n"
+                          "  \"cycle_counter\": %s,\n"
+                          "  \"results\": [\n",
+#ifdef PACKAGE_VERSION
+                          PACKAGE_VERSION,
+#else
+                          "unknown",
+#endif
+                          glib_major_version,
+                          glib_minor_version,
+                          glib_micro_version,
+                          date,
+                          g_get_num_processors (),
+                          warmup,
+                          repeats,
+                          min_time,
+#ifdef HAVE_CYCLE_COUNTER
+                          "\"tsc\""
+#else
+                          "null"
+#endif
+                          );
+  g_free (date);
+
+  g_print ("%-52s %7s %10s %8s %11s %7s\n",
+           "benchmark", "threads", "ns/item", "GB/s", "cycles/item", "stddev");
+
+  for (i = 0; i < benches->len; i++)
+    {
+      Bench *bench = g_ptr_array_index (benches, i);
+
+      /* serial kernels do not depend on the size of the pool */
+      for (t = 0; t < (bench->parallel ? threads->len : 1); t++)
+        {
+          BenchResult result;
+          guint n = bench->parallel ? g_array_index (threads, guint, t) : 1;
+
+          gfreenect_worker_pool_set_size (n);
+
+          run_bench (bench, n, &result);
+          print_result (bench, &result);
+
+          if (! first)
+            g_string_append (json, ",\n");
+          first = FALSE;
+
+          append_result (json, bench, &result);
+        }
+    }
+
+  g_string_append (json, "\n  ]\n}\n");
+
+  if (output != NULL &&
+      ! g_file_set_contents (output, json->str, json->len, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      g_error_free (error);
+    }
+
+  g_string_free (json, TRUE);
+
+ out:
+  g_ptr_array_unref (benches);
+
+  for (i = 0; i < G_N_ELEMENTS (fixtures); i++)
+    fixture_free (fixtures[i]);
+  audio_fixture_free (audio);
+
+  for (i = 0; i < G_N_ELEMENTS (motion); i++)
+    motion_fixture_free (motion[i]);
+
+  g_array_unref (threads);
+
+  return error == NULL ? 0 : 1;
+}
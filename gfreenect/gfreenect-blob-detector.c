@@ -0,0 +1,673 @@
+/*
+ * gfreenect-blob-detector.c
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+/**
+ * SECTION:gfreenect-blob-detector
+ * @short_description: Segments depth frames in connected blobs
+ *
+ * A #GFreenectBlobDetector groups the pixels of a depth frame that lie
+ * between the #GFreenectBlobDetector:near-clip and
+ * #GFreenectBlobDetector:far-clip distances into connected components.
+ * Neighbouring pixels belong to the same blob when their depths differ by
+ * no more than #GFreenectBlobDetector:depth-threshold, so that objects in
+ * front of each other are kept apart.
+ *
+ * gfreenect_blob_detector_process() takes an unregistered depth frame in
+ * millimeters, as delivered in %GFREENECT_DEPTH_FORMAT_MM, and returns a
+ * #GFreenectBlob for every component with at least
+ * #GFreenectBlobDetector:min-pixels pixels. The world coordinates of the
+ * blob centroids are computed with the #GFreenectRegistration of the device
+ * the frames come from, if given to gfreenect_blob_detector_new().
+ **/
+
+#include <string.h>
+
+#include "gfreenect-blob-detector.h"
+#include "gfreenect-parallel.h"
+
+#define GFREENECT_BLOB_DETECTOR_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), \
+                                                  GFREENECT_TYPE_BLOB_DETECTOR, \
+                                                  GFreenectBlobDetectorPrivate))
+
+#define DEFAULT_NEAR_CLIP       500
+#define DEFAULT_FAR_CLIP        4000
+#define DEFAULT_DEPTH_THRESHOLD 50
+#define DEFAULT_MIN_PIXELS      200
+
+/* world size of a depth pixel at 1mm, from the nominal sensor parameters,
+   used when no registration is available */
+#define DEFAULT_WORLD_FACTOR    (2.0 * 0.1042 / 120.0)
+#define REFERENCE_WIDTH         640
+
+#define MIN_ROWS_PER_CHUNK      32
+
+#define BACKGROUND              -1
+
+/* private data */
+struct _GFreenectBlobDetectorPrivate
+{
+  GFreenectRegistration *registration;
+
+  guint near_clip;
+  guint far_clip;
+  guint depth_threshold;
+  guint min_pixels;
+
+  gsize width;
+  gsize height;
+  gint32 *parent;
+  gint32 *slot;
+  guint8 *strip_start;
+};
+
+typedef struct
+{
+  GFreenectBlobDetectorPrivate *priv;
+  const guint16 *depth;
+} LabelJob;
+
+typedef struct
+{
+  guint x1, y1, x2, y2;
+  gsize pixels;
+  guint64 sum_z;
+  guint64 sum_xz;
+  guint64 sum_yz;
+} BlobAccum;
+
+/* properties */
+enum
+{
+  PROP_0,
+  PROP_REGISTRATION,
+  PROP_NEAR_CLIP,
+  PROP_FAR_CLIP,
+  PROP_DEPTH_THRESHOLD,
+  PROP_MIN_PIXELS
+};
+
+static void     gfreenect_blob_detector_class_init         (GFreenectBlobDetectorClass *class);
+static void     gfreenect_blob_detector_init               (GFreenectBlobDetector *self);
+static void     gfreenect_blob_detector_finalize           (GObject *obj);
+
+static void     gfreenect_blob_detector_set_property       (GObject      *obj,
+                                                            guint         prop_id,
+                                                            const GValue *value,
+                                                            GParamSpec   *pspec);
+static void     gfreenect_blob_detector_get_property       (GObject    *obj,
+                                                            guint       prop_id,
+                                                            GValue     *value,
+                                                            GParamSpec *pspec);
+
+G_DEFINE_TYPE (GFreenectBlobDetector, gfreenect_blob_detector, G_TYPE_OBJECT);
+
+static void
+gfreenect_blob_detector_class_init (GFreenectBlobDetectorClass *class)
+{
+  GObjectClass *obj_class;
+
+  obj_class = G_OBJECT_CLASS (class);
+
+  obj_class->finalize = gfreenect_blob_detector_finalize;
+  obj_class->get_property = gfreenect_blob_detector_get_property;
+  obj_class->set_property = gfreenect_blob_detector_set_property;
+
+  /* install properties */
+
+  /**
+   * GFreenectBlobDetector:registration
+   *
+   * The #GFreenectRegistration used to compute the world coordinates of the
+   * blob centroids, or %NULL to use the nominal parameters of the sensor.
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_REGISTRATION,
+                                   g_param_spec_boxed ("registration",
+                                                       "Registration",
+                                                       "Registration used to compute world coordinates",
+                                                       GFREENECT_TYPE_REGISTRATION,
+                                                       G_PARAM_READWRITE |
+                                                       G_PARAM_CONSTRUCT_ONLY |
+                                                       G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GFreenectBlobDetector:near-clip
+   *
+   * The distance, in millimeters, below which pixels are ignored.
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_NEAR_CLIP,
+                                   g_param_spec_uint ("near-clip",
+                                                      "Near clip",
+                                                      "Distance below which pixels are ignored",
+                                                      1,
+                                                      G_MAXUINT16,
+                                                      DEFAULT_NEAR_CLIP,
+                                                      G_PARAM_READWRITE |
+                                                      G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GFreenectBlobDetector:far-clip
+   *
+   * The distance, in millimeters, beyond which pixels are ignored.
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_FAR_CLIP,
+                                   g_param_spec_uint ("far-clip",
+                                                      "Far clip",
+                                                      "Distance beyond which pixels are ignored",
+                                                      1,
+                                                      G_MAXUINT16,
+                                                      DEFAULT_FAR_CLIP,
+                                                      G_PARAM_READWRITE |
+                                                      G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GFreenectBlobDetector:depth-threshold
+   *
+   * The largest depth difference, in millimeters, between neighbouring
+   * pixels of the same blob.
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_DEPTH_THRESHOLD,
+                                   g_param_spec_uint ("depth-threshold",
+                                                      "Depth threshold",
+                                                      "Largest depth difference between neighbouring pixels of a blob",
+                                                      0,
+                                                      G_MAXUINT16,
+                                                      DEFAULT_DEPTH_THRESHOLD,
+                                                      G_PARAM_READWRITE |
+                                                      G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GFreenectBlobDetector:min-pixels
+   *
+   * The number of pixels below which connected components are not reported
+   * as blobs.
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_MIN_PIXELS,
+                                   g_param_spec_uint ("min-pixels",
+                                                      "Minimum pixels",
+                                                      "Smallest number of pixels of a blob",
+                                                      1,
+                                                      G_MAXUINT,
+                                                      DEFAULT_MIN_PIXELS,
+                                                      G_PARAM_READWRITE |
+                                                      G_PARAM_STATIC_STRINGS));
+
+  /* add private structure */
+  g_type_class_add_private (obj_class, sizeof (GFreenectBlobDetectorPrivate));
+}
+
+static void
+gfreenect_blob_detector_init (GFreenectBlobDetector *self)
+{
+  GFreenectBlobDetectorPrivate *priv;
+
+  priv = GFREENECT_BLOB_DETECTOR_GET_PRIVATE (self);
+  self->priv = priv;
+
+  priv->registration = NULL;
+
+  priv->near_clip = DEFAULT_NEAR_CLIP;
+  priv->far_clip = DEFAULT_FAR_CLIP;
+  priv->depth_threshold = DEFAULT_DEPTH_THRESHOLD;
+  priv->min_pixels = DEFAULT_MIN_PIXELS;
+
+  priv->width = 0;
+  priv->height = 0;
+  priv->parent = NULL;
+  priv->slot = NULL;
+  priv->strip_start = NULL;
+}
+
+static void
+gfreenect_blob_detector_finalize (GObject *obj)
+{
+  GFreenectBlobDetector *self = GFREENECT_BLOB_DETECTOR (obj);
+
+  if (self->priv->registration != NULL)
+    gfreenect_registration_unref (self->priv->registration);
+
+  g_free (self->priv->parent);
+  g_free (self->priv->slot);
+  g_free (self->priv->strip_start);
+
+  G_OBJECT_CLASS (gfreenect_blob_detector_parent_class)->finalize (obj);
+}
+
+static void
+gfreenect_blob_detector_set_property (GObject      *obj,
+                                      guint         prop_id,
+                                      const GValue *value,
+                                      GParamSpec   *pspec)
+{
+  GFreenectBlobDetector *self;
+
+  self = GFREENECT_BLOB_DETECTOR (obj);
+
+  switch (prop_id)
+    {
+    case PROP_REGISTRATION:
+      self->priv->registration = g_value_dup_boxed (value);
+      break;
+
+    case PROP_NEAR_CLIP:
+      self->priv->near_clip = g_value_get_uint (value);
+      break;
+
+    case PROP_FAR_CLIP:
+      self->priv->far_clip = g_value_get_uint (value);
+      break;
+
+    case PROP_DEPTH_THRESHOLD:
+      self->priv->depth_threshold = g_value_get_uint (value);
+      break;
+
+    case PROP_MIN_PIXELS:
+      self->priv->min_pixels = g_value_get_uint (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (obj, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+gfreenect_blob_detector_get_property (GObject    *obj,
+                                      guint       prop_id,
+                                      GValue     *value,
+                                      GParamSpec *pspec)
+{
+  GFreenectBlobDetector *self;
+
+  self = GFREENECT_BLOB_DETECTOR (obj);
+
+  switch (prop_id)
+    {
+    case PROP_REGISTRATION:
+      g_value_set_boxed (value, self->priv->registration);
+      break;
+
+    case PROP_NEAR_CLIP:
+      g_value_set_uint (value, self->priv->near_clip);
+      break;
+
+    case PROP_FAR_CLIP:
+      g_value_set_uint (value, self->priv->far_clip);
+      break;
+
+    case PROP_DEPTH_THRESHOLD:
+      g_value_set_uint (value, self->priv->depth_threshold);
+      break;
+
+    case PROP_MIN_PIXELS:
+      g_value_set_uint (value, self->priv->min_pixels);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (obj, prop_id, pspec);
+      break;
+    }
+}
+
+static inline gint32
+find_root (gint32 *parent, gint32 i)
+{
+  /* path halving */
+  while (parent[i] != i)
+    {
+      parent[i] = parent[parent[i]];
+      i = parent[i];
+    }
+
+  return i;
+}
+
+static inline void
+unite (gint32 *parent, gint32 a, gint32 b)
+{
+  a = find_root (parent, a);
+  b = find_root (parent, b);
+
+  /* the smaller index becomes the root, so roots are the first pixel of
+     their component in raster order */
+  if (a < b)
+    parent[b] = a;
+  else if (b < a)
+    parent[a] = b;
+}
+
+/* Labels a strip of rows on its own. Unions only involve pixels of the
+   strip, so strips can be labelled concurrently and are stitched
+   together afterwards. */
+static void
+label_rows (guint first, guint last, gpointer user_data)
+{
+  LabelJob *job = user_data;
+  GFreenectBlobDetectorPrivate *priv = job->priv;
+  const guint16 *depth = job->depth;
+  gint32 *parent = priv->parent;
+  gint width = priv->width;
+  guint threshold = priv->depth_threshold;
+  guint y;
+  gint x;
+
+  priv->strip_start[first] = TRUE;
+
+  for (y = first; y < last; y++)
+    for (x = 0; x < width; x++)
+      {
+        gint32 i = y * width + x;
+        guint d = depth[i];
+
+        if (d == 0 || d < priv->near_clip || d > priv->far_clip)
+          {
+            parent[i] = BACKGROUND;
+            continue;
+          }
+
+        parent[i] = i;
+
+        if (x > 0 && parent[i - 1] != BACKGROUND &&
+            (guint) ABS ((gint) d - depth[i - 1]) <= threshold)
+          {
+            unite (parent, i - 1, i);
+          }
+
+        if (y > first && parent[i - width] != BACKGROUND &&
+            (guint) ABS ((gint) d - depth[i - width]) <= threshold)
+          {
+            unite (parent, i - width, i);
+          }
+      }
+}
+
+static void
+stitch_strips (GFreenectBlobDetectorPrivate *priv, const guint16 *depth)
+{
+  gint32 *parent = priv->parent;
+  gint width = priv->width;
+  guint y;
+  gint x;
+
+  for (y = 1; y < priv->height; y++)
+    {
+      if (! priv->strip_start[y])
+        continue;
+
+      for (x = 0; x < width; x++)
+        {
+          gint32 i = y * width + x;
+
+          if (parent[i] != BACKGROUND && parent[i - width] != BACKGROUND &&
+              (guint) ABS ((gint) depth[i] - depth[i - width]) <= priv->depth_threshold)
+            {
+              unite (parent, i - width, i);
+            }
+        }
+    }
+}
+
+static gdouble
+get_world_factor (GFreenectBlobDetectorPrivate *priv)
+{
+  gdouble factor = DEFAULT_WORLD_FACTOR;
+  gdouble unused;
+
+  /* the world size of one pixel at 1mm */
+  if (priv->registration != NULL)
+    gfreenect_registration_camera_to_world (priv->registration,
+                                            GFREENECT_REGISTRATION_WIDTH / 2 + 1,
+                                            GFREENECT_REGISTRATION_HEIGHT / 2,
+                                            1,
+                                            &factor,
+                                            &unused);
+
+  return factor * REFERENCE_WIDTH / priv->width;
+}
+
+static gint
+compare_blobs (gconstpointer a, gconstpointer b)
+{
+  const GFreenectBlob *blob_a = *(const GFreenectBlob **) a;
+  const GFreenectBlob *blob_b = *(const GFreenectBlob **) b;
+
+  if (blob_a->pixels == blob_b->pixels)
+    return 0;
+
+  return blob_a->pixels > blob_b->pixels ? -1 : 1;
+}
+
+static GPtrArray *
+collect_blobs (GFreenectBlobDetectorPrivate *priv, const guint16 *depth)
+{
+  GPtrArray *blobs;
+  GArray *accums;
+  gdouble factor;
+  gsize pixels;
+  guint x, y;
+  guint i;
+
+  pixels = priv->width * priv->height;
+  memset (priv->slot, 0xff, pixels * sizeof (gint32));
+
+  accums = g_array_new (FALSE, TRUE, sizeof (BlobAccum));
+
+  for (y = 0; y < priv->height; y++)
+    for (x = 0; x < priv->width; x++)
+      {
+        gint32 p = y * priv->width + x;
+        BlobAccum *accum;
+        gint32 root;
+        guint64 z;
+
+        if (priv->parent[p] == BACKGROUND)
+          continue;
+
+        root = find_root (priv->parent, p);
+
+        if (priv->slot[root] < 0)
+          {
+            priv->slot[root] = accums->len;
+            g_array_set_size (accums, accums->len + 1);
+
+            accum = &g_array_index (accums, BlobAccum, priv->slot[root]);
+            accum->x1 = accum->x2 = x;
+            accum->y1 = accum->y2 = y;
+          }
+
+        accum = &g_array_index (accums, BlobAccum, priv->slot[root]);
+        z = depth[p];
+
+        accum->x1 = MIN (accum->x1, x);
+        accum->x2 = MAX (accum->x2, x);
+        accum->y2 = y;
+        accum->pixels++;
+        accum->sum_z += z;
+        accum->sum_xz += x * z;
+        accum->sum_yz += y * z;
+      }
+
+  factor = get_world_factor (priv);
+  blobs = g_ptr_array_new_with_free_func ((GDestroyNotify) gfreenect_blob_free);
+
+  for (i = 0; i < accums->len; i++)
+    {
+      BlobAccum *accum = &g_array_index (accums, BlobAccum, i);
+      GFreenectBlob *blob;
+      gdouble cx, cy;
+
+      if (accum->pixels < priv->min_pixels)
+        continue;
+
+      blob = g_slice_new (GFreenectBlob);
+
+      blob->bounds.x = accum->x1;
+      blob->bounds.y = accum->y1;
+      blob->bounds.width = accum->x2 - accum->x1 + 1;
+      blob->bounds.height = accum->y2 - accum->y1 + 1;
+
+      blob->pixels = accum->pixels;
+      blob->mean_depth = (gdouble) accum->sum_z / accum->pixels;
+
+      /* the mean of (x - cx) * z * factor over the pixels of the blob */
+      cx = priv->width / 2.0;
+      cy = priv->height / 2.0;
+      blob->centroid_x = factor * (accum->sum_xz - cx * accum->sum_z) / accum->pixels;
+      blob->centroid_y = factor * (accum->sum_yz - cy * accum->sum_z) / accum->pixels;
+      blob->centroid_z = blob->mean_depth;
+
+      g_ptr_array_add (blobs, blob);
+    }
+
+  g_array_free (accums, TRUE);
+
+  g_ptr_array_sort (blobs, compare_blobs);
+
+  return blobs;
+}
+
+/* public methods */
+
+/**
+ * gfreenect_blob_get_type:
+ *
+ * Returns: The registered #GType for #GFreenectBlob boxed type
+ **/
+GType
+gfreenect_blob_get_type (void)
+{
+  static GType type = 0;
+
+  if (G_UNLIKELY (type == 0))
+    type = g_boxed_type_register_static ("GFreenectBlob",
+                                    (GBoxedCopyFunc) gfreenect_blob_copy,
+                                    (GBoxedFreeFunc) gfreenect_blob_free);
+  return type;
+}
+
+/**
+ * gfreenect_blob_copy:
+ * @blob: The #GFreenectBlob to copy
+ *
+ * Makes an exact copy of a #GFreenectBlob object.
+ *
+ * Returns: (transfer full): A newly created #GFreenectBlob. Use
+ * gfreenect_blob_free() to free it.
+ **/
+gpointer
+gfreenect_blob_copy (GFreenectBlob *blob)
+{
+  GFreenectBlob *copy;
+
+  copy = g_slice_new (GFreenectBlob);
+
+  memcpy (copy, blob, sizeof (GFreenectBlob));
+
+  return copy;
+}
+
+/**
+ * gfreenect_blob_free:
+ * @blob: The #GFreenectBlob to free
+ *
+ * Frees a #GFreenectBlob object.
+ **/
+void
+gfreenect_blob_free (GFreenectBlob *blob)
+{
+  g_slice_free (GFreenectBlob, blob);
+}
+
+/**
+ * gfreenect_blob_detector_new:
+ * @registration: (allow-none): The #GFreenectRegistration of the device the
+ * frames come from, or %NULL
+ *
+ * Creates a new #GFreenectBlobDetector. See
+ * gfreenect_device_get_registration() to obtain @registration.
+ *
+ * Returns: (transfer full): A newly created #GFreenectBlobDetector. Use
+ * g_object_unref() to free it.
+ **/
+GFreenectBlobDetector *
+gfreenect_blob_detector_new (GFreenectRegistration *registration)
+{
+  return g_object_new (GFREENECT_TYPE_BLOB_DETECTOR,
+                       "registration", registration,
+                       NULL);
+}
+
+/**
+ * gfreenect_blob_detector_process:
+ * @self: The #GFreenectBlobDetector
+ * @depth_mm: (array) (element-type guint16): An unregistered depth frame in
+ * millimeters, with zero for pixels without depth information
+ * @width: The width of the frame, in pixels
+ * @height: The height of the frame, in pixels
+ *
+ * Segments a depth frame into blobs. The frame is labelled in strips of rows
+ * concurrently, and the strips are stitched together afterwards.
+ *
+ * Returns: (transfer full) (element-type GFreenectBlob): A new array with the
+ * blobs found, from largest to smallest. Use g_ptr_array_unref() to free it.
+ **/
+GPtrArray *
+gfreenect_blob_detector_process (GFreenectBlobDetector *self,
+                                 const guint16         *depth_mm,
+                                 gsize                  width,
+                                 gsize                  height)
+{
+  GFreenectBlobDetectorPrivate *priv;
+  LabelJob job;
+
+  g_return_val_if_fail (GFREENECT_IS_BLOB_DETECTOR (self), NULL);
+  g_return_val_if_fail (depth_mm != NULL, NULL);
+  g_return_val_if_fail (width * height <= G_MAXINT32, NULL);
+
+  priv = self->priv;
+
+  if (priv->width != width || priv->height != height)
+    {
+      g_free (priv->parent);
+      g_free (priv->slot);
+      g_free (priv->strip_start);
+
+      priv->width = width;
+      priv->height = height;
+      priv->parent = g_new (gint32, width * height);
+      priv->slot = g_new (gint32, width * height);
+      priv->strip_start = g_new (guint8, height);
+    }
+
+  memset (priv->strip_start, 0, height);
+
+  job.priv = priv;
+  job.depth = depth_mm;
+
+  gfreenect_parallel_for (height, MIN_ROWS_PER_CHUNK, label_rows, &job);
+  stitch_strips (priv, depth_mm);
+
+  return collect_blobs (priv, depth_mm);
+}
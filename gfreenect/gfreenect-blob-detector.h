@@ -0,0 +1,101 @@
+/*
+ * gfreenect-blob-detector.h
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+#ifndef __GFREENECT_BLOB_DETECTOR_H__
+#define __GFREENECT_BLOB_DETECTOR_H__
+
+#include <glib.h>
+#include <glib-object.h>
+
+#include <gfreenect-region.h>
+#include <gfreenect-registration.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GFreenectBlob GFreenectBlob;
+
+/**
+ * GFreenectBlob:
+ * @bounds: The bounding box of the blob, in depth frame pixels
+ * @pixels: The number of pixels of the blob
+ * @mean_depth: The mean depth of the blob, in millimeters
+ * @centroid_x: The horizontal world coordinate of the centroid, in
+ * millimeters relative to the depth camera
+ * @centroid_y: The vertical world coordinate of the centroid, in millimeters
+ * relative to the depth camera
+ * @centroid_z: The distance of the centroid to the depth camera, in
+ * millimeters
+ *
+ * A connected component of a depth frame, as found by
+ * #GFreenectBlobDetector.
+ **/
+struct _GFreenectBlob
+{
+  GFreenectRegion bounds;
+  gsize pixels;
+  gdouble mean_depth;
+
+  gdouble centroid_x;
+  gdouble centroid_y;
+  gdouble centroid_z;
+};
+
+#define GFREENECT_TYPE_BLOB (gfreenect_blob_get_type ())
+
+GType                   gfreenect_blob_get_type                 (void);
+gpointer                gfreenect_blob_copy                     (GFreenectBlob *blob);
+void                    gfreenect_blob_free                     (GFreenectBlob *blob);
+
+typedef struct _GFreenectBlobDetector GFreenectBlobDetector;
+typedef struct _GFreenectBlobDetectorClass GFreenectBlobDetectorClass;
+typedef struct _GFreenectBlobDetectorPrivate GFreenectBlobDetectorPrivate;
+
+struct _GFreenectBlobDetector
+{
+  GObject parent;
+
+  GFreenectBlobDetectorPrivate *priv;
+};
+
+struct _GFreenectBlobDetectorClass
+{
+  GObjectClass parent_class;
+};
+
+#define GFREENECT_TYPE_BLOB_DETECTOR           (gfreenect_blob_detector_get_type ())
+#define GFREENECT_BLOB_DETECTOR(obj)           (G_TYPE_CHECK_INSTANCE_CAST ((obj), GFREENECT_TYPE_BLOB_DETECTOR, GFreenectBlobDetector))
+#define GFREENECT_BLOB_DETECTOR_CLASS(obj)     (G_TYPE_CHECK_CLASS_CAST ((obj), GFREENECT_TYPE_BLOB_DETECTOR, GFreenectBlobDetectorClass))
+#define GFREENECT_IS_BLOB_DETECTOR(obj)        (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GFREENECT_TYPE_BLOB_DETECTOR))
+#define GFREENECT_IS_BLOB_DETECTOR_CLASS(obj)  (G_TYPE_CHECK_CLASS_TYPE ((obj), GFREENECT_TYPE_BLOB_DETECTOR))
+#define GFREENECT_BLOB_DETECTOR_GET_CLASS(obj) (G_TYPE_INSTANCE_GET_CLASS ((obj), GFREENECT_TYPE_BLOB_DETECTOR, GFreenectBlobDetectorClass))
+
+GType                   gfreenect_blob_detector_get_type        (void) G_GNUC_CONST;
+
+GFreenectBlobDetector * gfreenect_blob_detector_new             (GFreenectRegistration *registration);
+
+GPtrArray *             gfreenect_blob_detector_process         (GFreenectBlobDetector *self,
+                                                                 const guint16         *depth_mm,
+                                                                 gsize                  width,
+                                                                 gsize                  height);
+
+G_END_DECLS
+
+#endif /* __GFREENECT_BLOB_DETECTOR_H__ */
@@ -0,0 +1,48 @@
+/*
+ * gfreenect-context-private.h
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+
+#ifndef __GFREENECT_CONTEXT_PRIVATE_H__
+#define __GFREENECT_CONTEXT_PRIVATE_H__
+
+#include <libfreenect.h>
+
+#include "gfreenect-context.h"
+
+G_BEGIN_DECLS
+
+gboolean gfreenect_context_open_device    (GFreenectContext  *self,
+                                           gint               index,
+                                           guint              subdevices,
+                                           freenect_device  **dev,
+                                           GError           **error);
+void     gfreenect_context_close_device   (GFreenectContext  *self,
+                                           freenect_device   *dev);
+
+gboolean gfreenect_context_hold_events    (GFreenectContext  *self,
+                                           GError           **error);
+void     gfreenect_context_release_events (GFreenectContext  *self);
+
+guint64  gfreenect_context_get_event_loop_iterations (GFreenectContext *self);
+
+G_END_DECLS
+
+#endif /* __GFREENECT_CONTEXT_PRIVATE_H__ */
@@ -0,0 +1,583 @@
+/*
+ * gfreenect-context.c
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+
+/**
+ * SECTION:gfreenect-context
+ * @short_description: Shares one libfreenect context among devices
+ *
+ * A #GFreenectContext owns a libfreenect context, through which USB events
+ * for all the devices opened from it are processed by a single thread.
+ * This thread only runs while at least one of the devices has a stream
+ * started.
+ *
+ * Every #GFreenectDevice belongs to a context. Devices created with
+ * gfreenect_device_new() get a context of their own, while devices created
+ * with gfreenect_device_new_with_context() share the given one. Sharing a
+ * context avoids running one event thread per device when several sensors
+ * are attached, and does not change how frames are delivered: each device
+ * keeps emitting its own signals.
+ *
+ * The event thread waits for USB events with a timeout, and is woken up
+ * right away when the last stream of the context stops, so stopping
+ * streams and disposing devices is quick. For steadier frame delivery
+ * under load, the thread can be given a real-time priority with the
+ * #GFreenectContext:event-thread-priority property and bound to a
+ * processor with the #GFreenectContext:event-thread-cpu property.
+ **/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#ifdef HAVE_PTHREAD_SETAFFINITY_NP
+#define _GNU_SOURCE
+#endif
+
+#include <string.h>
+#include <glib.h>
+#include <libfreenect.h>
+
+#ifdef G_OS_UNIX
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#ifdef HAVE_FREENECT_PROCESS_EVENTS_TIMEOUT
+#include <sys/time.h>
+#endif
+
+#ifdef HAVE_LIBUSB_INTERRUPT_EVENT_HANDLER
+#include <libusb.h>
+#endif
+
+#include "gfreenect-context.h"
+#include "gfreenect-context-private.h"
+
+#define GFREENECT_CONTEXT_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), \
+                                            GFREENECT_TYPE_CONTEXT, \
+                                            GFreenectContextPrivate))
+
+/* longest time the event thread waits for USB events before checking
+   whether it has to stop */
+#define EVENT_TIMEOUT_MS 100
+
+/* private data */
+struct _GFreenectContextPrivate
+{
+  freenect_context *ctx;
+#ifdef HAVE_LIBUSB_INTERRUPT_EVENT_HANDLER
+  libusb_context *usb_ctx;
+#endif
+
+  GMutex mutex;
+  GThread *event_thread;
+  gboolean event_thread_running;
+  gint abort_event_thread;
+  guint n_holds;
+
+  gint event_thread_priority;
+  gint event_thread_cpu;
+  gint sched_serial;
+
+  /* held by the event thread while processing events, so that devices
+     are not closed under it */
+  GMutex events_mutex;
+
+  gsize event_loop_iterations;
+};
+
+/* properties */
+enum
+{
+  PROP_0,
+  PROP_EVENT_THREAD_PRIORITY,
+  PROP_EVENT_THREAD_CPU
+};
+
+static void     gfreenect_context_class_init    (GFreenectContextClass *class);
+static void     gfreenect_context_init          (GFreenectContext *self);
+static void     gfreenect_context_finalize      (GObject *obj);
+
+static void     gfreenect_context_set_property  (GObject      *obj,
+                                                 guint         prop_id,
+                                                 const GValue *value,
+                                                 GParamSpec   *pspec);
+static void     gfreenect_context_get_property  (GObject    *obj,
+                                                 guint       prop_id,
+                                                 GValue     *value,
+                                                 GParamSpec *pspec);
+
+static void     gfreenect_initable_iface_init   (GInitableIface *iface);
+static gboolean init_sync                       (GInitable     *initable,
+                                                 GCancellable  *cancellable,
+                                                 GError       **error);
+
+G_DEFINE_TYPE_WITH_CODE (GFreenectContext, gfreenect_context, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (G_TYPE_INITABLE,
+                                                gfreenect_initable_iface_init))
+
+static void
+gfreenect_context_class_init (GFreenectContextClass *class)
+{
+  GObjectClass *obj_class;
+
+  obj_class = G_OBJECT_CLASS (class);
+
+  obj_class->finalize = gfreenect_context_finalize;
+  obj_class->get_property = gfreenect_context_get_property;
+  obj_class->set_property = gfreenect_context_set_property;
+
+  /* install properties */
+
+  /**
+   * GFreenectContext:event-thread-priority
+   *
+   * The real-time priority of the event thread, from 1 to 99, under the
+   * SCHED_FIFO scheduling policy, or 0 to use the normal policy. Real-time
+   * priorities usually require privileges; if the priority cannot be set,
+   * a warning is printed and the thread keeps running normally.
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_EVENT_THREAD_PRIORITY,
+                                   g_param_spec_uint ("event-thread-priority",
+                                                      "Event thread priority",
+                                                      "Real-time priority of the event thread",
+                                                      0,
+                                                      99,
+                                                      0,
+                                                      G_PARAM_READWRITE |
+                                                      G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GFreenectContext:event-thread-cpu
+   *
+   * The processor the event thread is bound to, or -1 to let it run on
+   * any of them.
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_EVENT_THREAD_CPU,
+                                   g_param_spec_int ("event-thread-cpu",
+                                                     "Event thread CPU",
+                                                     "Processor the event thread is bound to",
+                                                     -1,
+                                                     G_MAXINT,
+                                                     -1,
+                                                     G_PARAM_READWRITE |
+                                                     G_PARAM_STATIC_STRINGS));
+
+  /* add private structure */
+  g_type_class_add_private (obj_class, sizeof (GFreenectContextPrivate));
+}
+
+static void
+gfreenect_initable_iface_init (GInitableIface *iface)
+{
+  iface->init = init_sync;
+}
+
+static void
+gfreenect_context_init (GFreenectContext *self)
+{
+  GFreenectContextPrivate *priv;
+
+  priv = GFREENECT_CONTEXT_GET_PRIVATE (self);
+  self->priv = priv;
+
+  priv->ctx = NULL;
+#ifdef HAVE_LIBUSB_INTERRUPT_EVENT_HANDLER
+  priv->usb_ctx = NULL;
+#endif
+
+  g_mutex_init (&priv->mutex);
+  priv->event_thread = NULL;
+  priv->event_thread_running = FALSE;
+  priv->abort_event_thread = FALSE;
+  priv->n_holds = 0;
+
+  priv->event_thread_priority = 0;
+  priv->event_thread_cpu = -1;
+  priv->sched_serial = 0;
+
+  g_mutex_init (&priv->events_mutex);
+
+  priv->event_loop_iterations = 0;
+}
+
+/* makes the event thread return from waiting for USB events, if the USB
+   library allows it; otherwise the thread notices after EVENT_TIMEOUT_MS */
+static void
+wake_up_event_thread (GFreenectContext *self)
+{
+#ifdef HAVE_LIBUSB_INTERRUPT_EVENT_HANDLER
+  if (self->priv->usb_ctx != NULL)
+    libusb_interrupt_event_handler (self->priv->usb_ctx);
+#endif
+}
+
+static void
+gfreenect_context_finalize (GObject *obj)
+{
+  GFreenectContext *self = GFREENECT_CONTEXT (obj);
+
+  /* devices keep a reference to their context, so no device is left when
+     getting here, and the thread is about to exit if still running */
+  g_atomic_int_set (&self->priv->abort_event_thread, TRUE);
+  wake_up_event_thread (self);
+
+  if (self->priv->event_thread != NULL)
+    g_thread_join (self->priv->event_thread);
+
+  if (self->priv->ctx != NULL)
+    freenect_shutdown (self->priv->ctx);
+
+#ifdef HAVE_LIBUSB_INTERRUPT_EVENT_HANDLER
+  /* libfreenect does not free a USB context it was given */
+  if (self->priv->usb_ctx != NULL)
+    libusb_exit (self->priv->usb_ctx);
+#endif
+
+  g_mutex_clear (&self->priv->mutex);
+  g_mutex_clear (&self->priv->events_mutex);
+
+  G_OBJECT_CLASS (gfreenect_context_parent_class)->finalize (obj);
+}
+
+static void
+gfreenect_context_set_property (GObject      *obj,
+                                guint         prop_id,
+                                const GValue *value,
+                                GParamSpec   *pspec)
+{
+  GFreenectContext *self;
+
+  self = GFREENECT_CONTEXT (obj);
+
+  switch (prop_id)
+    {
+    case PROP_EVENT_THREAD_PRIORITY:
+      g_atomic_int_set (&self->priv->event_thread_priority,
+                        g_value_get_uint (value));
+      g_atomic_int_inc (&self->priv->sched_serial);
+      break;
+
+    case PROP_EVENT_THREAD_CPU:
+      g_atomic_int_set (&self->priv->event_thread_cpu,
+                        g_value_get_int (value));
+      g_atomic_int_inc (&self->priv->sched_serial);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (obj, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+gfreenect_context_get_property (GObject    *obj,
+                                guint       prop_id,
+                                GValue     *value,
+                                GParamSpec *pspec)
+{
+  GFreenectContext *self;
+
+  self = GFREENECT_CONTEXT (obj);
+
+  switch (prop_id)
+    {
+    case PROP_EVENT_THREAD_PRIORITY:
+      g_value_set_uint (value,
+                        g_atomic_int_get (&self->priv->event_thread_priority));
+      break;
+
+    case PROP_EVENT_THREAD_CPU:
+      g_value_set_int (value,
+                       g_atomic_int_get (&self->priv->event_thread_cpu));
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (obj, prop_id, pspec);
+      break;
+    }
+}
+
+static gboolean
+init_sync (GInitable     *initable,
+           GCancellable  *cancellable,
+           GError       **error)
+{
+  GFreenectContext *self = GFREENECT_CONTEXT (initable);
+  gpointer usb_ctx = NULL;
+
+#ifdef HAVE_LIBUSB_INTERRUPT_EVENT_HANDLER
+  /* own the USB context, to be able to interrupt event handling */
+  if (libusb_init (&self->priv->usb_ctx) != 0)
+    self->priv->usb_ctx = NULL;
+  usb_ctx = self->priv->usb_ctx;
+#endif
+
+  if (freenect_init (&self->priv->ctx, usb_ctx) != 0)
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_NOT_INITIALIZED,
+                   "Failed to initialize Kinect sensor context");
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* applies the scheduling properties to the calling thread */
+static void
+apply_scheduling (GFreenectContext *self)
+{
+#ifdef G_OS_UNIX
+  struct sched_param param;
+  gint priority;
+  gint policy;
+
+  priority = g_atomic_int_get (&self->priv->event_thread_priority);
+  policy = priority > 0 ? SCHED_FIFO : SCHED_OTHER;
+
+  memset (&param, 0, sizeof (param));
+  param.sched_priority = priority;
+
+  if (pthread_setschedparam (pthread_self (), policy, &param) != 0)
+    g_warning ("Failed to set the priority of the event thread to %d", priority);
+#endif
+
+#ifdef HAVE_PTHREAD_SETAFFINITY_NP
+  {
+    cpu_set_t set;
+    gint cpu;
+    guint i;
+
+    cpu = g_atomic_int_get (&self->priv->event_thread_cpu);
+
+    CPU_ZERO (&set);
+    if (cpu >= 0 && cpu < CPU_SETSIZE)
+      CPU_SET (cpu, &set);
+    else
+      for (i = 0; i < g_get_num_processors () && i < CPU_SETSIZE; i++)
+        CPU_SET (i, &set);
+
+    if (pthread_setaffinity_np (pthread_self (), sizeof (set), &set) != 0)
+      g_warning ("Failed to bind the event thread to CPU %d", cpu);
+  }
+#endif
+}
+
+static void
+process_events (GFreenectContext *self)
+{
+#ifdef HAVE_FREENECT_PROCESS_EVENTS_TIMEOUT
+  struct timeval timeout;
+
+  timeout.tv_sec = 0;
+  timeout.tv_usec = EVENT_TIMEOUT_MS * 1000;
+
+  freenect_process_events_timeout (self->priv->ctx, &timeout);
+#else
+  freenect_process_events (self->priv->ctx);
+#endif
+}
+
+static gpointer
+event_thread_func (gpointer _data)
+{
+  GFreenectContext *self = GFREENECT_CONTEXT (_data);
+  gint applied_serial = 0;
+
+  while (TRUE)
+    {
+      while (! g_atomic_int_get (&self->priv->abort_event_thread))
+        {
+          gint serial;
+
+          serial = g_atomic_int_get (&self->priv->sched_serial);
+          if (serial != applied_serial)
+            {
+              apply_scheduling (self);
+              applied_serial = serial;
+            }
+
+          g_mutex_lock (&self->priv->events_mutex);
+          process_events (self);
+          g_mutex_unlock (&self->priv->events_mutex);
+
+          g_atomic_pointer_add (&self->priv->event_loop_iterations, 1);
+        }
+
+      /* a device may have started streaming again meanwhile */
+      g_mutex_lock (&self->priv->mutex);
+      if (g_atomic_int_get (&self->priv->abort_event_thread))
+        break;
+      g_mutex_unlock (&self->priv->mutex);
+    }
+
+  self->priv->event_thread_running = FALSE;
+
+  g_mutex_unlock (&self->priv->mutex);
+
+  return NULL;
+}
+
+/* private methods, used by GFreenectDevice */
+
+gboolean
+gfreenect_context_open_device (GFreenectContext  *self,
+                               gint               index,
+                               guint              subdevices,
+                               freenect_device  **dev,
+                               GError           **error)
+{
+  gint result;
+
+  /* subdevices are selected for the whole context, and only matter while
+     opening */
+  g_mutex_lock (&self->priv->mutex);
+
+  freenect_select_subdevices (self->priv->ctx, subdevices);
+  result = freenect_open_device (self->priv->ctx, dev, index);
+
+  g_mutex_unlock (&self->priv->mutex);
+
+  if (result != 0)
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_INVALID_ARGUMENT,
+                   "Failed to open Kinect device");
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* waits for the event thread to be done with the current round of events,
+   so no callback for @dev runs after this */
+void
+gfreenect_context_close_device (GFreenectContext *self,
+                                freenect_device  *dev)
+{
+  g_mutex_lock (&self->priv->events_mutex);
+  freenect_close_device (dev);
+  g_mutex_unlock (&self->priv->events_mutex);
+}
+
+/* the event thread runs while there are holds, one per device with
+   streams started */
+gboolean
+gfreenect_context_hold_events (GFreenectContext  *self,
+                               GError           **error)
+{
+  GFreenectContextPrivate *priv = self->priv;
+  gboolean result = TRUE;
+
+  g_mutex_lock (&priv->mutex);
+
+  priv->n_holds++;
+  g_atomic_int_set (&priv->abort_event_thread, FALSE);
+
+  if (! priv->event_thread_running)
+    {
+      /* the previous thread, if any, left the loop and no longer needs
+         the mutex */
+      if (priv->event_thread != NULL)
+        g_thread_join (priv->event_thread);
+
+      priv->event_thread = g_thread_try_new ("gfreenect-events",
+                                             event_thread_func,
+                                             self,
+                                             error);
+      if (priv->event_thread != NULL)
+        {
+          priv->event_thread_running = TRUE;
+        }
+      else
+        {
+          priv->n_holds--;
+          result = FALSE;
+        }
+    }
+
+  g_mutex_unlock (&priv->mutex);
+
+  return result;
+}
+
+void
+gfreenect_context_release_events (GFreenectContext *self)
+{
+  g_mutex_lock (&self->priv->mutex);
+
+  self->priv->n_holds--;
+  if (self->priv->n_holds == 0)
+    {
+      g_atomic_int_set (&self->priv->abort_event_thread, TRUE);
+      wake_up_event_thread (self);
+    }
+
+  g_mutex_unlock (&self->priv->mutex);
+}
+
+guint64
+gfreenect_context_get_event_loop_iterations (GFreenectContext *self)
+{
+  return (gsize) g_atomic_pointer_get (&self->priv->event_loop_iterations);
+}
+
+/* public methods */
+
+/**
+ * gfreenect_context_new:
+ * @error: (allow-none): A pointer to a #GError, or %NULL
+ *
+ * Creates a new #GFreenectContext, to open devices from with
+ * gfreenect_device_new_with_context().
+ *
+ * Returns: (transfer full): A newly created #GFreenectContext, or %NULL if
+ * the libfreenect context could not be initialized, in which case @error is
+ * set. Use g_object_unref() to free it.
+ **/
+GFreenectContext *
+gfreenect_context_new (GError **error)
+{
+  return g_initable_new (GFREENECT_TYPE_CONTEXT, NULL, error, NULL);
+}
+
+/**
+ * gfreenect_context_get_num_devices:
+ * @self: The #GFreenectContext
+ *
+ * Counts the Kinect sensors attached to the system, which are opened with
+ * indexes from 0 to the returned value minus one.
+ *
+ * Returns: The number of devices, or a negative value on error.
+ **/
+gint
+gfreenect_context_get_num_devices (GFreenectContext *self)
+{
+  g_return_val_if_fail (GFREENECT_IS_CONTEXT (self), -1);
+
+  return freenect_num_devices (self->priv->ctx);
+}
@@ -0,0 +1,63 @@
+/*
+ * gfreenect-context.h
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+
+#ifndef __GFREENECT_CONTEXT_H__
+#define __GFREENECT_CONTEXT_H__
+
+#include <glib.h>
+#include <glib-object.h>
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GFreenectContext GFreenectContext;
+typedef struct _GFreenectContextClass GFreenectContextClass;
+typedef struct _GFreenectContextPrivate GFreenectContextPrivate;
+
+struct _GFreenectContext
+{
+  GObject parent;
+
+  GFreenectContextPrivate *priv;
+};
+
+struct _GFreenectContextClass
+{
+  GObjectClass parent_class;
+};
+
+#define GFREENECT_TYPE_CONTEXT           (gfreenect_context_get_type ())
+#define GFREENECT_CONTEXT(obj)           (G_TYPE_CHECK_INSTANCE_CAST ((obj), GFREENECT_TYPE_CONTEXT, GFreenectContext))
+#define GFREENECT_CONTEXT_CLASS(obj)     (G_TYPE_CHECK_CLASS_CAST ((obj), GFREENECT_TYPE_CONTEXT, GFreenectContextClass))
+#define GFREENECT_IS_CONTEXT(obj)        (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GFREENECT_TYPE_CONTEXT))
+#define GFREENECT_IS_CONTEXT_CLASS(obj)  (G_TYPE_CHECK_CLASS_TYPE ((obj), GFREENECT_TYPE_CONTEXT))
+#define GFREENECT_CONTEXT_GET_CLASS(obj) (G_TYPE_INSTANCE_GET_CLASS ((obj), GFREENECT_TYPE_CONTEXT, GFreenectContextClass))
+
+GType              gfreenect_context_get_type        (void) G_GNUC_CONST;
+
+GFreenectContext * gfreenect_context_new             (GError **error);
+
+gint               gfreenect_context_get_num_devices (GFreenectContext *self);
+
+G_END_DECLS
+
+#endif /* __GFREENECT_CONTEXT_H__ */
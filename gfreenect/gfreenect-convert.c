@@ -0,0 +1,207 @@
+/*
+ * gfreenect-convert.c
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+#include <string.h>
+#include <math.h>
+
+#include "gfreenect-convert.h"
+#include "gfreenect-parallel.h"
+
+/* rows below which splitting conversions across threads does not pay */
+#define MIN_ROWS_PER_CHUNK 16
+
+/* conversion of a region of a frame to packed RGB, done in bands of rows
+   by the worker pool */
+typedef struct
+{
+  const guint8 *src;
+  gsize src_width;
+  GFreenectRegion region;
+  guint8 *dst;
+
+  gboolean auto_range;
+  guint16 invalid;
+  guint min;
+  guint32 scale;
+} ConvertJob;
+
+static void
+convert_depth_grayscale_rows (guint first, guint last, gpointer user_data)
+{
+  ConvertJob *job = user_data;
+  const guint16 *data;
+  guint8 *out;
+  guint x, y;
+  gdouble d;
+  guchar c;
+
+  for (y = first; y < last; y++)
+    {
+      data = (const guint16 *) job->src +
+        (job->region.y + y) * job->src_width + job->region.x;
+      out = job->dst + y * job->region.width * 3;
+
+      if (job->auto_range)
+        {
+          for (x = 0; x < job->region.width; x++)
+            {
+              guint v = data[x] == job->invalid ?
+                0 : data[x] - MIN (data[x], job->min);
+
+              c = MIN ((v * job->scale + (1 << 15)) >> 16, 255);
+
+              out[0] = c;
+              out[1] = c;
+              out[2] = c;
+              out += 3;
+            }
+
+          continue;
+        }
+
+      for (x = 0; x < job->region.width; x++)
+        {
+          d = ((double) data[x]) / 2048.0;
+
+          c = round (d * 256);
+
+          out[0] = c;
+          out[1] = c;
+          out[2] = c;
+          out += 3;
+        }
+    }
+}
+
+static void
+convert_gray_rgb_rows (guint first, guint last, gpointer user_data)
+{
+  ConvertJob *job = user_data;
+  const guint8 *data;
+  guint8 *out;
+  guint x, y;
+
+  for (y = first; y < last; y++)
+    {
+      data = job->src + (job->region.y + y) * job->src_width + job->region.x;
+      out = job->dst + y * job->region.width * 3;
+
+      for (x = 0; x < job->region.width; x++)
+        {
+          out[0] = data[x];
+          out[1] = data[x];
+          out[2] = data[x];
+          out += 3;
+        }
+    }
+}
+
+/* copies 'region' out of a frame of 'width' pixels per row into 'dst', rows
+   packed; 'dst' can be the frame itself */
+void
+gfreenect_convert_crop (const guint8          *src,
+                        gsize                  width,
+                        guint                  bytes_per_pixel,
+                        const GFreenectRegion *region,
+                        guint8                *dst)
+{
+  gsize row_len;
+  guint y;
+
+  row_len = region->width * bytes_per_pixel;
+
+  for (y = 0; y < region->height; y++)
+    memmove (dst + y * row_len,
+             src + ((region->y + y) * width + region->x) * bytes_per_pixel,
+             row_len);
+}
+
+/* maps 'region' of an 11 bit depth frame to gray levels over the full
+   range of the sensor */
+void
+gfreenect_convert_depth_grayscale (const guint16         *depth,
+                                   gsize                  width,
+                                   const GFreenectRegion *region,
+                                   guint8                *rgb)
+{
+  ConvertJob job;
+
+  job.src = (const guint8 *) depth;
+  job.src_width = width;
+  job.region = *region;
+  job.dst = rgb;
+  job.auto_range = FALSE;
+
+  gfreenect_parallel_for (region->height,
+                          MIN_ROWS_PER_CHUNK,
+                          convert_depth_grayscale_rows,
+                          &job);
+}
+
+/* stretches the depth range [min, max] of 'region' to the gray levels,
+   leaving 'invalid' pixels black */
+void
+gfreenect_convert_depth_grayscale_range (const guint16         *depth,
+                                         gsize                  width,
+                                         const GFreenectRegion *region,
+                                         guint16                invalid,
+                                         guint                  min,
+                                         guint                  max,
+                                         guint8                *rgb)
+{
+  ConvertJob job;
+
+  job.src = (const guint8 *) depth;
+  job.src_width = width;
+  job.region = *region;
+  job.dst = rgb;
+
+  /* intensity in 1/65536 units per depth unit above the minimum */
+  job.auto_range = TRUE;
+  job.invalid = invalid;
+  job.min = min;
+  job.scale = (255 << 16) / MAX (max - MIN (min, max), 1);
+
+  gfreenect_parallel_for (region->height,
+                          MIN_ROWS_PER_CHUNK,
+                          convert_depth_grayscale_rows,
+                          &job);
+}
+
+/* expands 'region' of an 8 bit intensity frame to packed RGB */
+void
+gfreenect_convert_gray_rgb (const guint8          *gray,
+                            gsize                  width,
+                            const GFreenectRegion *region,
+                            guint8                *rgb)
+{
+  ConvertJob job;
+
+  job.src = gray;
+  job.src_width = width;
+  job.region = *region;
+  job.dst = rgb;
+
+  gfreenect_parallel_for (region->height,
+                          MIN_ROWS_PER_CHUNK,
+                          convert_gray_rgb_rows,
+                          &job);
+}
@@ -0,0 +1,57 @@
+/*
+ * gfreenect-convert.h
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+#ifndef __GFREENECT_CONVERT_H__
+#define __GFREENECT_CONVERT_H__
+
+#include <glib.h>
+
+#include "gfreenect-region.h"
+
+G_BEGIN_DECLS
+
+void gfreenect_convert_crop                  (const guint8          *src,
+                                              gsize                  width,
+                                              guint                  bytes_per_pixel,
+                                              const GFreenectRegion *region,
+                                              guint8                *dst);
+
+void gfreenect_convert_depth_grayscale       (const guint16         *depth,
+                                              gsize                  width,
+                                              const GFreenectRegion *region,
+                                              guint8                *rgb);
+
+void gfreenect_convert_depth_grayscale_range (const guint16         *depth,
+                                              gsize                  width,
+                                              const GFreenectRegion *region,
+                                              guint16                invalid,
+                                              guint                  min,
+                                              guint                  max,
+                                              guint8                *rgb);
+
+void gfreenect_convert_gray_rgb              (const guint8          *gray,
+                                              gsize                  width,
+                                              const GFreenectRegion *region,
+                                              guint8                *rgb);
+
+G_END_DECLS
+
+#endif /* __GFREENECT_CONVERT_H__ */
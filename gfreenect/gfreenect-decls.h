@@ -132,4 +132,113 @@ typedef enum {
   GFREENECT_LED_BLINK_RED_YELLOW = 6
 } GFreenectLed;
 
+/**
+ * GFreenectTiltStatus:
+ * @GFREENECT_TILT_STATUS_STOPPED: The tilt motor is stopped
+ * @GFREENECT_TILT_STATUS_LIMIT: The tilt motor reached the end of its range
+ * @GFREENECT_TILT_STATUS_MOVING: The tilt motor is moving
+ *
+ * Status of the tilt motor, as reported in #GFreenectMotionState.
+ **/
+typedef enum {
+  GFREENECT_TILT_STATUS_STOPPED = 0,
+  GFREENECT_TILT_STATUS_LIMIT   = 1,
+  GFREENECT_TILT_STATUS_MOVING  = 4
+} GFreenectTiltStatus;
+
+/**
+ * GFreenectDepthPyramid:
+ * @GFREENECT_DEPTH_PYRAMID_NONE: No depth pyramid is built
+ * @GFREENECT_DEPTH_PYRAMID_MIN: Each level keeps the closest valid depth of
+ * every 2x2 block of the level below
+ * @GFREENECT_DEPTH_PYRAMID_MEDIAN: Each level keeps the median of the valid
+ * depths of every 2x2 block of the level below
+ *
+ * Available reductions to build the multi-resolution depth pyramid.
+ **/
+typedef enum {
+  GFREENECT_DEPTH_PYRAMID_NONE   = 0,
+  GFREENECT_DEPTH_PYRAMID_MIN    = 1,
+  GFREENECT_DEPTH_PYRAMID_MEDIAN = 2
+} GFreenectDepthPyramid;
+
+/**
+ * GFREENECT_DEPTH_PYRAMID_LEVELS:
+ *
+ * The number of reduced levels of the depth pyramid, not counting the full
+ * resolution depth frame (level 0).
+ **/
+#define GFREENECT_DEPTH_PYRAMID_LEVELS 3
+
+/**
+ * GFreenectTemporalFilter:
+ * @GFREENECT_TEMPORAL_FILTER_NONE: Depth frames are not filtered over time
+ * @GFREENECT_TEMPORAL_FILTER_AVERAGE: Exponential moving average of each
+ * pixel, restarted when the depth changes abruptly
+ * @GFREENECT_TEMPORAL_FILTER_MEDIAN: Median of each pixel over the last
+ * frames
+ *
+ * Available temporal filters for the depth stream.
+ **/
+typedef enum {
+  GFREENECT_TEMPORAL_FILTER_NONE    = 0,
+  GFREENECT_TEMPORAL_FILTER_AVERAGE = 1,
+  GFREENECT_TEMPORAL_FILTER_MEDIAN  = 2
+} GFreenectTemporalFilter;
+
+/**
+ * GFreenectSpatialFilter:
+ * @GFREENECT_SPATIAL_FILTER_NONE: Depth frames are not filtered spatially
+ * @GFREENECT_SPATIAL_FILTER_BILATERAL: Edge-preserving bilateral filter,
+ * weighting neighbours by their distance and their difference in depth
+ * @GFREENECT_SPATIAL_FILTER_JOINT_BILATERAL: Bilateral filter guided by the
+ * intensity of the RGB video frame, which also fills holes in the depth
+ *
+ * Available spatial filters for the depth stream.
+ **/
+typedef enum {
+  GFREENECT_SPATIAL_FILTER_NONE            = 0,
+  GFREENECT_SPATIAL_FILTER_BILATERAL       = 1,
+  GFREENECT_SPATIAL_FILTER_JOINT_BILATERAL = 2
+} GFreenectSpatialFilter;
+
+/**
+ * GFREENECT_DEPTH_BANDS_MAX:
+ *
+ * The maximum number of depth bands that can be set with
+ * gfreenect_device_set_depth_bands().
+ **/
+#define GFREENECT_DEPTH_BANDS_MAX 8
+
+/**
+ * GFREENECT_MOTION_HISTORY:
+ *
+ * The number of samples of the motion stream kept by #GFreenectDevice, see
+ * gfreenect_device_get_motion_states_since(). A power of two.
+ **/
+#define GFREENECT_MOTION_HISTORY 1024
+
+/**
+ * GFREENECT_AUDIO_SAMPLE_RATE:
+ *
+ * The number of audio frames per second delivered by the audio stream.
+ **/
+#define GFREENECT_AUDIO_SAMPLE_RATE 16000
+
+/**
+ * GFREENECT_AUDIO_CHANNELS:
+ *
+ * The number of samples in each audio frame: one for each of the four
+ * microphones, followed by the echo-cancelled reference channel.
+ **/
+#define GFREENECT_AUDIO_CHANNELS 5
+
+/**
+ * GFREENECT_AUDIO_HISTORY:
+ *
+ * The number of audio frames kept by #GFreenectDevice for readers that fall
+ * behind, about one second. A power of two.
+ **/
+#define GFREENECT_AUDIO_HISTORY 16384
+
 #endif /* __GFREENECT_DECLS_H__ */
@@ -0,0 +1,216 @@
+/*
+ * gfreenect-depth-bands.c
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+#include <string.h>
+
+#include "gfreenect-depth-bands.h"
+#include "gfreenect-parallel.h"
+
+#define MIN_ROWS_PER_CHUNK 32
+
+typedef struct
+{
+  GFreenectDepthBandsState *bands;
+  const guint16 *depth;
+  guint16 invalid;
+
+  GMutex mutex;
+  guint x1[GFREENECT_DEPTH_BANDS_MAX];
+  guint y1[GFREENECT_DEPTH_BANDS_MAX];
+  guint x2[GFREENECT_DEPTH_BANDS_MAX];
+  guint y2[GFREENECT_DEPTH_BANDS_MAX];
+} BandsJob;
+
+void
+gfreenect_depth_bands_init (GFreenectDepthBandsState *bands)
+{
+  memset (bands, 0, sizeof (GFreenectDepthBandsState));
+}
+
+void
+gfreenect_depth_bands_clear (GFreenectDepthBandsState *bands)
+{
+  g_free (bands->masks);
+  bands->masks = NULL;
+
+  bands->width = 0;
+  bands->height = 0;
+  bands->has_output = FALSE;
+}
+
+/* Each row is read once and kept in cache while every band packs its bits.
+   A band covers [near, far]; the comparisons are folded into a single
+   unsigned range check so the packing loop has no branches. */
+static void
+bands_rows (guint first, guint last, gpointer user_data)
+{
+  BandsJob *job = user_data;
+  GFreenectDepthBandsState *bands = job->bands;
+  gsize width = bands->width;
+  gsize stride = bands->stride;
+  guint x1[GFREENECT_DEPTH_BANDS_MAX];
+  guint y1[GFREENECT_DEPTH_BANDS_MAX];
+  guint x2[GFREENECT_DEPTH_BANDS_MAX];
+  guint y2[GFREENECT_DEPTH_BANDS_MAX];
+  gsize pixels[GFREENECT_DEPTH_BANDS_MAX];
+  guint b, y;
+
+  for (b = 0; b < bands->n_bands; b++)
+    {
+      x1[b] = y1[b] = G_MAXUINT;
+      x2[b] = y2[b] = 0;
+      pixels[b] = 0;
+    }
+
+  for (y = first; y < last; y++)
+    {
+      const guint16 *row = job->depth + y * width;
+
+      for (b = 0; b < bands->n_bands; b++)
+        {
+          guint8 *mask = bands->masks + (b * bands->height + y) * stride;
+          guint16 near = bands->near[b];
+          guint16 span = bands->far[b] - bands->near[b];
+          guint16 invalid = job->invalid;
+          gint first_byte = -1;
+          gint last_byte = -1;
+          gsize x, i;
+
+          for (i = 0; i < stride; i++)
+            {
+              guint8 byte = 0;
+              guint bit;
+
+              for (bit = 0; bit < 8; bit++)
+                {
+                  guint16 d;
+
+                  x = i * 8 + bit;
+                  d = x < width ? row[x] : invalid;
+
+                  byte |= ((guint16) (d - near) <= span && d != invalid) << bit;
+                }
+
+              mask[i] = byte;
+            }
+
+          for (i = 0; i < stride; i++)
+            {
+              guint8 byte = mask[i];
+
+              if (byte == 0)
+                continue;
+
+              if (first_byte < 0)
+                first_byte = i;
+              last_byte = i;
+
+              /* popcount */
+              for (; byte != 0; byte &= byte - 1)
+                pixels[b]++;
+            }
+
+          if (first_byte < 0)
+            continue;
+
+          x1[b] = MIN (x1[b], first_byte * 8 + g_bit_nth_lsf (mask[first_byte], -1));
+          x2[b] = MAX (x2[b], last_byte * 8 + g_bit_nth_msf (mask[last_byte], -1));
+          y1[b] = MIN (y1[b], y);
+          y2[b] = y;
+        }
+    }
+
+  g_mutex_lock (&job->mutex);
+
+  for (b = 0; b < bands->n_bands; b++)
+    {
+      job->x1[b] = MIN (job->x1[b], x1[b]);
+      job->y1[b] = MIN (job->y1[b], y1[b]);
+      job->x2[b] = MAX (job->x2[b], x2[b]);
+      job->y2[b] = MAX (job->y2[b], y2[b]);
+      bands->pixels[b] += pixels[b];
+    }
+
+  g_mutex_unlock (&job->mutex);
+}
+
+/* Computes the packed masks, bounding boxes and pixel counts of all the
+   bands in a single pass over the depth frame. */
+void
+gfreenect_depth_bands_process (GFreenectDepthBandsState *bands,
+                               const guint16            *depth,
+                               gsize                     width,
+                               gsize                     height,
+                               guint16                   invalid)
+{
+  BandsJob job;
+  guint b;
+
+  if (bands->n_bands == 0)
+    return;
+
+  if (bands->width != width || bands->height != height)
+    {
+      gfreenect_depth_bands_clear (bands);
+
+      bands->width = width;
+      bands->height = height;
+      bands->stride = (width + 7) / 8;
+    }
+
+  if (bands->masks == NULL)
+    bands->masks = g_new (guint8,
+                          GFREENECT_DEPTH_BANDS_MAX * bands->stride * height);
+
+  job.bands = bands;
+  job.depth = depth;
+  job.invalid = invalid;
+  g_mutex_init (&job.mutex);
+
+  for (b = 0; b < bands->n_bands; b++)
+    {
+      job.x1[b] = job.y1[b] = G_MAXUINT;
+      job.x2[b] = job.y2[b] = 0;
+      bands->pixels[b] = 0;
+    }
+
+  gfreenect_parallel_for (height, MIN_ROWS_PER_CHUNK, bands_rows, &job);
+
+  g_mutex_clear (&job.mutex);
+
+  for (b = 0; b < bands->n_bands; b++)
+    {
+      GFreenectRegion *bounds = &bands->bounds[b];
+
+      if (bands->pixels[b] == 0)
+        {
+          memset (bounds, 0, sizeof (GFreenectRegion));
+          continue;
+        }
+
+      bounds->x = job.x1[b];
+      bounds->y = job.y1[b];
+      bounds->width = job.x2[b] - job.x1[b] + 1;
+      bounds->height = job.y2[b] - job.y1[b] + 1;
+    }
+
+  bands->has_output = TRUE;
+}
@@ -0,0 +1,61 @@
+/*
+ * gfreenect-depth-bands.h
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+#ifndef __GFREENECT_DEPTH_BANDS_H__
+#define __GFREENECT_DEPTH_BANDS_H__
+
+#include <glib.h>
+
+#include "gfreenect-decls.h"
+#include "gfreenect-region.h"
+
+G_BEGIN_DECLS
+
+typedef struct
+{
+  /* parameters */
+  guint n_bands;
+  guint16 near[GFREENECT_DEPTH_BANDS_MAX];
+  guint16 far[GFREENECT_DEPTH_BANDS_MAX];
+
+  /* state */
+  gsize width;
+  gsize height;
+  gsize stride;                 /* bytes per mask row */
+  guint8 *masks;                /* one after another, n_bands of them */
+
+  GFreenectRegion bounds[GFREENECT_DEPTH_BANDS_MAX];
+  gsize pixels[GFREENECT_DEPTH_BANDS_MAX];
+  gboolean has_output;
+} GFreenectDepthBandsState;
+
+void gfreenect_depth_bands_init    (GFreenectDepthBandsState *bands);
+void gfreenect_depth_bands_clear   (GFreenectDepthBandsState *bands);
+
+void gfreenect_depth_bands_process (GFreenectDepthBandsState *bands,
+                                    const guint16            *depth,
+                                    gsize                     width,
+                                    gsize                     height,
+                                    guint16                   invalid);
+
+G_END_DECLS
+
+#endif /* __GFREENECT_DEPTH_BANDS_H__ */
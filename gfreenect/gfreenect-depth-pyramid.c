@@ -0,0 +1,153 @@
+/*
+ * gfreenect-depth-pyramid.c
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+#include "gfreenect-depth-pyramid.h"
+
+#define SWAP_IF_GREATER(a,b) G_STMT_START { \
+    if ((a) > (b)) { guint16 _t = (a); (a) = (b); (b) = _t; } \
+  } G_STMT_END
+
+/* The invalid value is either 0 (depth in mm) or the largest value of the
+   format (raw 10 and 11 bit depth). Subtracting 'bias' moves 0 to the top of
+   the unsigned range, so in both cases invalid pixels lose against any valid
+   one and a plain, branchless minimum can be used. */
+static void
+reduce_min (const guint16 *src,
+            gsize          src_width,
+            gsize          src_height,
+            guint16        invalid,
+            guint16       *dst)
+{
+  guint16 bias = invalid == 0 ? 1 : 0;
+  gsize dst_width = src_width / 2;
+  gsize x, y;
+
+  for (y = 0; y < src_height / 2; y++)
+    {
+      const guint16 *row0 = src + (y * 2) * src_width;
+      const guint16 *row1 = row0 + src_width;
+      guint16 *out = dst + y * dst_width;
+
+      for (x = 0; x < dst_width; x++)
+        {
+          guint16 a = row0[x * 2] - bias;
+          guint16 b = row0[x * 2 + 1] - bias;
+          guint16 c = row1[x * 2] - bias;
+          guint16 d = row1[x * 2 + 1] - bias;
+
+          a = MIN (a, b);
+          c = MIN (c, d);
+
+          out[x] = MIN (a, c) + bias;
+        }
+    }
+}
+
+static void
+reduce_median (const guint16 *src,
+               gsize          src_width,
+               gsize          src_height,
+               guint16        invalid,
+               guint16       *dst)
+{
+  gsize dst_width = src_width / 2;
+  gsize x, y;
+
+  for (y = 0; y < src_height / 2; y++)
+    {
+      const guint16 *row0 = src + (y * 2) * src_width;
+      const guint16 *row1 = row0 + src_width;
+      guint16 *out = dst + y * dst_width;
+
+      for (x = 0; x < dst_width; x++)
+        {
+          guint16 v[4];
+          guint n = 0;
+
+          if (row0[x * 2] != invalid)
+            v[n++] = row0[x * 2];
+          if (row0[x * 2 + 1] != invalid)
+            v[n++] = row0[x * 2 + 1];
+          if (row1[x * 2] != invalid)
+            v[n++] = row1[x * 2];
+          if (row1[x * 2 + 1] != invalid)
+            v[n++] = row1[x * 2 + 1];
+
+          switch (n)
+            {
+            case 0:
+              out[x] = invalid;
+              break;
+
+            case 1:
+              out[x] = v[0];
+              break;
+
+            case 2:
+              out[x] = (v[0] + v[1] + 1) / 2;
+              break;
+
+            case 3:
+              SWAP_IF_GREATER (v[0], v[1]);
+              SWAP_IF_GREATER (v[1], v[2]);
+              SWAP_IF_GREATER (v[0], v[1]);
+              out[x] = v[1];
+              break;
+
+            default:
+              SWAP_IF_GREATER (v[0], v[1]);
+              SWAP_IF_GREATER (v[2], v[3]);
+              SWAP_IF_GREATER (v[0], v[2]);
+              SWAP_IF_GREATER (v[1], v[3]);
+              SWAP_IF_GREATER (v[1], v[2]);
+              out[x] = (v[1] + v[2] + 1) / 2;
+              break;
+            }
+        }
+    }
+}
+
+/* Reduces a depth image to half its width and height, combining every 2x2
+   block of pixels into one according to 'mode'. Pixels equal to 'invalid'
+   carry no depth and are ignored; a block with no valid pixels produces
+   'invalid'. */
+void
+gfreenect_depth_pyramid_reduce (GFreenectDepthPyramid  mode,
+                                const guint16         *src,
+                                gsize                  src_width,
+                                gsize                  src_height,
+                                guint16                invalid,
+                                guint16               *dst)
+{
+  switch (mode)
+    {
+    case GFREENECT_DEPTH_PYRAMID_MIN:
+      reduce_min (src, src_width, src_height, invalid, dst);
+      break;
+
+    case GFREENECT_DEPTH_PYRAMID_MEDIAN:
+      reduce_median (src, src_width, src_height, invalid, dst);
+      break;
+
+    default:
+      break;
+    }
+}
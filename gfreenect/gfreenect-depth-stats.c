@@ -0,0 +1,234 @@
+/*
+ * gfreenect-depth-stats.c
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+/**
+ * SECTION:gfreenect-depth-stats
+ * @short_description: Data structure with statistics of a depth frame.
+ *
+ * A #GFreenectDepthStats holds the range, mean and number of valid pixels
+ * of a depth frame. #GFreenectDevice computes them for every depth frame as
+ * it arrives, see gfreenect_device_get_depth_stats(). They can also be
+ * computed for any depth buffer with gfreenect_depth_stats_compute(), which
+ * optionally fills a histogram of the depth values in the same pass.
+ *
+ * Use gfreenect_depth_stats_copy() to create an exact copy of the object and
+ * gfreenect_depth_stats_free() to free it.
+ **/
+
+#include <string.h>
+
+#include "gfreenect-depth-stats.h"
+#include "gfreenect-parallel.h"
+
+#define MIN_PIXELS_PER_CHUNK 32768
+
+typedef struct
+{
+  const guint16 *depth;
+  guint16 invalid;
+  guint bin_shift;
+  guint32 *histogram;
+
+  GMutex mutex;
+  guint min;
+  guint max;
+  guint64 sum;
+  gsize count;
+} StatsJob;
+
+/**
+ * gfreenect_depth_stats_get_type:
+ *
+ * Returns: The registered #GType for #GFreenectDepthStats boxed type
+ **/
+GType
+gfreenect_depth_stats_get_type (void)
+{
+  static GType type = 0;
+
+  if (G_UNLIKELY (type == 0))
+    type = g_boxed_type_register_static ("GFreenectDepthStats",
+                                    (GBoxedCopyFunc) gfreenect_depth_stats_copy,
+                                    (GBoxedFreeFunc) gfreenect_depth_stats_free);
+  return type;
+}
+
+/**
+ * gfreenect_depth_stats_copy:
+ * @stats: The #GFreenectDepthStats to copy
+ *
+ * Makes an exact copy of a #GFreenectDepthStats object.
+ *
+ * Returns: (transfer full): A newly created #GFreenectDepthStats. Use
+ * gfreenect_depth_stats_free() to free it.
+ **/
+gpointer
+gfreenect_depth_stats_copy (GFreenectDepthStats *stats)
+{
+  GFreenectDepthStats *copy;
+
+  copy = g_slice_new (GFreenectDepthStats);
+
+  memcpy (copy, stats, sizeof (GFreenectDepthStats));
+
+  return copy;
+}
+
+/**
+ * gfreenect_depth_stats_free:
+ * @stats: The #GFreenectDepthStats to free
+ *
+ * Frees a #GFreenectDepthStats object.
+ **/
+void
+gfreenect_depth_stats_free (GFreenectDepthStats *stats)
+{
+  g_slice_free (GFreenectDepthStats, stats);
+}
+
+/* The range, sum and count are accumulated with selects instead of
+   branches so the loop vectorizes. When a histogram is requested it is
+   filled in the same loop, which then stays scalar because of its
+   scattered increments, but each chunk is still read only once. */
+static void
+stats_chunk (guint first, guint last, gpointer user_data)
+{
+  StatsJob *job = user_data;
+  const guint16 *depth = job->depth;
+  guint16 invalid = job->invalid;
+  guint min = G_MAXUINT16;
+  guint max = 0;
+  guint64 sum = 0;
+  guint count = 0;
+  guint i;
+
+  if (job->histogram != NULL)
+    {
+      guint32 histogram[GFREENECT_DEPTH_STATS_HISTOGRAM_BINS] = { 0 };
+      guint bin_shift = job->bin_shift;
+
+      for (i = first; i < last; i++)
+        {
+          guint d = depth[i];
+          gboolean valid = d != invalid;
+          guint bin = MIN (d >> bin_shift,
+                           GFREENECT_DEPTH_STATS_HISTOGRAM_BINS - 1);
+
+          min = MIN (min, valid ? d : G_MAXUINT16);
+          max = MAX (max, valid ? d : 0);
+          sum += valid ? d : 0;
+          count += valid;
+          histogram[bin] += valid;
+        }
+
+      g_mutex_lock (&job->mutex);
+      for (i = 0; i < GFREENECT_DEPTH_STATS_HISTOGRAM_BINS; i++)
+        job->histogram[i] += histogram[i];
+      g_mutex_unlock (&job->mutex);
+    }
+  else
+    {
+      for (i = first; i < last; i++)
+        {
+          guint d = depth[i];
+          gboolean valid = d != invalid;
+
+          min = MIN (min, valid ? d : G_MAXUINT16);
+          max = MAX (max, valid ? d : 0);
+          sum += valid ? d : 0;
+          count += valid;
+        }
+    }
+
+  g_mutex_lock (&job->mutex);
+
+  job->min = MIN (job->min, min);
+  job->max = MAX (job->max, max);
+  job->sum += sum;
+  job->count += count;
+
+  g_mutex_unlock (&job->mutex);
+}
+
+/**
+ * gfreenect_depth_stats_compute:
+ * @stats: (out caller-allocates): A #GFreenectDepthStats to fill
+ * @depth: (array length=pixels): The depth values, one guint16 per pixel
+ * @pixels: The number of pixels in @depth
+ * @invalid: The value that marks pixels without depth information
+ * @bin_shift: The number of bits each depth value is shifted right to
+ * obtain its histogram bin
+ * @histogram: (array fixed-size=2048) (allow-none): An array of
+ * %GFREENECT_DEPTH_STATS_HISTOGRAM_BINS counters to fill, or %NULL
+ *
+ * Computes the statistics of the valid pixels of a depth buffer and,
+ * optionally, the histogram of their values, in a single pass over the
+ * data. Values whose bin is beyond the last one are counted in the last
+ * bin. A @bin_shift of 0 covers %GFREENECT_DEPTH_FORMAT_11BIT exactly, while
+ * millimeter formats can use a shift of 3 to cover about 16 meters.
+ **/
+void
+gfreenect_depth_stats_compute (GFreenectDepthStats *stats,
+                               const guint16       *depth,
+                               gsize                pixels,
+                               guint16              invalid,
+                               guint                bin_shift,
+                               guint32             *histogram)
+{
+  StatsJob job;
+
+  g_return_if_fail (stats != NULL);
+  g_return_if_fail (depth != NULL || pixels == 0);
+
+  job.depth = depth;
+  job.invalid = invalid;
+  job.bin_shift = bin_shift;
+  job.histogram = histogram;
+
+  g_mutex_init (&job.mutex);
+  job.min = G_MAXUINT16;
+  job.max = 0;
+  job.sum = 0;
+  job.count = 0;
+
+  if (histogram != NULL)
+    memset (histogram, 0, GFREENECT_DEPTH_STATS_HISTOGRAM_BINS * sizeof (guint32));
+
+  gfreenect_parallel_for (pixels, MIN_PIXELS_PER_CHUNK, stats_chunk, &job);
+
+  g_mutex_clear (&job.mutex);
+
+  stats->total_pixels = pixels;
+  stats->valid_pixels = job.count;
+
+  if (job.count > 0)
+    {
+      stats->min = job.min;
+      stats->max = job.max;
+      stats->mean = (gdouble) job.sum / job.count;
+    }
+  else
+    {
+      stats->min = 0;
+      stats->max = 0;
+      stats->mean = 0.0;
+    }
+}
@@ -0,0 +1,76 @@
+/*
+ * gfreenect-depth-stats.h
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+#ifndef __GFREENECT_DEPTH_STATS_H__
+#define __GFREENECT_DEPTH_STATS_H__
+
+#include <glib.h>
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+#define GFREENECT_TYPE_DEPTH_STATS (gfreenect_depth_stats_get_type ())
+
+/**
+ * GFREENECT_DEPTH_STATS_HISTOGRAM_BINS:
+ *
+ * The number of bins of the depth histogram computed by
+ * gfreenect_depth_stats_compute().
+ **/
+#define GFREENECT_DEPTH_STATS_HISTOGRAM_BINS 2048
+
+typedef struct _GFreenectDepthStats GFreenectDepthStats;
+
+/**
+ * GFreenectDepthStats:
+ * @min: The smallest valid depth value
+ * @max: The largest valid depth value
+ * @mean: The mean of the valid depth values
+ * @valid_pixels: The number of pixels with a valid depth value
+ * @total_pixels: The total number of pixels
+ *
+ * Statistics of the valid pixels of a depth frame. When there are no valid
+ * pixels, @min, @max and @mean are zero.
+ **/
+struct _GFreenectDepthStats
+{
+  guint min;
+  guint max;
+  gdouble mean;
+
+  gsize valid_pixels;
+  gsize total_pixels;
+};
+
+GType                 gfreenect_depth_stats_get_type  (void);
+gpointer              gfreenect_depth_stats_copy      (GFreenectDepthStats *stats);
+void                  gfreenect_depth_stats_free      (GFreenectDepthStats *stats);
+
+void                  gfreenect_depth_stats_compute   (GFreenectDepthStats *stats,
+                                                       const guint16       *depth,
+                                                       gsize                pixels,
+                                                       guint16              invalid,
+                                                       guint                bin_shift,
+                                                       guint32             *histogram);
+
+G_END_DECLS
+
+#endif /* __GFREENECT_DEPTH_STATS_H__ */
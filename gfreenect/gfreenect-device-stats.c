@@ -0,0 +1,115 @@
+/*
+ * gfreenect-device-stats.c
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+
+/**
+ * SECTION:gfreenect-device-stats
+ * @short_description: Data structure with the runtime counters of a device.
+ *
+ * A #GFreenectDeviceStats is a snapshot of what a #GFreenectDevice has been
+ * doing since it was opened: the rate and number of frames received and
+ * delivered by each stream, the time spent converting them, and the
+ * activity of the threads talking to the device. It is obtained with
+ * gfreenect_device_get_stats() or the #GFreenectDevice:stats property.
+ *
+ * Use gfreenect_device_stats_copy() to create an exact copy of the object
+ * and gfreenect_device_stats_free() to free it.
+ **/
+
+#include <string.h>
+
+#include "gfreenect-device-stats.h"
+
+/* upper bounds of the latency buckets, in microseconds */
+static const gint64 latency_bounds[GFREENECT_LATENCY_BUCKETS - 1] =
+  {
+    500, 1000, 2000, 5000, 10000, 20000, 50000, 100000, 200000
+  };
+
+/**
+ * gfreenect_device_stats_get_type:
+ *
+ * Returns: The registered #GType for #GFreenectDeviceStats boxed type
+ **/
+GType
+gfreenect_device_stats_get_type (void)
+{
+  static GType type = 0;
+
+  if (G_UNLIKELY (type == 0))
+    type = g_boxed_type_register_static ("GFreenectDeviceStats",
+                              (GBoxedCopyFunc) gfreenect_device_stats_copy,
+                              (GBoxedFreeFunc) gfreenect_device_stats_free);
+  return type;
+}
+
+/**
+ * gfreenect_device_stats_copy:
+ * @stats: The #GFreenectDeviceStats to copy
+ *
+ * Makes an exact copy of a #GFreenectDeviceStats object.
+ *
+ * Returns: (transfer full): A newly created #GFreenectDeviceStats. Use
+ * gfreenect_device_stats_free() to free it.
+ **/
+gpointer
+gfreenect_device_stats_copy (GFreenectDeviceStats *stats)
+{
+  GFreenectDeviceStats *copy;
+
+  copy = g_slice_new (GFreenectDeviceStats);
+
+  memcpy (copy, stats, sizeof (GFreenectDeviceStats));
+
+  return copy;
+}
+
+/**
+ * gfreenect_device_stats_free:
+ * @stats: The #GFreenectDeviceStats to free
+ *
+ * Frees a #GFreenectDeviceStats object.
+ **/
+void
+gfreenect_device_stats_free (GFreenectDeviceStats *stats)
+{
+  g_slice_free (GFreenectDeviceStats, stats);
+}
+
+/**
+ * gfreenect_latency_histogram_get_bound:
+ * @bucket: The index of a bucket of a #GFreenectLatencyHistogram
+ *
+ * Obtains the upper bound of a latency bucket.
+ *
+ * Returns: The largest latency counted in @bucket, in microseconds, or
+ * %G_MAXINT64 for the last bucket.
+ **/
+gint64
+gfreenect_latency_histogram_get_bound (guint bucket)
+{
+  g_return_val_if_fail (bucket < GFREENECT_LATENCY_BUCKETS, G_MAXINT64);
+
+  if (bucket == GFREENECT_LATENCY_BUCKETS - 1)
+    return G_MAXINT64;
+
+  return latency_bounds[bucket];
+}
@@ -0,0 +1,154 @@
+/*
+ * gfreenect-device-stats.h
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+
+#ifndef __GFREENECT_DEVICE_STATS_H__
+#define __GFREENECT_DEVICE_STATS_H__
+
+#include <glib.h>
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+#define GFREENECT_TYPE_DEVICE_STATS (gfreenect_device_stats_get_type ())
+
+/**
+ * GFREENECT_LATENCY_BUCKETS:
+ *
+ * The number of buckets of a #GFreenectLatencyHistogram.
+ **/
+#define GFREENECT_LATENCY_BUCKETS 10
+
+typedef struct _GFreenectDeviceStats GFreenectDeviceStats;
+typedef struct _GFreenectStreamStats GFreenectStreamStats;
+typedef struct _GFreenectConversionStats GFreenectConversionStats;
+typedef struct _GFreenectLatencyHistogram GFreenectLatencyHistogram;
+
+/**
+ * GFreenectLatencyHistogram:
+ * @counts: The number of samples in each bucket. A bucket holds the samples
+ * above the upper bound of the previous one and up to its own, as returned
+ * by gfreenect_latency_histogram_get_bound(). The last bucket has no upper
+ * bound.
+ * @sum: The sum of all the samples, in microseconds
+ *
+ * The distribution of a latency measured by #GFreenectDevice.
+ **/
+struct _GFreenectLatencyHistogram
+{
+  guint64 counts[GFREENECT_LATENCY_BUCKETS];
+  guint64 sum;
+};
+
+/**
+ * GFreenectStreamStats:
+ * @fps: The rate frames are currently arriving at, in frames per second
+ * @bytes_per_second: The rate frame data is currently arriving at
+ * @frames_received: The number of frames received from the device
+ * @frames_delivered: The number of frames signalled to the application
+ * @frames_coalesced: The number of frames replaced by a newer one before
+ * the main loop got to signal them
+ * @frames_skipped: The number of frames not signalled because the scene
+ * was static, see #GFreenectDevice:skip-static-frames
+ * @latency: The time from the arrival of each delivered frame to its
+ * signal being emitted
+ *
+ * Counters of a depth or video stream, since the device was opened.
+ **/
+struct _GFreenectStreamStats
+{
+  gdouble fps;
+  gdouble bytes_per_second;
+
+  guint64 frames_received;
+  guint64 frames_delivered;
+  guint64 frames_coalesced;
+  guint64 frames_skipped;
+
+  GFreenectLatencyHistogram latency;
+};
+
+/**
+ * GFreenectConversionStats:
+ * @calls: The number of times the conversion ran
+ * @total_time: The time spent in the conversion, in microseconds
+ *
+ * The cost of one of the frame conversions of #GFreenectDevice.
+ **/
+struct _GFreenectConversionStats
+{
+  guint64 calls;
+  guint64 total_time;
+};
+
+/**
+ * GFreenectDeviceStats:
+ * @depth: Counters of the depth stream
+ * @video: Counters of the video stream
+ * @audio_frames_received: The number of audio frames received from the
+ * microphone array
+ * @depth_processing: The processing every depth frame goes through as it
+ * arrives: statistics, bands, pyramid, filters and motion detection
+ * @depth_grayscale: Calls to gfreenect_device_get_depth_frame_grayscale()
+ * @depth_registered: Calls to gfreenect_device_get_depth_frame_registered()
+ * that registered a frame in software
+ * @video_rgb: Calls to gfreenect_device_get_video_frame_rgb()
+ * @event_loop_iterations: The number of times the thread receiving frames
+ * has processed USB events. The thread is shared by all the devices of a
+ * #GFreenectContext.
+ * @dispatch_wakeups: The number of times the thread talking to the motor
+ * subdevice woke up to do some work
+ * @pending_queries: The number of tilt and accelerometer queries waiting
+ * for the motor subdevice to answer
+ *
+ * A snapshot of the runtime counters of a #GFreenectDevice, obtained with
+ * gfreenect_device_get_stats(). Counters are taken one at a time, so they
+ * may be a few events apart from each other. On 32-bit platforms the
+ * counts of frames, calls, wakeups and loop iterations wrap around at 2^32,
+ * which for frames takes more than two years at 60 frames per second.
+ * Times and audio frame counts are kept in 64 bits on every platform and
+ * do not wrap.
+ **/
+struct _GFreenectDeviceStats
+{
+  GFreenectStreamStats depth;
+  GFreenectStreamStats video;
+  guint64 audio_frames_received;
+
+  GFreenectConversionStats depth_processing;
+  GFreenectConversionStats depth_grayscale;
+  GFreenectConversionStats depth_registered;
+  GFreenectConversionStats video_rgb;
+
+  guint64 event_loop_iterations;
+  guint64 dispatch_wakeups;
+  guint pending_queries;
+};
+
+GType                  gfreenect_device_stats_get_type (void);
+gpointer               gfreenect_device_stats_copy     (GFreenectDeviceStats *stats);
+void                   gfreenect_device_stats_free     (GFreenectDeviceStats *stats);
+
+gint64                 gfreenect_latency_histogram_get_bound (guint bucket);
+
+G_END_DECLS
+
+#endif /* __GFREENECT_DEVICE_STATS_H__ */
@@ -38,6 +38,10 @@
  * The led status is set asynchronously using gfreenect_device_set_led() and
  * gfreenect_device_set_led_finish().
  *
+ * When several sensors are used at once, opening them from the same
+ * #GFreenectContext with gfreenect_device_new_with_context() makes them
+ * share one libfreenect context and a single thread to receive frames.
+ *
  * To start the depth or video camera streams,
  * use gfreenect_device_start_depth_stream() and
  * gfreenect_device_start_video_stream() respectively. Then connect to the
@@ -50,15 +54,106 @@
  *
  * The accelerometer data can be obtained asynchronously using
  * gfreenect_device_get_accel() and gfreenect_device_get_accel_finish(),
- * or synchronously using gfreenect_device_get_accel_sync().
+ * or synchronously using gfreenect_device_get_accel_sync(). Callers that can
+ * live with a slightly older reading should use
+ * gfreenect_device_query_motion_state() with a maximum age instead, which
+ * answers from the last reading when possible and otherwise shares one read
+ * among all the callers waiting for it.
+ *
+ * Applications that track the accelerometer or the tilt motor continuously
+ * should start the motion stream with gfreenect_device_start_motion_stream()
+ * instead. The motor subdevice is then sampled in the background at the
+ * #GFreenectDevice:motion-sample-rate, #GFreenectDevice::motion-state is
+ * emitted with the newest sample, and the last %GFREENECT_MOTION_HISTORY
+ * samples can be read from any thread with
+ * gfreenect_device_get_motion_state() and
+ * gfreenect_device_get_motion_states_since(). The orientation of the sensor
+ * when each frame arrived, interpolated from these samples, is available
+ * within the frame signal handlers through
+ * gfreenect_device_get_depth_frame_motion_state() and
+ * gfreenect_device_get_video_frame_motion_state().
+ *
+ * When the device is opened with %GFREENECT_SUBDEVICE_AUDIO, the microphone
+ * array is streamed with gfreenect_device_start_audio_stream(). Audio frames
+ * are delivered by the #GFreenectDevice::audio-samples signal, and can also
+ * be pulled from another thread with gfreenect_device_read_audio().
+ *
+ * Depth frames in %GFREENECT_DEPTH_FORMAT_11BIT can be aligned to the RGB
+ * image in software using gfreenect_device_get_depth_frame_registered().
+ * The #GFreenectRegistration used for it is available through
+ * gfreenect_device_get_registration(), to register raw frames later on.
+ *
+ * Setting the #GFreenectDevice:depth-pyramid property makes the device build
+ * reduced resolution copies of every depth frame as it arrives, which are
+ * retrieved with gfreenect_device_get_depth_pyramid_level().
+ *
+ * The range, mean and number of valid pixels of every depth frame are
+ * computed as it arrives, and retrieved with
+ * gfreenect_device_get_depth_stats(). A histogram of the depth values is
+ * also computed when the #GFreenectDevice:depth-histogram property is set,
+ * see gfreenect_device_get_depth_histogram(). The
+ * #GFreenectDevice:auto-range property uses these statistics to stretch
+ * the grayscale conversion to the depth range actually in the frame.
+ *
+ * Applications that only care about objects at certain distances can set up
+ * to %GFREENECT_DEPTH_BANDS_MAX depth bands with
+ * gfreenect_device_set_depth_bands(). Every depth frame is then classified
+ * into packed 1-bit masks, one per band, together with their bounding boxes
+ * and pixel counts, retrieved with gfreenect_device_get_depth_band().
+ *
+ * When only part of the image is of interest, a region of interest can be
+ * set for each stream using gfreenect_device_set_depth_roi() and
+ * gfreenect_device_set_video_roi(). The frame getters then only convert the
+ * pixels within that region and return frames of the region's size.
+ *
+ * Depth noise can be reduced over time by setting the
+ * #GFreenectDevice:temporal-filter property, and within each frame by setting
+ * the #GFreenectDevice:spatial-filter property. When both are set, the
+ * spatial filter runs on the output of the temporal one. The filtered frames
+ * are retrieved with gfreenect_device_get_depth_frame_filtered(), while the
+ * raw ones stay available through the usual getters.
+ *
+ * Setting the #GFreenectDevice:motion-detection property compares every
+ * depth frame against a background model learnt over time, and emits
+ * #GFreenectDevice::motion with the regions that changed. Together with
+ * #GFreenectDevice:skip-static-frames, the frame signals are only emitted
+ * while something moves in front of the sensor.
+ *
+ * What the device is doing at runtime can be monitored through
+ * gfreenect_device_get_stats(), which returns the measured frame rates,
+ * frame counts, conversion times and thread activity, and through the
+ * #GFreenectDevice:depth-fps and #GFreenectDevice:video-fps properties.
+ * When the library is configured with <literal>--enable-tracing</literal>,
+ * the same activity is also exposed as USDT probes of the "gfreenect"
+ * provider and, if sysprof is available, as marks in sysprof captures.
  **/
 
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
 #include <libfreenect.h>
+#include <libfreenect_registration.h>
+#ifdef HAVE_FREENECT_START_AUDIO
+#include <libfreenect_audio.h>
+#endif
 #include <string.h>
 #include <math.h>
 #include <stdlib.h>
 
 #include "gfreenect-device.h"
+#include "gfreenect-context-private.h"
+#include "gfreenect-depth-pyramid.h"
+#include "gfreenect-temporal-filter.h"
+#include "gfreenect-spatial-filter.h"
+#include "gfreenect-motion-detector.h"
+#include "gfreenect-depth-bands.h"
+#include "gfreenect-motion-ring.h"
+#include "gfreenect-motion-cache.h"
+#include "gfreenect-audio-ring.h"
+#include "gfreenect-marshal.h"
+#include "gfreenect-convert.h"
+#include "gfreenect-trace.h"
 
 #define GFREENECT_DEVICE_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), \
                                            GFREENECT_TYPE_DEVICE, \
@@ -69,9 +164,109 @@
 #define DEFAULT_VIDEO_RESOLUTION GFREENECT_RESOLUTION_MEDIUM
 #define DEFAULT_VIDEO_FORMAT     GFREENECT_VIDEO_FORMAT_RGB
 #define DEFAULT_TILT_ANGLE       0.0
+#define DEFAULT_TILT_POLL_INTERVAL 50
+#define DEFAULT_MOTION_SAMPLE_RATE 100
+
+#define DEFAULT_TEMPORAL_FILTER_ALPHA     0.25
+#define DEFAULT_TEMPORAL_FILTER_THRESHOLD 32
+#define DEFAULT_TEMPORAL_FILTER_FRAMES    5
+
+#define DEFAULT_SPATIAL_FILTER_RADIUS      2
+#define DEFAULT_SPATIAL_FILTER_SIGMA       30
+#define DEFAULT_SPATIAL_FILTER_COLOR_SIGMA 12
+
+#define DEFAULT_MOTION_THRESHOLD 50
+
+/* frames without motion after which the scene is considered static */
+#define MOTION_HOLD_FRAMES 15
 
 #define USER_BUF_SIZE 1280 * 1024 * 3
 
+/* weight of the newest interval in the moving average of frame intervals,
+   as a power of two */
+#define FRAME_INTERVAL_SHIFT 3
+
+/* Times in microseconds, and counts of audio frames, would wrap around
+   within hours in 32 bits, and GLib has no 64-bit atomic operations. Where
+   gpointer is smaller than 64 bits these counters are updated under a lock
+   instead, shared by all devices as updates are a few per frame. */
+#if GLIB_SIZEOF_VOID_P >= 8
+typedef gsize Counter64;
+#else
+typedef guint64 Counter64;
+
+static GMutex counter64_mutex;
+#endif
+
+static void
+counter64_add (Counter64 *counter, gint64 value)
+{
+#if GLIB_SIZEOF_VOID_P >= 8
+  g_atomic_pointer_add (counter, value);
+#else
+  g_mutex_lock (&counter64_mutex);
+  *counter += value;
+  g_mutex_unlock (&counter64_mutex);
+#endif
+}
+
+static void
+counter64_set (Counter64 *counter, gint64 value)
+{
+#if GLIB_SIZEOF_VOID_P >= 8
+  g_atomic_pointer_set (counter, value);
+#else
+  g_mutex_lock (&counter64_mutex);
+  *counter = value;
+  g_mutex_unlock (&counter64_mutex);
+#endif
+}
+
+static guint64
+counter64_get (Counter64 *counter)
+{
+#if GLIB_SIZEOF_VOID_P >= 8
+  return (gsize) g_atomic_pointer_get (counter);
+#else
+  guint64 value;
+
+  g_mutex_lock (&counter64_mutex);
+  value = *counter;
+  g_mutex_unlock (&counter64_mutex);
+
+  return value;
+#endif
+}
+
+/* Runtime counters. They are written by a single thread and read from any
+   thread without locking. Event counts are gpointer-sized to be updated
+   with atomic operations, so they wrap around at 2^32 on 32-bit platforms,
+   after more than two years at 60 frames per second. Times and audio frames
+   are Counter64 and do not wrap. */
+typedef struct
+{
+  gsize frames_received;
+  gsize frames_delivered;
+  gsize frames_coalesced;
+  gsize frames_skipped;
+
+  /* arrival time of the last frame and moving average of the time between
+     frames, in microseconds */
+  Counter64 last_frame_time;
+  gint frame_interval;
+  gint frame_size;
+
+  /* time from the arrival of frames to their signal, in microseconds */
+  gsize latency_counts[GFREENECT_LATENCY_BUCKETS];
+  Counter64 latency_sum;
+} StreamCounters;
+
+typedef struct
+{
+  gsize calls;
+  Counter64 total_time;           /* in microseconds */
+} ConversionCounters;
+
 /* private data */
 struct _GFreenectDevicePrivate
 {
@@ -86,7 +281,7 @@ struct _GFreenectDevicePrivate
   gdouble tilt_angle;
   gboolean tilt_motor_moving;
 
-  freenect_context *ctx;
+  GFreenectContext *context;
   freenect_device *dev;
 
   freenect_frame_mode depth_mode;
@@ -94,11 +289,18 @@ struct _GFreenectDevicePrivate
 
   GThread *dispatch_thread;
   GMutex dispatch_mutex;
+  GCond dispatch_cond;
   gboolean abort_dispatch_thread;
+  guint tilt_poll_interval;
+
+  gboolean motion_stream_started;
+  guint motion_sample_rate;
+  GFreenectMotionRing motion_ring;
+  GMainContext *motion_context;
+  guint motion_state_src_id;
 
-  GThread *stream_thread;
   GMutex stream_mutex;
-  gboolean abort_stream_thread;
+  gboolean holds_events;
 
   guint depth_frame_src_id;
   guint video_frame_src_id;
@@ -111,15 +313,73 @@ struct _GFreenectDevicePrivate
   void *depth_buf;
   gboolean got_depth_frame;
 
+  /* arrival time of the last depth frame, and of the one being signalled */
+  gint64 depth_frame_time;
+  gint64 depth_signal_time;
+
+  GFreenectRegion *depth_roi;
+  guint8 *depth_roi_buf;
+
+  GFreenectRegion *video_roi;
+  guint8 *video_roi_buf;
+
+  GFreenectDepthPyramid depth_pyramid;
+  guint16 *depth_pyramid_buf;
+  guint16 *depth_pyramid_levels[GFREENECT_DEPTH_PYRAMID_LEVELS];
+  gboolean has_depth_pyramid;
+
+  GFreenectDepthStats depth_stats;
+  gboolean has_depth_stats;
+  gboolean depth_histogram_enabled;
+  guint32 *depth_histogram;
+  guint depth_histogram_shift;
+  gboolean auto_range;
+
+  GFreenectDepthBandsState depth_bands;
+
+  GFreenectTemporalFilterState temporal_filter;
+  GFreenectSpatialFilterState spatial_filter;
+
+  gboolean motion_detection;
+  gboolean skip_static_frames;
+  GFreenectMotionDetectorState motion_detector;
+  GPtrArray *motion_regions;
+  guint static_frames;
+
   void *video_buf;
   gboolean got_video_frame;
 
+  gint64 video_frame_time;
+  gint64 video_signal_time;
+
+  gboolean audio_stream_started;
+  GFreenectAudioRing audio_ring;
+  gint32 *audio_signal_buf;
+  guint audio_signal_cursor;
+  guint audio_read_cursor;
+  guint audio_src_id;
+
   gboolean update_tilt_angle;
   gboolean update_led;
 
   GSimpleAsyncResult *set_tilt_result;
   GSimpleAsyncResult *set_led_result;
-  GList *state_dependent_results;
+  GQueue state_dependent_results;
+
+  /* the last state read from the motor subdevice, and the refresh shared
+     by all the queries that find it too old */
+  GFreenectMotionCache motion_cache;
+
+  GFreenectRegistration *registration;
+
+  StreamCounters depth_counters;
+  StreamCounters video_counters;
+  Counter64 audio_frames_received;
+  ConversionCounters depth_processing_counters;
+  ConversionCounters depth_grayscale_counters;
+  ConversionCounters depth_registered_counters;
+  ConversionCounters video_rgb_counters;
+  gsize dispatch_wakeups;
 };
 
 /* constructor data */
@@ -135,6 +395,9 @@ enum
 {
   SIGNAL_DEPTH_FRAME,
   SIGNAL_VIDEO_FRAME,
+  SIGNAL_MOTION,
+  SIGNAL_MOTION_STATE,
+  SIGNAL_AUDIO_SAMPLES,
   LAST_SIGNAL
 };
 
@@ -146,8 +409,30 @@ enum
   PROP_0,
   PROP_INDEX,
   PROP_SUBDEVICES,
+  PROP_CONTEXT,
   PROP_LED,
-  PROP_TILT_ANGLE
+  PROP_TILT_ANGLE,
+  PROP_DEPTH_PYRAMID,
+  PROP_DEPTH_ROI,
+  PROP_VIDEO_ROI,
+  PROP_TEMPORAL_FILTER,
+  PROP_TEMPORAL_FILTER_ALPHA,
+  PROP_TEMPORAL_FILTER_THRESHOLD,
+  PROP_TEMPORAL_FILTER_FRAMES,
+  PROP_SPATIAL_FILTER,
+  PROP_SPATIAL_FILTER_RADIUS,
+  PROP_SPATIAL_FILTER_SIGMA,
+  PROP_SPATIAL_FILTER_COLOR_SIGMA,
+  PROP_MOTION_DETECTION,
+  PROP_MOTION_THRESHOLD,
+  PROP_SKIP_STATIC_FRAMES,
+  PROP_DEPTH_HISTOGRAM,
+  PROP_AUTO_RANGE,
+  PROP_TILT_POLL_INTERVAL,
+  PROP_MOTION_SAMPLE_RATE,
+  PROP_DEPTH_FPS,
+  PROP_VIDEO_FPS,
+  PROP_STATS
 };
 
 
@@ -232,6 +517,71 @@ gfreenect_device_class_init (GFreenectDeviceClass *class)
           g_cclosure_marshal_VOID__VOID,
           G_TYPE_NONE, 0);
 
+  /**
+   * GFreenectDevice::motion:
+   * @self: The #GFreenectDevice
+   * @regions: (element-type GFreenectRegion): The bounding boxes of the
+   * regions of the depth frame that changed
+   *
+   * Called when motion is detected in the depth stream, before the
+   * corresponding #GFreenectDevice::depth-frame signal. Motion detection
+   * has to be enabled with the #GFreenectDevice:motion-detection property.
+   **/
+  gfreenect_device_signals[SIGNAL_MOTION] =
+    g_signal_new ("motion",
+          G_TYPE_FROM_CLASS (obj_class),
+          G_SIGNAL_RUN_LAST | G_SIGNAL_ACTION,
+          G_STRUCT_OFFSET (GFreenectDeviceClass, motion),
+          NULL, NULL,
+          g_cclosure_marshal_VOID__BOXED,
+          G_TYPE_NONE, 1,
+          G_TYPE_PTR_ARRAY);
+
+  /**
+   * GFreenectDevice::motion-state:
+   * @self: The #GFreenectDevice
+   * @state: The newest #GFreenectMotionState
+   *
+   * Called when new samples of the motor subdevice state are available. The
+   * motion stream has to be started with
+   * gfreenect_device_start_motion_stream(). Samples taken since the last
+   * emission can be retrieved with gfreenect_device_get_motion_states_since().
+   **/
+  gfreenect_device_signals[SIGNAL_MOTION_STATE] =
+    g_signal_new ("motion-state",
+          G_TYPE_FROM_CLASS (obj_class),
+          G_SIGNAL_RUN_LAST | G_SIGNAL_ACTION,
+          G_STRUCT_OFFSET (GFreenectDeviceClass, motion_state),
+          NULL, NULL,
+          g_cclosure_marshal_VOID__BOXED,
+          G_TYPE_NONE, 1,
+          GFREENECT_TYPE_MOTION_STATE | G_SIGNAL_TYPE_STATIC_SCOPE);
+
+  /**
+   * GFreenectDevice::audio-samples:
+   * @self: The #GFreenectDevice
+   * @frames: The new frames, of %GFREENECT_AUDIO_CHANNELS interleaved
+   * gint32 samples each
+   * @n_frames: The number of frames
+   * @timestamp: The monotonic time the first frame arrived at, in
+   * microseconds
+   *
+   * Called whenever new audio frames are available. The audio stream has to
+   * be started with gfreenect_device_start_audio_stream(). @frames is only
+   * valid during the emission.
+   **/
+  gfreenect_device_signals[SIGNAL_AUDIO_SAMPLES] =
+    g_signal_new ("audio-samples",
+          G_TYPE_FROM_CLASS (obj_class),
+          G_SIGNAL_RUN_LAST | G_SIGNAL_ACTION,
+          G_STRUCT_OFFSET (GFreenectDeviceClass, audio_samples),
+          NULL, NULL,
+          gfreenect_marshal_VOID__POINTER_UINT_INT64,
+          G_TYPE_NONE, 3,
+          G_TYPE_POINTER,
+          G_TYPE_UINT,
+          G_TYPE_INT64);
+
   /* install properties */
 
   /**
@@ -267,6 +617,21 @@ gfreenect_device_class_init (GFreenectDeviceClass *class)
                                                       G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY |
                                                       G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GFreenectDevice:context
+   *
+   * The #GFreenectContext the device is opened from. If not set on
+   * construction, the device gets a context of its own.
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_CONTEXT,
+                                   g_param_spec_object ("context",
+                                                        "Context",
+                                                        "The context the device is opened from",
+                                                        GFREENECT_TYPE_CONTEXT,
+                                                        G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY |
+                                                        G_PARAM_STATIC_STRINGS));
+
   /**
    * GFreenectDevice:led
    *
@@ -298,6 +663,372 @@ gfreenect_device_class_init (GFreenectDeviceClass *class)
                                                         G_PARAM_READWRITE |
                                                         G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GFreenectDevice:depth-pyramid
+   *
+   * The reduction from #GFreenectDepthPyramid used to build a pyramid of
+   * %GFREENECT_DEPTH_PYRAMID_LEVELS reduced resolution copies of each depth
+   * frame, or %GFREENECT_DEPTH_PYRAMID_NONE to not build it. Pixels with no
+   * depth information are ignored by the reduction. See
+   * gfreenect_device_get_depth_pyramid_level().
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_DEPTH_PYRAMID,
+                                   g_param_spec_uint ("depth-pyramid",
+                                                      "Depth pyramid",
+                                                      "Reduction used to build the depth pyramid",
+                                                      GFREENECT_DEPTH_PYRAMID_NONE,
+                                                      GFREENECT_DEPTH_PYRAMID_MEDIAN,
+                                                      GFREENECT_DEPTH_PYRAMID_NONE,
+                                                      G_PARAM_READWRITE |
+                                                      G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GFreenectDevice:depth-roi
+   *
+   * The region of interest of the depth frames, or %NULL to use the whole
+   * frame. See gfreenect_device_set_depth_roi().
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_DEPTH_ROI,
+                                   g_param_spec_boxed ("depth-roi",
+                                                       "Depth ROI",
+                                                       "Region of interest of the depth frames",
+                                                       GFREENECT_TYPE_REGION,
+                                                       G_PARAM_READWRITE |
+                                                       G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GFreenectDevice:video-roi
+   *
+   * The region of interest of the video frames, or %NULL to use the whole
+   * frame. See gfreenect_device_set_video_roi().
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_VIDEO_ROI,
+                                   g_param_spec_boxed ("video-roi",
+                                                       "Video ROI",
+                                                       "Region of interest of the video frames",
+                                                       GFREENECT_TYPE_REGION,
+                                                       G_PARAM_READWRITE |
+                                                       G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GFreenectDevice:temporal-filter
+   *
+   * The #GFreenectTemporalFilter applied to the depth stream, or
+   * %GFREENECT_TEMPORAL_FILTER_NONE to not filter it. Only depth formats
+   * that use one guint16 per pixel are filtered. See
+   * gfreenect_device_get_depth_frame_filtered().
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_TEMPORAL_FILTER,
+                                   g_param_spec_uint ("temporal-filter",
+                                                      "Temporal filter",
+                                                      "Filter applied to the depth stream over time",
+                                                      GFREENECT_TEMPORAL_FILTER_NONE,
+                                                      GFREENECT_TEMPORAL_FILTER_MEDIAN,
+                                                      GFREENECT_TEMPORAL_FILTER_NONE,
+                                                      G_PARAM_READWRITE |
+                                                      G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GFreenectDevice:temporal-filter-alpha
+   *
+   * The weight of each new depth sample in the moving average of
+   * %GFREENECT_TEMPORAL_FILTER_AVERAGE. Lower values smooth more, but lag
+   * behind slow movements.
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_TEMPORAL_FILTER_ALPHA,
+                                   g_param_spec_double ("temporal-filter-alpha",
+                                                        "Temporal filter alpha",
+                                                        "Weight of new samples in the moving average",
+                                                        0.0,
+                                                        1.0,
+                                                        DEFAULT_TEMPORAL_FILTER_ALPHA,
+                                                        G_PARAM_READWRITE |
+                                                        G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GFreenectDevice:temporal-filter-threshold
+   *
+   * The change in depth, in units of the depth format, above which
+   * %GFREENECT_TEMPORAL_FILTER_AVERAGE considers that something moved and
+   * restarts the average of a pixel instead of blending the new sample.
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_TEMPORAL_FILTER_THRESHOLD,
+                                   g_param_spec_uint ("temporal-filter-threshold",
+                                                      "Temporal filter threshold",
+                                                      "Depth change that restarts the moving average",
+                                                      0,
+                                                      G_MAXUINT16,
+                                                      DEFAULT_TEMPORAL_FILTER_THRESHOLD,
+                                                      G_PARAM_READWRITE |
+                                                      G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GFreenectDevice:temporal-filter-frames
+   *
+   * The number of frames %GFREENECT_TEMPORAL_FILTER_MEDIAN takes the median
+   * over. %GFREENECT_TEMPORAL_FILTER_AVERAGE keeps the last valid depth of a
+   * pixel for up to this number of frames, to fill short-lived holes.
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_TEMPORAL_FILTER_FRAMES,
+                                   g_param_spec_uint ("temporal-filter-frames",
+                                                      "Temporal filter frames",
+                                                      "Number of frames the temporal filter spans",
+                                                      1,
+                                                      GFREENECT_TEMPORAL_FILTER_MAX_FRAMES,
+                                                      DEFAULT_TEMPORAL_FILTER_FRAMES,
+                                                      G_PARAM_READWRITE |
+                                                      G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GFreenectDevice:spatial-filter
+   *
+   * The #GFreenectSpatialFilter applied to each depth frame, or
+   * %GFREENECT_SPATIAL_FILTER_NONE to not filter them. Only depth formats
+   * that use one guint16 per pixel are filtered.
+   *
+   * %GFREENECT_SPATIAL_FILTER_JOINT_BILATERAL is guided by the video stream
+   * when it is running in %GFREENECT_VIDEO_FORMAT_RGB at the resolution of
+   * the depth frames; use %GFREENECT_DEPTH_FORMAT_REGISTERED so that both
+   * are aligned. Otherwise it behaves as %GFREENECT_SPATIAL_FILTER_BILATERAL.
+   * See gfreenect_device_get_depth_frame_filtered().
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_SPATIAL_FILTER,
+                                   g_param_spec_uint ("spatial-filter",
+                                                      "Spatial filter",
+                                                      "Filter applied within each depth frame",
+                                                      GFREENECT_SPATIAL_FILTER_NONE,
+                                                      GFREENECT_SPATIAL_FILTER_JOINT_BILATERAL,
+                                                      GFREENECT_SPATIAL_FILTER_NONE,
+                                                      G_PARAM_READWRITE |
+                                                      G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GFreenectDevice:spatial-filter-radius
+   *
+   * The radius, in pixels, of the neighbourhood the spatial filter averages.
+   * The cost of the filter grows with the square of the radius.
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_SPATIAL_FILTER_RADIUS,
+                                   g_param_spec_uint ("spatial-filter-radius",
+                                                      "Spatial filter radius",
+                                                      "Radius of the spatial filter kernel",
+                                                      1,
+                                                      GFREENECT_SPATIAL_FILTER_MAX_RADIUS,
+                                                      DEFAULT_SPATIAL_FILTER_RADIUS,
+                                                      G_PARAM_READWRITE |
+                                                      G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GFreenectDevice:spatial-filter-sigma
+   *
+   * The standard deviation, in units of the depth format, of the depth
+   * difference weight of the spatial filter. Neighbours further than about
+   * three times this value in depth do not contribute, which preserves the
+   * edges of objects.
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_SPATIAL_FILTER_SIGMA,
+                                   g_param_spec_uint ("spatial-filter-sigma",
+                                                      "Spatial filter sigma",
+                                                      "Depth difference sigma of the spatial filter",
+                                                      1,
+                                                      300,
+                                                      DEFAULT_SPATIAL_FILTER_SIGMA,
+                                                      G_PARAM_READWRITE |
+                                                      G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GFreenectDevice:spatial-filter-color-sigma
+   *
+   * The standard deviation of the intensity difference weight used by
+   * %GFREENECT_SPATIAL_FILTER_JOINT_BILATERAL, in 8-bit intensity levels.
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_SPATIAL_FILTER_COLOR_SIGMA,
+                                   g_param_spec_uint ("spatial-filter-color-sigma",
+                                                      "Spatial filter color sigma",
+                                                      "Intensity difference sigma of the joint bilateral filter",
+                                                      1,
+                                                      80,
+                                                      DEFAULT_SPATIAL_FILTER_COLOR_SIGMA,
+                                                      G_PARAM_READWRITE |
+                                                      G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GFreenectDevice:motion-detection
+   *
+   * Whether depth frames are compared against a learnt background to
+   * detect motion, emitting #GFreenectDevice::motion. Only depth formats
+   * that use one guint16 per pixel are analyzed.
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_MOTION_DETECTION,
+                                   g_param_spec_boolean ("motion-detection",
+                                                         "Motion detection",
+                                                         "Whether to detect motion in the depth stream",
+                                                         FALSE,
+                                                         G_PARAM_READWRITE |
+                                                         G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GFreenectDevice:motion-threshold
+   *
+   * The change in depth with respect to the background, in units of the
+   * depth format, above which a pixel is considered to have changed.
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_MOTION_THRESHOLD,
+                                   g_param_spec_uint ("motion-threshold",
+                                                      "Motion threshold",
+                                                      "Depth change considered as motion",
+                                                      1,
+                                                      G_MAXUINT16,
+                                                      DEFAULT_MOTION_THRESHOLD,
+                                                      G_PARAM_READWRITE |
+                                                      G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GFreenectDevice:skip-static-frames
+   *
+   * Whether #GFreenectDevice::depth-frame and #GFreenectDevice::video-frame
+   * are not emitted while the scene is static. The frames keep being
+   * emitted for a short while after the last motion is detected. Has no
+   * effect unless #GFreenectDevice:motion-detection is set and the depth
+   * stream is running.
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_SKIP_STATIC_FRAMES,
+                                   g_param_spec_boolean ("skip-static-frames",
+                                                         "Skip static frames",
+                                                         "Whether to skip frames while there is no motion",
+                                                         FALSE,
+                                                         G_PARAM_READWRITE |
+                                                         G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GFreenectDevice:depth-histogram
+   *
+   * Whether a histogram of the depth values is computed for every depth
+   * frame, together with its statistics. See
+   * gfreenect_device_get_depth_histogram().
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_DEPTH_HISTOGRAM,
+                                   g_param_spec_boolean ("depth-histogram",
+                                                         "Depth histogram",
+                                                         "Whether to compute the histogram of depth frames",
+                                                         FALSE,
+                                                         G_PARAM_READWRITE |
+                                                         G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GFreenectDevice:auto-range
+   *
+   * Whether gfreenect_device_get_depth_frame_grayscale() maps the range of
+   * valid depth values of each frame to the full intensity range, instead of
+   * the fixed range of %GFREENECT_DEPTH_FORMAT_11BIT.
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_AUTO_RANGE,
+                                   g_param_spec_boolean ("auto-range",
+                                                         "Auto range",
+                                                         "Whether to stretch grayscale depth frames to their range",
+                                                         FALSE,
+                                                         G_PARAM_READWRITE |
+                                                         G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GFreenectDevice:tilt-poll-interval
+   *
+   * The interval, in milliseconds, at which the status of the tilt motor is
+   * polled while it is moving, to complete
+   * gfreenect_device_set_tilt_angle(). The motor is not polled otherwise.
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_TILT_POLL_INTERVAL,
+                                   g_param_spec_uint ("tilt-poll-interval",
+                                                      "Tilt poll interval",
+                                                      "Milliseconds between tilt status polls while the motor moves",
+                                                      1,
+                                                      1000,
+                                                      DEFAULT_TILT_POLL_INTERVAL,
+                                                      G_PARAM_READWRITE |
+                                                      G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GFreenectDevice:motion-sample-rate
+   *
+   * The number of times per second the state of the motor subdevice is
+   * sampled while the motion stream is started. See
+   * gfreenect_device_start_motion_stream().
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_MOTION_SAMPLE_RATE,
+                                   g_param_spec_uint ("motion-sample-rate",
+                                                      "Motion sample rate",
+                                                      "Samples per second of the motion stream",
+                                                      1,
+                                                      1000,
+                                                      DEFAULT_MOTION_SAMPLE_RATE,
+                                                      G_PARAM_READWRITE |
+                                                      G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GFreenectDevice:depth-fps
+   *
+   * The rate depth frames are currently arriving at, in frames per second.
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_DEPTH_FPS,
+                                   g_param_spec_double ("depth-fps",
+                                                        "Depth FPS",
+                                                        "Measured depth frames per second",
+                                                        0.0,
+                                                        G_MAXDOUBLE,
+                                                        0.0,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GFreenectDevice:video-fps
+   *
+   * The rate video frames are currently arriving at, in frames per second.
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_VIDEO_FPS,
+                                   g_param_spec_double ("video-fps",
+                                                        "Video FPS",
+                                                        "Measured video frames per second",
+                                                        0.0,
+                                                        G_MAXDOUBLE,
+                                                        0.0,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GFreenectDevice:stats
+   *
+   * A #GFreenectDeviceStats snapshot of the runtime counters of the device,
+   * as returned by gfreenect_device_get_stats().
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_STATS,
+                                   g_param_spec_boxed ("stats",
+                                                       "Stats",
+                                                       "Runtime counters of the device",
+                                                       GFREENECT_TYPE_DEVICE_STATS,
+                                                       G_PARAM_READABLE |
+                                                       G_PARAM_STATIC_STRINGS));
+
   /* add private structure */
   g_type_class_add_private (obj_class, sizeof (GFreenectDevicePrivate));
 }
@@ -325,14 +1056,25 @@ gfreenect_device_init (GFreenectDevice *self)
 
   priv->glib_context = NULL;
 
-  priv->ctx = NULL;
+  priv->context = NULL;
   priv->dev = NULL;
 
   priv->dispatch_thread = NULL;
   g_mutex_init (&priv->dispatch_mutex);
+  g_cond_init (&priv->dispatch_cond);
+  priv->abort_dispatch_thread = FALSE;
+  priv->tilt_poll_interval = DEFAULT_TILT_POLL_INTERVAL;
+  priv->update_tilt_angle = FALSE;
+  priv->update_led = FALSE;
+
+  priv->motion_stream_started = FALSE;
+  priv->motion_sample_rate = DEFAULT_MOTION_SAMPLE_RATE;
+  gfreenect_motion_ring_init (&priv->motion_ring);
+  priv->motion_context = NULL;
+  priv->motion_state_src_id = 0;
 
-  priv->stream_thread = NULL;
   g_mutex_init (&priv->stream_mutex);
+  priv->holds_events = FALSE;
 
   priv->video_resolution = DEFAULT_VIDEO_RESOLUTION;
   priv->video_format = DEFAULT_VIDEO_FORMAT;
@@ -341,10 +1083,68 @@ gfreenect_device_init (GFreenectDevice *self)
   priv->set_led_result = NULL;
   priv->tilt_motor_moving = FALSE;
 
-  priv->state_dependent_results = NULL;
+  g_queue_init (&priv->state_dependent_results);
+  gfreenect_motion_cache_init (&priv->motion_cache);
+
+  priv->depth_frame_time = 0;
+  priv->depth_signal_time = 0;
+  priv->video_frame_time = 0;
+  priv->video_signal_time = 0;
+
+  priv->audio_stream_started = FALSE;
+  priv->audio_ring.samples = NULL;
+  priv->audio_signal_buf = NULL;
+  priv->audio_signal_cursor = 0;
+  priv->audio_read_cursor = 0;
+  priv->audio_src_id = 0;
 
   priv->depth_stream_started = FALSE;
   priv->video_stream_started = FALSE;
+
+  priv->registration = NULL;
+
+  memset (&priv->depth_counters, 0, sizeof (StreamCounters));
+  memset (&priv->video_counters, 0, sizeof (StreamCounters));
+  priv->audio_frames_received = 0;
+  memset (&priv->depth_processing_counters, 0, sizeof (ConversionCounters));
+  memset (&priv->depth_grayscale_counters, 0, sizeof (ConversionCounters));
+  memset (&priv->depth_registered_counters, 0, sizeof (ConversionCounters));
+  memset (&priv->video_rgb_counters, 0, sizeof (ConversionCounters));
+  priv->dispatch_wakeups = 0;
+
+  priv->depth_pyramid = GFREENECT_DEPTH_PYRAMID_NONE;
+  priv->depth_pyramid_buf = NULL;
+  priv->has_depth_pyramid = FALSE;
+
+  priv->depth_roi = NULL;
+  priv->depth_roi_buf = NULL;
+  priv->video_roi = NULL;
+  priv->video_roi_buf = NULL;
+
+  priv->has_depth_stats = FALSE;
+  priv->depth_histogram_enabled = FALSE;
+  priv->depth_histogram = NULL;
+  priv->depth_histogram_shift = 0;
+  priv->auto_range = FALSE;
+
+  gfreenect_depth_bands_init (&priv->depth_bands);
+
+  gfreenect_temporal_filter_init (&priv->temporal_filter);
+  priv->temporal_filter.alpha = DEFAULT_TEMPORAL_FILTER_ALPHA * 256;
+  priv->temporal_filter.threshold = DEFAULT_TEMPORAL_FILTER_THRESHOLD;
+  priv->temporal_filter.frames = DEFAULT_TEMPORAL_FILTER_FRAMES;
+
+  gfreenect_spatial_filter_init (&priv->spatial_filter);
+  priv->spatial_filter.radius = DEFAULT_SPATIAL_FILTER_RADIUS;
+  priv->spatial_filter.sigma = DEFAULT_SPATIAL_FILTER_SIGMA;
+  priv->spatial_filter.color_sigma = DEFAULT_SPATIAL_FILTER_COLOR_SIGMA;
+
+  priv->motion_detection = FALSE;
+  priv->skip_static_frames = FALSE;
+  gfreenect_motion_detector_init (&priv->motion_detector);
+  priv->motion_detector.threshold = DEFAULT_MOTION_THRESHOLD;
+  priv->motion_regions = NULL;
+  priv->static_frames = 0;
 }
 
 static void
@@ -352,44 +1152,60 @@ gfreenect_device_dispose (GObject *obj)
 {
   GFreenectDevice *self = GFREENECT_DEVICE (obj);
 
-  /* stop stream thread */
-  if (self->priv->stream_thread != NULL)
+  /* stop receiving frames; closing the device waits for the event thread
+     of the context to be done with it */
+  if (self->priv->holds_events)
     {
-      self->priv->abort_stream_thread = TRUE;
-      g_thread_join (self->priv->stream_thread);
-
-      g_mutex_lock (&self->priv->stream_mutex);
-
-      if (self->priv->depth_frame_src_id != 0)
-        {
-          g_source_remove (self->priv->depth_frame_src_id);
-          self->priv->depth_frame_src_id = 0;
-        }
-
-      if (self->priv->video_frame_src_id != 0)
-        {
-          g_source_remove (self->priv->video_frame_src_id);
-          self->priv->video_frame_src_id = 0;
-        }
-
-      self->priv->stream_thread = NULL;
-
-      g_mutex_unlock (&self->priv->stream_mutex);
+      gfreenect_context_release_events (self->priv->context);
+      self->priv->holds_events = FALSE;
     }
 
-  /* stop dispatch thread */
+  /* stop dispatch thread before the device it talks to goes away */
   if (self->priv->dispatch_thread != NULL)
     {
+      g_mutex_lock (&self->priv->dispatch_mutex);
       self->priv->abort_dispatch_thread = TRUE;
+      g_cond_signal (&self->priv->dispatch_cond);
+      g_mutex_unlock (&self->priv->dispatch_mutex);
+
       g_thread_join (self->priv->dispatch_thread);
+      self->priv->dispatch_thread = NULL;
+    }
 
-      g_mutex_lock (&self->priv->dispatch_mutex);
+  if (self->priv->motion_state_src_id != 0)
+    {
+      g_source_remove (self->priv->motion_state_src_id);
+      self->priv->motion_state_src_id = 0;
+    }
 
-      self->priv->dispatch_thread = NULL;
+  if (self->priv->dev != NULL)
+    {
+      gfreenect_context_close_device (self->priv->context, self->priv->dev);
+      self->priv->dev = NULL;
+    }
 
-      g_mutex_unlock (&self->priv->dispatch_mutex);
+  g_mutex_lock (&self->priv->stream_mutex);
+
+  if (self->priv->depth_frame_src_id != 0)
+    {
+      g_source_remove (self->priv->depth_frame_src_id);
+      self->priv->depth_frame_src_id = 0;
+    }
+
+  if (self->priv->video_frame_src_id != 0)
+    {
+      g_source_remove (self->priv->video_frame_src_id);
+      self->priv->video_frame_src_id = 0;
+    }
+
+  if (self->priv->audio_src_id != 0)
+    {
+      g_source_remove (self->priv->audio_src_id);
+      self->priv->audio_src_id = 0;
     }
 
+  g_mutex_unlock (&self->priv->stream_mutex);
+
   /* cancel set tilt angle operation */
   if (self->priv->set_tilt_result != NULL)
     {
@@ -427,19 +1243,14 @@ gfreenect_device_dispose (GObject *obj)
     }
 
   /* cancel all pending state dependent operations */
-  if (self->priv->state_dependent_results != NULL)
+  if (! g_queue_is_empty (&self->priv->state_dependent_results))
     {
-      GList *node;
+      GSimpleAsyncResult *res;
 
       g_mutex_lock (&self->priv->dispatch_mutex);
 
-      node = self->priv->state_dependent_results;
-      while (node != NULL)
+      while ((res = g_queue_pop_head (&self->priv->state_dependent_results)) != NULL)
         {
-          GSimpleAsyncResult *res;
-
-          res = node->data;
-
           g_simple_async_result_set_error (res,
                                            G_IO_ERROR,
                                            G_IO_ERROR_CANCELLED,
@@ -448,26 +1259,21 @@ gfreenect_device_dispose (GObject *obj)
 
           g_simple_async_result_complete (res);
           g_object_unref (res);
-
-          node = node->next;
         }
 
-      g_list_free (self->priv->state_dependent_results);
-      self->priv->state_dependent_results = NULL;
-
       g_mutex_unlock (&self->priv->dispatch_mutex);
     }
 
-  if (self->priv->dev != NULL)
+  if (self->priv->registration != NULL)
     {
-      freenect_close_device (self->priv->dev);
-      self->priv->dev = NULL;
+      gfreenect_registration_unref (self->priv->registration);
+      self->priv->registration = NULL;
     }
 
-  if (self->priv->ctx != NULL)
+  if (self->priv->context != NULL)
     {
-      freenect_shutdown (self->priv->ctx);
-      self->priv->ctx = NULL;
+      g_object_unref (self->priv->context);
+      self->priv->context = NULL;
     }
 
   G_OBJECT_CLASS (gfreenect_device_parent_class)->dispose (obj);
@@ -480,6 +1286,8 @@ gfreenect_device_finalize (GObject *obj)
 
   g_mutex_clear (&self->priv->stream_mutex);
   g_mutex_clear (&self->priv->dispatch_mutex);
+  g_cond_clear (&self->priv->dispatch_cond);
+  gfreenect_motion_cache_clear (&self->priv->motion_cache);
 
   if (self->priv->depth_buf != NULL)
     g_slice_free1 (self->priv->depth_mode.bytes, self->priv->depth_buf);
@@ -490,6 +1298,31 @@ gfreenect_device_finalize (GObject *obj)
   if (self->priv->user_buf != NULL)
     g_slice_free1 (USER_BUF_SIZE, self->priv->user_buf);
 
+  g_free (self->priv->depth_pyramid_buf);
+
+  g_free (self->priv->depth_histogram);
+
+  gfreenect_depth_bands_clear (&self->priv->depth_bands);
+  gfreenect_motion_ring_clear (&self->priv->motion_ring);
+
+  if (self->priv->audio_ring.samples != NULL)
+    gfreenect_audio_ring_clear (&self->priv->audio_ring);
+  g_free (self->priv->audio_signal_buf);
+  gfreenect_temporal_filter_clear (&self->priv->temporal_filter);
+  gfreenect_spatial_filter_clear (&self->priv->spatial_filter);
+
+  gfreenect_motion_detector_clear (&self->priv->motion_detector);
+  if (self->priv->motion_regions != NULL)
+    g_ptr_array_unref (self->priv->motion_regions);
+
+  if (self->priv->depth_roi != NULL)
+    gfreenect_region_free (self->priv->depth_roi);
+  g_free (self->priv->depth_roi_buf);
+
+  if (self->priv->video_roi != NULL)
+    gfreenect_region_free (self->priv->video_roi);
+  g_free (self->priv->video_roi_buf);
+
   G_OBJECT_CLASS (gfreenect_device_parent_class)->finalize (obj);
 }
 
@@ -513,6 +1346,10 @@ gfreenect_device_set_property (GObject      *obj,
       self->priv->subdevices = g_value_get_uint (value);
       break;
 
+    case PROP_CONTEXT:
+      self->priv->context = g_value_dup_object (value);
+      break;
+
     case PROP_LED:
       gfreenect_device_set_led (self,
                                 g_value_get_uint (value),
@@ -529,6 +1366,118 @@ gfreenect_device_set_property (GObject      *obj,
                                        NULL);
       break;
 
+    case PROP_DEPTH_PYRAMID:
+      g_mutex_lock (&self->priv->stream_mutex);
+      self->priv->depth_pyramid = g_value_get_uint (value);
+      self->priv->has_depth_pyramid = FALSE;
+      g_mutex_unlock (&self->priv->stream_mutex);
+      break;
+
+    case PROP_DEPTH_ROI:
+      gfreenect_device_set_depth_roi (self, g_value_get_boxed (value));
+      break;
+
+    case PROP_VIDEO_ROI:
+      gfreenect_device_set_video_roi (self, g_value_get_boxed (value));
+      break;
+
+    case PROP_TEMPORAL_FILTER:
+      g_mutex_lock (&self->priv->stream_mutex);
+      self->priv->temporal_filter.mode = g_value_get_uint (value);
+      gfreenect_temporal_filter_reset (&self->priv->temporal_filter);
+      g_mutex_unlock (&self->priv->stream_mutex);
+      break;
+
+    case PROP_TEMPORAL_FILTER_ALPHA:
+      g_mutex_lock (&self->priv->stream_mutex);
+      self->priv->temporal_filter.alpha = g_value_get_double (value) * 256;
+      g_mutex_unlock (&self->priv->stream_mutex);
+      break;
+
+    case PROP_TEMPORAL_FILTER_THRESHOLD:
+      g_mutex_lock (&self->priv->stream_mutex);
+      self->priv->temporal_filter.threshold = g_value_get_uint (value);
+      g_mutex_unlock (&self->priv->stream_mutex);
+      break;
+
+    case PROP_TEMPORAL_FILTER_FRAMES:
+      g_mutex_lock (&self->priv->stream_mutex);
+      self->priv->temporal_filter.frames = g_value_get_uint (value);
+      g_mutex_unlock (&self->priv->stream_mutex);
+      break;
+
+    case PROP_SPATIAL_FILTER:
+      g_mutex_lock (&self->priv->stream_mutex);
+      self->priv->spatial_filter.mode = g_value_get_uint (value);
+      self->priv->spatial_filter.has_output = FALSE;
+      g_mutex_unlock (&self->priv->stream_mutex);
+      break;
+
+    case PROP_SPATIAL_FILTER_RADIUS:
+      g_mutex_lock (&self->priv->stream_mutex);
+      self->priv->spatial_filter.radius = g_value_get_uint (value);
+      g_mutex_unlock (&self->priv->stream_mutex);
+      break;
+
+    case PROP_SPATIAL_FILTER_SIGMA:
+      g_mutex_lock (&self->priv->stream_mutex);
+      self->priv->spatial_filter.sigma = g_value_get_uint (value);
+      g_mutex_unlock (&self->priv->stream_mutex);
+      break;
+
+    case PROP_SPATIAL_FILTER_COLOR_SIGMA:
+      g_mutex_lock (&self->priv->stream_mutex);
+      self->priv->spatial_filter.color_sigma = g_value_get_uint (value);
+      g_mutex_unlock (&self->priv->stream_mutex);
+      break;
+
+    case PROP_MOTION_DETECTION:
+      g_mutex_lock (&self->priv->stream_mutex);
+      self->priv->motion_detection = g_value_get_boolean (value);
+      gfreenect_motion_detector_reset (&self->priv->motion_detector);
+      self->priv->static_frames = 0;
+      g_mutex_unlock (&self->priv->stream_mutex);
+      break;
+
+    case PROP_MOTION_THRESHOLD:
+      g_mutex_lock (&self->priv->stream_mutex);
+      self->priv->motion_detector.threshold = g_value_get_uint (value);
+      g_mutex_unlock (&self->priv->stream_mutex);
+      break;
+
+    case PROP_SKIP_STATIC_FRAMES:
+      g_mutex_lock (&self->priv->stream_mutex);
+      self->priv->skip_static_frames = g_value_get_boolean (value);
+      g_mutex_unlock (&self->priv->stream_mutex);
+      break;
+
+    case PROP_DEPTH_HISTOGRAM:
+      g_mutex_lock (&self->priv->stream_mutex);
+      self->priv->depth_histogram_enabled = g_value_get_boolean (value);
+      if (! self->priv->depth_histogram_enabled)
+        {
+          g_free (self->priv->depth_histogram);
+          self->priv->depth_histogram = NULL;
+        }
+      g_mutex_unlock (&self->priv->stream_mutex);
+      break;
+
+    case PROP_AUTO_RANGE:
+      self->priv->auto_range = g_value_get_boolean (value);
+      break;
+
+    case PROP_TILT_POLL_INTERVAL:
+      g_mutex_lock (&self->priv->dispatch_mutex);
+      self->priv->tilt_poll_interval = g_value_get_uint (value);
+      g_mutex_unlock (&self->priv->dispatch_mutex);
+      break;
+
+    case PROP_MOTION_SAMPLE_RATE:
+      g_mutex_lock (&self->priv->dispatch_mutex);
+      self->priv->motion_sample_rate = g_value_get_uint (value);
+      g_mutex_unlock (&self->priv->dispatch_mutex);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (obj, prop_id, pspec);
       break;
@@ -555,6 +1504,10 @@ gfreenect_device_get_property (GObject    *obj,
       g_value_set_uint (value, self->priv->subdevices);
       break;
 
+    case PROP_CONTEXT:
+      g_value_set_object (value, self->priv->context);
+      break;
+
     case PROP_LED:
       g_value_set_uint (value, self->priv->led);
       break;
@@ -563,6 +1516,105 @@ gfreenect_device_get_property (GObject    *obj,
       g_value_set_double (value, self->priv->tilt_angle);
       break;
 
+    case PROP_DEPTH_PYRAMID:
+      g_value_set_uint (value, self->priv->depth_pyramid);
+      break;
+
+    case PROP_DEPTH_ROI:
+      g_value_set_boxed (value, self->priv->depth_roi);
+      break;
+
+    case PROP_VIDEO_ROI:
+      g_value_set_boxed (value, self->priv->video_roi);
+      break;
+
+    case PROP_TEMPORAL_FILTER:
+      g_value_set_uint (value, self->priv->temporal_filter.mode);
+      break;
+
+    case PROP_TEMPORAL_FILTER_ALPHA:
+      g_value_set_double (value, self->priv->temporal_filter.alpha / 256.0);
+      break;
+
+    case PROP_TEMPORAL_FILTER_THRESHOLD:
+      g_value_set_uint (value, self->priv->temporal_filter.threshold);
+      break;
+
+    case PROP_TEMPORAL_FILTER_FRAMES:
+      g_value_set_uint (value, self->priv->temporal_filter.frames);
+      break;
+
+    case PROP_SPATIAL_FILTER:
+      g_value_set_uint (value, self->priv->spatial_filter.mode);
+      break;
+
+    case PROP_SPATIAL_FILTER_RADIUS:
+      g_value_set_uint (value, self->priv->spatial_filter.radius);
+      break;
+
+    case PROP_SPATIAL_FILTER_SIGMA:
+      g_value_set_uint (value, self->priv->spatial_filter.sigma);
+      break;
+
+    case PROP_SPATIAL_FILTER_COLOR_SIGMA:
+      g_value_set_uint (value, self->priv->spatial_filter.color_sigma);
+      break;
+
+    case PROP_MOTION_DETECTION:
+      g_value_set_boolean (value, self->priv->motion_detection);
+      break;
+
+    case PROP_MOTION_THRESHOLD:
+      g_value_set_uint (value, self->priv->motion_detector.threshold);
+      break;
+
+    case PROP_SKIP_STATIC_FRAMES:
+      g_value_set_boolean (value, self->priv->skip_static_frames);
+      break;
+
+    case PROP_DEPTH_HISTOGRAM:
+      g_value_set_boolean (value, self->priv->depth_histogram_enabled);
+      break;
+
+    case PROP_AUTO_RANGE:
+      g_value_set_boolean (value, self->priv->auto_range);
+      break;
+
+    case PROP_TILT_POLL_INTERVAL:
+      g_value_set_uint (value, self->priv->tilt_poll_interval);
+      break;
+
+    case PROP_MOTION_SAMPLE_RATE:
+      g_value_set_uint (value, self->priv->motion_sample_rate);
+      break;
+
+    case PROP_DEPTH_FPS:
+      {
+        GFreenectDeviceStats stats;
+
+        gfreenect_device_get_stats (self, &stats);
+        g_value_set_double (value, stats.depth.fps);
+        break;
+      }
+
+    case PROP_VIDEO_FPS:
+      {
+        GFreenectDeviceStats stats;
+
+        gfreenect_device_get_stats (self, &stats);
+        g_value_set_double (value, stats.video.fps);
+        break;
+      }
+
+    case PROP_STATS:
+      {
+        GFreenectDeviceStats stats;
+
+        gfreenect_device_get_stats (self, &stats);
+        g_value_set_boxed (value, &stats);
+        break;
+      }
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (obj, prop_id, pspec);
       break;
@@ -599,153 +1651,667 @@ timeout_add (GMainContext *context,
   return src_id;
 }
 
-static gboolean
-on_depth_frame_main_loop (gpointer user_data)
+/* the part of a frame to deliver: the region of interest clipped to the
+   frame, or the whole frame if no region of interest is set */
+static void
+get_frame_region (gsize                  width,
+                  gsize                  height,
+                  const GFreenectRegion *roi,
+                  GFreenectRegion       *region)
 {
-  GFreenectDevice *self = GFREENECT_DEVICE (user_data);
-  gboolean got_frame = FALSE;
+  region->x = 0;
+  region->y = 0;
+  region->width = width;
+  region->height = height;
 
-  g_mutex_lock (&self->priv->stream_mutex);
-
-  self->priv->depth_frame_src_id = 0;
+  if (roi != NULL)
+    gfreenect_region_intersect (region, roi, region);
+}
 
-  if (self->priv->got_depth_frame)
-    {
-      got_frame = TRUE;
-      self->priv->got_depth_frame = FALSE;
-    }
+static gboolean
+region_is_full_frame (const GFreenectRegion *region, gsize width, gsize height)
+{
+  return region->x == 0 && region->y == 0 &&
+    region->width == width && region->height == height;
+}
 
-  g_mutex_unlock (&self->priv->stream_mutex);
+/* returns 0 for packed formats, whose pixels are not byte aligned */
+static guint
+get_bytes_per_pixel (const freenect_frame_mode *mode)
+{
+  guint bits;
 
-  if (got_frame)
-    g_signal_emit (self, gfreenect_device_signals[SIGNAL_DEPTH_FRAME], 0, NULL);
+  bits = mode->data_bits_per_pixel + mode->padding_bits_per_pixel;
 
-  return FALSE;
+  return bits % 8 == 0 ? bits / 8 : 0;
 }
 
-
 static void
-on_depth_frame (freenect_device *dev, void *depth, uint32_t timestamp)
+set_frame_mode_region (GFreenectFrameMode    *frame_mode,
+                       const GFreenectRegion *region)
 {
-  GFreenectDevice *self;
+  frame_mode->width = region->width;
+  frame_mode->height = region->height;
+  frame_mode->length = region->width * region->height *
+    ((frame_mode->bits_per_pixel + frame_mode->padding_bits_per_pixel) / 8);
+}
 
-  self = freenect_get_user (dev);
+/* called by the stream thread, with the stream mutex held, for every frame
+   received */
+static void
+count_frame (StreamCounters *counters,
+             gint64          frame_time,
+             gsize           frame_size,
+             gboolean        coalesced,
+             gboolean        skipped)
+{
+  gint64 last_frame_time;
 
-  g_mutex_lock (&self->priv->stream_mutex);
+  g_atomic_pointer_add (&counters->frames_received, 1);
 
-  self->priv->got_depth_frame = TRUE;
+  if (coalesced)
+    g_atomic_pointer_add (&counters->frames_coalesced, 1);
 
-  if (freenect_set_depth_buffer (self->priv->dev, self->priv->depth_buf) != 0)
-    g_warning ("Failed to set depth buffer");
+  if (skipped)
+    g_atomic_pointer_add (&counters->frames_skipped, 1);
 
-  if (self->priv->depth_frame_src_id == 0)
+  last_frame_time = counter64_get (&counters->last_frame_time);
+  if (last_frame_time != 0)
     {
-      self->priv->depth_frame_src_id = timeout_add (self->priv->glib_context,
-                                                    0,
-                                                    G_PRIORITY_DEFAULT,
-                                                    on_depth_frame_main_loop,
-                                                    self);
+      gint interval;
+      gint average;
+
+      interval = CLAMP (frame_time - last_frame_time, 0, G_MAXINT);
+
+      average = g_atomic_int_get (&counters->frame_interval);
+      if (average == 0)
+        average = interval;
+      else
+        average += (interval - average) >> FRAME_INTERVAL_SHIFT;
+
+      g_atomic_int_set (&counters->frame_interval, average);
     }
 
-  g_mutex_unlock (&self->priv->stream_mutex);
+  counter64_set (&counters->last_frame_time, frame_time);
+  g_atomic_int_set (&counters->frame_size, frame_size);
 }
 
-static gboolean
-on_video_frame_main_loop (gpointer user_data)
+/* called from the main loop for every frame signalled */
+static void
+count_delivery (StreamCounters *counters, gint64 latency)
 {
-  GFreenectDevice *self = GFREENECT_DEVICE (user_data);
-  gboolean got_frame = FALSE;
+  guint bucket = 0;
 
-  g_mutex_lock (&self->priv->stream_mutex);
+  g_atomic_pointer_add (&counters->frames_delivered, 1);
 
-  self->priv->video_frame_src_id = 0;
+  while (bucket < GFREENECT_LATENCY_BUCKETS - 1 &&
+         latency > gfreenect_latency_histogram_get_bound (bucket))
+    bucket++;
 
-  if (self->priv->got_video_frame)
+  g_atomic_pointer_add (&counters->latency_counts[bucket], 1);
+  counter64_add (&counters->latency_sum, latency);
+}
+
+static void
+get_stream_stats (StreamCounters       *counters,
+                  gint64                now,
+                  GFreenectStreamStats *stats)
+{
+  gint64 last_frame_time;
+  gint interval;
+  guint i;
+
+  stats->frames_received =
+    (gsize) g_atomic_pointer_get (&counters->frames_received);
+  stats->frames_delivered =
+    (gsize) g_atomic_pointer_get (&counters->frames_delivered);
+  stats->frames_coalesced =
+    (gsize) g_atomic_pointer_get (&counters->frames_coalesced);
+  stats->frames_skipped =
+    (gsize) g_atomic_pointer_get (&counters->frames_skipped);
+
+  for (i = 0; i < GFREENECT_LATENCY_BUCKETS; i++)
+    stats->latency.counts[i] =
+      (gsize) g_atomic_pointer_get (&counters->latency_counts[i]);
+  stats->latency.sum = counter64_get (&counters->latency_sum);
+
+  stats->fps = 0.0;
+  stats->bytes_per_second = 0.0;
+
+  last_frame_time = counter64_get (&counters->last_frame_time);
+  interval = g_atomic_int_get (&counters->frame_interval);
+  if (last_frame_time == 0 || interval == 0)
+    return;
+
+  /* the rate decays once frames stop arriving */
+  stats->fps = G_USEC_PER_SEC / MAX ((gdouble) interval,
+                                     (gdouble) (now - last_frame_time));
+  stats->bytes_per_second =
+    stats->fps * g_atomic_int_get (&counters->frame_size);
+}
+
+static void
+count_conversion (ConversionCounters *counters, gint64 start_time)
+{
+  g_atomic_pointer_add (&counters->calls, 1);
+  counter64_add (&counters->total_time, g_get_monotonic_time () - start_time);
+}
+
+static void
+get_conversion_stats (ConversionCounters       *counters,
+                      GFreenectConversionStats *stats)
+{
+  stats->calls = (gsize) g_atomic_pointer_get (&counters->calls);
+  stats->total_time = counter64_get (&counters->total_time);
+}
+
+static gboolean
+get_depth_invalid_value (GFreenectDepthFormat format, guint16 *invalid)
+{
+  switch (format)
     {
-      got_frame = TRUE;
-      self->priv->got_video_frame = FALSE;
-    }
+    case GFREENECT_DEPTH_FORMAT_11BIT:
+      *invalid = 2047;
+      return TRUE;
 
-  g_mutex_unlock (&self->priv->stream_mutex);
+    case GFREENECT_DEPTH_FORMAT_10BIT:
+      *invalid = 1023;
+      return TRUE;
 
-  if (got_frame)
-    g_signal_emit (self, gfreenect_device_signals[SIGNAL_VIDEO_FRAME], 0, NULL);
+    case GFREENECT_DEPTH_FORMAT_REGISTERED:
+    case GFREENECT_DEPTH_FORMAT_MM:
+      *invalid = 0;
+      return TRUE;
 
-  return FALSE;
+    default:
+      /* packed formats are not one guint16 per pixel */
+      return FALSE;
+    }
 }
 
 static void
-on_video_frame (freenect_device *dev, void *buf, uint32_t timestamp)
+build_depth_pyramid (GFreenectDevice *self, guint16 invalid)
 {
-  GFreenectDevice *self;
+  const guint16 *src;
+  gsize width;
+  gsize height;
+  gint i;
 
-  self = freenect_get_user (dev);
+  width = self->priv->depth_mode.width;
+  height = self->priv->depth_mode.height;
 
-  g_mutex_lock (&self->priv->stream_mutex);
+  if (self->priv->depth_pyramid_buf == NULL)
+    {
+      gsize size = 0;
 
-  self->priv->got_video_frame = TRUE;
+      for (i = 0; i < GFREENECT_DEPTH_PYRAMID_LEVELS; i++)
+        size += (width >> (i + 1)) * (height >> (i + 1));
 
-  if (freenect_set_video_buffer (self->priv->dev, self->priv->video_buf) != 0)
-    g_warning ("Failed to set video buffer");
+      self->priv->depth_pyramid_buf = g_new (guint16, size);
+
+      size = 0;
+      for (i = 0; i < GFREENECT_DEPTH_PYRAMID_LEVELS; i++)
+        {
+          self->priv->depth_pyramid_levels[i] =
+            self->priv->depth_pyramid_buf + size;
+          size += (width >> (i + 1)) * (height >> (i + 1));
+        }
+    }
 
-  if (self->priv->video_frame_src_id == 0)
+  src = self->priv->depth_buf;
+  for (i = 0; i < GFREENECT_DEPTH_PYRAMID_LEVELS; i++)
     {
-      self->priv->video_frame_src_id = timeout_add (self->priv->glib_context,
-                                                    0,
-                                                    G_PRIORITY_DEFAULT,
-                                                    on_video_frame_main_loop,
-                                                    self);
+      gfreenect_depth_pyramid_reduce (self->priv->depth_pyramid,
+                                      src,
+                                      width >> i,
+                                      height >> i,
+                                      invalid,
+                                      self->priv->depth_pyramid_levels[i]);
+      src = self->priv->depth_pyramid_levels[i];
     }
 
-  g_mutex_unlock (&self->priv->stream_mutex);
+  self->priv->has_depth_pyramid = TRUE;
 }
 
-static gboolean
-check_cancelled (GCancellable *cancellable, GError **error, const gchar *op_desc)
+static void
+compute_depth_stats (GFreenectDevice *self, guint16 invalid)
 {
-  if (cancellable && g_cancellable_is_cancelled (cancellable))
+  if (self->priv->depth_histogram_enabled &&
+      self->priv->depth_histogram == NULL)
     {
-      g_set_error (error,
-                   G_IO_ERROR,
-                   G_IO_ERROR_CANCELLED,
-                   "%s operation cancelled",
-                   op_desc);
-
-      return FALSE;
+      self->priv->depth_histogram =
+        g_new (guint32, GFREENECT_DEPTH_STATS_HISTOGRAM_BINS);
     }
 
-  return TRUE;
+  /* millimeters go up to 10000, 8mm per bin covers them */
+  if (self->priv->depth_format == GFREENECT_DEPTH_FORMAT_REGISTERED ||
+      self->priv->depth_format == GFREENECT_DEPTH_FORMAT_MM)
+    self->priv->depth_histogram_shift = 3;
+  else
+    self->priv->depth_histogram_shift = 0;
+
+  gfreenect_depth_stats_compute (&self->priv->depth_stats,
+                                 self->priv->depth_buf,
+                                 self->priv->depth_mode.width *
+                                 self->priv->depth_mode.height,
+                                 invalid,
+                                 self->priv->depth_histogram_shift,
+                                 self->priv->depth_histogram);
+
+  self->priv->has_depth_stats = TRUE;
 }
 
-static gboolean
-init_sync (GInitable     *initable,
-           GCancellable  *cancellable,
-           GError       **error)
+/* the output of the last filter in the chain, or NULL */
+static guint16 *
+get_filtered_depth (GFreenectDevice *self)
 {
-  GFreenectDevice *self = GFREENECT_DEVICE (initable);
-
-  if (freenect_init (&self->priv->ctx, NULL) != 0)
+  if (self->priv->spatial_filter.mode != GFREENECT_SPATIAL_FILTER_NONE)
     {
-      g_set_error (error,
-                   G_IO_ERROR,
-                   G_IO_ERROR_NOT_INITIALIZED,
-                   "Failed to initialize Kinect sensor context");
-      return FALSE;
+      if (self->priv->spatial_filter.has_output)
+        return self->priv->spatial_filter.output;
     }
-
-  if (! check_cancelled (cancellable, error, "Init kinect"))
-    return FALSE;
-
-  freenect_select_subdevices (self->priv->ctx, self->priv->subdevices);
-
-  if (freenect_open_device (self->priv->ctx,
-                            &self->priv->dev,
-                            self->priv->index) != 0)
+  else if (self->priv->temporal_filter.mode != GFREENECT_TEMPORAL_FILTER_NONE)
+    {
+      if (self->priv->temporal_filter.has_output)
+        return self->priv->temporal_filter.output;
+    }
+
+  return NULL;
+}
+
+static void
+detect_motion (GFreenectDevice *self, guint16 invalid)
+{
+  const guint16 *depth;
+  GPtrArray *regions;
+
+  /* filtered frames have less noise to be mistaken for motion */
+  depth = get_filtered_depth (self);
+  if (depth == NULL)
+    depth = self->priv->depth_buf;
+
+  regions = gfreenect_motion_detector_process (&self->priv->motion_detector,
+                                               depth,
+                                               self->priv->depth_mode.width,
+                                               self->priv->depth_mode.height,
+                                               invalid);
+  if (regions == NULL)
+    {
+      if (self->priv->static_frames < G_MAXUINT)
+        self->priv->static_frames++;
+      return;
+    }
+
+  self->priv->static_frames = 0;
+
+  /* only the latest regions are reported if the main loop falls behind */
+  if (self->priv->motion_regions != NULL)
+    g_ptr_array_unref (self->priv->motion_regions);
+  self->priv->motion_regions = regions;
+}
+
+/* whether frame signals are to be skipped, called with the stream mutex
+   held */
+static gboolean
+is_scene_static (GFreenectDevice *self)
+{
+  return self->priv->motion_detection &&
+    self->priv->skip_static_frames &&
+    self->priv->depth_stream_started &&
+    self->priv->static_frames > MOTION_HOLD_FRAMES;
+}
+
+/* runs in the stream thread, with the stream mutex held, for every new
+   depth frame */
+static void
+process_depth_frame (GFreenectDevice *self)
+{
+  guint16 invalid;
+
+  if (! get_depth_invalid_value (self->priv->depth_format, &invalid))
+    return;
+
+  compute_depth_stats (self, invalid);
+
+  if (self->priv->depth_bands.n_bands > 0)
+    gfreenect_depth_bands_process (&self->priv->depth_bands,
+                                   self->priv->depth_buf,
+                                   self->priv->depth_mode.width,
+                                   self->priv->depth_mode.height,
+                                   invalid);
+
+  if (self->priv->depth_pyramid != GFREENECT_DEPTH_PYRAMID_NONE)
+    build_depth_pyramid (self, invalid);
+
+  if (self->priv->temporal_filter.mode != GFREENECT_TEMPORAL_FILTER_NONE)
+    gfreenect_temporal_filter_process (&self->priv->temporal_filter,
+                                       self->priv->depth_buf,
+                                       self->priv->depth_mode.width *
+                                       self->priv->depth_mode.height,
+                                       invalid);
+
+  if (self->priv->spatial_filter.mode != GFREENECT_SPATIAL_FILTER_NONE)
+    {
+      const guint16 *depth = self->priv->depth_buf;
+      const guint8 *guide = NULL;
+
+      if (self->priv->temporal_filter.mode != GFREENECT_TEMPORAL_FILTER_NONE)
+        depth = self->priv->temporal_filter.output;
+
+      /* both frames come from the same event loop, so the video buffer is
+         not being written to while the depth frame is processed */
+      if (self->priv->video_stream_started &&
+          self->priv->video_mode.video_format == FREENECT_VIDEO_RGB &&
+          self->priv->video_mode.width == self->priv->depth_mode.width &&
+          self->priv->video_mode.height == self->priv->depth_mode.height)
+        {
+          guide = self->priv->video_buf;
+        }
+
+      gfreenect_spatial_filter_process (&self->priv->spatial_filter,
+                                        depth,
+                                        self->priv->depth_mode.width,
+                                        self->priv->depth_mode.height,
+                                        invalid,
+                                        guide);
+    }
+
+  if (self->priv->motion_detection)
+    detect_motion (self, invalid);
+}
+
+
+static gboolean
+on_depth_frame_main_loop (gpointer user_data)
+{
+  GFreenectDevice *self = GFREENECT_DEVICE (user_data);
+  gboolean got_frame = FALSE;
+  GPtrArray *motion_regions;
+  GFreenectTraceSpan span;
+
+  GFREENECT_TRACE (depth_dispatch);
+
+  g_mutex_lock (&self->priv->stream_mutex);
+
+  self->priv->depth_frame_src_id = 0;
+
+  if (self->priv->got_depth_frame)
+    {
+      got_frame = TRUE;
+      self->priv->got_depth_frame = FALSE;
+      self->priv->depth_signal_time = self->priv->depth_frame_time;
+    }
+
+  motion_regions = self->priv->motion_regions;
+  self->priv->motion_regions = NULL;
+
+  g_mutex_unlock (&self->priv->stream_mutex);
+
+  if (motion_regions != NULL)
+    {
+      GFREENECT_TRACE_BEGIN (span, motion_signal);
+      g_signal_emit (self,
+                     gfreenect_device_signals[SIGNAL_MOTION],
+                     0,
+                     motion_regions);
+      GFREENECT_TRACE_END (span, motion_signal, "motion-signal");
+
+      g_ptr_array_unref (motion_regions);
+    }
+
+  if (got_frame)
+    {
+      count_delivery (&self->priv->depth_counters,
+                      g_get_monotonic_time () - self->priv->depth_signal_time);
+
+      GFREENECT_TRACE_BEGIN (span, depth_signal);
+      g_signal_emit (self, gfreenect_device_signals[SIGNAL_DEPTH_FRAME], 0, NULL);
+      GFREENECT_TRACE_END (span, depth_signal, "depth-frame-signal");
+    }
+
+  return FALSE;
+}
+
+
+static void
+on_depth_frame (freenect_device *dev, void *depth, uint32_t timestamp)
+{
+  GFreenectDevice *self;
+  gboolean coalesced;
+  gint64 start_time;
+  GFreenectTraceSpan frame_span;
+  GFreenectTraceSpan span;
+
+  GFREENECT_TRACE_BEGIN (frame_span, depth_frame);
+  GFREENECT_TRACE1 (depth_frame__timestamp, timestamp);
+
+  self = freenect_get_user (dev);
+
+  g_mutex_lock (&self->priv->stream_mutex);
+
+  GFREENECT_TRACE (depth_frame__locked);
+
+  self->priv->depth_frame_time = g_get_monotonic_time ();
+
+  GFREENECT_TRACE_BEGIN (span, depth_processing);
+  start_time = g_get_monotonic_time ();
+  process_depth_frame (self);
+  count_conversion (&self->priv->depth_processing_counters, start_time);
+  GFREENECT_TRACE_END (span, depth_processing, "depth-processing");
+
+  coalesced = self->priv->got_depth_frame;
+  self->priv->got_depth_frame = ! is_scene_static (self);
+
+  count_frame (&self->priv->depth_counters,
+               self->priv->depth_frame_time,
+               self->priv->depth_mode.bytes,
+               coalesced,
+               ! self->priv->got_depth_frame);
+
+  if (freenect_set_depth_buffer (self->priv->dev, self->priv->depth_buf) != 0)
+    g_warning ("Failed to set depth buffer");
+
+  if (self->priv->depth_frame_src_id == 0 &&
+      (self->priv->got_depth_frame || self->priv->motion_regions != NULL))
+    {
+      self->priv->depth_frame_src_id = timeout_add (self->priv->glib_context,
+                                                    0,
+                                                    G_PRIORITY_DEFAULT,
+                                                    on_depth_frame_main_loop,
+                                                    self);
+      GFREENECT_TRACE (depth_frame__queued);
+    }
+
+  g_mutex_unlock (&self->priv->stream_mutex);
+
+  GFREENECT_TRACE_END (frame_span, depth_frame, "depth-frame");
+}
+
+#ifdef HAVE_FREENECT_START_AUDIO
+static gboolean
+on_audio_main_loop (gpointer user_data)
+{
+  GFreenectDevice *self = GFREENECT_DEVICE (user_data);
+  gint64 timestamp;
+  guint n_frames;
+
+  g_mutex_lock (&self->priv->stream_mutex);
+  self->priv->audio_src_id = 0;
+  g_mutex_unlock (&self->priv->stream_mutex);
+
+  n_frames = gfreenect_audio_ring_read (&self->priv->audio_ring,
+                                        &self->priv->audio_signal_cursor,
+                                        self->priv->audio_signal_buf,
+                                        GFREENECT_AUDIO_HISTORY,
+                                        &timestamp);
+  if (n_frames > 0)
+    g_signal_emit (self,
+                   gfreenect_device_signals[SIGNAL_AUDIO_SAMPLES],
+                   0,
+                   self->priv->audio_signal_buf,
+                   n_frames,
+                   timestamp);
+
+  return FALSE;
+}
+
+static void
+on_audio_in (freenect_device *dev,
+             int              num_samples,
+             int32_t         *mic1,
+             int32_t         *mic2,
+             int32_t         *mic3,
+             int32_t         *mic4,
+             int16_t         *cancelled,
+             void            *unknown)
+{
+  GFreenectDevice *self;
+
+  self = freenect_get_user (dev);
+
+  /* the ring is written under stream_mutex so that restarting the stream
+     can reset it without racing with a late callback */
+  g_mutex_lock (&self->priv->stream_mutex);
+
+  gfreenect_audio_ring_write (&self->priv->audio_ring,
+                              num_samples,
+                              mic1, mic2, mic3, mic4,
+                              cancelled,
+                              g_get_monotonic_time ());
+
+  counter64_add (&self->priv->audio_frames_received, num_samples);
+
+  if (self->priv->audio_src_id == 0)
+    self->priv->audio_src_id = timeout_add (self->priv->glib_context,
+                                            0,
+                                            G_PRIORITY_DEFAULT,
+                                            on_audio_main_loop,
+                                            self);
+
+  g_mutex_unlock (&self->priv->stream_mutex);
+}
+#endif
+
+static gboolean
+on_video_frame_main_loop (gpointer user_data)
+{
+  GFreenectDevice *self = GFREENECT_DEVICE (user_data);
+  gboolean got_frame = FALSE;
+  GFreenectTraceSpan span;
+
+  GFREENECT_TRACE (video_dispatch);
+
+  g_mutex_lock (&self->priv->stream_mutex);
+
+  self->priv->video_frame_src_id = 0;
+
+  if (self->priv->got_video_frame)
+    {
+      got_frame = TRUE;
+      self->priv->got_video_frame = FALSE;
+      self->priv->video_signal_time = self->priv->video_frame_time;
+    }
+
+  g_mutex_unlock (&self->priv->stream_mutex);
+
+  if (got_frame)
+    {
+      count_delivery (&self->priv->video_counters,
+                      g_get_monotonic_time () - self->priv->video_signal_time);
+
+      GFREENECT_TRACE_BEGIN (span, video_signal);
+      g_signal_emit (self, gfreenect_device_signals[SIGNAL_VIDEO_FRAME], 0, NULL);
+      GFREENECT_TRACE_END (span, video_signal, "video-frame-signal");
+    }
+
+  return FALSE;
+}
+
+static void
+on_video_frame (freenect_device *dev, void *buf, uint32_t timestamp)
+{
+  GFreenectDevice *self;
+  gboolean coalesced;
+  GFreenectTraceSpan frame_span;
+
+  GFREENECT_TRACE_BEGIN (frame_span, video_frame);
+  GFREENECT_TRACE1 (video_frame__timestamp, timestamp);
+
+  self = freenect_get_user (dev);
+
+  g_mutex_lock (&self->priv->stream_mutex);
+
+  GFREENECT_TRACE (video_frame__locked);
+
+  self->priv->video_frame_time = g_get_monotonic_time ();
+
+  coalesced = self->priv->got_video_frame;
+  self->priv->got_video_frame = ! is_scene_static (self);
+
+  count_frame (&self->priv->video_counters,
+               self->priv->video_frame_time,
+               self->priv->video_mode.bytes,
+               coalesced,
+               ! self->priv->got_video_frame);
+
+  if (freenect_set_video_buffer (self->priv->dev, self->priv->video_buf) != 0)
+    g_warning ("Failed to set video buffer");
+
+  if (self->priv->video_frame_src_id == 0 && self->priv->got_video_frame)
+    {
+      self->priv->video_frame_src_id = timeout_add (self->priv->glib_context,
+                                                    0,
+                                                    G_PRIORITY_DEFAULT,
+                                                    on_video_frame_main_loop,
+                                                    self);
+      GFREENECT_TRACE (video_frame__queued);
+    }
+
+  g_mutex_unlock (&self->priv->stream_mutex);
+
+  GFREENECT_TRACE_END (frame_span, video_frame, "video-frame");
+}
+
+static gboolean
+check_cancelled (GCancellable *cancellable, GError **error, const gchar *op_desc)
+{
+  if (cancellable && g_cancellable_is_cancelled (cancellable))
     {
       g_set_error (error,
                    G_IO_ERROR,
-                   G_IO_ERROR_INVALID_ARGUMENT,
-                   "Failed to open Kinect device");
+                   G_IO_ERROR_CANCELLED,
+                   "%s operation cancelled",
+                   op_desc);
+
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+init_sync (GInitable     *initable,
+           GCancellable  *cancellable,
+           GError       **error)
+{
+  GFreenectDevice *self = GFREENECT_DEVICE (initable);
+
+  if (self->priv->context == NULL)
+    {
+      self->priv->context = gfreenect_context_new (error);
+      if (self->priv->context == NULL)
+        return FALSE;
+    }
+
+  if (! check_cancelled (cancellable, error, "Init kinect"))
+    return FALSE;
+
+  if (! gfreenect_context_open_device (self->priv->context,
+                                      self->priv->index,
+                                      self->priv->subdevices,
+                                      &self->priv->dev,
+                                      error))
+    {
       return FALSE;
     }
 
@@ -832,84 +2398,226 @@ init_finish (GAsyncInitable  *initable,
                                                   error);
 }
 
+static gboolean
+on_motion_state_main_loop (gpointer user_data)
+{
+  GFreenectDevice *self = GFREENECT_DEVICE (user_data);
+  GFreenectMotionState state;
+
+  g_mutex_lock (&self->priv->dispatch_mutex);
+  self->priv->motion_state_src_id = 0;
+  g_mutex_unlock (&self->priv->dispatch_mutex);
+
+  if (gfreenect_motion_ring_latest (&self->priv->motion_ring, &state))
+    g_signal_emit (self,
+                   gfreenect_device_signals[SIGNAL_MOTION_STATE],
+                   0,
+                   &state);
+
+  return FALSE;
+}
+
+/* the time the dispatch thread has to wake up at to poll the device when
+   no commands arrive, or -1 to sleep until they do; with the dispatch mutex
+   held */
+static gint64
+get_dispatch_wake_time (GFreenectDevice *self,
+                        gint64           poll_time,
+                        gint64           sample_time)
+{
+  gint64 wake_time = -1;
+
+  if (self->priv->set_tilt_result != NULL)
+    wake_time = poll_time;
+
+  if (self->priv->motion_stream_started &&
+      (wake_time == -1 || sample_time < wake_time))
+    wake_time = sample_time;
+
+  return wake_time;
+}
+
+/* whether the dispatch thread has commands to send or requests to answer,
+   with the dispatch mutex held */
+static gboolean
+has_pending_commands (GFreenectDevice *self)
+{
+  return self->priv->update_tilt_angle ||
+    self->priv->update_led ||
+    self->priv->motion_cache.requested ||
+    ! g_queue_is_empty (&self->priv->state_dependent_results);
+}
+
+static void
+motion_state_from_raw (const freenect_raw_tilt_state *raw,
+                       gint64                         timestamp,
+                       GFreenectMotionState          *state)
+{
+  state->timestamp = timestamp;
+  state->accel_x = raw->accelerometer_x;
+  state->accel_y = raw->accelerometer_y;
+  state->accel_z = raw->accelerometer_z;
+  state->tilt_angle = freenect_get_tilt_degs ((freenect_raw_tilt_state *) raw);
+  state->tilt_status = raw->tilt_status;
+}
+
+/* The dispatch thread sleeps until commands are queued by the setters, and
+   only wakes up periodically to poll the tilt motor while a
+   gfreenect_device_set_tilt_angle() operation waits for it to stop, or to
+   sample the motor subdevice while the motion stream is started. Commands
+   queued while the thread is busy supersede older ones of the same kind, so
+   only the last tilt angle and led status are sent. */
 static gpointer
 dispatch_thread_func (gpointer _data)
 {
   GFreenectDevice *self = GFREENECT_DEVICE (_data);
-  gboolean abort = FALSE;
+  gint64 poll_time = 0;
+  gint64 sample_time = 0;
 
-  while (! abort)
-    {
-      freenect_raw_tilt_state *state = NULL;
-      gboolean update_tilt_failed;
+  g_mutex_lock (&self->priv->dispatch_mutex);
 
-      /* update tilt angle */
-      if (self->priv->update_tilt_angle)
+  while (TRUE)
+    {
+      freenect_raw_tilt_state state;
+      GFreenectMotionState motion_state;
+      GSimpleAsyncResult *res;
+      gboolean update_tilt_angle;
+      gboolean update_led;
+      gdouble tilt_angle;
+      GFreenectLed led;
+      gboolean set_led_failed = FALSE;
+      gboolean update_tilt_failed = FALSE;
+      gint64 now;
+      GFreenectTraceSpan span;
+
+      while (! self->priv->abort_dispatch_thread &&
+             ! has_pending_commands (self))
         {
-          g_mutex_lock (&self->priv->dispatch_mutex);
+          gint64 wake_time;
+
+          wake_time = get_dispatch_wake_time (self, poll_time, sample_time);
+
+          if (wake_time == -1)
+            g_cond_wait (&self->priv->dispatch_cond,
+                         &self->priv->dispatch_mutex);
+          else if (! g_cond_wait_until (&self->priv->dispatch_cond,
+                                        &self->priv->dispatch_mutex,
+                                        wake_time))
+            break;
+        }
 
-          self->priv->update_tilt_angle = FALSE;
+      if (self->priv->abort_dispatch_thread)
+        break;
+
+      g_atomic_pointer_add (&self->priv->dispatch_wakeups, 1);
+      GFREENECT_TRACE (dispatch_wakeup);
+
+      update_tilt_angle = self->priv->update_tilt_angle;
+      update_led = self->priv->update_led;
+      tilt_angle = self->priv->tilt_angle;
+      led = self->priv->led;
+
+      self->priv->update_tilt_angle = FALSE;
+      self->priv->update_led = FALSE;
+
+      /* queries arriving from now on join this refresh */
+      gfreenect_motion_cache_begin_refresh (&self->priv->motion_cache);
+
+      if (update_tilt_angle)
+        self->priv->tilt_motor_moving = FALSE;
+
+      /* talk to the device without holding the mutex, so that setters
+         don't block on USB transfers */
+      g_mutex_unlock (&self->priv->dispatch_mutex);
 
-          if (freenect_set_tilt_degs (self->priv->dev, self->priv->tilt_angle) != 0)
+      if (update_tilt_angle)
+        {
+          GFREENECT_TRACE_BEGIN (span, set_tilt);
+
+          if (freenect_set_tilt_degs (self->priv->dev, tilt_angle) != 0)
             {
               /* @TODO: this error must be reported! */
               g_warning ("Failed to set tilt");
             }
 
-          g_mutex_unlock (&self->priv->dispatch_mutex);
+          GFREENECT_TRACE_END (span, set_tilt, "set-tilt");
         }
 
-      /* update led */
-      if (self->priv->update_led)
+      if (update_led)
         {
-          g_mutex_lock (&self->priv->dispatch_mutex);
+          GFREENECT_TRACE_BEGIN (span, set_led);
 
-          self->priv->update_led = FALSE;
-
-          if (freenect_set_led (self->priv->dev, self->priv->led) != 0)
+          if (freenect_set_led (self->priv->dev, led) != 0)
             {
               g_warning ("Failed to set led");
-
-              if (self->priv->set_led_result != NULL)
-               {
-                 g_simple_async_result_set_error (self->priv->set_led_result,
-                                                  G_IO_ERROR,
-                                                  G_IO_ERROR_FAILED,
-                                                  "Failed to set led");
-               }
+              set_led_failed = TRUE;
             }
 
-          if (self->priv->set_led_result != NULL)
-            {
-              g_simple_async_result_complete_in_idle (self->priv->set_led_result);
-              g_object_unref (self->priv->set_led_result);
-              self->priv->set_led_result = NULL;
-            }
-
-          g_mutex_unlock (&self->priv->dispatch_mutex);
+          GFREENECT_TRACE_END (span, set_led, "set-led");
         }
 
-      /* whether to update tilt state */
-      if (self->priv->set_tilt_result != NULL ||
-          self->priv->set_led_result != NULL ||
-          self->priv->state_dependent_results != NULL)
-        {
-          update_tilt_failed = FALSE;
+      GFREENECT_TRACE_BEGIN (span, read_state);
 
-          if (freenect_update_tilt_state (self->priv->dev) == -1)
-            update_tilt_failed = TRUE;
-          else
-            state = freenect_get_tilt_state (self->priv->dev);
+      if (freenect_update_tilt_state (self->priv->dev) == -1)
+        update_tilt_failed = TRUE;
+      else
+        memcpy (&state,
+                freenect_get_tilt_state (self->priv->dev),
+                sizeof (freenect_raw_tilt_state));
+
+      GFREENECT_TRACE_END (span, read_state, "read-motor-state");
+
+      now = g_get_monotonic_time ();
+
+      g_mutex_lock (&self->priv->dispatch_mutex);
+
+      poll_time = now + (gint64) self->priv->tilt_poll_interval * 1000;
+      sample_time = now + G_USEC_PER_SEC / self->priv->motion_sample_rate;
+
+      if (! update_tilt_failed)
+        motion_state_from_raw (&state, now, &motion_state);
+
+      gfreenect_motion_cache_end_refresh (&self->priv->motion_cache,
+                                          update_tilt_failed ?
+                                          NULL : &motion_state);
+
+      if (self->priv->motion_stream_started && ! update_tilt_failed)
+        {
+          gfreenect_motion_ring_push (&self->priv->motion_ring, &motion_state);
+
+          if (self->priv->motion_state_src_id == 0)
+            self->priv->motion_state_src_id =
+              timeout_add (self->priv->motion_context,
+                           0,
+                           G_PRIORITY_DEFAULT,
+                           on_motion_state_main_loop,
+                           self);
+        }
+
+      /* complete the 'set-led' operation, unless a newer command
+         superseded the one just sent */
+      if (update_led &&
+          ! self->priv->update_led &&
+          self->priv->set_led_result != NULL)
+        {
+          if (set_led_failed)
+            g_simple_async_result_set_error (self->priv->set_led_result,
+                                             G_IO_ERROR,
+                                             G_IO_ERROR_FAILED,
+                                             "Failed to set led");
+
+          g_simple_async_result_complete_in_idle (self->priv->set_led_result);
+          g_object_unref (self->priv->set_led_result);
+          self->priv->set_led_result = NULL;
         }
 
       /* check tilt motor status */
-      if (self->priv->set_tilt_result != NULL)
+      if (self->priv->set_tilt_result != NULL &&
+          ! self->priv->update_tilt_angle)
         {
           if (update_tilt_failed)
             {
               /* complete the 'set-tilt' operation with error */
-              g_mutex_lock (&self->priv->dispatch_mutex);
-
               g_simple_async_result_set_error (self->priv->set_tilt_result,
                                                G_IO_ERROR,
                                                G_IO_ERROR_FAILED,
@@ -918,138 +2626,234 @@ dispatch_thread_func (gpointer _data)
                                         self->priv->set_tilt_result);
               g_object_unref (self->priv->set_tilt_result);
               self->priv->set_tilt_result = NULL;
-
-              g_mutex_unlock (&self->priv->dispatch_mutex);
             }
-          else
+          else if (state.tilt_status != TILT_STATUS_MOVING &&
+                   self->priv->tilt_motor_moving)
             {
-              if (state->tilt_status != TILT_STATUS_MOVING && self->priv->tilt_motor_moving)
-                {
-                  /* complete the 'set-tilt' operation */
-                  g_mutex_lock (&self->priv->dispatch_mutex);
-
-                  self->priv->tilt_motor_moving = FALSE;
+              /* complete the 'set-tilt' operation */
+              self->priv->tilt_motor_moving = FALSE;
 
-                  g_simple_async_result_complete_in_idle (
+              g_simple_async_result_complete_in_idle (
                                         self->priv->set_tilt_result);
-                  g_object_unref (self->priv->set_tilt_result);
-                  self->priv->set_tilt_result = NULL;
-
-                  g_mutex_unlock (&self->priv->dispatch_mutex);
-                }
-              else if (state->tilt_status == TILT_STATUS_MOVING)
-                {
-                  self->priv->tilt_motor_moving = TRUE;
-                }
+              g_object_unref (self->priv->set_tilt_result);
+              self->priv->set_tilt_result = NULL;
+            }
+          else if (state.tilt_status == TILT_STATUS_MOVING)
+            {
+              self->priv->tilt_motor_moving = TRUE;
             }
         }
 
       /* complete any async operations that need the device's state */
-      if (self->priv->state_dependent_results != NULL)
+      while ((res = g_queue_pop_head (&self->priv->state_dependent_results)) != NULL)
         {
-          GList *node;
+          if (update_tilt_failed)
+            g_simple_async_result_set_error (res,
+                                             G_IO_ERROR,
+                                             G_IO_ERROR_FAILED,
+                                             "Failed to get state");
+          else
+            g_simple_async_result_set_op_res_gpointer (res,
+                             gfreenect_motion_state_copy (&motion_state),
+                             (GDestroyNotify) gfreenect_motion_state_free);
+
+          g_simple_async_result_complete_in_idle (res);
+          g_object_unref (res);
+        }
+    }
 
-          g_mutex_lock (&self->priv->dispatch_mutex);
+  /* don't leave synchronous queries waiting */
+  gfreenect_motion_cache_abort (&self->priv->motion_cache);
 
-          node = self->priv->state_dependent_results;
-          while (node != NULL)
-            {
-              GSimpleAsyncResult *res;
-
-              res = G_SIMPLE_ASYNC_RESULT (node->data);
-
-              if (update_tilt_failed)
-                {
-                  g_simple_async_result_set_error (res,
-                                                   G_IO_ERROR,
-                                                   G_IO_ERROR_FAILED,
-                                                   "Failed to get state");
-                }
-              else
-                {
-                  freenect_raw_tilt_state *state_copy =
-                                           g_new (freenect_raw_tilt_state, 1);
-                  memcpy (state_copy, state, sizeof (freenect_raw_tilt_state));
-
-                  g_simple_async_result_set_op_res_gpointer (res, state_copy,
-                                                             g_free);
-                }
-
-              g_simple_async_result_complete_in_idle (res);
-              g_object_unref (res);
-
-              node = node->next;
-            }
+  g_mutex_unlock (&self->priv->dispatch_mutex);
 
-          g_list_free (self->priv->state_dependent_results);
-          self->priv->state_dependent_results = NULL;
+  return NULL;
+}
 
-          g_mutex_unlock (&self->priv->dispatch_mutex);
-        }
+/* starts the dispatch thread on first use, with the dispatch mutex held;
+   it then lives until the device is disposed */
+static gboolean
+launch_dispatch_thread (GFreenectDevice *self, GError **error)
+{
+  if (self->priv->dispatch_thread != NULL)
+    return TRUE;
 
-      if ((self->priv->set_tilt_result == NULL &&
-           self->priv->set_led_result == NULL) ||
-          (self->priv->abort_dispatch_thread))
-        {
-          abort = TRUE;
-        }
-      else
-        {
-          g_usleep (1);
-        }
-    }
+  self->priv->dispatch_thread = g_thread_try_new (NULL,
+                                                  dispatch_thread_func,
+                                                  self,
+                                                  error);
+  return self->priv->dispatch_thread != NULL;
+}
+
+static void
+on_get_tilt_cancelled (GCancellable *cancellable, gpointer user_data)
+{
+  GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
+  GFreenectDevice *self;
+  GList *link;
+
+  self =
+    GFREENECT_DEVICE (g_async_result_get_source_object (G_ASYNC_RESULT (res)));
+
+  g_signal_handlers_disconnect_by_func (cancellable,
+                                        on_get_tilt_cancelled,
+                                        user_data);
 
   g_mutex_lock (&self->priv->dispatch_mutex);
-  self->priv->dispatch_thread = NULL;
+
+  /* the dispatch thread may have completed it already */
+  link = g_queue_find (&self->priv->state_dependent_results, res);
+  if (link != NULL)
+    {
+      g_queue_delete_link (&self->priv->state_dependent_results, link);
+
+      g_simple_async_result_set_error (res,
+                                       G_IO_ERROR,
+                                       G_IO_ERROR_CANCELLED,
+                                       "Get tilt angle operation cancelled");
+      g_simple_async_result_complete_in_idle (res);
+      g_object_unref (res);
+    }
+
   g_mutex_unlock (&self->priv->dispatch_mutex);
 
-  return NULL;
+  g_object_unref (self);
 }
 
-static gpointer
-stream_thread_func (gpointer _data)
+/* Completes @res with the cached state if it is fresh enough, or queues it
+   to be completed by the next refresh of the dispatch thread, together with
+   all other queries. Takes ownership of @res. */
+static void
+request_state (GFreenectDevice    *self,
+               GSimpleAsyncResult *res,
+               gint64              max_age,
+               GCancellable       *cancellable)
 {
-  GFreenectDevice *self = GFREENECT_DEVICE (_data);
+  GFreenectMotionState state;
+
+  g_mutex_lock (&self->priv->dispatch_mutex);
 
-  while (! self->priv->abort_stream_thread)
+  if (gfreenect_motion_cache_lookup (&self->priv->motion_cache,
+                                     max_age,
+                                     &state))
     {
-      freenect_process_events (self->priv->ctx);
+      g_simple_async_result_set_op_res_gpointer (res,
+                       gfreenect_motion_state_copy (&state),
+                       (GDestroyNotify) gfreenect_motion_state_free);
+      g_simple_async_result_complete_in_idle (res);
+      g_object_unref (res);
     }
+  else
+    {
+      if (cancellable != NULL)
+        g_signal_connect_object (cancellable,
+                                 "cancelled",
+                                 G_CALLBACK (on_get_tilt_cancelled),
+                                 res,
+                                 0);
 
-  g_mutex_lock (&self->priv->stream_mutex);
-  self->priv->stream_thread = NULL;
-  g_mutex_unlock (&self->priv->stream_mutex);
+      launch_dispatch_thread (self, NULL);
 
-  return NULL;
+      g_queue_push_tail (&self->priv->state_dependent_results, res);
+      g_cond_signal (&self->priv->dispatch_cond);
+    }
+
+  g_mutex_unlock (&self->priv->dispatch_mutex);
 }
 
+/* Blocking version of request_state(). A query finding the cached state
+   too old while a refresh is in flight waits for that one to finish instead
+   of starting another. */
 static gboolean
-launch_dispatch_thread (GFreenectDevice *self, GError **error)
+request_state_sync (GFreenectDevice       *self,
+                    gint64                 max_age,
+                    GFreenectMotionState  *state,
+                    GError               **error)
 {
-  self->priv->abort_dispatch_thread = FALSE;
+  gboolean result = TRUE;
 
-  self->priv->update_tilt_angle = FALSE;
-  self->priv->update_led = FALSE;
+  g_mutex_lock (&self->priv->dispatch_mutex);
 
-  self->priv->dispatch_thread = g_thread_new (NULL,
-                                              dispatch_thread_func,
-                                              self);
-  return self->priv->dispatch_thread != NULL;
+  if (! gfreenect_motion_cache_lookup (&self->priv->motion_cache,
+                                       max_age,
+                                       state))
+    {
+      result = launch_dispatch_thread (self, error) &&
+        gfreenect_motion_cache_wait (&self->priv->motion_cache,
+                                     &self->priv->dispatch_mutex,
+                                     &self->priv->dispatch_cond,
+                                     &self->priv->abort_dispatch_thread,
+                                     state,
+                                     error);
+    }
+
+  g_mutex_unlock (&self->priv->dispatch_mutex);
+
+  return result;
 }
 
+/* the state of the motor subdevice at @time, from the motion stream if it
+   sampled around that time, or the last one read otherwise */
 static gboolean
-launch_stream_thread (GFreenectDevice *self, GError **error)
+get_motion_state_at (GFreenectDevice      *self,
+                     gint64                time,
+                     GFreenectMotionState *state)
 {
-  self->priv->depth_frame_src_id = 0;
-  self->priv->video_frame_src_id = 0;
+  gboolean result = FALSE;
+
+  if (time == 0)
+    return FALSE;
+
+  g_mutex_lock (&self->priv->dispatch_mutex);
+
+  if (self->priv->motion_stream_started)
+    {
+      g_mutex_unlock (&self->priv->dispatch_mutex);
+
+      return gfreenect_motion_ring_interpolate (&self->priv->motion_ring,
+                                                time,
+                                                state);
+    }
+
+  if (gfreenect_motion_cache_lookup (&self->priv->motion_cache,
+                                     G_MAXINT64,
+                                     state))
+    {
+      state->timestamp = time;
+      result = TRUE;
+    }
+
+  g_mutex_unlock (&self->priv->dispatch_mutex);
+
+  return result;
+}
 
-  self->priv->abort_stream_thread = FALSE;
+/* frames are delivered by the event thread of the context, which runs
+   while any of its devices has streams started */
+static gboolean
+hold_events (GFreenectDevice *self, GError **error)
+{
+  if (self->priv->holds_events)
+    return TRUE;
 
   self->priv->glib_context = g_main_context_get_thread_default ();
-  self->priv->stream_thread = g_thread_new (NULL,
-                                            stream_thread_func,
-                                            self);
-  return self->priv->stream_thread != NULL;
+
+  if (! gfreenect_context_hold_events (self->priv->context, error))
+    return FALSE;
+
+  self->priv->holds_events = TRUE;
+
+  return TRUE;
+}
+
+static void
+release_events (GFreenectDevice *self)
+{
+  if (! self->priv->holds_events)
+    return;
+
+  gfreenect_context_release_events (self->priv->context);
+  self->priv->holds_events = FALSE;
 }
 
 static void
@@ -1057,13 +2861,14 @@ on_set_tilt_cancelled (GCancellable *cancellable, gpointer user_data)
 {
   GFreenectDevice *self = GFREENECT_DEVICE (user_data);
 
+  g_signal_handlers_disconnect_by_func (cancellable,
+                                        on_set_tilt_cancelled,
+                                        user_data);
+
+  g_mutex_lock (&self->priv->dispatch_mutex);
+
   if (self->priv->set_tilt_result != NULL)
     {
-      g_signal_handlers_disconnect_by_func (cancellable,
-                                            on_set_tilt_cancelled,
-                                            user_data);
-
-      g_mutex_lock (&self->priv->dispatch_mutex);
       g_simple_async_result_set_error (self->priv->set_tilt_result,
                                        G_IO_ERROR,
                                        G_IO_ERROR_CANCELLED,
@@ -1072,9 +2877,9 @@ on_set_tilt_cancelled (GCancellable *cancellable, gpointer user_data)
                                         self->priv->set_tilt_result);
       g_object_unref (self->priv->set_tilt_result);
       self->priv->set_tilt_result = NULL;
-
-      g_mutex_unlock (&self->priv->dispatch_mutex);
     }
+
+  g_mutex_unlock (&self->priv->dispatch_mutex);
 }
 
 static void
@@ -1082,13 +2887,14 @@ on_set_led_cancelled (GCancellable *cancellable, gpointer user_data)
 {
   GFreenectDevice *self = GFREENECT_DEVICE (user_data);
 
+  g_signal_handlers_disconnect_by_func (cancellable,
+                                        on_set_led_cancelled,
+                                        user_data);
+
+  g_mutex_lock (&self->priv->dispatch_mutex);
+
   if (self->priv->set_led_result != NULL)
     {
-      g_signal_handlers_disconnect_by_func (cancellable,
-                                            on_set_led_cancelled,
-                                            user_data);
-
-      g_mutex_lock (&self->priv->dispatch_mutex);
       g_simple_async_result_set_error (self->priv->set_led_result,
                                        G_IO_ERROR,
                                        G_IO_ERROR_CANCELLED,
@@ -1097,36 +2903,7 @@ on_set_led_cancelled (GCancellable *cancellable, gpointer user_data)
                                         self->priv->set_led_result);
       g_object_unref (self->priv->set_led_result);
       self->priv->set_led_result = NULL;
-
-      g_mutex_unlock (&self->priv->dispatch_mutex);
     }
-}
-
-static void
-on_get_tilt_cancelled (GCancellable *cancellable, gpointer user_data)
-{
-  GSimpleAsyncResult *res = G_SIMPLE_ASYNC_RESULT (user_data);
-  GFreenectDevice *self;
-
-  self =
-    GFREENECT_DEVICE (g_async_result_get_source_object (G_ASYNC_RESULT (res)));
-
-  g_signal_handlers_disconnect_by_func (cancellable,
-                                        on_get_tilt_cancelled,
-                                        user_data);
-
-  g_mutex_lock (&self->priv->dispatch_mutex);
-
-  self->priv->state_dependent_results =
-                        g_list_remove (self->priv->state_dependent_results,
-                                       res);
-
-  g_simple_async_result_set_error (res,
-                                   G_IO_ERROR,
-                                   G_IO_ERROR_CANCELLED,
-                                   "Get tilt angle operation cancelled");
-  g_simple_async_result_complete_in_idle (res);
-  g_object_unref (res);
 
   g_mutex_unlock (&self->priv->dispatch_mutex);
 }
@@ -1160,6 +2937,42 @@ gfreenect_device_new (gint                 device_index,
                               NULL);
 }
 
+/**
+ * gfreenect_device_new_with_context:
+ * @context: The #GFreenectContext to open the device from
+ * @device_index: The device index to use, normally 0 for one kinect sensor attached
+ * @subdevices: Or'ed combination of subdevices to use from #GFreenectSubdevice set
+ * @cancellable: (allow-none): The cancellable object
+ * @callback: (scope async): The callback to be called when the new instance is ready
+ * @user_data: (allow-none): User data to pass in @callback
+ *
+ * Constructs a new #GFreenectDevice object asynchronously, as
+ * gfreenect_device_new() does, but opening the device from @context. All
+ * the devices opened from the same context share a single thread to
+ * receive their frames. The actual instance is obtained with
+ * gfreenect_device_new_finish() when @callback is called.
+ **/
+void
+gfreenect_device_new_with_context (GFreenectContext    *context,
+                                   gint                 device_index,
+                                   guint                subdevices,
+                                   GCancellable        *cancellable,
+                                   GAsyncReadyCallback  callback,
+                                   gpointer             user_data)
+{
+  g_return_if_fail (GFREENECT_IS_CONTEXT (context));
+
+  g_async_initable_new_async (GFREENECT_TYPE_DEVICE,
+                              G_PRIORITY_DEFAULT,
+                              cancellable,
+                              callback,
+                              user_data,
+                              "context", context,
+                              "index", device_index,
+                              "subdevices", subdevices,
+                              NULL);
+}
+
 /**
  * gfreenect_device_new_finish:
  * @result: The #GAsyncResult provided in the callback
@@ -1230,13 +3043,26 @@ gfreenect_device_start_depth_stream (GFreenectDevice       *self,
 
   self->priv->depth_format = format;
 
-  /* free current depth buffer */
+  /* free current depth buffers */
   if (self->priv->depth_buf != NULL)
     {
       g_slice_free1 (self->priv->depth_mode.bytes, self->priv->depth_buf);
       self->priv->depth_buf = NULL;
     }
 
+  g_free (self->priv->depth_roi_buf);
+  self->priv->depth_roi_buf = NULL;
+
+  g_mutex_lock (&self->priv->stream_mutex);
+  self->priv->has_depth_stats = FALSE;
+  self->priv->has_depth_pyramid = FALSE;
+  self->priv->depth_bands.has_output = FALSE;
+  gfreenect_temporal_filter_reset (&self->priv->temporal_filter);
+  self->priv->spatial_filter.has_output = FALSE;
+  gfreenect_motion_detector_reset (&self->priv->motion_detector);
+  self->priv->static_frames = 0;
+  g_mutex_unlock (&self->priv->stream_mutex);
+
   self->priv->depth_mode = freenect_find_depth_mode (FREENECT_RESOLUTION_MEDIUM,
                                                      self->priv->depth_format);
 
@@ -1271,7 +3097,7 @@ gfreenect_device_start_depth_stream (GFreenectDevice       *self,
   self->priv->got_depth_frame = FALSE;
 
 
-  if (self->priv->stream_thread == NULL && ! launch_stream_thread (self, error))
+  if (! hold_events (self, error))
     return FALSE;
 
   self->priv->depth_stream_started = TRUE;
@@ -1306,8 +3132,9 @@ gfreenect_device_stop_depth_stream (GFreenectDevice  *self,
 
   self->priv->depth_stream_started = FALSE;
 
-  if (! self->priv->video_stream_started)
-    self->priv->abort_stream_thread = TRUE;
+  if (! self->priv->video_stream_started &&
+      ! self->priv->audio_stream_started)
+    release_events (self);
 
   return TRUE;
 }
@@ -1345,13 +3172,16 @@ gfreenect_device_start_video_stream (GFreenectDevice      *self,
   self->priv->video_resolution = resolution;
   self->priv->video_format = format;
 
-  /* free current video buffer */
+  /* free current video buffers */
   if (self->priv->video_buf != NULL)
     {
       g_slice_free1 (self->priv->video_mode.bytes, self->priv->video_buf);
       self->priv->video_buf = NULL;
     }
 
+  g_free (self->priv->video_roi_buf);
+  self->priv->video_roi_buf = NULL;
+
   self->priv->video_mode = freenect_find_video_mode (self->priv->video_resolution,
                                                      self->priv->video_format);
 
@@ -1385,7 +3215,7 @@ gfreenect_device_start_video_stream (GFreenectDevice      *self,
       return FALSE;
     }
 
-  if (self->priv->stream_thread == NULL && ! launch_stream_thread (self, error))
+  if (! hold_events (self, error))
     return FALSE;
 
   self->priv->video_stream_started = TRUE;
@@ -1420,133 +3250,922 @@ gfreenect_device_stop_video_stream (GFreenectDevice  *self,
 
   self->priv->video_stream_started = FALSE;
 
-  if (! self->priv->depth_stream_started)
-    self->priv->abort_stream_thread = TRUE;
+  if (! self->priv->depth_stream_started &&
+      ! self->priv->audio_stream_started)
+    release_events (self);
 
   return TRUE;
 }
 
 /**
- * gfreenect_device_set_led:
+ * gfreenect_device_start_audio_stream:
  * @self: The #GFreenectDevice
- * @led: A led status from #GFreenectLed
- * @cancellable: (allow-none): A cancellable object, or %NULL
- * @callback: (scope async) (allow-none): The function to call upon completion,
- * or %NULL
- * @user_data: (allow-none): Arbitrary user data to pass in @callback, or %NULL
+ * @error: (allow-none): A pointer to a #GError, or %NULL
  *
- * Sets the status of the device's led asynchronously. Use
- * gfreenect_device_set_led_finish() to obtain the result of the operation.
+ * Starts the audio stream of the microphone array. The device must have
+ * been opened with %GFREENECT_SUBDEVICE_AUDIO. Audio arrives at
+ * %GFREENECT_AUDIO_SAMPLE_RATE frames per second, each frame holding the
+ * samples of the four microphones followed by the reference channel, see
+ * %GFREENECT_AUDIO_CHANNELS. Incoming frames are stored in a preallocated
+ * history of %GFREENECT_AUDIO_HISTORY frames, without allocating memory.
  *
- * If this method is called while a previous operation has not completed, a
- * %G_IO_ERROR_PENDING error occurs.
+ * After calling this, the #GFreenectDevice::audio-samples signal is
+ * triggered whenever new frames are available. Frames can also be pulled
+ * from any thread with gfreenect_device_read_audio(). Use
+ * gfreenect_device_stop_audio_stream() to stop it.
+ *
+ * Returns: %TRUE on success or %FALSE if an error occurred.
  **/
-void
-gfreenect_device_set_led (GFreenectDevice     *self,
-                          GFreenectLed         led,
-                          GCancellable        *cancellable,
-                          GAsyncReadyCallback  callback,
-                          gpointer             user_data)
+gboolean
+gfreenect_device_start_audio_stream (GFreenectDevice  *self,
+                                     GError          **error)
 {
-  GSimpleAsyncResult *res = NULL;
+  g_return_val_if_fail (GFREENECT_IS_DEVICE (self), FALSE);
 
-  g_return_if_fail (GFREENECT_IS_DEVICE (self));
+#ifdef HAVE_FREENECT_START_AUDIO
+  if (self->priv->audio_stream_started)
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_PENDING,
+                   "Audio stream already started, try stopping it first");
+      return FALSE;
+    }
 
-  if (callback != NULL)
+  /* the stream is stopped here, as freenect_stop_audio() succeeded or it
+     was never started, but a callback of the previous stream may still be
+     running on the event thread: it writes the ring under stream_mutex */
+  g_mutex_lock (&self->priv->stream_mutex);
+
+  if (self->priv->audio_ring.samples == NULL)
     {
-      res = g_simple_async_result_new (G_OBJECT (self),
-                                       callback,
-                                       user_data,
-                                       gfreenect_device_set_led);
+      gfreenect_audio_ring_init (&self->priv->audio_ring,
+                                 GFREENECT_AUDIO_HISTORY);
+      self->priv->audio_signal_buf =
+        g_new (gint32, GFREENECT_AUDIO_HISTORY * GFREENECT_AUDIO_CHANNELS);
+    }
+  else
+    {
+      gfreenect_audio_ring_reset (&self->priv->audio_ring);
+    }
 
-      if (self->priv->set_led_result != NULL)
-        {
-          g_simple_async_result_set_error (res,
-                                           G_IO_ERROR,
-                                           G_IO_ERROR_PENDING,
-                                           "Set led operation pending");
+  if (self->priv->audio_src_id != 0)
+    {
+      g_source_remove (self->priv->audio_src_id);
+      self->priv->audio_src_id = 0;
+    }
+
+  self->priv->audio_signal_cursor = 0;
+  self->priv->audio_read_cursor = 0;
+
+  g_mutex_unlock (&self->priv->stream_mutex);
+
+  freenect_set_audio_in_callback (self->priv->dev, on_audio_in);
+
+  if (freenect_start_audio (self->priv->dev) != 0)
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_FAILED,
+                   "Failed to start audio stream");
+      return FALSE;
+    }
+
+  if (! hold_events (self, error))
+    {
+      freenect_stop_audio (self->priv->dev);
+      return FALSE;
+    }
+
+  self->priv->audio_stream_started = TRUE;
+
+  return TRUE;
+#else
+  g_set_error (error,
+               G_IO_ERROR,
+               G_IO_ERROR_NOT_SUPPORTED,
+               "Audio is not supported by this version of libfreenect");
+  return FALSE;
+#endif
+}
+
+/**
+ * gfreenect_device_stop_audio_stream:
+ * @self: The #GFreenectDevice
+ * @error: (allow-none): A pointer to a #GError, or %NULL
+ *
+ * Stops the audio stream that was previously started with
+ * gfreenect_device_start_audio_stream(). Frames not read yet can still be
+ * pulled with gfreenect_device_read_audio().
+ *
+ * Returns: %TRUE on success or %FALSE if an error occurred.
+ **/
+gboolean
+gfreenect_device_stop_audio_stream (GFreenectDevice  *self,
+                                    GError          **error)
+{
+  g_return_val_if_fail (GFREENECT_IS_DEVICE (self), FALSE);
+
+#ifdef HAVE_FREENECT_START_AUDIO
+  if (freenect_stop_audio (self->priv->dev) != 0)
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_FAILED,
+                   "Failed to stop audio stream");
+      return FALSE;
+    }
+#endif
+
+  self->priv->audio_stream_started = FALSE;
+
+  if (! self->priv->depth_stream_started &&
+      ! self->priv->video_stream_started)
+    release_events (self);
+
+  return TRUE;
+}
+
+/**
+ * gfreenect_device_read_audio:
+ * @self: The #GFreenectDevice
+ * @frames: (out caller-allocates) (array length=max_frames): A buffer for
+ * @max_frames frames of %GFREENECT_AUDIO_CHANNELS interleaved samples
+ * @max_frames: The maximum number of frames to read
+ * @timestamp: (out) (allow-none): A pointer to retrieve the monotonic time
+ * the first frame arrived at, in microseconds, or %NULL
+ *
+ * Reads the audio frames received since the last call, independently of
+ * the #GFreenectDevice::audio-samples signal. Frames are kept for
+ * %GFREENECT_AUDIO_HISTORY frames; if the caller falls further behind, the
+ * oldest ones are skipped. Reading never blocks the audio stream nor
+ * allocates memory, but only one thread may read at a time.
+ *
+ * Returns: The number of frames read, possibly 0.
+ **/
+guint
+gfreenect_device_read_audio (GFreenectDevice *self,
+                             gint32          *frames,
+                             guint            max_frames,
+                             gint64          *timestamp)
+{
+  g_return_val_if_fail (GFREENECT_IS_DEVICE (self), 0);
+  g_return_val_if_fail (frames != NULL || max_frames == 0, 0);
+
+  if (self->priv->audio_ring.samples == NULL)
+    return 0;
+
+  return gfreenect_audio_ring_read (&self->priv->audio_ring,
+                                    &self->priv->audio_read_cursor,
+                                    frames,
+                                    max_frames,
+                                    timestamp);
+}
+
+/**
+ * gfreenect_device_start_motion_stream:
+ * @self: The #GFreenectDevice
+ * @error: (allow-none): A pointer to a #GError, or %NULL
+ *
+ * Starts sampling the state of the motor subdevice at the rate given by
+ * #GFreenectDevice:motion-sample-rate, in a background thread. Samples are
+ * kept in a history of the last few seconds that can be queried from any
+ * thread with gfreenect_device_get_motion_state() and
+ * gfreenect_device_get_motion_states_since(), without any USB transfer. The
+ * #GFreenectDevice::motion-state signal is triggered with the newest sample
+ * in the thread-default main context of the caller. Use
+ * gfreenect_device_stop_motion_stream() to stop it.
+ *
+ * Returns: %TRUE on success or %FALSE if an error occurred.
+ **/
+gboolean
+gfreenect_device_start_motion_stream (GFreenectDevice  *self,
+                                      GError          **error)
+{
+  gboolean result;
+
+  g_return_val_if_fail (GFREENECT_IS_DEVICE (self), FALSE);
+
+  g_mutex_lock (&self->priv->dispatch_mutex);
+
+  if (self->priv->motion_stream_started)
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_PENDING,
+                   "Motion stream already started, try stopping it first");
+      result = FALSE;
+    }
+  else if (! launch_dispatch_thread (self, error))
+    {
+      result = FALSE;
+    }
+  else
+    {
+      self->priv->motion_context = g_main_context_get_thread_default ();
+      self->priv->motion_stream_started = TRUE;
+      g_cond_signal (&self->priv->dispatch_cond);
+      result = TRUE;
+    }
+
+  g_mutex_unlock (&self->priv->dispatch_mutex);
+
+  return result;
+}
+
+/**
+ * gfreenect_device_stop_motion_stream:
+ * @self: The #GFreenectDevice
+ * @error: (allow-none): A pointer to a #GError, or %NULL
+ *
+ * Stops the motion stream that was previously started with
+ * gfreenect_device_start_motion_stream(). The samples taken so far can
+ * still be queried.
+ *
+ * Returns: %TRUE on success or %FALSE if an error occurred.
+ **/
+gboolean
+gfreenect_device_stop_motion_stream (GFreenectDevice  *self,
+                                     GError          **error)
+{
+  g_return_val_if_fail (GFREENECT_IS_DEVICE (self), FALSE);
+
+  g_mutex_lock (&self->priv->dispatch_mutex);
+
+  self->priv->motion_stream_started = FALSE;
+
+  if (self->priv->motion_state_src_id != 0)
+    {
+      g_source_remove (self->priv->motion_state_src_id);
+      self->priv->motion_state_src_id = 0;
+    }
+
+  g_mutex_unlock (&self->priv->dispatch_mutex);
+
+  return TRUE;
+}
+
+/**
+ * gfreenect_device_get_motion_state:
+ * @self: The #GFreenectDevice
+ * @state: (out caller-allocates): A #GFreenectMotionState to fill
+ *
+ * Retrieves the newest sample of the motion stream, see
+ * gfreenect_device_start_motion_stream(). It can be called from any thread
+ * and never blocks.
+ *
+ * Returns: %TRUE if @state was filled, or %FALSE if no sample was taken
+ * yet.
+ **/
+gboolean
+gfreenect_device_get_motion_state (GFreenectDevice      *self,
+                                   GFreenectMotionState *state)
+{
+  g_return_val_if_fail (GFREENECT_IS_DEVICE (self), FALSE);
+  g_return_val_if_fail (state != NULL, FALSE);
+
+  return gfreenect_motion_ring_latest (&self->priv->motion_ring, state);
+}
+
+/**
+ * gfreenect_device_get_motion_states_since:
+ * @self: The #GFreenectDevice
+ * @since: A monotonic time, in microseconds
+ *
+ * Retrieves the samples of the motion stream taken at or after @since, as
+ * returned by g_get_monotonic_time(), oldest first. Only the last
+ * %GFREENECT_MOTION_HISTORY samples are kept. It can be called from any
+ * thread and never blocks.
+ *
+ * Returns: (transfer full) (element-type GFreenectMotionState): An array of
+ * #GFreenectMotionState, possibly empty. Use g_array_unref() to free it.
+ **/
+GArray *
+gfreenect_device_get_motion_states_since (GFreenectDevice *self,
+                                          gint64           since)
+{
+  g_return_val_if_fail (GFREENECT_IS_DEVICE (self), NULL);
+
+  return gfreenect_motion_ring_since (&self->priv->motion_ring, since);
+}
+
+/**
+ * gfreenect_device_query_motion_state:
+ * @self: The #GFreenectDevice
+ * @max_age: The maximum age of an acceptable state, in microseconds
+ * @cancellable: (allow-none): A cancellable object, or %NULL
+ * @callback: (scope async) (allow-none): A function to be called upon
+ * completion, or %NULL
+ * @user_data: (allow-none): An arbitrary user data to pass in @callback,
+ * or %NULL
+ *
+ * Asynchronously gets the state of the motor subdevice. The last state read
+ * from the device is returned if it was read at most @max_age microseconds
+ * ago, without any USB transfer. Otherwise the operation waits for the next
+ * read, which is shared by all the queries pending at that time. Use
+ * gfreenect_device_query_motion_state_finish() to obtain the result.
+ *
+ * gfreenect_device_get_tilt_angle() and gfreenect_device_get_accel() behave
+ * as if @max_age were 0.
+ **/
+void
+gfreenect_device_query_motion_state (GFreenectDevice     *self,
+                                     gint64               max_age,
+                                     GCancellable        *cancellable,
+                                     GAsyncReadyCallback  callback,
+                                     gpointer             user_data)
+{
+  GSimpleAsyncResult *res;
+
+  g_return_if_fail (GFREENECT_IS_DEVICE (self));
+
+  res = g_simple_async_result_new (G_OBJECT (self),
+                                   callback,
+                                   user_data,
+                                   gfreenect_device_query_motion_state);
+
+  request_state (self, res, max_age, cancellable);
+}
+
+/**
+ * gfreenect_device_query_motion_state_finish:
+ * @self: The #GFreenectDevice
+ * @result: The #GAsyncResult provided in the callback
+ * @state: (out caller-allocates): A #GFreenectMotionState to fill
+ * @error: (allow-none): A pointer to a #GError, or %NULL
+ *
+ * Obtains the result of a gfreenect_device_query_motion_state() operation.
+ * The @timestamp member of @state tells when it was read from the device.
+ *
+ * Returns: %TRUE on success or %FALSE if an error occurred.
+ **/
+gboolean
+gfreenect_device_query_motion_state_finish (GFreenectDevice       *self,
+                                            GAsyncResult          *result,
+                                            GFreenectMotionState  *state,
+                                            GError               **error)
+{
+  g_return_val_if_fail (GFREENECT_IS_DEVICE (self), FALSE);
+  g_return_val_if_fail (g_simple_async_result_is_valid (result,
+                                       G_OBJECT (self),
+                                       gfreenect_device_query_motion_state),
+                        FALSE);
+  g_return_val_if_fail (state != NULL, FALSE);
+
+  if (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (result),
+                                             error))
+    return FALSE;
+
+  *state = *(GFreenectMotionState *)
+    g_simple_async_result_get_op_res_gpointer (G_SIMPLE_ASYNC_RESULT (result));
+
+  return TRUE;
+}
+
+/**
+ * gfreenect_device_query_motion_state_sync:
+ * @self: The #GFreenectDevice
+ * @max_age: The maximum age of an acceptable state, in microseconds
+ * @state: (out caller-allocates): A #GFreenectMotionState to fill
+ * @cancellable: (allow-none): A cancellable object, or %NULL
+ * @error: (allow-none): A pointer to a #GError, or %NULL
+ *
+ * Gets the state of the motor subdevice synchronously. This is the blocking
+ * version of gfreenect_device_query_motion_state(). Concurrent callers
+ * finding the last state too old share a single read from the device.
+ *
+ * Returns: %TRUE on success or %FALSE if an error occurred.
+ **/
+gboolean
+gfreenect_device_query_motion_state_sync (GFreenectDevice       *self,
+                                          gint64                 max_age,
+                                          GFreenectMotionState  *state,
+                                          GCancellable          *cancellable,
+                                          GError               **error)
+{
+  g_return_val_if_fail (GFREENECT_IS_DEVICE (self), FALSE);
+  g_return_val_if_fail (state != NULL, FALSE);
+
+  return request_state_sync (self, max_age, state, error) &&
+    check_cancelled (cancellable, error, "Query motion state");
+}
+
+/**
+ * gfreenect_device_set_led:
+ * @self: The #GFreenectDevice
+ * @led: A led status from #GFreenectLed
+ * @cancellable: (allow-none): A cancellable object, or %NULL
+ * @callback: (scope async) (allow-none): The function to call upon completion,
+ * or %NULL
+ * @user_data: (allow-none): Arbitrary user data to pass in @callback, or %NULL
+ *
+ * Sets the status of the device's led asynchronously. Use
+ * gfreenect_device_set_led_finish() to obtain the result of the operation.
+ *
+ * If this method is called while a previous operation has not completed, a
+ * %G_IO_ERROR_PENDING error occurs.
+ **/
+void
+gfreenect_device_set_led (GFreenectDevice     *self,
+                          GFreenectLed         led,
+                          GCancellable        *cancellable,
+                          GAsyncReadyCallback  callback,
+                          gpointer             user_data)
+{
+  GSimpleAsyncResult *res = NULL;
+
+  g_return_if_fail (GFREENECT_IS_DEVICE (self));
+
+  if (callback != NULL)
+    {
+      res = g_simple_async_result_new (G_OBJECT (self),
+                                       callback,
+                                       user_data,
+                                       gfreenect_device_set_led);
+    }
+
+  g_mutex_lock (&self->priv->dispatch_mutex);
+
+  if (res != NULL && self->priv->set_led_result != NULL)
+    {
+      g_mutex_unlock (&self->priv->dispatch_mutex);
+
+      g_simple_async_result_set_error (res,
+                                       G_IO_ERROR,
+                                       G_IO_ERROR_PENDING,
+                                       "Set led operation pending");
+
+      g_simple_async_result_complete_in_idle (res);
+      g_object_unref (res);
+      return;
+    }
+
+  launch_dispatch_thread (self, NULL);
+
+  /* a pending operation is completed once the newest status is set
+     instead */
+  if (res != NULL)
+    {
+      self->priv->set_led_result = res;
+      if (cancellable != NULL)
+        g_signal_connect (cancellable,
+                          "cancelled",
+                          G_CALLBACK (on_set_led_cancelled),
+                          self);
+    }
+
+  self->priv->led = led;
+  self->priv->update_led = TRUE;
+  g_cond_signal (&self->priv->dispatch_cond);
+
+  g_mutex_unlock (&self->priv->dispatch_mutex);
+}
+
+/**
+ * gfreenect_device_set_led_finish:
+ * @self: The #GFreenectDevice
+ * @result: The #GAsyncResult provided in the callback
+ * @error: (allow-none): A pointer to a #GError, or %NULL
+ *
+ * Obtains the result of a gfreenect_device_set_led() operation.
+ *
+ * Returns: %TRUE on success or %FALSE if an error occurred.
+ **/
+gboolean
+gfreenect_device_set_led_finish (GFreenectDevice  *self,
+                                 GAsyncResult     *result,
+                                 GError          **error)
+{
+  g_return_val_if_fail (GFREENECT_IS_DEVICE (self), FALSE);
+  g_return_val_if_fail (g_simple_async_result_is_valid (result,
+                                                      G_OBJECT (self),
+                                                      gfreenect_device_set_led),
+                        FALSE);
+
+  return ! g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (result),
+                                                  error);
+}
+
+/**
+ * gfreenect_device_get_depth_frame_raw:
+ * @self: The #GFreenectDevice
+ * @len: (out) (allow-none): A pointer to retrieve the length of the returned
+ * frame data
+ * @frame_mode: (out) (allow-none): A #GFreenectFrameMode structure to fill
+ * with the attributes of the frame
+ *
+ * Retrieves one depth frame in raw format as provided by the lower levels.
+ * If a region of interest is set with gfreenect_device_set_depth_roi(), only
+ * that region of the frame is returned, except for packed formats.
+ *
+ * Optionally the frame metadata can also be retrieved providing a non-%NULL
+ * pointer to a #GFreenectFrameMode structure in @frame_mode.
+ *
+ * This method should only be called within a #GFreenectDevice::depth-frame
+ * signal handler, otherwise the returned values can be undefined.
+ *
+ * Returns: (array length=len) (element-type guint8) (transfer none): An array
+ * of @len bytes representing the frame data.
+ **/
+guint8 *
+gfreenect_device_get_depth_frame_raw (GFreenectDevice    *self,
+                                      gsize              *len,
+                                      GFreenectFrameMode *frame_mode)
+{
+  GFreenectRegion region;
+  guint bytes_per_pixel;
+
+  g_return_val_if_fail (GFREENECT_IS_DEVICE (self), NULL);
+
+  if (frame_mode != NULL)
+    gfreenect_frame_mode_set_from_native (frame_mode, &self->priv->depth_mode);
+
+  get_frame_region (self->priv->depth_mode.width,
+                    self->priv->depth_mode.height,
+                    self->priv->depth_roi,
+                    &region);
+
+  bytes_per_pixel = get_bytes_per_pixel (&self->priv->depth_mode);
+
+  /* packed frames are always delivered whole */
+  if (bytes_per_pixel == 0 ||
+      region_is_full_frame (&region,
+                            self->priv->depth_mode.width,
+                            self->priv->depth_mode.height))
+    {
+      if (len != NULL)
+        *len = self->priv->depth_mode.bytes;
+
+      return self->priv->depth_buf;
+    }
+
+  if (self->priv->depth_roi_buf == NULL)
+    self->priv->depth_roi_buf = g_malloc (self->priv->depth_mode.bytes);
+
+  gfreenect_convert_crop (self->priv->depth_buf,
+                          self->priv->depth_mode.width,
+                          bytes_per_pixel,
+                          &region,
+                          self->priv->depth_roi_buf);
+
+  if (frame_mode != NULL)
+    set_frame_mode_region (frame_mode, &region);
+
+  if (len != NULL)
+    *len = region.width * region.height * bytes_per_pixel;
+
+  return self->priv->depth_roi_buf;
+}
+
+/**
+ * gfreenect_device_get_depth_pyramid_level:
+ * @self: The #GFreenectDevice
+ * @level: The level of the pyramid, from 0 to %GFREENECT_DEPTH_PYRAMID_LEVELS
+ * @len: (out) (allow-none): A pointer to retrieve the length of the returned
+ * frame data
+ * @frame_mode: (out) (allow-none): A #GFreenectFrameMode structure to fill
+ * with the attributes of the frame
+ *
+ * Retrieves one level of the depth pyramid built for the current depth frame.
+ * Level 0 is the depth frame itself, as returned by
+ * gfreenect_device_get_depth_frame_raw(), and each following level halves the
+ * width and height of the previous one. The pyramid is only built when the
+ * #GFreenectDevice:depth-pyramid property is set, and for depth formats
+ * that use one guint16 per pixel. The reduced levels always cover the whole
+ * frame, regardless of the depth region of interest.
+ *
+ * Optionally the frame metadata can also be retrieved providing a non-%NULL
+ * pointer to a #GFreenectFrameMode structure in @frame_mode.
+ *
+ * This method should only be called within a #GFreenectDevice::depth-frame
+ * signal handler, otherwise the returned values can be undefined.
+ *
+ * Returns: (array length=len) (element-type guint8) (transfer none): An array
+ * of @len bytes representing the frame data, or %NULL if the pyramid is not
+ * available.
+ **/
+guint8 *
+gfreenect_device_get_depth_pyramid_level (GFreenectDevice    *self,
+                                          guint               level,
+                                          gsize              *len,
+                                          GFreenectFrameMode *frame_mode)
+{
+  gsize width;
+  gsize height;
+
+  g_return_val_if_fail (GFREENECT_IS_DEVICE (self), NULL);
+  g_return_val_if_fail (level <= GFREENECT_DEPTH_PYRAMID_LEVELS, NULL);
+
+  if (level == 0)
+    return gfreenect_device_get_depth_frame_raw (self, len, frame_mode);
+
+  if (self->priv->depth_pyramid == GFREENECT_DEPTH_PYRAMID_NONE ||
+      ! self->priv->has_depth_pyramid)
+    {
+      return NULL;
+    }
+
+  width = self->priv->depth_mode.width >> level;
+  height = self->priv->depth_mode.height >> level;
+
+  if (frame_mode != NULL)
+    {
+      gfreenect_frame_mode_set_from_native (frame_mode, &self->priv->depth_mode);
+
+      frame_mode->width = width;
+      frame_mode->height = height;
+      frame_mode->length = width * height * sizeof (guint16);
+    }
+
+  if (len != NULL)
+    *len = width * height * sizeof (guint16);
+
+  return (guint8 *) self->priv->depth_pyramid_levels[level - 1];
+}
+
+/**
+ * gfreenect_device_get_depth_frame_filtered:
+ * @self: The #GFreenectDevice
+ * @len: (out) (allow-none): A pointer to retrieve the length of the returned
+ * frame data
+ * @frame_mode: (out) (allow-none): A #GFreenectFrameMode structure to fill
+ * with the attributes of the frame
+ *
+ * Retrieves the current depth frame after applying the filters set in the
+ * #GFreenectDevice:temporal-filter and #GFreenectDevice:spatial-filter
+ * properties. The frame has the same format as the one returned by
+ * gfreenect_device_get_depth_frame_raw(), and the depth region of interest
+ * is applied to it as well.
+ *
+ * Optionally the frame metadata can also be retrieved providing a non-%NULL
+ * pointer to a #GFreenectFrameMode structure in @frame_mode.
+ *
+ * This method should only be called within a #GFreenectDevice::depth-frame
+ * signal handler, otherwise the returned values can be undefined.
+ *
+ * Returns: (array length=len) (element-type guint8) (transfer none): An array
+ * of @len bytes representing the frame data, or %NULL if no filter is set or
+ * the depth format cannot be filtered.
+ **/
+guint8 *
+gfreenect_device_get_depth_frame_filtered (GFreenectDevice    *self,
+                                           gsize              *len,
+                                           GFreenectFrameMode *frame_mode)
+{
+  guint16 *filtered;
+  GFreenectRegion region;
+
+  g_return_val_if_fail (GFREENECT_IS_DEVICE (self), NULL);
+
+  filtered = get_filtered_depth (self);
+  if (filtered == NULL)
+    return NULL;
+
+  if (frame_mode != NULL)
+    gfreenect_frame_mode_set_from_native (frame_mode, &self->priv->depth_mode);
+
+  get_frame_region (self->priv->depth_mode.width,
+                    self->priv->depth_mode.height,
+                    self->priv->depth_roi,
+                    &region);
+
+  if (region_is_full_frame (&region,
+                            self->priv->depth_mode.width,
+                            self->priv->depth_mode.height))
+    {
+      if (len != NULL)
+        *len = self->priv->depth_mode.bytes;
+
+      return (guint8 *) filtered;
+    }
+
+  gfreenect_convert_crop ((const guint8 *) filtered,
+                          self->priv->depth_mode.width,
+                          sizeof (guint16),
+                          &region,
+                          self->priv->user_buf);
+
+  if (frame_mode != NULL)
+    set_frame_mode_region (frame_mode, &region);
+
+  if (len != NULL)
+    *len = region.width * region.height * sizeof (guint16);
+
+  return self->priv->user_buf;
+}
+
+/**
+ * gfreenect_device_get_depth_stats:
+ * @self: The #GFreenectDevice
+ * @stats: (out caller-allocates): A #GFreenectDepthStats structure to fill
+ *
+ * Retrieves the statistics of the current depth frame, computed over the
+ * whole frame regardless of the depth region of interest. Statistics are
+ * only computed for depth formats that use one guint16 per pixel.
+ *
+ * This method should only be called within a #GFreenectDevice::depth-frame
+ * signal handler, otherwise the returned values can be undefined.
+ *
+ * Returns: %TRUE if @stats was filled, %FALSE if no statistics are
+ * available.
+ **/
+gboolean
+gfreenect_device_get_depth_stats (GFreenectDevice     *self,
+                                  GFreenectDepthStats *stats)
+{
+  g_return_val_if_fail (GFREENECT_IS_DEVICE (self), FALSE);
+  g_return_val_if_fail (stats != NULL, FALSE);
+
+  if (! self->priv->has_depth_stats)
+    return FALSE;
+
+  memcpy (stats, &self->priv->depth_stats, sizeof (GFreenectDepthStats));
+
+  return TRUE;
+}
+
+/**
+ * gfreenect_device_get_depth_frame_motion_state:
+ * @self: The #GFreenectDevice
+ * @state: (out caller-allocates): A #GFreenectMotionState to fill
+ *
+ * Retrieves the state of the motor subdevice at the time the current depth
+ * frame arrived, to compensate for the movement of the sensor. While the
+ * motion stream is started, the state is interpolated between the samples
+ * taken around that time, so its accuracy depends on
+ * #GFreenectDevice:motion-sample-rate and no USB transfer is made. Otherwise
+ * the last state read from the device is returned, however old it is. The
+ * @timestamp member of @state is the arrival time of the frame.
+ *
+ * This method should only be called within a #GFreenectDevice::depth-frame
+ * signal handler, otherwise the returned values can be undefined.
+ *
+ * Returns: %TRUE if @state was filled, %FALSE if the state of the motor
+ * subdevice is not known yet.
+ **/
+gboolean
+gfreenect_device_get_depth_frame_motion_state (GFreenectDevice      *self,
+                                               GFreenectMotionState *state)
+{
+  g_return_val_if_fail (GFREENECT_IS_DEVICE (self), FALSE);
+  g_return_val_if_fail (state != NULL, FALSE);
 
-          g_simple_async_result_complete_in_idle (res);
-          g_object_unref (res);
-          return;
-        }
-    }
+  return get_motion_state_at (self, self->priv->depth_signal_time, state);
+}
 
-  if (self->priv->dispatch_thread == NULL)
-    launch_dispatch_thread (self, NULL);
+/**
+ * gfreenect_device_get_video_frame_motion_state:
+ * @self: The #GFreenectDevice
+ * @state: (out caller-allocates): A #GFreenectMotionState to fill
+ *
+ * Retrieves the state of the motor subdevice at the time the current video
+ * frame arrived. See gfreenect_device_get_depth_frame_motion_state().
+ *
+ * This method should only be called within a #GFreenectDevice::video-frame
+ * signal handler, otherwise the returned values can be undefined.
+ *
+ * Returns: %TRUE if @state was filled, %FALSE if the state of the motor
+ * subdevice is not known yet.
+ **/
+gboolean
+gfreenect_device_get_video_frame_motion_state (GFreenectDevice      *self,
+                                               GFreenectMotionState *state)
+{
+  g_return_val_if_fail (GFREENECT_IS_DEVICE (self), FALSE);
+  g_return_val_if_fail (state != NULL, FALSE);
 
-  g_mutex_lock (&self->priv->dispatch_mutex);
+  return get_motion_state_at (self, self->priv->video_signal_time, state);
+}
 
-  self->priv->set_led_result = res;
-  if (cancellable != NULL)
-    g_signal_connect (cancellable,
-                      "cancelled",
-                      G_CALLBACK (on_set_led_cancelled),
-                      self);
+/**
+ * gfreenect_device_get_depth_histogram:
+ * @self: The #GFreenectDevice
+ * @bin_shift: (out) (allow-none): A pointer to retrieve the number of bits
+ * depth values are shifted right to obtain their bin, or %NULL
+ *
+ * Retrieves the histogram of the valid depth values of the current depth
+ * frame, with %GFREENECT_DEPTH_STATS_HISTOGRAM_BINS bins. Each bin covers
+ * one raw value for %GFREENECT_DEPTH_FORMAT_11BIT and
+ * %GFREENECT_DEPTH_FORMAT_10BIT, and 8 millimeters for the millimeter
+ * formats. The histogram is only computed when the
+ * #GFreenectDevice:depth-histogram property is set.
+ *
+ * This method should only be called within a #GFreenectDevice::depth-frame
+ * signal handler, otherwise the returned values can be undefined.
+ *
+ * Returns: (array fixed-size=2048) (transfer none): The histogram, or %NULL
+ * if it is not available.
+ **/
+const guint32 *
+gfreenect_device_get_depth_histogram (GFreenectDevice *self,
+                                      guint           *bin_shift)
+{
+  g_return_val_if_fail (GFREENECT_IS_DEVICE (self), NULL);
 
-  self->priv->led = led;
-  self->priv->update_led = TRUE;
+  if (! self->priv->has_depth_stats || self->priv->depth_histogram == NULL)
+    return NULL;
 
-  g_mutex_unlock (&self->priv->dispatch_mutex);
+  if (bin_shift != NULL)
+    *bin_shift = self->priv->depth_histogram_shift;
+
+  return self->priv->depth_histogram;
 }
 
 /**
- * gfreenect_device_set_led_finish:
+ * gfreenect_device_set_depth_bands:
  * @self: The #GFreenectDevice
- * @result: The #GAsyncResult provided in the callback
- * @error: (allow-none): A pointer to a #GError, or %NULL
+ * @n_bands: The number of bands, up to %GFREENECT_DEPTH_BANDS_MAX, or 0 to
+ * remove all bands
+ * @near: (array length=n_bands) (allow-none): The nearest depth of each band
+ * @far: (array length=n_bands) (allow-none): The farthest depth of each band
  *
- * Obtains the result of a gfreenect_device_set_led() operation.
- *
- * Returns: %TRUE on success or %FALSE if an error occurred.
+ * Sets the depth bands every depth frame is classified into, replacing any
+ * bands set before. A pixel belongs to band i when it has depth information
+ * and its depth lies between @near[i] and @far[i], both included, in the
+ * units of the depth format of the stream. Bands can overlap, and all of
+ * them are computed in a single pass over the frame as it arrives. See
+ * gfreenect_device_get_depth_band().
  **/
-gboolean
-gfreenect_device_set_led_finish (GFreenectDevice  *self,
-                                 GAsyncResult     *result,
-                                 GError          **error)
+void
+gfreenect_device_set_depth_bands (GFreenectDevice *self,
+                                  guint            n_bands,
+                                  const guint     *near,
+                                  const guint     *far)
 {
-  g_return_val_if_fail (GFREENECT_IS_DEVICE (self), FALSE);
-  g_return_val_if_fail (g_simple_async_result_is_valid (result,
-                                                      G_OBJECT (self),
-                                                      gfreenect_device_set_led),
-                        FALSE);
+  GFreenectDepthBandsState *bands;
+  guint i;
 
-  return ! g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (result),
-                                                  error);
+  g_return_if_fail (GFREENECT_IS_DEVICE (self));
+  g_return_if_fail (n_bands <= GFREENECT_DEPTH_BANDS_MAX);
+  g_return_if_fail (n_bands == 0 || (near != NULL && far != NULL));
+
+  bands = &self->priv->depth_bands;
+
+  g_mutex_lock (&self->priv->stream_mutex);
+
+  for (i = 0; i < n_bands; i++)
+    {
+      bands->near[i] = MIN (near[i], G_MAXUINT16);
+      bands->far[i] = MAX (MIN (far[i], G_MAXUINT16), bands->near[i]);
+    }
+
+  bands->n_bands = n_bands;
+  bands->has_output = FALSE;
+
+  g_mutex_unlock (&self->priv->stream_mutex);
 }
 
 /**
- * gfreenect_device_get_depth_frame_raw:
+ * gfreenect_device_get_depth_band:
  * @self: The #GFreenectDevice
+ * @band: The index of the band
+ * @bounds: (out caller-allocates) (allow-none): A #GFreenectRegion to fill
+ * with the bounding box of the band's pixels, or %NULL
+ * @pixels: (out) (allow-none): A pointer to retrieve the number of pixels
+ * in the band, or %NULL
  * @len: (out) (allow-none): A pointer to retrieve the length of the returned
- * frame data
- * @frame_mode: (out) (allow-none): A #GFreenectFrameMode structure to fill
- * with the attributes of the frame
+ * mask, or %NULL
  *
- * Retrieves one depth frame in raw format as provided by the lower levels.
- * Optionally the frame metadata can also be retrieved providing a non-%NULL
- * pointer to a #GFreenectFrameMode structure in @frame_mode.
+ * Retrieves the mask of one of the bands set with
+ * gfreenect_device_set_depth_bands() for the current depth frame. The mask
+ * has one bit per pixel, row by row, where the least significant bit of each
+ * byte is the leftmost pixel. Rows are padded to a whole number of bytes.
+ * When the band has no pixels, @bounds is filled with an empty region.
+ * Masks always cover the whole frame, regardless of the depth region of
+ * interest.
  *
  * This method should only be called within a #GFreenectDevice::depth-frame
  * signal handler, otherwise the returned values can be undefined.
  *
- * Returns: (array length=len) (element-type guint8) (transfer none): An array
- * of @len bytes representing the frame data.
+ * Returns: (array length=len) (element-type guint8) (transfer none): The
+ * packed mask, or %NULL if the band is not available.
  **/
-guint8 *
-gfreenect_device_get_depth_frame_raw (GFreenectDevice    *self,
-                                      gsize              *len,
-                                      GFreenectFrameMode *frame_mode)
+const guint8 *
+gfreenect_device_get_depth_band (GFreenectDevice *self,
+                                 guint            band,
+                                 GFreenectRegion *bounds,
+                                 gsize           *pixels,
+                                 gsize           *len)
 {
+  GFreenectDepthBandsState *bands;
+
   g_return_val_if_fail (GFREENECT_IS_DEVICE (self), NULL);
 
-  if (frame_mode != NULL)
-    gfreenect_frame_mode_set_from_native (frame_mode, &self->priv->depth_mode);
+  bands = &self->priv->depth_bands;
+
+  if (band >= bands->n_bands || ! bands->has_output)
+    return NULL;
+
+  if (bounds != NULL)
+    *bounds = bands->bounds[band];
+
+  if (pixels != NULL)
+    *pixels = bands->pixels[band];
 
   if (len != NULL)
-    *len = self->priv->depth_mode.bytes;
+    *len = bands->stride * bands->height;
 
-  return self->priv->depth_buf;
+  return bands->masks + band * bands->stride * bands->height;
 }
 
 /**
@@ -1558,6 +4177,9 @@ gfreenect_device_get_depth_frame_raw (GFreenectDevice    *self,
  * with the attributes of the frame
  *
  * Retrieves one video frame in raw format as provided by the lower levels.
+ * If a region of interest is set with gfreenect_device_set_video_roi(), only
+ * that region of the frame is returned, except for packed formats.
+ *
  * Optionally the frame metadata can also be retrieved providing a non-%NULL
  * pointer to a #GFreenectFrameMode structure in @frame_mode.
  *
@@ -1572,15 +4194,49 @@ gfreenect_device_get_video_frame_raw (GFreenectDevice    *self,
                                       gsize              *len,
                                       GFreenectFrameMode *frame_mode)
 {
+  GFreenectRegion region;
+  guint bytes_per_pixel;
+
   g_return_val_if_fail (GFREENECT_IS_DEVICE (self), NULL);
 
   if (frame_mode != NULL)
     gfreenect_frame_mode_set_from_native (frame_mode, &self->priv->video_mode);
 
+  get_frame_region (self->priv->video_mode.width,
+                    self->priv->video_mode.height,
+                    self->priv->video_roi,
+                    &region);
+
+  bytes_per_pixel = get_bytes_per_pixel (&self->priv->video_mode);
+
+  /* packed frames are always delivered whole */
+  if (bytes_per_pixel == 0 ||
+      region_is_full_frame (&region,
+                            self->priv->video_mode.width,
+                            self->priv->video_mode.height))
+    {
+      if (len != NULL)
+        *len = self->priv->video_mode.bytes;
+
+      return (guint8 *) self->priv->video_buf;
+    }
+
+  if (self->priv->video_roi_buf == NULL)
+    self->priv->video_roi_buf = g_malloc (self->priv->video_mode.bytes);
+
+  gfreenect_convert_crop (self->priv->video_buf,
+                          self->priv->video_mode.width,
+                          bytes_per_pixel,
+                          &region,
+                          self->priv->video_roi_buf);
+
+  if (frame_mode != NULL)
+    set_frame_mode_region (frame_mode, &region);
+
   if (len != NULL)
-    *len = self->priv->video_mode.bytes;
+    *len = region.width * region.height * bytes_per_pixel;
 
-  return (guint8 *) self->priv->video_buf;
+  return self->priv->video_roi_buf;
 }
 
 /**
@@ -1593,7 +4249,11 @@ gfreenect_device_get_video_frame_raw (GFreenectDevice    *self,
  *
  * Retrieves one depth frame in RGB format using gray values to represent the
  * depth. This method is useful for rendering the frame directly to an RGB
- * capable texture.
+ * capable texture. Only the depth region of interest is converted, if set.
+ * When the #GFreenectDevice:auto-range property is set, the range of valid
+ * depth values of the frame is stretched to the full intensity range, and
+ * pixels without depth information are black.
+ *
  * Optionally the frame metadata can also be retrieved providing a non-%NULL
  * pointer to a #GFreenectFrameMode structure in @frame_mode.
  *
@@ -1608,15 +4268,22 @@ gfreenect_device_get_depth_frame_grayscale (GFreenectDevice    *self,
                                             gsize              *len,
                                             GFreenectFrameMode *frame_mode)
 {
+  GFreenectRegion region;
   guint8 *rgb_buf;
-  gint i;
-  gdouble d;
-  guchar c;
-  guint16 *data;
-  gsize pixels;
+  guint16 invalid;
+  gint64 start_time;
+  GFreenectTraceSpan span;
 
   g_return_val_if_fail (GFREENECT_IS_DEVICE (self), NULL);
 
+  GFREENECT_TRACE_BEGIN (span, depth_grayscale);
+  start_time = g_get_monotonic_time ();
+
+  get_frame_region (self->priv->depth_mode.width,
+                    self->priv->depth_mode.height,
+                    self->priv->depth_roi,
+                    &region);
+
   if (frame_mode != NULL)
     {
       gfreenect_frame_mode_set_from_native (frame_mode, &self->priv->depth_mode);
@@ -1626,30 +4293,165 @@ gfreenect_device_get_depth_frame_grayscale (GFreenectDevice    *self,
       frame_mode->bits_per_pixel = 24;
       frame_mode->padding_bits_per_pixel = 0;
 
-      frame_mode->length = frame_mode->width * frame_mode->height * 3;
+      set_frame_mode_region (frame_mode, &region);
     }
 
   rgb_buf = (guint8 *) self->priv->user_buf;
 
-  data = self->priv->depth_buf;
+  if (self->priv->auto_range &&
+      self->priv->has_depth_stats &&
+      self->priv->depth_stats.valid_pixels > 0 &&
+      get_depth_invalid_value (self->priv->depth_format, &invalid))
+    {
+      gfreenect_convert_depth_grayscale_range (self->priv->depth_buf,
+                                               self->priv->depth_mode.width,
+                                               &region,
+                                               invalid,
+                                               self->priv->depth_stats.min,
+                                               self->priv->depth_stats.max,
+                                               rgb_buf);
+    }
+  else
+    {
+      gfreenect_convert_depth_grayscale (self->priv->depth_buf,
+                                         self->priv->depth_mode.width,
+                                         &region,
+                                         rgb_buf);
+    }
+
+  if (len != NULL)
+    *len = region.width * region.height * 3;
+
+  count_conversion (&self->priv->depth_grayscale_counters, start_time);
+  GFREENECT_TRACE_END (span, depth_grayscale, "depth-grayscale");
+
+  return rgb_buf;
+}
+
+/**
+ * gfreenect_device_get_registration:
+ * @self: The #GFreenectDevice
+ *
+ * Obtains the #GFreenectRegistration of the device, which holds the tables
+ * to convert raw depth frames of this particular sensor to millimeters and
+ * to align them to the RGB image. The tables are read from the device the
+ * first time this method is called and cached afterwards.
+ *
+ * Returns: (transfer none): The #GFreenectRegistration of the device, or
+ * %NULL if the camera subdevice is not active.
+ **/
+GFreenectRegistration *
+gfreenect_device_get_registration (GFreenectDevice *self)
+{
+  g_return_val_if_fail (GFREENECT_IS_DEVICE (self), NULL);
+
+  if (self->priv->registration == NULL && self->priv->dev != NULL &&
+      (self->priv->subdevices & GFREENECT_SUBDEVICE_CAMERA) != 0)
+    {
+      freenect_registration reg;
+
+      reg = freenect_copy_registration (self->priv->dev);
+      self->priv->registration = gfreenect_registration_new_from_native (&reg);
+      freenect_destroy_registration (&reg);
+    }
+
+  return self->priv->registration;
+}
+
+/**
+ * gfreenect_device_get_depth_frame_registered:
+ * @self: The #GFreenectDevice
+ * @len: (out) (allow-none): A pointer to retrieve the length of the returned
+ * frame data
+ * @frame_mode: (out) (allow-none): A #GFreenectFrameMode structure to fill
+ * with the attributes of the frame
+ *
+ * Retrieves one depth frame in millimeters, aligned to the 640x480 image of
+ * the RGB camera. If the depth stream was started with
+ * %GFREENECT_DEPTH_FORMAT_11BIT the frame is registered in software using
+ * the device's #GFreenectRegistration; with
+ * %GFREENECT_DEPTH_FORMAT_REGISTERED the raw frame is returned as is. Other
+ * formats are not supported and %NULL is returned. If a depth region of
+ * interest is set, it applies to the registered frame.
+ *
+ * Optionally the frame metadata can also be retrieved providing a non-%NULL
+ * pointer to a #GFreenectFrameMode structure in @frame_mode.
+ *
+ * This method should only be called within a #GFreenectDevice::depth-frame
+ * signal handler, otherwise the returned values can be undefined.
+ *
+ * Returns: (array length=len) (element-type guint8) (transfer none): An array
+ * of @len bytes representing the frame data.
+ **/
+guint8 *
+gfreenect_device_get_depth_frame_registered (GFreenectDevice    *self,
+                                             gsize              *len,
+                                             GFreenectFrameMode *frame_mode)
+{
+  GFreenectRegistration *registration;
+  GFreenectRegion region;
+  gint64 start_time;
+  GFreenectTraceSpan span;
+  guint8 *buf;
+
+  g_return_val_if_fail (GFREENECT_IS_DEVICE (self), NULL);
+
+  if (self->priv->depth_format == GFREENECT_DEPTH_FORMAT_REGISTERED)
+    return gfreenect_device_get_depth_frame_raw (self, len, frame_mode);
 
-  pixels = self->priv->depth_mode.width * self->priv->depth_mode.height;
+  if (self->priv->depth_format != GFREENECT_DEPTH_FORMAT_11BIT)
+    return NULL;
 
-  for (i=0; i < pixels; i++)
+  registration = gfreenect_device_get_registration (self);
+  if (registration == NULL)
+    return NULL;
+
+  if (frame_mode != NULL)
     {
-      d = ((double) data[i]) / 2048.0;
+      gfreenect_frame_mode_set_from_native (frame_mode, &self->priv->depth_mode);
+
+      frame_mode->depth_format = GFREENECT_DEPTH_FORMAT_REGISTERED;
+
+      frame_mode->bits_per_pixel = 16;
+      frame_mode->padding_bits_per_pixel = 0;
+
+      frame_mode->length = frame_mode->width * frame_mode->height * 2;
+    }
 
-      c = round (d * 256);
+  get_frame_region (GFREENECT_REGISTRATION_WIDTH,
+                    GFREENECT_REGISTRATION_HEIGHT,
+                    self->priv->depth_roi,
+                    &region);
 
-      rgb_buf[i * 3 + 0] = c;
-      rgb_buf[i * 3 + 1] = c;
-      rgb_buf[i * 3 + 2] = c;
+  if (frame_mode != NULL)
+    set_frame_mode_region (frame_mode, &region);
+
+  buf = (guint8 *) self->priv->user_buf;
+
+  GFREENECT_TRACE_BEGIN (span, depth_registered);
+  start_time = g_get_monotonic_time ();
+
+  gfreenect_registration_apply (registration, self->priv->depth_buf,
+                                (guint16 *) buf);
+
+  if (! region_is_full_frame (&region,
+                              GFREENECT_REGISTRATION_WIDTH,
+                              GFREENECT_REGISTRATION_HEIGHT))
+    {
+      gfreenect_convert_crop (buf,
+                              GFREENECT_REGISTRATION_WIDTH,
+                              sizeof (guint16),
+                              &region,
+                              buf);
     }
 
+  count_conversion (&self->priv->depth_registered_counters, start_time);
+  GFREENECT_TRACE_END (span, depth_registered, "depth-registered");
+
   if (len != NULL)
-    *len = pixels * 3;
+    *len = region.width * region.height * 2;
 
-  return rgb_buf;
+  return buf;
 }
 
 /**
@@ -1662,7 +4464,8 @@ gfreenect_device_get_depth_frame_grayscale (GFreenectDevice    *self,
  *
  * Retrieves one video frame in RGB format. A conversion to RGB is applied if
  * the video format is set to IR (infra-red). This method is useful for
- * rendering the frame directly to an RGB capable texture.
+ * rendering the frame directly to an RGB capable texture. Only the video
+ * region of interest is converted, if set.
  *
  * Optionally the frame metadata can also be retrieved providing a non-%NULL
  * pointer to a #GFreenectFrameMode structure in @frame_mode.
@@ -1678,13 +4481,21 @@ gfreenect_device_get_video_frame_rgb (GFreenectDevice    *self,
                                       gsize              *len,
                                       GFreenectFrameMode *frame_mode)
 {
+  GFreenectRegion region;
   guint8 *rgb_buf;
-  gint i;
-  guint8 *data;
-  gsize pixels;
+  gint64 start_time;
+  GFreenectTraceSpan span;
 
   g_return_val_if_fail (GFREENECT_IS_DEVICE (self), NULL);
 
+  GFREENECT_TRACE_BEGIN (span, video_rgb);
+  start_time = g_get_monotonic_time ();
+
+  get_frame_region (self->priv->video_mode.width,
+                    self->priv->video_mode.height,
+                    self->priv->video_roi,
+                    &region);
+
   if (frame_mode != NULL)
     {
       gfreenect_frame_mode_set_from_native (frame_mode, &self->priv->video_mode);
@@ -1694,7 +4505,7 @@ gfreenect_device_get_video_frame_rgb (GFreenectDevice    *self,
       frame_mode->bits_per_pixel = 24;
       frame_mode->padding_bits_per_pixel = 0;
 
-      frame_mode->length = frame_mode->width * frame_mode->height * 3;
+      set_frame_mode_region (frame_mode, &region);
     }
 
   switch (self->priv->video_mode.video_format)
@@ -1708,19 +4519,13 @@ gfreenect_device_get_video_frame_rgb (GFreenectDevice    *self,
       {
         rgb_buf = (guint8 *) self->priv->user_buf;
 
-        data = self->priv->video_buf;
-
-        pixels = self->priv->video_mode.width * self->priv->video_mode.height;
-
-        for (i=0; i < pixels; i++)
-          {
-            rgb_buf[i * 3 + 0] = data[i];
-            rgb_buf[i * 3 + 1] = data[i];
-            rgb_buf[i * 3 + 2] = data[i];
-          }
+        gfreenect_convert_gray_rgb (self->priv->video_buf,
+                                    self->priv->video_mode.width,
+                                    &region,
+                                    rgb_buf);
 
         if (len != NULL)
-          *len = pixels * 3;
+          *len = region.width * region.height * 3;
 
         break;
       }
@@ -1731,9 +4536,66 @@ gfreenect_device_get_video_frame_rgb (GFreenectDevice    *self,
       break;
     }
 
+  if (rgb_buf != NULL)
+    count_conversion (&self->priv->video_rgb_counters, start_time);
+
+  GFREENECT_TRACE_END (span, video_rgb, "video-rgb");
+
   return rgb_buf;
 }
 
+/**
+ * gfreenect_device_set_depth_roi:
+ * @self: The #GFreenectDevice
+ * @roi: (allow-none): A #GFreenectRegion, or %NULL to use the whole frame
+ *
+ * Sets the region of interest of the depth stream. Afterwards, depth frame
+ * getters like gfreenect_device_get_depth_frame_raw() and
+ * gfreenect_device_get_depth_frame_grayscale() only process the pixels
+ * within @roi, and return frames of its size. The region is clipped to the
+ * size of the depth frames.
+ **/
+void
+gfreenect_device_set_depth_roi (GFreenectDevice       *self,
+                                const GFreenectRegion *roi)
+{
+  g_return_if_fail (GFREENECT_IS_DEVICE (self));
+
+  if (self->priv->depth_roi != NULL)
+    gfreenect_region_free (self->priv->depth_roi);
+
+  self->priv->depth_roi = roi != NULL ?
+    gfreenect_region_copy ((GFreenectRegion *) roi) : NULL;
+
+  g_object_notify (G_OBJECT (self), "depth-roi");
+}
+
+/**
+ * gfreenect_device_set_video_roi:
+ * @self: The #GFreenectDevice
+ * @roi: (allow-none): A #GFreenectRegion, or %NULL to use the whole frame
+ *
+ * Sets the region of interest of the video stream. Afterwards, video frame
+ * getters like gfreenect_device_get_video_frame_raw() and
+ * gfreenect_device_get_video_frame_rgb() only process the pixels within
+ * @roi, and return frames of its size. The region is clipped to the size of
+ * the video frames.
+ **/
+void
+gfreenect_device_set_video_roi (GFreenectDevice       *self,
+                                const GFreenectRegion *roi)
+{
+  g_return_if_fail (GFREENECT_IS_DEVICE (self));
+
+  if (self->priv->video_roi != NULL)
+    gfreenect_region_free (self->priv->video_roi);
+
+  self->priv->video_roi = roi != NULL ?
+    gfreenect_region_copy ((GFreenectRegion *) roi) : NULL;
+
+  g_object_notify (G_OBJECT (self), "video-roi");
+}
+
 /**
  * gfreenect_device_set_tilt_angle:
  * @self: The #GFreenectDevice
@@ -1767,24 +4629,30 @@ gfreenect_device_set_tilt_angle (GFreenectDevice     *self,
                                        callback,
                                        user_data,
                                        gfreenect_device_set_tilt_angle);
+    }
 
-      if (self->priv->set_tilt_result != NULL)
-        {
-          g_simple_async_result_set_error (res,
-                                           G_IO_ERROR,
-                                           G_IO_ERROR_PENDING,
-                                           "Tilt operation pending");
+  g_mutex_lock (&self->priv->dispatch_mutex);
 
-          g_simple_async_result_complete_in_idle (res);
-          g_object_unref (res);
-          return;
-        }
+  if (res != NULL && self->priv->set_tilt_result != NULL)
+    {
+      g_mutex_unlock (&self->priv->dispatch_mutex);
+
+      g_simple_async_result_set_error (res,
+                                       G_IO_ERROR,
+                                       G_IO_ERROR_PENDING,
+                                       "Tilt operation pending");
+
+      g_simple_async_result_complete_in_idle (res);
+      g_object_unref (res);
+      return;
     }
 
   /* Kinect's motor won't move less than 1 degree, thus we need to add some
      threshold to avoid waiting forever for the call to complete */
   if (abs (tilt_angle - self->priv->tilt_angle) <= 1.0)
     {
+      g_mutex_unlock (&self->priv->dispatch_mutex);
+
       if (res != NULL)
         {
           g_simple_async_result_complete_in_idle (res);
@@ -1794,20 +4662,23 @@ gfreenect_device_set_tilt_angle (GFreenectDevice     *self,
       return;
     }
 
-  if (self->priv->dispatch_thread == NULL)
-    launch_dispatch_thread (self, NULL);
-
-  g_mutex_lock (&self->priv->dispatch_mutex);
+  launch_dispatch_thread (self, NULL);
 
-  self->priv->set_tilt_result = res;
-  if (cancellable != NULL)
-    g_signal_connect (cancellable,
-                      "cancelled",
-                      G_CALLBACK (on_set_tilt_cancelled),
-                      self);
+  /* a pending operation is completed once the motor reaches the newest
+     angle instead */
+  if (res != NULL)
+    {
+      self->priv->set_tilt_result = res;
+      if (cancellable != NULL)
+        g_signal_connect (cancellable,
+                          "cancelled",
+                          G_CALLBACK (on_set_tilt_cancelled),
+                          self);
+    }
 
   self->priv->tilt_angle = tilt_angle;
   self->priv->update_tilt_angle = TRUE;
+  g_cond_signal (&self->priv->dispatch_cond);
 
   g_mutex_unlock (&self->priv->dispatch_mutex);
 }
@@ -1864,19 +4735,7 @@ gfreenect_device_get_tilt_angle (GFreenectDevice     *self,
                                    user_data,
                                    gfreenect_device_get_tilt_angle);
 
-  if (cancellable != NULL)
-    g_signal_connect (cancellable,
-                      "cancelled",
-                      G_CALLBACK (on_get_tilt_cancelled),
-                      res);
-
-  g_mutex_lock (&self->priv->dispatch_mutex);
-
-  self->priv->state_dependent_results =
-                        g_list_append (self->priv->state_dependent_results,
-                                       res);
-
-  g_mutex_unlock (&self->priv->dispatch_mutex);
+  request_state (self, res, 0, cancellable);
 }
 
 /**
@@ -1904,13 +4763,13 @@ gfreenect_device_get_tilt_angle_finish (GFreenectDevice  *self,
   if (! g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (result),
                                                error))
     {
-      freenect_raw_tilt_state *state = NULL;
+      GFreenectMotionState *state;
 
       state =
         g_simple_async_result_get_op_res_gpointer (G_SIMPLE_ASYNC_RESULT (result));
 
       if (state != NULL)
-        return freenect_get_tilt_degs (state);
+        return state->tilt_angle;
     }
 
   return 0.0;
@@ -1933,29 +4792,16 @@ gfreenect_device_get_tilt_angle_sync (GFreenectDevice  *self,
                                       GCancellable     *cancellable,
                                       GError          **error)
 {
-  g_return_val_if_fail (GFREENECT_IS_DEVICE (self), 0.0);
+  GFreenectMotionState state;
 
-  if (freenect_update_tilt_state (self->priv->dev) == -1)
-    {
-      g_set_error (error,
-                   G_IO_ERROR,
-                   G_IO_ERROR_FAILED,
-                   "Failed to update tilt state");
+  g_return_val_if_fail (GFREENECT_IS_DEVICE (self), 0.0);
 
-      return 0.0;
-    }
+  if (! request_state_sync (self, 0, &state, error))
+    return 0.0;
   else if (! check_cancelled (cancellable, error, "Get tilt"))
-    {
-      return 0.0;
-    }
+    return 0.0;
   else
-    {
-      freenect_raw_tilt_state *state = NULL;
-
-      state = freenect_get_tilt_state (self->priv->dev);
-
-      return freenect_get_tilt_degs (state);
-    }
+    return state.tilt_angle;
 }
 
 /**
@@ -1988,19 +4834,7 @@ gfreenect_device_get_accel (GFreenectDevice     *self,
                                    user_data,
                                    gfreenect_device_get_accel);
 
-  if (cancellable != NULL)
-    g_signal_connect (cancellable,
-                      "cancelled",
-                      G_CALLBACK (on_get_tilt_cancelled),
-                      res);
-
-  g_mutex_lock (&self->priv->dispatch_mutex);
-
-  self->priv->state_dependent_results =
-                        g_list_append (self->priv->state_dependent_results,
-                                       res);
-
-  g_mutex_unlock (&self->priv->dispatch_mutex);
+  request_state (self, res, 0, cancellable);
 }
 
 /**
@@ -2034,14 +4868,14 @@ gfreenect_device_get_accel_finish (GFreenectDevice  *self,
   if (! g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (result),
                                                error))
     {
-      freenect_raw_tilt_state *state = NULL;
+      GFreenectMotionState *state;
 
       state =
         g_simple_async_result_get_op_res_gpointer (G_SIMPLE_ASYNC_RESULT (result));
 
-      *x = state->accelerometer_x;
-      *y = state->accelerometer_y;
-      *z = state->accelerometer_z;
+      *x = state->accel_x;
+      *y = state->accel_y;
+      *z = state->accel_z;
 
       return TRUE;
     }
@@ -2071,26 +4905,65 @@ gfreenect_device_get_accel_sync (GFreenectDevice  *self,
                                  GCancellable     *cancellable,
                                  GError          **error)
 {
+  GFreenectMotionState state;
+
   g_return_val_if_fail (GFREENECT_IS_DEVICE (self), FALSE);
 
-  if (freenect_update_tilt_state (self->priv->dev) == -1)
-    {
-      g_set_error (error,
-                   G_IO_ERROR,
-                   G_IO_ERROR_FAILED,
-                   "Failed to update tilt state");
-    }
-  else if (!check_cancelled (cancellable, error, "Get MKS acceleration"))
-    {
-      freenect_raw_tilt_state *state = NULL;
+  if (! request_state_sync (self, 0, &state, error) ||
+      ! check_cancelled (cancellable, error, "Get MKS acceleration"))
+    return FALSE;
 
-      state = freenect_get_tilt_state (self->priv->dev);
-      *x = state->accelerometer_x;
-      *y = state->accelerometer_y;
-      *z = state->accelerometer_z;
+  *x = state.accel_x;
+  *y = state.accel_y;
+  *z = state.accel_z;
 
-      return TRUE;
-    }
+  return TRUE;
+}
 
-  return FALSE;
+/**
+ * gfreenect_device_get_stats:
+ * @self: The #GFreenectDevice
+ * @stats: (out caller-allocates): A #GFreenectDeviceStats structure to fill
+ *
+ * Takes a snapshot of the runtime counters of the device: the rate and
+ * number of frames received and delivered by each stream, the time spent
+ * processing and converting them, and the activity of the threads talking
+ * to the device. The counters are updated with atomic operations as the
+ * device works, so this method is cheap and can be called from any thread,
+ * e.g to export them periodically to a monitoring system.
+ **/
+void
+gfreenect_device_get_stats (GFreenectDevice      *self,
+                            GFreenectDeviceStats *stats)
+{
+  GFreenectDevicePrivate *priv;
+  gint64 now;
+
+  g_return_if_fail (GFREENECT_IS_DEVICE (self));
+  g_return_if_fail (stats != NULL);
+
+  priv = self->priv;
+  now = g_get_monotonic_time ();
+
+  get_stream_stats (&priv->depth_counters, now, &stats->depth);
+  get_stream_stats (&priv->video_counters, now, &stats->video);
+  stats->audio_frames_received =
+    counter64_get (&priv->audio_frames_received);
+
+  get_conversion_stats (&priv->depth_processing_counters,
+                        &stats->depth_processing);
+  get_conversion_stats (&priv->depth_grayscale_counters,
+                        &stats->depth_grayscale);
+  get_conversion_stats (&priv->depth_registered_counters,
+                        &stats->depth_registered);
+  get_conversion_stats (&priv->video_rgb_counters, &stats->video_rgb);
+
+  stats->event_loop_iterations = priv->context != NULL ?
+    gfreenect_context_get_event_loop_iterations (priv->context) : 0;
+  stats->dispatch_wakeups =
+    (gsize) g_atomic_pointer_get (&priv->dispatch_wakeups);
+
+  g_mutex_lock (&priv->dispatch_mutex);
+  stats->pending_queries = g_queue_get_length (&priv->state_dependent_results);
+  g_mutex_unlock (&priv->dispatch_mutex);
 }
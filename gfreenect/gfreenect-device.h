@@ -28,7 +28,13 @@
 
 #include <gfreenect-decls.h>
 
+#include <gfreenect-context.h>
 #include <gfreenect-frame-mode.h>
+#include <gfreenect-depth-stats.h>
+#include <gfreenect-device-stats.h>
+#include <gfreenect-region.h>
+#include <gfreenect-motion-state.h>
+#include <gfreenect-registration.h>
 
 G_BEGIN_DECLS
 
@@ -47,6 +53,9 @@ struct _GFreenectDevice
  * GFreenectDeviceClass:
  * @depth_frame: Prototype for #GFreenectDevice::depth-frame signal
  * @video_frame: Prototype for #GFreenectDevice::video-frame signal
+ * @motion: Prototype for #GFreenectDevice::motion signal
+ * @motion_state: Prototype for #GFreenectDevice::motion-state signal
+ * @audio_samples: Prototype for #GFreenectDevice::audio-samples signal
  **/
 struct _GFreenectDeviceClass
 {
@@ -55,6 +64,12 @@ struct _GFreenectDeviceClass
   /* Signal prototypes */
   void (* depth_frame) (GFreenectDevice *self, gpointer user_data);
   void (* video_frame) (GFreenectDevice *self, gpointer user_data);
+  void (* motion)      (GFreenectDevice *self, GPtrArray *regions);
+  void (* motion_state) (GFreenectDevice *self, GFreenectMotionState *state);
+  void (* audio_samples) (GFreenectDevice *self,
+                          const gint32    *frames,
+                          guint            n_frames,
+                          gint64           timestamp);
 };
 
 #define GFREENECT_TYPE_DEVICE           (gfreenect_device_get_type ())
@@ -72,6 +87,12 @@ void              gfreenect_device_new                        (gint
                                                                GCancellable        *cancellable,
                                                                GAsyncReadyCallback  callback,
                                                                gpointer             user_data);
+void              gfreenect_device_new_with_context           (GFreenectContext    *context,
+                                                               gint                 device_index,
+                                                               guint                subdevices,
+                                                               GCancellable        *cancellable,
+                                                               GAsyncReadyCallback  callback,
+                                                               gpointer             user_data);
 GFreenectDevice * gfreenect_device_new_finish                 (GAsyncResult  *result,
                                                                GError       **error);
 
@@ -88,6 +109,40 @@ gboolean          gfreenect_device_stop_depth_stream          (GFreenectDevice
 gboolean          gfreenect_device_stop_video_stream          (GFreenectDevice  *self,
                                                                GError          **error);
 
+gboolean          gfreenect_device_start_audio_stream         (GFreenectDevice  *self,
+                                                               GError          **error);
+gboolean          gfreenect_device_stop_audio_stream          (GFreenectDevice  *self,
+                                                               GError          **error);
+guint             gfreenect_device_read_audio                 (GFreenectDevice  *self,
+                                                               gint32           *frames,
+                                                               guint             max_frames,
+                                                               gint64           *timestamp);
+
+gboolean          gfreenect_device_start_motion_stream        (GFreenectDevice  *self,
+                                                               GError          **error);
+gboolean          gfreenect_device_stop_motion_stream         (GFreenectDevice  *self,
+                                                               GError          **error);
+
+gboolean          gfreenect_device_get_motion_state           (GFreenectDevice      *self,
+                                                               GFreenectMotionState *state);
+GArray *          gfreenect_device_get_motion_states_since    (GFreenectDevice      *self,
+                                                               gint64                since);
+
+void              gfreenect_device_query_motion_state         (GFreenectDevice      *self,
+                                                               gint64                max_age,
+                                                               GCancellable         *cancellable,
+                                                               GAsyncReadyCallback   callback,
+                                                               gpointer              user_data);
+gboolean          gfreenect_device_query_motion_state_finish  (GFreenectDevice       *self,
+                                                               GAsyncResult          *result,
+                                                               GFreenectMotionState  *state,
+                                                               GError               **error);
+gboolean          gfreenect_device_query_motion_state_sync    (GFreenectDevice       *self,
+                                                               gint64                 max_age,
+                                                               GFreenectMotionState  *state,
+                                                               GCancellable          *cancellable,
+                                                               GError               **error);
+
 void              gfreenect_device_set_led                    (GFreenectDevice     *self,
                                                                GFreenectLed         led,
                                                                GCancellable        *cancellable,
@@ -100,6 +155,11 @@ gboolean          gfreenect_device_set_led_finish             (GFreenectDevice
 guint8 *          gfreenect_device_get_depth_frame_raw        (GFreenectDevice    *self,
                                                                gsize              *len,
                                                                GFreenectFrameMode *frame_mode);
+guint8 *          gfreenect_device_get_depth_pyramid_level    (GFreenectDevice    *self,
+                                                               guint               level,
+                                                               gsize              *len,
+                                                               GFreenectFrameMode *frame_mode);
+
 guint8 *          gfreenect_device_get_video_frame_raw        (GFreenectDevice    *self,
                                                                gsize              *len,
                                                                GFreenectFrameMode *frame_mode);
@@ -112,6 +172,42 @@ guint8 *          gfreenect_device_get_video_frame_rgb        (GFreenectDevice
                                                                gsize              *len,
                                                                GFreenectFrameMode *frame_mode);
 
+guint8 *          gfreenect_device_get_depth_frame_registered (GFreenectDevice    *self,
+                                                               gsize              *len,
+                                                               GFreenectFrameMode *frame_mode);
+
+guint8 *          gfreenect_device_get_depth_frame_filtered   (GFreenectDevice    *self,
+                                                               gsize              *len,
+                                                               GFreenectFrameMode *frame_mode);
+
+gboolean          gfreenect_device_get_depth_stats            (GFreenectDevice     *self,
+                                                               GFreenectDepthStats *stats);
+const guint32 *   gfreenect_device_get_depth_histogram        (GFreenectDevice     *self,
+                                                               guint               *bin_shift);
+
+gboolean          gfreenect_device_get_depth_frame_motion_state (GFreenectDevice      *self,
+                                                                 GFreenectMotionState *state);
+gboolean          gfreenect_device_get_video_frame_motion_state (GFreenectDevice      *self,
+                                                                 GFreenectMotionState *state);
+
+void              gfreenect_device_set_depth_bands            (GFreenectDevice     *self,
+                                                               guint                n_bands,
+                                                               const guint         *near,
+                                                               const guint         *far);
+const guint8 *    gfreenect_device_get_depth_band             (GFreenectDevice     *self,
+                                                               guint                band,
+                                                               GFreenectRegion     *bounds,
+                                                               gsize               *pixels,
+                                                               gsize               *len);
+
+GFreenectRegistration *
+                  gfreenect_device_get_registration           (GFreenectDevice *self);
+
+void              gfreenect_device_set_depth_roi              (GFreenectDevice       *self,
+                                                               const GFreenectRegion *roi);
+void              gfreenect_device_set_video_roi              (GFreenectDevice       *self,
+                                                               const GFreenectRegion *roi);
+
 void              gfreenect_device_set_tilt_angle             (GFreenectDevice     *self,
                                                                gdouble              tilt_angle,
                                                                GCancellable        *cancellable,
@@ -151,6 +247,9 @@ gboolean          gfreenect_device_get_accel_sync             (GFreenectDevice
                                                                GCancellable     *cancellable,
                                                                GError          **error);
 
+void              gfreenect_device_get_stats                  (GFreenectDevice      *self,
+                                                               GFreenectDeviceStats *stats);
+
 G_END_DECLS
 
 #endif /* __GFREENECT_DEVICE_H__ */
@@ -0,0 +1,833 @@
+/*
+ * gfreenect-floor-estimator.c
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+/**
+ * SECTION:gfreenect-floor-estimator
+ * @short_description: Tracks the floor plane using depth and gravity
+ *
+ * A #GFreenectFloorEstimator finds the plane of the floor in depth frames.
+ * The orientation of the floor is known beforehand from the gravity vector
+ * measured by the accelerometer, which gfreenect_floor_estimator_set_gravity()
+ * takes as returned by gfreenect_device_get_accel(). This leaves only the
+ * height of the plane to search for, which a few RANSAC iterations over a
+ * subsampled set of points find quickly. The plane is then refined with a
+ * least squares fit that may tilt it slightly, up to
+ * #GFreenectFloorEstimator:max-tilt degrees, to correct the accelerometer.
+ *
+ * Once found, the plane is tracked from frame to frame, so RANSAC only runs
+ * again when the previous plane no longer fits the depth frame.
+ *
+ * After each call to gfreenect_floor_estimator_process(), the plane is
+ * retrieved with gfreenect_floor_estimator_get_plane(), a mask of the
+ * pixels above the floor with gfreenect_floor_estimator_get_mask(), and the
+ * point cloud of the frame in floor coordinates with
+ * gfreenect_floor_estimator_get_aligned_points().
+ **/
+
+#include <string.h>
+#include <math.h>
+
+#include "gfreenect-floor-estimator.h"
+#include "gfreenect-parallel.h"
+
+#define GFREENECT_FLOOR_ESTIMATOR_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), \
+                                                    GFREENECT_TYPE_FLOOR_ESTIMATOR, \
+                                                    GFreenectFloorEstimatorPrivate))
+
+#define WIDTH                    GFREENECT_REGISTRATION_WIDTH
+#define HEIGHT                   GFREENECT_REGISTRATION_HEIGHT
+#define PIXELS                   (WIDTH * HEIGHT)
+
+#define DEFAULT_INLIER_THRESHOLD 30.0
+#define DEFAULT_MAX_TILT         10.0
+#define DEFAULT_ITERATIONS       32
+
+/* one point out of SAMPLE_STEP x SAMPLE_STEP pixels is used for fitting */
+#define SAMPLE_STEP              8
+#define MAX_SAMPLES              ((WIDTH / SAMPLE_STEP) * (HEIGHT / SAMPLE_STEP))
+
+/* fraction of the samples a plane must explain to be the floor */
+#define MIN_INLIER_FRACTION      0.05
+
+/* weight of the new estimate when tracking the plane */
+#define TRACKING_RATE            0.3
+
+/* gravity changes larger than this, in degrees, discard the tracked plane */
+#define GRAVITY_RESET_ANGLE      2.0
+
+#define MIN_ROWS_PER_CHUNK       32
+
+/* private data */
+struct _GFreenectFloorEstimatorPrivate
+{
+  GFreenectRegistration *registration;
+
+  gdouble inlier_threshold;
+  gdouble max_tilt;
+  guint iterations;
+
+  gdouble up[3];
+
+  gboolean has_plane;
+  gdouble normal[3];
+  gdouble offset;
+
+  GRand *rand;
+
+  gfloat *points;
+  gfloat *samples;
+  guint n_samples;
+  guint8 *mask;
+  gboolean has_frame;
+};
+
+typedef struct
+{
+  GFreenectFloorEstimatorPrivate *priv;
+  gfloat *dst;
+  gdouble x_axis[3];
+  gdouble z_axis[3];
+} RowsJob;
+
+/* properties */
+enum
+{
+  PROP_0,
+  PROP_REGISTRATION,
+  PROP_INLIER_THRESHOLD,
+  PROP_MAX_TILT,
+  PROP_ITERATIONS
+};
+
+static void     gfreenect_floor_estimator_class_init         (GFreenectFloorEstimatorClass *class);
+static void     gfreenect_floor_estimator_init               (GFreenectFloorEstimator *self);
+static void     gfreenect_floor_estimator_finalize           (GObject *obj);
+
+static void     gfreenect_floor_estimator_set_property       (GObject      *obj,
+                                                              guint         prop_id,
+                                                              const GValue *value,
+                                                              GParamSpec   *pspec);
+static void     gfreenect_floor_estimator_get_property       (GObject    *obj,
+                                                              guint       prop_id,
+                                                              GValue     *value,
+                                                              GParamSpec *pspec);
+
+G_DEFINE_TYPE (GFreenectFloorEstimator, gfreenect_floor_estimator, G_TYPE_OBJECT);
+
+static void
+gfreenect_floor_estimator_class_init (GFreenectFloorEstimatorClass *class)
+{
+  GObjectClass *obj_class;
+
+  obj_class = G_OBJECT_CLASS (class);
+
+  obj_class->finalize = gfreenect_floor_estimator_finalize;
+  obj_class->get_property = gfreenect_floor_estimator_get_property;
+  obj_class->set_property = gfreenect_floor_estimator_set_property;
+
+  /* install properties */
+
+  /**
+   * GFreenectFloorEstimator:registration
+   *
+   * The #GFreenectRegistration used to project depth frames to world
+   * coordinates.
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_REGISTRATION,
+                                   g_param_spec_boxed ("registration",
+                                                       "Registration",
+                                                       "Registration used to compute world coordinates",
+                                                       GFREENECT_TYPE_REGISTRATION,
+                                                       G_PARAM_READWRITE |
+                                                       G_PARAM_CONSTRUCT_ONLY |
+                                                       G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GFreenectFloorEstimator:inlier-threshold
+   *
+   * The largest distance, in millimeters, from a point to the plane for the
+   * point to be considered part of the floor.
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_INLIER_THRESHOLD,
+                                   g_param_spec_double ("inlier-threshold",
+                                                        "Inlier threshold",
+                                                        "Largest distance from a floor point to the plane",
+                                                        1.0,
+                                                        1000.0,
+                                                        DEFAULT_INLIER_THRESHOLD,
+                                                        G_PARAM_READWRITE |
+                                                        G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GFreenectFloorEstimator:max-tilt
+   *
+   * The largest angle, in degrees, between the floor normal and the
+   * direction opposite to gravity.
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_MAX_TILT,
+                                   g_param_spec_double ("max-tilt",
+                                                        "Maximum tilt",
+                                                        "Largest angle between the floor normal and gravity",
+                                                        0.0,
+                                                        45.0,
+                                                        DEFAULT_MAX_TILT,
+                                                        G_PARAM_READWRITE |
+                                                        G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GFreenectFloorEstimator:iterations
+   *
+   * The number of RANSAC hypotheses tried when searching for the floor.
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_ITERATIONS,
+                                   g_param_spec_uint ("iterations",
+                                                      "Iterations",
+                                                      "Number of RANSAC hypotheses",
+                                                      1,
+                                                      1024,
+                                                      DEFAULT_ITERATIONS,
+                                                      G_PARAM_READWRITE |
+                                                      G_PARAM_STATIC_STRINGS));
+
+  /* add private structure */
+  g_type_class_add_private (obj_class, sizeof (GFreenectFloorEstimatorPrivate));
+}
+
+static void
+gfreenect_floor_estimator_init (GFreenectFloorEstimator *self)
+{
+  GFreenectFloorEstimatorPrivate *priv;
+
+  priv = GFREENECT_FLOOR_ESTIMATOR_GET_PRIVATE (self);
+  self->priv = priv;
+
+  priv->registration = NULL;
+
+  priv->inlier_threshold = DEFAULT_INLIER_THRESHOLD;
+  priv->max_tilt = DEFAULT_MAX_TILT;
+  priv->iterations = DEFAULT_ITERATIONS;
+
+  /* with no gravity measurement, assume a level sensor: world Y points
+     down in camera coordinates */
+  priv->up[0] = 0.0;
+  priv->up[1] = -1.0;
+  priv->up[2] = 0.0;
+
+  priv->has_plane = FALSE;
+
+  priv->rand = g_rand_new ();
+
+  priv->points = g_new (gfloat, PIXELS * 3);
+  priv->samples = g_new (gfloat, MAX_SAMPLES * 3);
+  priv->n_samples = 0;
+  priv->mask = g_new0 (guint8, PIXELS);
+  priv->has_frame = FALSE;
+}
+
+static void
+gfreenect_floor_estimator_finalize (GObject *obj)
+{
+  GFreenectFloorEstimator *self = GFREENECT_FLOOR_ESTIMATOR (obj);
+
+  if (self->priv->registration != NULL)
+    gfreenect_registration_unref (self->priv->registration);
+
+  g_rand_free (self->priv->rand);
+
+  g_free (self->priv->points);
+  g_free (self->priv->samples);
+  g_free (self->priv->mask);
+
+  G_OBJECT_CLASS (gfreenect_floor_estimator_parent_class)->finalize (obj);
+}
+
+static void
+gfreenect_floor_estimator_set_property (GObject      *obj,
+                                        guint         prop_id,
+                                        const GValue *value,
+                                        GParamSpec   *pspec)
+{
+  GFreenectFloorEstimator *self;
+
+  self = GFREENECT_FLOOR_ESTIMATOR (obj);
+
+  switch (prop_id)
+    {
+    case PROP_REGISTRATION:
+      self->priv->registration = g_value_dup_boxed (value);
+      break;
+
+    case PROP_INLIER_THRESHOLD:
+      self->priv->inlier_threshold = g_value_get_double (value);
+      break;
+
+    case PROP_MAX_TILT:
+      self->priv->max_tilt = g_value_get_double (value);
+      break;
+
+    case PROP_ITERATIONS:
+      self->priv->iterations = g_value_get_uint (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (obj, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+gfreenect_floor_estimator_get_property (GObject    *obj,
+                                        guint       prop_id,
+                                        GValue     *value,
+                                        GParamSpec *pspec)
+{
+  GFreenectFloorEstimator *self;
+
+  self = GFREENECT_FLOOR_ESTIMATOR (obj);
+
+  switch (prop_id)
+    {
+    case PROP_REGISTRATION:
+      g_value_set_boxed (value, self->priv->registration);
+      break;
+
+    case PROP_INLIER_THRESHOLD:
+      g_value_set_double (value, self->priv->inlier_threshold);
+      break;
+
+    case PROP_MAX_TILT:
+      g_value_set_double (value, self->priv->max_tilt);
+      break;
+
+    case PROP_ITERATIONS:
+      g_value_set_uint (value, self->priv->iterations);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (obj, prop_id, pspec);
+      break;
+    }
+}
+
+static inline gdouble
+dot (const gdouble *a, const gfloat *p)
+{
+  return a[0] * p[0] + a[1] * p[1] + a[2] * p[2];
+}
+
+static void
+normalize (gdouble *v)
+{
+  gdouble len;
+
+  len = sqrt (v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+  if (len == 0.0)
+    return;
+
+  v[0] /= len;
+  v[1] /= len;
+  v[2] /= len;
+}
+
+static void
+cross (const gdouble *a, const gdouble *b, gdouble *dest)
+{
+  dest[0] = a[1] * b[2] - a[2] * b[1];
+  dest[1] = a[2] * b[0] - a[0] * b[2];
+  dest[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+static void
+collect_samples (GFreenectFloorEstimatorPrivate *priv)
+{
+  guint x, y;
+
+  priv->n_samples = 0;
+
+  for (y = SAMPLE_STEP / 2; y < HEIGHT; y += SAMPLE_STEP)
+    for (x = SAMPLE_STEP / 2; x < WIDTH; x += SAMPLE_STEP)
+      {
+        const gfloat *p = priv->points + (y * WIDTH + x) * 3;
+
+        if (p[2] <= 0.0f)
+          continue;
+
+        memcpy (priv->samples + priv->n_samples * 3, p, 3 * sizeof (gfloat));
+        priv->n_samples++;
+      }
+}
+
+static guint
+count_inliers (GFreenectFloorEstimatorPrivate *priv,
+               const gdouble                  *normal,
+               gdouble                         offset)
+{
+  guint count = 0;
+  guint i;
+
+  for (i = 0; i < priv->n_samples; i++)
+    count += fabs (dot (normal, priv->samples + i * 3) + offset) <= priv->inlier_threshold;
+
+  return count;
+}
+
+/* With the orientation given by gravity, a single point defines a
+   hypothesis. The floor is the lowest plane that explains enough points,
+   which keeps table tops and other horizontal surfaces from winning. */
+static gboolean
+search_plane (GFreenectFloorEstimatorPrivate *priv,
+              guint                           min_inliers,
+              gdouble                        *offset)
+{
+  gboolean found = FALSE;
+  gdouble best_height = G_MAXDOUBLE;
+  guint i;
+
+  for (i = 0; i < priv->iterations; i++)
+    {
+      const gfloat *p;
+      gdouble height;
+
+      p = priv->samples + g_rand_int_range (priv->rand, 0, priv->n_samples) * 3;
+      height = dot (priv->up, p);
+
+      if (height >= best_height)
+        continue;
+
+      if (count_inliers (priv, priv->up, -height) >= min_inliers)
+        {
+          best_height = height;
+          found = TRUE;
+        }
+    }
+
+  if (found)
+    *offset = -best_height;
+
+  return found;
+}
+
+/* Least squares fit of the heights of the inliers of a plane as a linear
+   function of their coordinates along two horizontal axes, which tilts the
+   normal away from the gravity direction by the fitted slopes. */
+static gboolean
+refine_plane (GFreenectFloorEstimatorPrivate *priv,
+              gdouble                        *normal,
+              gdouble                        *offset)
+{
+  gdouble e1[3], e2[3], ref[3] = { 0.0, 0.0, 1.0 };
+  gdouble suu = 0, suv = 0, svv = 0, su = 0, sv = 0, n = 0;
+  gdouble suh = 0, svh = 0, sh = 0;
+  gdouble det, a, b, c;
+  gdouble refined[3];
+  guint i;
+
+  if (fabs (priv->up[2]) > 0.9)
+    {
+      ref[0] = 1.0;
+      ref[2] = 0.0;
+    }
+
+  cross (priv->up, ref, e1);
+  normalize (e1);
+  cross (priv->up, e1, e2);
+
+  for (i = 0; i < priv->n_samples; i++)
+    {
+      const gfloat *p = priv->samples + i * 3;
+      gdouble u, v, h;
+
+      if (fabs (dot (normal, p) + *offset) > priv->inlier_threshold)
+        continue;
+
+      u = dot (e1, p);
+      v = dot (e2, p);
+      h = dot (priv->up, p);
+
+      suu += u * u;
+      suv += u * v;
+      svv += v * v;
+      su += u;
+      sv += v;
+      n += 1.0;
+      suh += u * h;
+      svh += v * h;
+      sh += h;
+    }
+
+  if (n < 3.0)
+    return FALSE;
+
+  /* Cramer's rule on the normal equations */
+  det = suu * (svv * n - sv * sv) - suv * (suv * n - sv * su) + su * (suv * sv - svv * su);
+  if (fabs (det) < 1e-9)
+    return FALSE;
+
+  a = (suh * (svv * n - sv * sv) - suv * (svh * n - sv * sh) + su * (svh * sv - svv * sh)) / det;
+  b = (suu * (svh * n - sh * sv) - suh * (suv * n - sv * su) + su * (suv * sh - svh * su)) / det;
+  c = (suu * (svv * sh - sv * svh) - suv * (suv * sh - svh * su) + suh * (suv * sv - svv * su)) / det;
+
+  /* up . p - a e1 . p - b e2 . p - c = 0 */
+  for (i = 0; i < 3; i++)
+    refined[i] = priv->up[i] - a * e1[i] - b * e2[i];
+
+  det = sqrt (refined[0] * refined[0] + refined[1] * refined[1] + refined[2] * refined[2]);
+
+  /* reject fits that contradict the accelerometer */
+  if (acos (CLAMP ((refined[0] * priv->up[0] + refined[1] * priv->up[1] + refined[2] * priv->up[2]) / det, -1.0, 1.0)) >
+      priv->max_tilt * G_PI / 180.0)
+    {
+      return FALSE;
+    }
+
+  for (i = 0; i < 3; i++)
+    normal[i] = refined[i] / det;
+  *offset = -c / det;
+
+  return TRUE;
+}
+
+static void
+mask_rows (guint first, guint last, gpointer user_data)
+{
+  RowsJob *job = user_data;
+  GFreenectFloorEstimatorPrivate *priv = job->priv;
+  guint i;
+
+  for (i = first * WIDTH; i < last * WIDTH; i++)
+    {
+      const gfloat *p = priv->points + i * 3;
+
+      priv->mask[i] = p[2] > 0.0f &&
+        dot (priv->normal, p) + priv->offset > priv->inlier_threshold;
+    }
+}
+
+static void
+align_rows (guint first, guint last, gpointer user_data)
+{
+  RowsJob *job = user_data;
+  GFreenectFloorEstimatorPrivate *priv = job->priv;
+  guint i;
+
+  for (i = first * WIDTH; i < last * WIDTH; i++)
+    {
+      const gfloat *p = priv->points + i * 3;
+      gfloat *q = job->dst + i * 3;
+
+      if (p[2] <= 0.0f)
+        {
+          q[0] = q[1] = q[2] = NAN;
+          continue;
+        }
+
+      q[0] = dot (job->x_axis, p);
+      q[1] = dot (priv->normal, p) + priv->offset;
+      q[2] = dot (job->z_axis, p);
+    }
+}
+
+/* public methods */
+
+/**
+ * gfreenect_floor_estimator_new:
+ * @registration: The #GFreenectRegistration of the device the frames come
+ * from
+ *
+ * Creates a new #GFreenectFloorEstimator. See
+ * gfreenect_device_get_registration() to obtain @registration.
+ *
+ * Returns: (transfer full): A newly created #GFreenectFloorEstimator. Use
+ * g_object_unref() to free it.
+ **/
+GFreenectFloorEstimator *
+gfreenect_floor_estimator_new (GFreenectRegistration *registration)
+{
+  g_return_val_if_fail (registration != NULL, NULL);
+
+  return g_object_new (GFREENECT_TYPE_FLOOR_ESTIMATOR,
+                       "registration", registration,
+                       NULL);
+}
+
+/**
+ * gfreenect_floor_estimator_set_gravity:
+ * @self: The #GFreenectFloorEstimator
+ * @x: The X-axis value of the accelerometer
+ * @y: The Y-axis value of the accelerometer
+ * @z: The Z-axis value of the accelerometer
+ *
+ * Sets the gravity vector, as measured by the accelerometer of the sensor
+ * and returned by gfreenect_device_get_accel(). Only the direction of the
+ * vector is used, so its units do not matter. It should be updated whenever
+ * the sensor is tilted; large changes make the estimator search for the
+ * floor again.
+ **/
+void
+gfreenect_floor_estimator_set_gravity (GFreenectFloorEstimator *self,
+                                       gdouble                  x,
+                                       gdouble                  y,
+                                       gdouble                  z)
+{
+  gdouble up[3];
+  gdouble cos_angle;
+
+  g_return_if_fail (GFREENECT_IS_FLOOR_ESTIMATOR (self));
+
+  /* the accelerometer measures the reaction to gravity, which points up
+     along the camera's Y axis when the sensor is level */
+  up[0] = x;
+  up[1] = -y;
+  up[2] = z;
+
+  if (up[0] == 0.0 && up[1] == 0.0 && up[2] == 0.0)
+    return;
+
+  normalize (up);
+
+  cos_angle = up[0] * self->priv->up[0] +
+    up[1] * self->priv->up[1] +
+    up[2] * self->priv->up[2];
+
+  if (cos_angle < cos (GRAVITY_RESET_ANGLE * G_PI / 180.0))
+    self->priv->has_plane = FALSE;
+
+  memcpy (self->priv->up, up, sizeof (up));
+}
+
+/**
+ * gfreenect_floor_estimator_process:
+ * @self: The #GFreenectFloorEstimator
+ * @depth_mm: (array fixed-size=307200): A 640x480 unregistered depth frame,
+ * in millimeters
+ *
+ * Finds the floor plane in a new depth frame, starting from the plane found
+ * in the previous frame if there is one, and computes the mask returned by
+ * gfreenect_floor_estimator_get_mask().
+ *
+ * Returns: %TRUE if the floor was found, %FALSE otherwise.
+ **/
+gboolean
+gfreenect_floor_estimator_process (GFreenectFloorEstimator *self,
+                                   const guint16           *depth_mm)
+{
+  GFreenectFloorEstimatorPrivate *priv;
+  gdouble normal[3];
+  gdouble offset;
+  guint min_inliers;
+  RowsJob job;
+  guint i;
+
+  g_return_val_if_fail (GFREENECT_IS_FLOOR_ESTIMATOR (self), FALSE);
+  g_return_val_if_fail (depth_mm != NULL, FALSE);
+
+  priv = self->priv;
+
+  gfreenect_registration_depth_to_points (priv->registration,
+                                          depth_mm,
+                                          priv->points);
+  priv->has_frame = TRUE;
+
+  collect_samples (priv);
+  min_inliers = MAX (priv->n_samples * MIN_INLIER_FRACTION, 3);
+
+  /* keep tracking the previous plane while it still fits */
+  if (priv->has_plane &&
+      count_inliers (priv, priv->normal, priv->offset) >= min_inliers)
+    {
+      memcpy (normal, priv->normal, sizeof (normal));
+      offset = priv->offset;
+    }
+  else
+    {
+      priv->has_plane = FALSE;
+
+      if (priv->n_samples == 0 || ! search_plane (priv, min_inliers, &offset))
+        {
+          memset (priv->mask, 0, PIXELS);
+          return FALSE;
+        }
+
+      memcpy (normal, priv->up, sizeof (normal));
+    }
+
+  if (! refine_plane (priv, normal, &offset) && ! priv->has_plane)
+    {
+      /* keep the gravity aligned hypothesis */
+      memcpy (normal, priv->up, sizeof (normal));
+    }
+
+  if (priv->has_plane)
+    {
+      gdouble len;
+
+      for (i = 0; i < 3; i++)
+        priv->normal[i] += TRACKING_RATE * (normal[i] - priv->normal[i]);
+      priv->offset += TRACKING_RATE * (offset - priv->offset);
+
+      /* scale the whole equation, so the normal stays a unit vector */
+      len = sqrt (priv->normal[0] * priv->normal[0] +
+                  priv->normal[1] * priv->normal[1] +
+                  priv->normal[2] * priv->normal[2]);
+      for (i = 0; i < 3; i++)
+        priv->normal[i] /= len;
+      priv->offset /= len;
+    }
+  else
+    {
+      memcpy (priv->normal, normal, sizeof (normal));
+      priv->offset = offset;
+      priv->has_plane = TRUE;
+    }
+
+  job.priv = priv;
+  gfreenect_parallel_for (HEIGHT, MIN_ROWS_PER_CHUNK, mask_rows, &job);
+
+  return TRUE;
+}
+
+/**
+ * gfreenect_floor_estimator_get_plane:
+ * @self: The #GFreenectFloorEstimator
+ * @a: (out) (allow-none): Location to store the X component of the normal
+ * @b: (out) (allow-none): Location to store the Y component of the normal
+ * @c: (out) (allow-none): Location to store the Z component of the normal
+ * @d: (out) (allow-none): Location to store the offset of the plane, in
+ * millimeters
+ *
+ * Retrieves the floor plane found by the last call to
+ * gfreenect_floor_estimator_process(), as the equation
+ * a * x + b * y + c * z + d = 0 in the world coordinates of
+ * gfreenect_registration_depth_to_points(). The normal (a, b, c) is a unit
+ * vector pointing up, so the left hand side of the equation is the height
+ * of a point above the floor.
+ *
+ * Returns: %TRUE if a plane is available, %FALSE otherwise.
+ **/
+gboolean
+gfreenect_floor_estimator_get_plane (GFreenectFloorEstimator *self,
+                                     gdouble                 *a,
+                                     gdouble                 *b,
+                                     gdouble                 *c,
+                                     gdouble                 *d)
+{
+  g_return_val_if_fail (GFREENECT_IS_FLOOR_ESTIMATOR (self), FALSE);
+
+  if (! self->priv->has_plane)
+    return FALSE;
+
+  if (a != NULL)
+    *a = self->priv->normal[0];
+  if (b != NULL)
+    *b = self->priv->normal[1];
+  if (c != NULL)
+    *c = self->priv->normal[2];
+  if (d != NULL)
+    *d = self->priv->offset;
+
+  return TRUE;
+}
+
+/**
+ * gfreenect_floor_estimator_get_mask:
+ * @self: The #GFreenectFloorEstimator
+ *
+ * Retrieves the floor-removed mask of the frame given to the last call to
+ * gfreenect_floor_estimator_process(). Pixels with depth information that
+ * lie above the floor by more than #GFreenectFloorEstimator:inlier-threshold
+ * are 1, and the floor and pixels with no depth information are 0. When no
+ * floor was found, all pixels are 0.
+ *
+ * Returns: (array fixed-size=307200) (transfer none): The 640x480 mask.
+ **/
+const guint8 *
+gfreenect_floor_estimator_get_mask (GFreenectFloorEstimator *self)
+{
+  g_return_val_if_fail (GFREENECT_IS_FLOOR_ESTIMATOR (self), NULL);
+
+  return self->priv->mask;
+}
+
+/**
+ * gfreenect_floor_estimator_get_aligned_points:
+ * @self: The #GFreenectFloorEstimator
+ * @points: (out caller-allocates) (array fixed-size=921600): Location to
+ * store 640x480 triplets of X, Y and Z coordinates
+ *
+ * Projects the frame given to the last call to
+ * gfreenect_floor_estimator_process() to a gravity aligned coordinate
+ * system, in millimeters: Y is the height above the floor, X points to the
+ * right of the sensor along the floor, and Z points from the scene towards
+ * the sensor. Pixels with no depth information produce NaN coordinates.
+ *
+ * Returns: %TRUE if @points was filled, %FALSE if no floor is available.
+ **/
+gboolean
+gfreenect_floor_estimator_get_aligned_points (GFreenectFloorEstimator *self,
+                                              gfloat                  *points)
+{
+  GFreenectFloorEstimatorPrivate *priv;
+  RowsJob job;
+  gdouble dot_x;
+
+  g_return_val_if_fail (GFREENECT_IS_FLOOR_ESTIMATOR (self), FALSE);
+  g_return_val_if_fail (points != NULL, FALSE);
+
+  priv = self->priv;
+
+  if (! priv->has_plane || ! priv->has_frame)
+    return FALSE;
+
+  /* camera X projected onto the floor */
+  dot_x = priv->normal[0];
+  job.x_axis[0] = 1.0 - priv->normal[0] * dot_x;
+  job.x_axis[1] = - priv->normal[1] * dot_x;
+  job.x_axis[2] = - priv->normal[2] * dot_x;
+  normalize (job.x_axis);
+
+  cross (job.x_axis, priv->normal, job.z_axis);
+
+  job.priv = priv;
+  job.dst = points;
+
+  gfreenect_parallel_for (HEIGHT, MIN_ROWS_PER_CHUNK, align_rows, &job);
+
+  return TRUE;
+}
+
+/**
+ * gfreenect_floor_estimator_reset:
+ * @self: The #GFreenectFloorEstimator
+ *
+ * Forgets the tracked plane, so that the next call to
+ * gfreenect_floor_estimator_process() searches for the floor from scratch.
+ **/
+void
+gfreenect_floor_estimator_reset (GFreenectFloorEstimator *self)
+{
+  g_return_if_fail (GFREENECT_IS_FLOOR_ESTIMATOR (self));
+
+  self->priv->has_plane = FALSE;
+}
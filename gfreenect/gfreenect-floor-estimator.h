@@ -0,0 +1,82 @@
+/*
+ * gfreenect-floor-estimator.h
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+#ifndef __GFREENECT_FLOOR_ESTIMATOR_H__
+#define __GFREENECT_FLOOR_ESTIMATOR_H__
+
+#include <glib.h>
+#include <glib-object.h>
+
+#include <gfreenect-registration.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GFreenectFloorEstimator GFreenectFloorEstimator;
+typedef struct _GFreenectFloorEstimatorClass GFreenectFloorEstimatorClass;
+typedef struct _GFreenectFloorEstimatorPrivate GFreenectFloorEstimatorPrivate;
+
+struct _GFreenectFloorEstimator
+{
+  GObject parent;
+
+  GFreenectFloorEstimatorPrivate *priv;
+};
+
+struct _GFreenectFloorEstimatorClass
+{
+  GObjectClass parent_class;
+};
+
+#define GFREENECT_TYPE_FLOOR_ESTIMATOR           (gfreenect_floor_estimator_get_type ())
+#define GFREENECT_FLOOR_ESTIMATOR(obj)           (G_TYPE_CHECK_INSTANCE_CAST ((obj), GFREENECT_TYPE_FLOOR_ESTIMATOR, GFreenectFloorEstimator))
+#define GFREENECT_FLOOR_ESTIMATOR_CLASS(obj)     (G_TYPE_CHECK_CLASS_CAST ((obj), GFREENECT_TYPE_FLOOR_ESTIMATOR, GFreenectFloorEstimatorClass))
+#define GFREENECT_IS_FLOOR_ESTIMATOR(obj)        (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GFREENECT_TYPE_FLOOR_ESTIMATOR))
+#define GFREENECT_IS_FLOOR_ESTIMATOR_CLASS(obj)  (G_TYPE_CHECK_CLASS_TYPE ((obj), GFREENECT_TYPE_FLOOR_ESTIMATOR))
+#define GFREENECT_FLOOR_ESTIMATOR_GET_CLASS(obj) (G_TYPE_INSTANCE_GET_CLASS ((obj), GFREENECT_TYPE_FLOOR_ESTIMATOR, GFreenectFloorEstimatorClass))
+
+GType                     gfreenect_floor_estimator_get_type           (void) G_GNUC_CONST;
+
+GFreenectFloorEstimator * gfreenect_floor_estimator_new                (GFreenectRegistration *registration);
+
+void                      gfreenect_floor_estimator_set_gravity        (GFreenectFloorEstimator *self,
+                                                                        gdouble                  x,
+                                                                        gdouble                  y,
+                                                                        gdouble                  z);
+
+gboolean                  gfreenect_floor_estimator_process            (GFreenectFloorEstimator *self,
+                                                                        const guint16           *depth_mm);
+
+gboolean                  gfreenect_floor_estimator_get_plane          (GFreenectFloorEstimator *self,
+                                                                        gdouble                 *a,
+                                                                        gdouble                 *b,
+                                                                        gdouble                 *c,
+                                                                        gdouble                 *d);
+
+const guint8 *            gfreenect_floor_estimator_get_mask           (GFreenectFloorEstimator *self);
+
+gboolean                  gfreenect_floor_estimator_get_aligned_points (GFreenectFloorEstimator *self,
+                                                                        gfloat                  *points);
+
+void                      gfreenect_floor_estimator_reset              (GFreenectFloorEstimator *self);
+
+G_END_DECLS
+
+#endif /* __GFREENECT_FLOOR_ESTIMATOR_H__ */
@@ -0,0 +1,38 @@
+/*
+ * gfreenect-metrics-exporter-private.h
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+
+#ifndef __GFREENECT_METRICS_EXPORTER_PRIVATE_H__
+#define __GFREENECT_METRICS_EXPORTER_PRIVATE_H__
+
+#include <glib.h>
+
+#include "gfreenect-device-stats.h"
+
+G_BEGIN_DECLS
+
+gchar *gfreenect_metrics_exporter_render_stats (guint                       n_devices,
+                                                const gchar * const        *names,
+                                                const GFreenectDeviceStats *stats);
+
+G_END_DECLS
+
+#endif /* __GFREENECT_METRICS_EXPORTER_PRIVATE_H__ */
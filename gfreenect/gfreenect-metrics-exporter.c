@@ -0,0 +1,929 @@
+/*
+ * gfreenect-metrics-exporter.c
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+
+/**
+ * SECTION:gfreenect-metrics-exporter
+ * @short_description: Serves the statistics of devices to Prometheus
+ *
+ * A #GFreenectMetricsExporter publishes the #GFreenectDeviceStats of a set
+ * of devices in the Prometheus text exposition format, so that the
+ * performance of capture nodes can be scraped centrally. Devices are added
+ * with gfreenect_metrics_exporter_add_device(), under a name that becomes
+ * the <literal>device</literal> label of their samples.
+ *
+ * gfreenect_metrics_exporter_listen_port() serves the metrics over HTTP on
+ * a loopback port, at <literal>/metrics</literal>, while
+ * gfreenect_metrics_exporter_listen_unix() writes them to every client
+ * connecting to a Unix socket and closes the connection. Clients are
+ * handled in threads of their own, and the statistics are read from the
+ * atomic counters of the devices, so the exporter adds no work to the frame
+ * path nor to the main loop. gfreenect_metrics_exporter_render() returns
+ * the same text without any socket.
+ *
+ * For instance, with the exporter listening on port 9300:
+ * <informalexample><programlisting>
+ * $ curl http://127.0.0.1:9300/metrics
+ * # HELP gfreenect_frames_received_total Frames received from the device.
+ * # TYPE gfreenect_frames_received_total counter
+ * gfreenect_frames_received_total{device="kinect0",stream="depth"} 1812
+ * ...
+ * </programlisting></informalexample>
+ **/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#include <glib/gstdio.h>
+#include <gio/gio.h>
+
+#ifdef HAVE_GIO_UNIX
+#include <gio/gunixsocketaddress.h>
+#endif
+
+#include "gfreenect-metrics-exporter.h"
+#include "gfreenect-metrics-exporter-private.h"
+
+#define GFREENECT_METRICS_EXPORTER_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), \
+                                                     GFREENECT_TYPE_METRICS_EXPORTER, \
+                                                     GFreenectMetricsExporterPrivate))
+
+/* clients served at once, and seconds a client has to send its request */
+#define MAX_CLIENTS     4
+#define CLIENT_TIMEOUT  5
+
+#define MAX_REQUEST_SIZE 4096
+
+#define CONTENT_TYPE "text/plain; version=0.0.4; charset=utf-8"
+
+/* precise enough for counters up to 10^15, and short for fractions */
+#define VALUE_FORMAT "%.15g"
+
+/* the devices to export, shared with the threads serving clients, which
+   may outlive the exporter */
+typedef struct
+{
+  gint ref_count;
+
+  GMutex mutex;
+  GList *devices;
+} ExporterState;
+
+typedef struct
+{
+  GFreenectDevice *device;
+  gchar *name;
+} ExportedDevice;
+
+typedef enum
+{
+  VALUE_UINT64,
+  VALUE_UINT,
+  VALUE_DOUBLE
+} ValueType;
+
+typedef struct
+{
+  const gchar *name;
+  const gchar *type;
+  const gchar *help;
+  gsize offset;
+  ValueType value_type;
+} Metric;
+
+static const Metric stream_metrics[] =
+  {
+    { "frames_received_total", "counter",
+      "Frames received from the device.",
+      G_STRUCT_OFFSET (GFreenectStreamStats, frames_received), VALUE_UINT64 },
+    { "frames_delivered_total", "counter",
+      "Frames signalled to the application.",
+      G_STRUCT_OFFSET (GFreenectStreamStats, frames_delivered), VALUE_UINT64 },
+    { "frames_coalesced_total", "counter",
+      "Frames replaced by a newer one before being signalled.",
+      G_STRUCT_OFFSET (GFreenectStreamStats, frames_coalesced), VALUE_UINT64 },
+    { "frames_skipped_total", "counter",
+      "Frames not signalled because the scene was static.",
+      G_STRUCT_OFFSET (GFreenectStreamStats, frames_skipped), VALUE_UINT64 },
+    { "frames_per_second", "gauge",
+      "Rate frames are currently arriving at.",
+      G_STRUCT_OFFSET (GFreenectStreamStats, fps), VALUE_DOUBLE },
+    { "bytes_per_second", "gauge",
+      "Rate frame data is currently arriving at.",
+      G_STRUCT_OFFSET (GFreenectStreamStats, bytes_per_second), VALUE_DOUBLE }
+  };
+
+static const Metric device_metrics[] =
+  {
+    { "audio_frames_received_total", "counter",
+      "Audio frames received from the microphone array.",
+      G_STRUCT_OFFSET (GFreenectDeviceStats, audio_frames_received), VALUE_UINT64 },
+    { "event_loop_iterations_total", "counter",
+      "Iterations of the thread receiving frames.",
+      G_STRUCT_OFFSET (GFreenectDeviceStats, event_loop_iterations), VALUE_UINT64 },
+    { "dispatch_wakeups_total", "counter",
+      "Wakeups of the thread talking to the motor subdevice.",
+      G_STRUCT_OFFSET (GFreenectDeviceStats, dispatch_wakeups), VALUE_UINT64 },
+    { "pending_queries", "gauge",
+      "Motor subdevice queries waiting for an answer.",
+      G_STRUCT_OFFSET (GFreenectDeviceStats, pending_queries), VALUE_UINT }
+  };
+
+static const struct
+{
+  const gchar *name;
+  gsize offset;
+} conversions[] =
+  {
+    { "depth_processing", G_STRUCT_OFFSET (GFreenectDeviceStats, depth_processing) },
+    { "depth_grayscale", G_STRUCT_OFFSET (GFreenectDeviceStats, depth_grayscale) },
+    { "depth_registered", G_STRUCT_OFFSET (GFreenectDeviceStats, depth_registered) },
+    { "video_rgb", G_STRUCT_OFFSET (GFreenectDeviceStats, video_rgb) }
+  };
+
+/* private data */
+struct _GFreenectMetricsExporterPrivate
+{
+  ExporterState *state;
+
+  GSocketService *service;
+  gchar *unix_path;
+};
+
+static void     gfreenect_metrics_exporter_class_init   (GFreenectMetricsExporterClass *class);
+static void     gfreenect_metrics_exporter_init         (GFreenectMetricsExporter *self);
+static void     gfreenect_metrics_exporter_finalize     (GObject *obj);
+
+G_DEFINE_TYPE (GFreenectMetricsExporter, gfreenect_metrics_exporter, G_TYPE_OBJECT);
+
+static void
+exported_device_free (ExportedDevice *exported)
+{
+  g_object_unref (exported->device);
+  g_free (exported->name);
+  g_slice_free (ExportedDevice, exported);
+}
+
+static ExporterState *
+state_ref (ExporterState *state)
+{
+  g_atomic_int_inc (&state->ref_count);
+
+  return state;
+}
+
+static void
+state_unref (ExporterState *state)
+{
+  if (! g_atomic_int_dec_and_test (&state->ref_count))
+    return;
+
+  g_list_free_full (state->devices, (GDestroyNotify) exported_device_free);
+  g_mutex_clear (&state->mutex);
+  g_slice_free (ExporterState, state);
+}
+
+static void
+gfreenect_metrics_exporter_class_init (GFreenectMetricsExporterClass *class)
+{
+  GObjectClass *obj_class;
+
+  obj_class = G_OBJECT_CLASS (class);
+
+  obj_class->finalize = gfreenect_metrics_exporter_finalize;
+
+  /* add private structure */
+  g_type_class_add_private (obj_class, sizeof (GFreenectMetricsExporterPrivate));
+}
+
+static void
+gfreenect_metrics_exporter_init (GFreenectMetricsExporter *self)
+{
+  GFreenectMetricsExporterPrivate *priv;
+
+  priv = GFREENECT_METRICS_EXPORTER_GET_PRIVATE (self);
+  self->priv = priv;
+
+  priv->state = g_slice_new (ExporterState);
+  priv->state->ref_count = 1;
+  g_mutex_init (&priv->state->mutex);
+  priv->state->devices = NULL;
+
+  priv->service = NULL;
+  priv->unix_path = NULL;
+}
+
+static void
+gfreenect_metrics_exporter_finalize (GObject *obj)
+{
+  GFreenectMetricsExporter *self = GFREENECT_METRICS_EXPORTER (obj);
+  GList *devices;
+
+  gfreenect_metrics_exporter_stop (self);
+
+  /* release the devices here rather than in whichever thread drops the
+     state last */
+  g_mutex_lock (&self->priv->state->mutex);
+  devices = self->priv->state->devices;
+  self->priv->state->devices = NULL;
+  g_mutex_unlock (&self->priv->state->mutex);
+
+  g_list_free_full (devices, (GDestroyNotify) exported_device_free);
+
+  state_unref (self->priv->state);
+
+  G_OBJECT_CLASS (gfreenect_metrics_exporter_parent_class)->finalize (obj);
+}
+
+static void
+append_family (GString     *out,
+               const gchar *name,
+               const gchar *type,
+               const gchar *help)
+{
+  g_string_append_printf (out,
+                          "# HELP gfreenect_%s %s\n# TYPE gfreenect_%s %s\n",
+                          name, help, name, type);
+}
+
+static void
+append_sample (GString     *out,
+               const gchar *name,
+               const gchar *labels,
+               gdouble      value)
+{
+  gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+  g_string_append_printf (out,
+                          "gfreenect_%s{%s} %s\n",
+                          name,
+                          labels,
+                          g_ascii_formatd (buf, sizeof (buf), VALUE_FORMAT, value));
+}
+
+/* appends a label, escaping its value as the exposition format requires */
+static void
+append_label (GString *labels, const gchar *name, const gchar *value)
+{
+  if (labels->len > 0)
+    g_string_append_c (labels, ',');
+
+  g_string_append_printf (labels, "%s=\"", name);
+
+  for (; *value != '\0'; value++)
+    {
+      if (*value == '\\' || *value == '"')
+        g_string_append_c (labels, '\\');
+
+      if (*value == '\n')
+        g_string_append (labels, "\\n");
+      else
+        g_string_append_c (labels, *value);
+    }
+
+  g_string_append_c (labels, '"');
+}
+
+static gdouble
+get_value (gconstpointer base, const Metric *metric)
+{
+  gconstpointer field = (const guint8 *) base + metric->offset;
+
+  switch (metric->value_type)
+    {
+    case VALUE_UINT64:
+      return *(const guint64 *) field;
+
+    case VALUE_UINT:
+      return *(const guint *) field;
+
+    default:
+      return *(const gdouble *) field;
+    }
+}
+
+static void
+append_latency (GString                         *out,
+                const gchar                     *labels,
+                const GFreenectLatencyHistogram *latency)
+{
+  GString *bucket_labels;
+  guint64 count = 0;
+  guint i;
+
+  bucket_labels = g_string_new (NULL);
+
+  for (i = 0; i < GFREENECT_LATENCY_BUCKETS; i++)
+    {
+      gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+      count += latency->counts[i];
+
+      if (i < GFREENECT_LATENCY_BUCKETS - 1)
+        g_ascii_formatd (buf, sizeof (buf), VALUE_FORMAT,
+                         gfreenect_latency_histogram_get_bound (i) /
+                         (gdouble) G_USEC_PER_SEC);
+      else
+        strcpy (buf, "+Inf");
+
+      g_string_assign (bucket_labels, labels);
+      append_label (bucket_labels, "le", buf);
+
+      append_sample (out, "frame_latency_seconds_bucket",
+                     bucket_labels->str, count);
+    }
+
+  append_sample (out, "frame_latency_seconds_sum", labels,
+                 latency->sum / (gdouble) G_USEC_PER_SEC);
+  append_sample (out, "frame_latency_seconds_count", labels, count);
+
+  g_string_free (bucket_labels, TRUE);
+}
+
+/* the labels of a device, and of each of its streams */
+static gchar **
+get_labels (const gchar *name)
+{
+  static const gchar *streams[] = { "depth", "video" };
+  gchar **labels;
+  guint i;
+
+  labels = g_new0 (gchar *, 4);
+
+  for (i = 0; i < 3; i++)
+    {
+      GString *str = g_string_new (NULL);
+
+      append_label (str, "device", name);
+      if (i > 0)
+        append_label (str, "stream", streams[i - 1]);
+
+      labels[i] = g_string_free (str, FALSE);
+    }
+
+  return labels;
+}
+
+/* Renders the statistics @stats of @n_devices devices, named @names. Kept
+   apart from the devices so that it can be tested without them. */
+gchar *
+gfreenect_metrics_exporter_render_stats (guint                       n_devices,
+                                         const gchar * const        *names,
+                                         const GFreenectDeviceStats *stats)
+{
+  gchar ***labels;
+  GString *out;
+  guint i;
+  guint j;
+  guint k;
+
+  labels = g_new (gchar **, n_devices);
+  for (i = 0; i < n_devices; i++)
+    labels[i] = get_labels (names[i]);
+
+  out = g_string_new (NULL);
+
+  for (k = 0; k < G_N_ELEMENTS (stream_metrics); k++)
+    {
+      const Metric *metric = &stream_metrics[k];
+
+      append_family (out, metric->name, metric->type, metric->help);
+
+      for (i = 0; i < n_devices; i++)
+        {
+          append_sample (out, metric->name, labels[i][1],
+                         get_value (&stats[i].depth, metric));
+          append_sample (out, metric->name, labels[i][2],
+                         get_value (&stats[i].video, metric));
+        }
+    }
+
+  append_family (out, "frame_latency_seconds", "histogram",
+                 "Time from the arrival of frames to their signal.");
+
+  for (i = 0; i < n_devices; i++)
+    {
+      append_latency (out, labels[i][1], &stats[i].depth.latency);
+      append_latency (out, labels[i][2], &stats[i].video.latency);
+    }
+
+  for (k = 0; k < G_N_ELEMENTS (device_metrics); k++)
+    {
+      const Metric *metric = &device_metrics[k];
+
+      append_family (out, metric->name, metric->type, metric->help);
+
+      for (i = 0; i < n_devices; i++)
+        append_sample (out, metric->name, labels[i][0],
+                       get_value (&stats[i], metric));
+    }
+
+  for (k = 0; k < 2; k++)
+    {
+      if (k == 0)
+        append_family (out, "conversions_total", "counter",
+                       "Runs of each frame conversion.");
+      else
+        append_family (out, "conversion_seconds_total", "counter",
+                       "Time spent in each frame conversion.");
+
+      for (i = 0; i < n_devices; i++)
+        for (j = 0; j < G_N_ELEMENTS (conversions); j++)
+          {
+            const GFreenectConversionStats *conversion;
+            GString *conversion_labels;
+
+            conversion = (const GFreenectConversionStats *)
+              ((const guint8 *) &stats[i] + conversions[j].offset);
+
+            conversion_labels = g_string_new (labels[i][0]);
+            append_label (conversion_labels, "conversion", conversions[j].name);
+
+            if (k == 0)
+              append_sample (out, "conversions_total",
+                             conversion_labels->str, conversion->calls);
+            else
+              append_sample (out, "conversion_seconds_total",
+                             conversion_labels->str,
+                             conversion->total_time / (gdouble) G_USEC_PER_SEC);
+
+            g_string_free (conversion_labels, TRUE);
+          }
+    }
+
+  for (i = 0; i < n_devices; i++)
+    g_strfreev (labels[i]);
+  g_free (labels);
+
+  return g_string_free (out, FALSE);
+}
+
+static gchar *
+render_metrics (ExporterState *state)
+{
+  GFreenectDeviceStats *stats;
+  gchar **names;
+  gchar *text;
+  GList *node;
+  guint n_devices;
+  guint i;
+
+  /* take the statistics under the lock, render them out of it */
+  g_mutex_lock (&state->mutex);
+
+  n_devices = g_list_length (state->devices);
+  names = g_new0 (gchar *, n_devices + 1);
+  stats = g_new (GFreenectDeviceStats, MAX (n_devices, 1));
+
+  for (node = state->devices, i = 0; node != NULL; node = node->next, i++)
+    {
+      ExportedDevice *exported = node->data;
+
+      names[i] = g_strdup (exported->name);
+      gfreenect_device_get_stats (exported->device, &stats[i]);
+    }
+
+  g_mutex_unlock (&state->mutex);
+
+  text = gfreenect_metrics_exporter_render_stats (n_devices,
+                                                  (const gchar * const *) names,
+                                                  stats);
+
+  g_strfreev (names);
+  g_free (stats);
+
+  return text;
+}
+
+/* Reads an HTTP request up to the end of its headers, and returns the
+   status line of the response to it. */
+static const gchar *
+read_request (GInputStream *input)
+{
+  gchar request[MAX_REQUEST_SIZE + 1];
+  gsize len = 0;
+  gchar **parts;
+  const gchar *status;
+
+  request[0] = '\0';
+
+  /* tolerate bare newlines from hand-typed requests */
+  while (strstr (request, "\r\n\r\n") == NULL &&
+         strstr (request, "\n\n") == NULL)
+    {
+      gssize n;
+
+      if (len == MAX_REQUEST_SIZE)
+        return "431 Request Header Fields Too Large";
+
+      n = g_input_stream_read (input,
+                               request + len,
+                               MAX_REQUEST_SIZE - len,
+                               NULL,
+                               NULL);
+      if (n <= 0)
+        return NULL;
+
+      len += n;
+      request[len] = '\0';
+    }
+
+  parts = g_strsplit (request, " ", 3);
+
+  if (g_strv_length (parts) < 3)
+    status = "400 Bad Request";
+  else if (g_strcmp0 (parts[0], "GET") != 0)
+    status = "405 Method Not Allowed";
+  else if (g_strcmp0 (parts[1], "/metrics") != 0 &&
+           g_strcmp0 (parts[1], "/") != 0)
+    status = "404 Not Found";
+  else
+    status = "200 OK";
+
+  g_strfreev (parts);
+
+  return status;
+}
+
+/* runs in a thread of the socket service for every client */
+static gboolean
+on_client (GThreadedSocketService *service,
+           GSocketConnection      *connection,
+           GObject                *source_object,
+           gpointer                user_data)
+{
+  ExporterState *state = user_data;
+  GSocket *socket;
+  GOutputStream *output;
+  gchar *body = NULL;
+
+  socket = g_socket_connection_get_socket (connection);
+  g_socket_set_timeout (socket, CLIENT_TIMEOUT);
+
+  output = g_io_stream_get_output_stream (G_IO_STREAM (connection));
+
+  if (g_socket_get_family (socket) == G_SOCKET_FAMILY_UNIX)
+    {
+      body = render_metrics (state);
+
+      g_output_stream_write_all (output, body, strlen (body),
+                                 NULL, NULL, NULL);
+    }
+  else
+    {
+      const gchar *status;
+      gchar *header;
+
+      status = read_request (g_io_stream_get_input_stream (G_IO_STREAM (connection)));
+      if (status == NULL)
+        goto out;
+
+      if (g_str_has_prefix (status, "200"))
+        body = render_metrics (state);
+      else
+        body = g_strdup_printf ("%s\n", status);
+
+      header = g_strdup_printf ("HTTP/1.0 %s\r\n"
+                                "Content-Type: %s\r\n"
+                                "Content-Length: %" G_GSIZE_FORMAT "\r\n"
+                                "Connection: close\r\n"
+                                "\r\n",
+                                status,
+                                g_str_has_prefix (status, "200") ?
+                                CONTENT_TYPE : "text/plain",
+                                strlen (body));
+
+      if (g_output_stream_write_all (output, header, strlen (header),
+                                     NULL, NULL, NULL))
+        g_output_stream_write_all (output, body, strlen (body),
+                                   NULL, NULL, NULL);
+
+      g_free (header);
+    }
+
+ out:
+  g_io_stream_close (G_IO_STREAM (connection), NULL, NULL);
+  g_free (body);
+
+  return TRUE;
+}
+
+static GSocketService *
+ensure_service (GFreenectMetricsExporter *self)
+{
+  if (self->priv->service == NULL)
+    {
+      self->priv->service = g_threaded_socket_service_new (MAX_CLIENTS);
+
+      /* the closure keeps the state alive while clients are served */
+      g_signal_connect_data (self->priv->service,
+                             "run",
+                             G_CALLBACK (on_client),
+                             state_ref (self->priv->state),
+                             (GClosureNotify) state_unref,
+                             0);
+    }
+
+  return self->priv->service;
+}
+
+/* public methods */
+
+/**
+ * gfreenect_metrics_exporter_new:
+ *
+ * Creates a new #GFreenectMetricsExporter, without any device nor
+ * listening socket.
+ *
+ * Returns: (transfer full): A newly created #GFreenectMetricsExporter. Use
+ * g_object_unref() to free it.
+ **/
+GFreenectMetricsExporter *
+gfreenect_metrics_exporter_new (void)
+{
+  return g_object_new (GFREENECT_TYPE_METRICS_EXPORTER, NULL);
+}
+
+/**
+ * gfreenect_metrics_exporter_add_device:
+ * @self: The #GFreenectMetricsExporter
+ * @device: The #GFreenectDevice to export the statistics of
+ * @name: The value of the <literal>device</literal> label of its samples
+ *
+ * Adds a device to the ones exported. The exporter keeps a reference to
+ * @device until it is removed with
+ * gfreenect_metrics_exporter_remove_device(). If @device was already
+ * exported, only its name changes.
+ **/
+void
+gfreenect_metrics_exporter_add_device (GFreenectMetricsExporter *self,
+                                       GFreenectDevice          *device,
+                                       const gchar              *name)
+{
+  ExporterState *state;
+  ExportedDevice *exported;
+  GList *node;
+
+  g_return_if_fail (GFREENECT_IS_METRICS_EXPORTER (self));
+  g_return_if_fail (GFREENECT_IS_DEVICE (device));
+  g_return_if_fail (name != NULL);
+
+  state = self->priv->state;
+
+  g_mutex_lock (&state->mutex);
+
+  for (node = state->devices; node != NULL; node = node->next)
+    {
+      exported = node->data;
+
+      if (exported->device == device)
+        {
+          g_free (exported->name);
+          exported->name = g_strdup (name);
+
+          g_mutex_unlock (&state->mutex);
+          return;
+        }
+    }
+
+  exported = g_slice_new (ExportedDevice);
+  exported->device = g_object_ref (device);
+  exported->name = g_strdup (name);
+
+  state->devices = g_list_append (state->devices, exported);
+
+  g_mutex_unlock (&state->mutex);
+}
+
+/**
+ * gfreenect_metrics_exporter_remove_device:
+ * @self: The #GFreenectMetricsExporter
+ * @device: A #GFreenectDevice added with
+ * gfreenect_metrics_exporter_add_device()
+ *
+ * Stops exporting the statistics of @device and drops the reference the
+ * exporter held on it.
+ **/
+void
+gfreenect_metrics_exporter_remove_device (GFreenectMetricsExporter *self,
+                                          GFreenectDevice          *device)
+{
+  ExporterState *state;
+  ExportedDevice *exported = NULL;
+  GList *node;
+
+  g_return_if_fail (GFREENECT_IS_METRICS_EXPORTER (self));
+  g_return_if_fail (GFREENECT_IS_DEVICE (device));
+
+  state = self->priv->state;
+
+  g_mutex_lock (&state->mutex);
+
+  for (node = state->devices; node != NULL; node = node->next)
+    if (((ExportedDevice *) node->data)->device == device)
+      {
+        exported = node->data;
+        state->devices = g_list_delete_link (state->devices, node);
+        break;
+      }
+
+  g_mutex_unlock (&state->mutex);
+
+  if (exported != NULL)
+    exported_device_free (exported);
+}
+
+/**
+ * gfreenect_metrics_exporter_listen_port:
+ * @self: The #GFreenectMetricsExporter
+ * @port: The TCP port to listen on, or 0 to pick any free port
+ * @bound_port: (out) (allow-none): A pointer to retrieve the port listened
+ * on
+ * @error: (allow-none): A pointer to a #GError, or %NULL
+ *
+ * Serves the metrics over HTTP on @port of the loopback interface. The
+ * port is only reachable from the same host; a reverse proxy or an SSH
+ * tunnel can make it available to a central Prometheus server.
+ *
+ * Returns: %TRUE on success, or %FALSE if the port could not be listened
+ * on, in which case @error is set.
+ **/
+gboolean
+gfreenect_metrics_exporter_listen_port (GFreenectMetricsExporter  *self,
+                                        guint16                    port,
+                                        guint16                   *bound_port,
+                                        GError                   **error)
+{
+  GInetAddress *loopback;
+  GSocketAddress *address;
+  GSocketAddress *effective_address = NULL;
+  GSocketService *service;
+  gboolean result;
+
+  g_return_val_if_fail (GFREENECT_IS_METRICS_EXPORTER (self), FALSE);
+
+  service = ensure_service (self);
+
+  loopback = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  address = g_inet_socket_address_new (loopback, port);
+
+  result = g_socket_listener_add_address (G_SOCKET_LISTENER (service),
+                                          address,
+                                          G_SOCKET_TYPE_STREAM,
+                                          G_SOCKET_PROTOCOL_DEFAULT,
+                                          NULL,
+                                          &effective_address,
+                                          error);
+
+  g_object_unref (address);
+  g_object_unref (loopback);
+
+  if (! result)
+    return FALSE;
+
+  if (bound_port != NULL)
+    *bound_port = g_inet_socket_address_get_port (G_INET_SOCKET_ADDRESS (effective_address));
+  g_object_unref (effective_address);
+
+  g_socket_service_start (service);
+
+  return TRUE;
+}
+
+/**
+ * gfreenect_metrics_exporter_listen_unix:
+ * @self: The #GFreenectMetricsExporter
+ * @path: The path of the Unix socket to create
+ * @error: (allow-none): A pointer to a #GError, or %NULL
+ *
+ * Writes the metrics to every client connecting to a Unix socket at
+ * @path, then closes the connection. The socket is removed by
+ * gfreenect_metrics_exporter_stop(). Fails if @path already exists.
+ *
+ * Returns: %TRUE on success, or %FALSE if the socket could not be created,
+ * or Unix sockets are not supported on this platform, in which case @error
+ * is set.
+ **/
+gboolean
+gfreenect_metrics_exporter_listen_unix (GFreenectMetricsExporter  *self,
+                                        const gchar               *path,
+                                        GError                   **error)
+{
+#ifdef HAVE_GIO_UNIX
+  GSocketAddress *address;
+  GSocketService *service;
+  gboolean result;
+
+  g_return_val_if_fail (GFREENECT_IS_METRICS_EXPORTER (self), FALSE);
+  g_return_val_if_fail (path != NULL, FALSE);
+
+  if (self->priv->unix_path != NULL)
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_EXISTS,
+                   "Already listening on Unix socket %s",
+                   self->priv->unix_path);
+      return FALSE;
+    }
+
+  service = ensure_service (self);
+
+  address = g_unix_socket_address_new (path);
+
+  result = g_socket_listener_add_address (G_SOCKET_LISTENER (service),
+                                          address,
+                                          G_SOCKET_TYPE_STREAM,
+                                          G_SOCKET_PROTOCOL_DEFAULT,
+                                          NULL,
+                                          NULL,
+                                          error);
+
+  g_object_unref (address);
+
+  if (! result)
+    return FALSE;
+
+  self->priv->unix_path = g_strdup (path);
+
+  g_socket_service_start (service);
+
+  return TRUE;
+#else
+  g_return_val_if_fail (GFREENECT_IS_METRICS_EXPORTER (self), FALSE);
+
+  g_set_error (error,
+               G_IO_ERROR,
+               G_IO_ERROR_NOT_SUPPORTED,
+               "Unix sockets are not supported on this platform");
+  return FALSE;
+#endif
+}
+
+/**
+ * gfreenect_metrics_exporter_stop:
+ * @self: The #GFreenectMetricsExporter
+ *
+ * Closes all the sockets listened on, and removes the Unix socket if any.
+ * Clients already connected are still served.
+ **/
+void
+gfreenect_metrics_exporter_stop (GFreenectMetricsExporter *self)
+{
+  g_return_if_fail (GFREENECT_IS_METRICS_EXPORTER (self));
+
+  if (self->priv->service != NULL)
+    {
+      g_socket_service_stop (self->priv->service);
+      g_socket_listener_close (G_SOCKET_LISTENER (self->priv->service));
+
+      g_object_unref (self->priv->service);
+      self->priv->service = NULL;
+    }
+
+  if (self->priv->unix_path != NULL)
+    {
+      g_unlink (self->priv->unix_path);
+
+      g_free (self->priv->unix_path);
+      self->priv->unix_path = NULL;
+    }
+}
+
+/**
+ * gfreenect_metrics_exporter_render:
+ * @self: The #GFreenectMetricsExporter
+ *
+ * Renders the current statistics of the exported devices in the
+ * Prometheus text exposition format, as served to clients.
+ *
+ * Returns: (transfer full): A newly allocated string. Use g_free() to free
+ * it.
+ **/
+gchar *
+gfreenect_metrics_exporter_render (GFreenectMetricsExporter *self)
+{
+  g_return_val_if_fail (GFREENECT_IS_METRICS_EXPORTER (self), NULL);
+
+  return render_metrics (self->priv->state);
+}
@@ -0,0 +1,79 @@
+/*
+ * gfreenect-metrics-exporter.h
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+
+#ifndef __GFREENECT_METRICS_EXPORTER_H__
+#define __GFREENECT_METRICS_EXPORTER_H__
+
+#include <glib.h>
+#include <glib-object.h>
+
+#include <gfreenect-device.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GFreenectMetricsExporter GFreenectMetricsExporter;
+typedef struct _GFreenectMetricsExporterClass GFreenectMetricsExporterClass;
+typedef struct _GFreenectMetricsExporterPrivate GFreenectMetricsExporterPrivate;
+
+struct _GFreenectMetricsExporter
+{
+  GObject parent;
+
+  GFreenectMetricsExporterPrivate *priv;
+};
+
+struct _GFreenectMetricsExporterClass
+{
+  GObjectClass parent_class;
+};
+
+#define GFREENECT_TYPE_METRICS_EXPORTER           (gfreenect_metrics_exporter_get_type ())
+#define GFREENECT_METRICS_EXPORTER(obj)           (G_TYPE_CHECK_INSTANCE_CAST ((obj), GFREENECT_TYPE_METRICS_EXPORTER, GFreenectMetricsExporter))
+#define GFREENECT_METRICS_EXPORTER_CLASS(obj)     (G_TYPE_CHECK_CLASS_CAST ((obj), GFREENECT_TYPE_METRICS_EXPORTER, GFreenectMetricsExporterClass))
+#define GFREENECT_IS_METRICS_EXPORTER(obj)        (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GFREENECT_TYPE_METRICS_EXPORTER))
+#define GFREENECT_IS_METRICS_EXPORTER_CLASS(obj)  (G_TYPE_CHECK_CLASS_TYPE ((obj), GFREENECT_TYPE_METRICS_EXPORTER))
+#define GFREENECT_METRICS_EXPORTER_GET_CLASS(obj) (G_TYPE_INSTANCE_GET_CLASS ((obj), GFREENECT_TYPE_METRICS_EXPORTER, GFreenectMetricsExporterClass))
+
+GType                      gfreenect_metrics_exporter_get_type      (void) G_GNUC_CONST;
+
+GFreenectMetricsExporter * gfreenect_metrics_exporter_new           (void);
+
+void                       gfreenect_metrics_exporter_add_device    (GFreenectMetricsExporter *self,
+                                                                     GFreenectDevice          *device,
+                                                                     const gchar              *name);
+void                       gfreenect_metrics_exporter_remove_device (GFreenectMetricsExporter *self,
+                                                                     GFreenectDevice          *device);
+
+gboolean                   gfreenect_metrics_exporter_listen_port   (GFreenectMetricsExporter  *self,
+                                                                     guint16                    port,
+                                                                     guint16                   *bound_port,
+                                                                     GError                   **error);
+gboolean                   gfreenect_metrics_exporter_listen_unix   (GFreenectMetricsExporter  *self,
+                                                                     const gchar               *path,
+                                                                     GError                   **error);
+void                       gfreenect_metrics_exporter_stop          (GFreenectMetricsExporter *self);
+
+gchar *                    gfreenect_metrics_exporter_render        (GFreenectMetricsExporter *self);
+
+G_END_DECLS
+
+#endif /* __GFREENECT_METRICS_EXPORTER_H__ */
@@ -0,0 +1,134 @@
+/*
+ * gfreenect-motion-cache.c
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+
+#include <string.h>
+
+#include <gio/gio.h>
+
+#include "gfreenect-motion-cache.h"
+
+void
+gfreenect_motion_cache_init (GFreenectMotionCache *cache)
+{
+  memset (cache, 0, sizeof (GFreenectMotionCache));
+
+  g_cond_init (&cache->cond);
+}
+
+void
+gfreenect_motion_cache_clear (GFreenectMotionCache *cache)
+{
+  g_cond_clear (&cache->cond);
+}
+
+/* Copies the cached state into @state if it is at most @max_age
+   microseconds old. */
+gboolean
+gfreenect_motion_cache_lookup (GFreenectMotionCache *cache,
+                               gint64                max_age,
+                               GFreenectMotionState *state)
+{
+  if (! cache->has_state ||
+      g_get_monotonic_time () - cache->state.timestamp > max_age)
+    {
+      return FALSE;
+    }
+
+  *state = cache->state;
+
+  return TRUE;
+}
+
+/* Waits, with @mutex held, for the end of the refresh in flight, or of a
+   new one requested by signalling @refresher when there is none, and
+   copies its result into @state. Gives up when @abort becomes TRUE, which
+   the owner sets under @mutex before calling
+   gfreenect_motion_cache_abort(). */
+gboolean
+gfreenect_motion_cache_wait (GFreenectMotionCache  *cache,
+                             GMutex                *mutex,
+                             GCond                 *refresher,
+                             const gboolean        *abort,
+                             GFreenectMotionState  *state,
+                             GError               **error)
+{
+  guint serial = cache->serial;
+
+  if (! cache->refreshing)
+    {
+      cache->requested = TRUE;
+      g_cond_signal (refresher);
+    }
+
+  while (cache->serial == serial && ! *abort)
+    g_cond_wait (&cache->cond, mutex);
+
+  if (cache->serial == serial || cache->failed)
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_FAILED,
+                   "Failed to update tilt state");
+      return FALSE;
+    }
+
+  *state = cache->state;
+
+  return TRUE;
+}
+
+/* Marks a refresh as in flight, answering the pending request. The owner
+   then reads the device without holding its mutex. */
+void
+gfreenect_motion_cache_begin_refresh (GFreenectMotionCache *cache)
+{
+  cache->requested = FALSE;
+  cache->refreshing = TRUE;
+}
+
+/* Ends the refresh in flight with the @state read, or %NULL if reading the
+   device failed, and wakes up the queries waiting for it. */
+void
+gfreenect_motion_cache_end_refresh (GFreenectMotionCache       *cache,
+                                    const GFreenectMotionState *state)
+{
+  if (state != NULL)
+    {
+      cache->state = *state;
+      cache->has_state = TRUE;
+    }
+
+  cache->refreshing = FALSE;
+  cache->failed = state == NULL;
+  cache->serial++;
+
+  g_cond_broadcast (&cache->cond);
+}
+
+/* Wakes up the waiting queries when the refreshing thread stops. */
+void
+gfreenect_motion_cache_abort (GFreenectMotionCache *cache)
+{
+  cache->refreshing = FALSE;
+
+  g_cond_broadcast (&cache->cond);
+}
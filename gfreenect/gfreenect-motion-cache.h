@@ -0,0 +1,71 @@
+/*
+ * gfreenect-motion-cache.h
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+
+#ifndef __GFREENECT_MOTION_CACHE_H__
+#define __GFREENECT_MOTION_CACHE_H__
+
+#include <glib.h>
+
+#include "gfreenect-motion-state.h"
+
+G_BEGIN_DECLS
+
+/* The last state read from the motor subdevice, shared by all the queries
+   of a device so that concurrent callers wait for a single refresh instead
+   of each starting its own control transfer. The cache has no lock of its
+   own: every function is called with the owner's mutex held, the one the
+   waiters are given, and refreshes are done by a single thread of the
+   owner. */
+typedef struct
+{
+  GFreenectMotionState state;
+  gboolean has_state;
+
+  gboolean requested;           /* a query waits for a refresh to start */
+  gboolean refreshing;          /* a refresh is in flight, queries join it */
+  gboolean failed;              /* the last refresh failed */
+  guint serial;                 /* refreshes completed, wrapping */
+
+  GCond cond;                   /* broadcast when a refresh ends */
+} GFreenectMotionCache;
+
+void     gfreenect_motion_cache_init          (GFreenectMotionCache        *cache);
+void     gfreenect_motion_cache_clear         (GFreenectMotionCache        *cache);
+
+gboolean gfreenect_motion_cache_lookup        (GFreenectMotionCache        *cache,
+                                               gint64                       max_age,
+                                               GFreenectMotionState        *state);
+gboolean gfreenect_motion_cache_wait          (GFreenectMotionCache        *cache,
+                                               GMutex                      *mutex,
+                                               GCond                       *refresher,
+                                               const gboolean              *abort,
+                                               GFreenectMotionState        *state,
+                                               GError                     **error);
+
+void     gfreenect_motion_cache_begin_refresh (GFreenectMotionCache        *cache);
+void     gfreenect_motion_cache_end_refresh   (GFreenectMotionCache        *cache,
+                                               const GFreenectMotionState  *state);
+void     gfreenect_motion_cache_abort         (GFreenectMotionCache        *cache);
+
+G_END_DECLS
+
+#endif /* __GFREENECT_MOTION_CACHE_H__ */
@@ -0,0 +1,241 @@
+/*
+ * gfreenect-motion-detector.c
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+#include <string.h>
+
+#include "gfreenect-motion-detector.h"
+#include "gfreenect-region.h"
+
+/* one depth sample per 4x4 pixels is compared against the background */
+#define CELL_SIZE  4
+
+/* cells are grouped in blocks of 8x8, 32x32 pixels of the depth frame */
+#define BLOCK_SIZE 8
+
+void
+gfreenect_motion_detector_init (GFreenectMotionDetectorState *detector)
+{
+  memset (detector, 0, sizeof (GFreenectMotionDetectorState));
+
+  detector->threshold = 50;
+  detector->learning_rate = 8;
+  detector->min_block_cells = 6;
+}
+
+void
+gfreenect_motion_detector_clear (GFreenectMotionDetectorState *detector)
+{
+  g_free (detector->background);
+  detector->background = NULL;
+
+  g_free (detector->block_counts);
+  detector->block_counts = NULL;
+
+  g_free (detector->block_labels);
+  detector->block_labels = NULL;
+
+  g_free (detector->stack);
+  detector->stack = NULL;
+
+  detector->width = 0;
+  detector->height = 0;
+}
+
+/* forgets the background, which is learnt again from the next frame */
+void
+gfreenect_motion_detector_reset (GFreenectMotionDetectorState *detector)
+{
+  gsize i;
+
+  if (detector->background == NULL)
+    return;
+
+  for (i = 0; i < detector->grid_width * detector->grid_height; i++)
+    detector->background[i] = -1;
+}
+
+static void
+ensure_buffers (GFreenectMotionDetectorState *detector,
+                gsize                         width,
+                gsize                         height)
+{
+  gsize blocks;
+
+  if (detector->width == width && detector->height == height)
+    return;
+
+  gfreenect_motion_detector_clear (detector);
+
+  detector->width = width;
+  detector->height = height;
+
+  detector->grid_width = width / CELL_SIZE;
+  detector->grid_height = height / CELL_SIZE;
+  detector->background = g_new (gint32,
+                                detector->grid_width * detector->grid_height);
+  gfreenect_motion_detector_reset (detector);
+
+  detector->blocks_width = (detector->grid_width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+  detector->blocks_height = (detector->grid_height + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+  blocks = detector->blocks_width * detector->blocks_height;
+  detector->block_counts = g_new (guint8, blocks);
+  detector->block_labels = g_new (guint8, blocks);
+  detector->stack = g_new (guint, blocks);
+}
+
+/* Compares the center pixel of every cell against the background, counting
+   the changed cells of each block, and lets the background follow the
+   scene so that objects that stop moving are eventually absorbed. */
+static void
+update_background (GFreenectMotionDetectorState *detector,
+                   const guint16                *depth)
+{
+  gint32 threshold = detector->threshold << 8;
+  gint32 rate = detector->learning_rate;
+  gsize gx, gy;
+
+  memset (detector->block_counts,
+          0,
+          detector->blocks_width * detector->blocks_height);
+
+  for (gy = 0; gy < detector->grid_height; gy++)
+    {
+      const guint16 *row = depth +
+        (gy * CELL_SIZE + CELL_SIZE / 2) * detector->width + CELL_SIZE / 2;
+      gint32 *background = detector->background + gy * detector->grid_width;
+      guint8 *counts = detector->block_counts +
+        (gy / BLOCK_SIZE) * detector->blocks_width;
+
+      for (gx = 0; gx < detector->grid_width; gx++)
+        {
+          guint16 d = row[gx * CELL_SIZE];
+          gint32 sample = (gint32) d << 8;
+          gint32 delta = sample - background[gx];
+
+          if (d == detector->invalid)
+            continue;
+
+          if (background[gx] < 0)
+            {
+              background[gx] = sample;
+              continue;
+            }
+
+          if (delta > threshold || -delta > threshold)
+            counts[gx / BLOCK_SIZE]++;
+
+          background[gx] += (delta * rate) >> 8;
+        }
+    }
+}
+
+/* groups 4-connected changed blocks, returning their bounding boxes */
+static GPtrArray *
+find_regions (GFreenectMotionDetectorState *detector)
+{
+  GPtrArray *regions = NULL;
+  gsize bw = detector->blocks_width;
+  gsize bh = detector->blocks_height;
+  guint block_pixels = BLOCK_SIZE * CELL_SIZE;
+  guint i;
+
+  for (i = 0; i < bw * bh; i++)
+    detector->block_labels[i] = detector->block_counts[i] >= detector->min_block_cells;
+
+  for (i = 0; i < bw * bh; i++)
+    {
+      guint x0, y0, x1, y1;
+      guint top = 0;
+
+      if (! detector->block_labels[i])
+        continue;
+
+      x0 = x1 = i % bw;
+      y0 = y1 = i / bw;
+
+      detector->block_labels[i] = 0;
+      detector->stack[top++] = i;
+
+      while (top > 0)
+        {
+          guint b = detector->stack[--top];
+          guint bx = b % bw;
+          guint by = b / bw;
+
+          x0 = MIN (x0, bx);
+          x1 = MAX (x1, bx);
+          y0 = MIN (y0, by);
+          y1 = MAX (y1, by);
+
+#define VISIT(cond, n) \
+          if ((cond) && detector->block_labels[n]) \
+            { \
+              detector->block_labels[n] = 0; \
+              detector->stack[top++] = n; \
+            }
+
+          VISIT (bx > 0, b - 1);
+          VISIT (bx + 1 < bw, b + 1);
+          VISIT (by > 0, b - bw);
+          VISIT (by + 1 < bh, b + bw);
+
+#undef VISIT
+        }
+
+      if (regions == NULL)
+        regions = g_ptr_array_new_with_free_func ((GDestroyNotify) gfreenect_region_free);
+
+      g_ptr_array_add (regions,
+                       gfreenect_region_new (x0 * block_pixels,
+                                             y0 * block_pixels,
+                                             MIN ((x1 + 1) * block_pixels,
+                                                  detector->width) - x0 * block_pixels,
+                                             MIN ((y1 + 1) * block_pixels,
+                                                  detector->height) - y0 * block_pixels));
+    }
+
+  return regions;
+}
+
+/* Feeds a new depth frame to the detector. Returns a new array with the
+   bounding boxes of the regions that changed with respect to the
+   background, as #GFreenectRegion in depth frame coordinates, or %NULL if
+   the scene is static. */
+GPtrArray *
+gfreenect_motion_detector_process (GFreenectMotionDetectorState *detector,
+                                   const guint16                *depth,
+                                   gsize                         width,
+                                   gsize                         height,
+                                   guint16                       invalid)
+{
+  ensure_buffers (detector, width, height);
+
+  if (detector->invalid != invalid)
+    {
+      gfreenect_motion_detector_reset (detector);
+      detector->invalid = invalid;
+    }
+
+  update_background (detector, depth);
+
+  return find_regions (detector);
+}
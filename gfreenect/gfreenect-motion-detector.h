@@ -0,0 +1,64 @@
+/*
+ * gfreenect-motion-detector.h
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+#ifndef __GFREENECT_MOTION_DETECTOR_H__
+#define __GFREENECT_MOTION_DETECTOR_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct
+{
+  /* parameters */
+  guint threshold;              /* depth change counted as motion */
+  guint learning_rate;          /* background adaptation, in 1/256 units */
+  guint min_block_cells;        /* changed cells that make a block change */
+
+  /* state */
+  gsize width;
+  gsize height;
+  guint16 invalid;
+
+  gsize grid_width;
+  gsize grid_height;
+  gint32 *background;           /* in 1/256 depth units, -1 if unknown */
+
+  gsize blocks_width;
+  gsize blocks_height;
+  guint8 *block_counts;
+  guint8 *block_labels;
+  guint *stack;
+} GFreenectMotionDetectorState;
+
+void        gfreenect_motion_detector_init    (GFreenectMotionDetectorState *detector);
+void        gfreenect_motion_detector_clear   (GFreenectMotionDetectorState *detector);
+void        gfreenect_motion_detector_reset   (GFreenectMotionDetectorState *detector);
+
+GPtrArray * gfreenect_motion_detector_process (GFreenectMotionDetectorState *detector,
+                                               const guint16                *depth,
+                                               gsize                         width,
+                                               gsize                         height,
+                                               guint16                       invalid);
+
+G_END_DECLS
+
+#endif /* __GFREENECT_MOTION_DETECTOR_H__ */
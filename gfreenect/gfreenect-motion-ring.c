@@ -0,0 +1,201 @@
+/*
+ * gfreenect-motion-ring.c
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+
+#include <string.h>
+
+#include "gfreenect-motion-ring.h"
+
+#define RING_MASK (GFREENECT_MOTION_HISTORY - 1)
+
+void
+gfreenect_motion_ring_init (GFreenectMotionRing *ring)
+{
+  ring->states = g_new0 (GFreenectMotionState, GFREENECT_MOTION_HISTORY);
+  ring->seq = g_new0 (gint, GFREENECT_MOTION_HISTORY);
+  ring->head = 0;
+}
+
+void
+gfreenect_motion_ring_clear (GFreenectMotionRing *ring)
+{
+  g_free (ring->states);
+  ring->states = NULL;
+
+  g_free (ring->seq);
+  ring->seq = NULL;
+}
+
+/* Only one thread may push samples. */
+void
+gfreenect_motion_ring_push (GFreenectMotionRing        *ring,
+                            const GFreenectMotionState *state)
+{
+  guint index;
+  guint slot;
+
+  index = (guint) g_atomic_int_get (&ring->head);
+  slot = index & RING_MASK;
+
+  g_atomic_int_set (&ring->seq[slot], (gint) (index * 2 + 1));
+  memcpy (&ring->states[slot], state, sizeof (GFreenectMotionState));
+  g_atomic_int_set (&ring->seq[slot], (gint) (index * 2 + 2));
+
+  g_atomic_int_set (&ring->head, (gint) (index + 1));
+}
+
+/* Copies the sample pushed as @index into @state, returning FALSE if the
+   writer has overwritten it, or is overwriting it. */
+static gboolean
+read_sample (GFreenectMotionRing  *ring,
+             guint                 index,
+             GFreenectMotionState *state)
+{
+  guint slot = index & RING_MASK;
+  guint expected = index * 2 + 2;
+
+  if ((guint) g_atomic_int_get (&ring->seq[slot]) != expected)
+    return FALSE;
+
+  memcpy (state, &ring->states[slot], sizeof (GFreenectMotionState));
+
+  return (guint) g_atomic_int_get (&ring->seq[slot]) == expected;
+}
+
+gboolean
+gfreenect_motion_ring_latest (GFreenectMotionRing  *ring,
+                              GFreenectMotionState *state)
+{
+  guint head;
+
+  do
+    {
+      head = (guint) g_atomic_int_get (&ring->head);
+      if (head == 0)
+        return FALSE;
+    }
+  while (! read_sample (ring, head - 1, state));
+
+  return TRUE;
+}
+
+/* Returns the samples taken at or after @since, oldest first. The scan
+   stops at samples overwritten while reading. */
+GArray *
+gfreenect_motion_ring_since (GFreenectMotionRing *ring,
+                             gint64               since)
+{
+  GArray *states;
+  guint head;
+  guint n;
+  guint i;
+
+  head = (guint) g_atomic_int_get (&ring->head);
+  n = MIN (head, GFREENECT_MOTION_HISTORY);
+
+  states = g_array_new (FALSE, FALSE, sizeof (GFreenectMotionState));
+
+  for (i = 1; i <= n; i++)
+    {
+      GFreenectMotionState state;
+
+      if (! read_sample (ring, head - i, &state) || state.timestamp < since)
+        break;
+
+      g_array_append_val (states, state);
+    }
+
+  /* collected newest first */
+  for (i = 0; i < states->len / 2; i++)
+    {
+      GFreenectMotionState tmp;
+      guint j = states->len - 1 - i;
+
+      tmp = g_array_index (states, GFreenectMotionState, i);
+      g_array_index (states, GFreenectMotionState, i) =
+        g_array_index (states, GFreenectMotionState, j);
+      g_array_index (states, GFreenectMotionState, j) = tmp;
+    }
+
+  return states;
+}
+
+/* Estimates the state at @time by interpolating linearly between the
+   samples taken around it. Times outside the history take the closest
+   sample. Returns FALSE if no sample was taken yet. */
+gboolean
+gfreenect_motion_ring_interpolate (GFreenectMotionRing  *ring,
+                                   gint64                time,
+                                   GFreenectMotionState *state)
+{
+  GFreenectMotionState newer;
+  GFreenectMotionState older;
+  gboolean has_newer = FALSE;
+  guint head;
+  guint n;
+  guint i;
+  gdouble t;
+
+  head = (guint) g_atomic_int_get (&ring->head);
+  n = MIN (head, GFREENECT_MOTION_HISTORY);
+
+  for (i = 1; i <= n; i++)
+    {
+      if (! read_sample (ring, head - i, &older))
+        break;
+
+      if (older.timestamp <= time)
+        {
+          if (! has_newer || newer.timestamp == older.timestamp)
+            {
+              *state = older;
+            }
+          else
+            {
+              t = (gdouble) (time - older.timestamp) /
+                (newer.timestamp - older.timestamp);
+
+              state->accel_x = older.accel_x + t * (newer.accel_x - older.accel_x);
+              state->accel_y = older.accel_y + t * (newer.accel_y - older.accel_y);
+              state->accel_z = older.accel_z + t * (newer.accel_z - older.accel_z);
+              state->tilt_angle = older.tilt_angle +
+                t * (newer.tilt_angle - older.tilt_angle);
+              state->tilt_status = t < 0.5 ? older.tilt_status :
+                newer.tilt_status;
+            }
+
+          state->timestamp = time;
+          return TRUE;
+        }
+
+      newer = older;
+      has_newer = TRUE;
+    }
+
+  /* older than the history, or the writer lapped us */
+  if (! has_newer)
+    return FALSE;
+
+  *state = newer;
+  state->timestamp = time;
+
+  return TRUE;
+}
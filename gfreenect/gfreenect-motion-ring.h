@@ -0,0 +1,59 @@
+/*
+ * gfreenect-motion-ring.h
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+
+#ifndef __GFREENECT_MOTION_RING_H__
+#define __GFREENECT_MOTION_RING_H__
+
+#include <glib.h>
+
+#include "gfreenect-motion-state.h"
+
+G_BEGIN_DECLS
+
+/* History of the last GFREENECT_MOTION_HISTORY motion states, with a
+   single writer and any number of readers that never block it. Each slot
+   has a sequence number that is odd while the slot is being written, and
+   otherwise tells which sample it holds. */
+typedef struct
+{
+  GFreenectMotionState *states;
+  gint *seq;
+  gint head;                    /* samples pushed so far, wrapping */
+} GFreenectMotionRing;
+
+void     gfreenect_motion_ring_init        (GFreenectMotionRing        *ring);
+void     gfreenect_motion_ring_clear       (GFreenectMotionRing        *ring);
+
+void     gfreenect_motion_ring_push        (GFreenectMotionRing        *ring,
+                                            const GFreenectMotionState *state);
+
+gboolean gfreenect_motion_ring_latest      (GFreenectMotionRing        *ring,
+                                            GFreenectMotionState       *state);
+GArray * gfreenect_motion_ring_since       (GFreenectMotionRing        *ring,
+                                            gint64                      since);
+gboolean gfreenect_motion_ring_interpolate (GFreenectMotionRing        *ring,
+                                            gint64                      time,
+                                            GFreenectMotionState       *state);
+
+G_END_DECLS
+
+#endif /* __GFREENECT_MOTION_RING_H__ */
@@ -0,0 +1,88 @@
+/*
+ * gfreenect-motion-state.c
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+
+/**
+ * SECTION:gfreenect-motion-state
+ * @short_description: Data structure describing a sample of the motor
+ * subdevice state.
+ *
+ * A #GFreenectMotionState holds the accelerometer values and the tilt motor
+ * status sampled at a given time. They are produced by the motion stream of
+ * #GFreenectDevice, see gfreenect_device_start_motion_stream().
+ *
+ * Use gfreenect_motion_state_copy() to create an exact copy of the object
+ * and gfreenect_motion_state_free() to free it.
+ **/
+
+#include <string.h>
+
+#include "gfreenect-motion-state.h"
+
+/**
+ * gfreenect_motion_state_get_type:
+ *
+ * Returns: The registered #GType for #GFreenectMotionState boxed type
+ **/
+GType
+gfreenect_motion_state_get_type (void)
+{
+  static GType type = 0;
+
+  if (G_UNLIKELY (type == 0))
+    type = g_boxed_type_register_static ("GFreenectMotionState",
+                              (GBoxedCopyFunc) gfreenect_motion_state_copy,
+                              (GBoxedFreeFunc) gfreenect_motion_state_free);
+  return type;
+}
+
+/**
+ * gfreenect_motion_state_copy:
+ * @state: The #GFreenectMotionState to copy
+ *
+ * Makes an exact copy of a #GFreenectMotionState object.
+ *
+ * Returns: (transfer full): A newly created #GFreenectMotionState. Use
+ * gfreenect_motion_state_free() to free it.
+ **/
+gpointer
+gfreenect_motion_state_copy (GFreenectMotionState *state)
+{
+  GFreenectMotionState *copy;
+
+  copy = g_slice_new (GFreenectMotionState);
+
+  memcpy (copy, state, sizeof (GFreenectMotionState));
+
+  return copy;
+}
+
+/**
+ * gfreenect_motion_state_free:
+ * @state: The #GFreenectMotionState to free
+ *
+ * Frees a #GFreenectMotionState object.
+ **/
+void
+gfreenect_motion_state_free (GFreenectMotionState *state)
+{
+  g_slice_free (GFreenectMotionState, state);
+}
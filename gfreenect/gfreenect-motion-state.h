@@ -0,0 +1,67 @@
+/*
+ * gfreenect-motion-state.h
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+
+#ifndef __GFREENECT_MOTION_STATE_H__
+#define __GFREENECT_MOTION_STATE_H__
+
+#include <glib.h>
+#include <glib-object.h>
+
+#include "gfreenect-decls.h"
+
+G_BEGIN_DECLS
+
+#define GFREENECT_TYPE_MOTION_STATE (gfreenect_motion_state_get_type ())
+
+typedef struct _GFreenectMotionState GFreenectMotionState;
+
+/**
+ * GFreenectMotionState:
+ * @timestamp: The monotonic time the state was sampled at, in microseconds,
+ * as returned by g_get_monotonic_time()
+ * @accel_x: The X-axis value of the accelerometer
+ * @accel_y: The Y-axis value of the accelerometer
+ * @accel_z: The Z-axis value of the accelerometer
+ * @tilt_angle: The angle of the tilt motor relative to the horizon, in
+ * degrees
+ * @tilt_status: The #GFreenectTiltStatus of the tilt motor
+ *
+ * A sample of the state of the motor subdevice. The accelerometer values
+ * are raw, as returned by gfreenect_device_get_accel().
+ **/
+struct _GFreenectMotionState
+{
+  gint64 timestamp;
+  gdouble accel_x;
+  gdouble accel_y;
+  gdouble accel_z;
+  gdouble tilt_angle;
+  GFreenectTiltStatus tilt_status;
+};
+
+GType                  gfreenect_motion_state_get_type (void);
+gpointer               gfreenect_motion_state_copy     (GFreenectMotionState *state);
+void                   gfreenect_motion_state_free     (GFreenectMotionState *state);
+
+G_END_DECLS
+
+#endif /* __GFREENECT_MOTION_STATE_H__ */
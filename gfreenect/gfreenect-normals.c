@@ -0,0 +1,236 @@
+/*
+ * gfreenect-normals.c
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+#include <math.h>
+
+#include "gfreenect-normals.h"
+#include "gfreenect-parallel.h"
+
+#define MIN_ROWS_PER_CHUNK    16
+#define MIN_COLUMNS_PER_CHUNK 64
+
+/* one entry of the summed-area table: sums of the coordinates of the valid
+   points above and to the left, and their number */
+typedef struct
+{
+  gdouble x;
+  gdouble y;
+  gdouble z;
+  gdouble n;
+} AreaSum;
+
+typedef struct
+{
+  const gfloat *points;
+  gsize width;
+  gsize height;
+  guint window;
+  AreaSum *table;
+  gfloat *normals;
+} NormalsJob;
+
+/* Returns the size of the scratch buffer gfreenect_normals_compute()
+   needs for frames of the given size. */
+gsize
+gfreenect_normals_get_scratch_size (gsize width, gsize height)
+{
+  return (width + 1) * (height + 1) * sizeof (AreaSum);
+}
+
+/* prefix sums along each row, table row y + 1 holds image row y */
+static void
+sum_rows (guint first, guint last, gpointer user_data)
+{
+  NormalsJob *job = user_data;
+  gsize stride = job->width + 1;
+  guint x, y;
+
+  for (y = first; y < last; y++)
+    {
+      const gfloat *p = job->points + y * job->width * 3;
+      AreaSum *row = job->table + (y + 1) * stride;
+      AreaSum acc = { 0.0, 0.0, 0.0, 0.0 };
+
+      row[0] = acc;
+      for (x = 0; x < job->width; x++)
+        {
+          gdouble valid = p[x * 3 + 2] > 0.0f;
+
+          acc.x += p[x * 3 + 0];
+          acc.y += p[x * 3 + 1];
+          acc.z += p[x * 3 + 2];
+          acc.n += valid;
+
+          row[x + 1] = acc;
+        }
+    }
+}
+
+/* prefix sums along each column, over a range of columns so that every
+   thread walks contiguous memory */
+static void
+sum_columns (guint first, guint last, gpointer user_data)
+{
+  NormalsJob *job = user_data;
+  gsize stride = job->width + 1;
+  guint x, y;
+
+  for (y = 2; y <= job->height; y++)
+    {
+      AreaSum *row = job->table + y * stride;
+      const AreaSum *prev = row - stride;
+
+      for (x = first; x < last; x++)
+        {
+          row[x].x += prev[x].x;
+          row[x].y += prev[x].y;
+          row[x].z += prev[x].z;
+          row[x].n += prev[x].n;
+        }
+    }
+}
+
+/* mean point of the valid points in [x0, x1) x [y0, y1), FALSE if none */
+static inline gboolean
+area_mean (const NormalsJob *job,
+           gint              x0,
+           gint              y0,
+           gint              x1,
+           gint              y1,
+           gdouble          *mean)
+{
+  gsize stride = job->width + 1;
+  const AreaSum *a = job->table + y0 * stride + x0;
+  const AreaSum *b = job->table + y0 * stride + x1;
+  const AreaSum *c = job->table + y1 * stride + x0;
+  const AreaSum *d = job->table + y1 * stride + x1;
+  gdouble n;
+
+  n = d->n - b->n - c->n + a->n;
+  if (n < 0.5)
+    return FALSE;
+
+  mean[0] = (d->x - b->x - c->x + a->x) / n;
+  mean[1] = (d->y - b->y - c->y + a->y) / n;
+  mean[2] = (d->z - b->z - c->z + a->z) / n;
+
+  return TRUE;
+}
+
+/* The normal is the cross product of the horizontal and vertical
+   gradients, each one the difference between the mean points of the two
+   halves of a window around the pixel. The window grows with the depth,
+   as the noise of the sensor does. */
+static void
+normal_rows (guint first, guint last, gpointer user_data)
+{
+  NormalsJob *job = user_data;
+  gint width = job->width;
+  gint height = job->height;
+  gint x, y;
+
+  for (y = first; y < (gint) last; y++)
+    for (x = 0; x < width; x++)
+      {
+        const gfloat *p = job->points + (y * width + x) * 3;
+        gfloat *n = job->normals + (y * width + x) * 3;
+        gdouble left[3], right[3], up[3], down[3];
+        gdouble h[3], v[3], c[3];
+        gdouble len;
+        gint r;
+
+        n[0] = n[1] = n[2] = NAN;
+
+        if (p[2] <= 0.0f)
+          continue;
+
+        r = (job->window * p[2] + 500.0f) / 1000.0f;
+        r = CLAMP (r, 1, GFREENECT_NORMALS_MAX_RADIUS);
+
+        if (x < r || y < r || x + r >= width || y + r >= height)
+          continue;
+
+        if (! area_mean (job, x - r, y - r, x, y + r + 1, left) ||
+            ! area_mean (job, x + 1, y - r, x + r + 1, y + r + 1, right) ||
+            ! area_mean (job, x - r, y - r, x + r + 1, y, up) ||
+            ! area_mean (job, x - r, y + 1, x + r + 1, y + r + 1, down))
+          {
+            continue;
+          }
+
+        h[0] = right[0] - left[0];
+        h[1] = right[1] - left[1];
+        h[2] = right[2] - left[2];
+
+        v[0] = down[0] - up[0];
+        v[1] = down[1] - up[1];
+        v[2] = down[2] - up[2];
+
+        c[0] = h[1] * v[2] - h[2] * v[1];
+        c[1] = h[2] * v[0] - h[0] * v[2];
+        c[2] = h[0] * v[1] - h[1] * v[0];
+
+        len = sqrt (c[0] * c[0] + c[1] * c[1] + c[2] * c[2]);
+        if (len == 0.0)
+          continue;
+
+        /* orient towards the camera */
+        if (c[0] * p[0] + c[1] * p[1] + c[2] * p[2] > 0.0)
+          len = -len;
+
+        n[0] = c[0] / len;
+        n[1] = c[1] / len;
+        n[2] = c[2] / len;
+      }
+}
+
+/* Computes a unit normal for every point of an organized point cloud, as
+   produced by gfreenect_registration_depth_to_points(). Points with a zero
+   Z are invalid and, as pixels too close to the border for their window or
+   whose window has no valid points on either side, get a NaN normal.
+   'window' is the half size of the window at one meter; 'scratch' must
+   hold gfreenect_normals_get_scratch_size() bytes. */
+void
+gfreenect_normals_compute (const gfloat *points,
+                           gsize         width,
+                           gsize         height,
+                           guint         window,
+                           gpointer      scratch,
+                           gfloat       *normals)
+{
+  NormalsJob job;
+  guint x;
+
+  job.points = points;
+  job.width = width;
+  job.height = height;
+  job.window = window;
+  job.table = scratch;
+  job.normals = normals;
+
+  /* the first row of the table stays zero */
+  for (x = 0; x <= width; x++)
+    job.table[x].x = job.table[x].y = job.table[x].z = job.table[x].n = 0.0;
+
+  gfreenect_parallel_for (height, MIN_ROWS_PER_CHUNK, sum_rows, &job);
+  gfreenect_parallel_for (width + 1, MIN_COLUMNS_PER_CHUNK, sum_columns, &job);
+  gfreenect_parallel_for (height, MIN_ROWS_PER_CHUNK, normal_rows, &job);
+}
@@ -0,0 +1,42 @@
+/*
+ * gfreenect-normals.h
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+#ifndef __GFREENECT_NORMALS_H__
+#define __GFREENECT_NORMALS_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+#define GFREENECT_NORMALS_MAX_RADIUS 16
+
+gsize gfreenect_normals_get_scratch_size (gsize width, gsize height);
+
+void  gfreenect_normals_compute          (const gfloat *points,
+                                          gsize         width,
+                                          gsize         height,
+                                          guint         window,
+                                          gpointer      scratch,
+                                          gfloat       *normals);
+
+G_END_DECLS
+
+#endif /* __GFREENECT_NORMALS_H__ */
@@ -0,0 +1,878 @@
+/*
+ * gfreenect-occupancy-grid.c
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+
+/**
+ * SECTION:gfreenect-occupancy-grid
+ * @short_description: Accumulates depth frames into a 3D occupancy grid
+ *
+ * A #GFreenectOccupancyGrid fuses depth frames over time into a coarse grid
+ * of cubic voxels of #GFreenectOccupancyGrid:voxel-size millimeters, each
+ * holding the log-odds of being occupied. Every call to
+ * gfreenect_occupancy_grid_process() raises the log-odds of the voxels the
+ * pixels of the frame fall into, and lowers those of known voxels the
+ * sensor sees through, so objects that move away fade out of the grid.
+ *
+ * The grid is kept level with the floor using the tilt of the sensor, set
+ * with gfreenect_occupancy_grid_set_tilt_angle() or by binding the
+ * #GFreenectOccupancyGrid:tilt-angle property to the
+ * #GFreenectDevice:tilt-angle property of the device. Voxel coordinates are
+ * relative to the sensor: X grows to the right, Y upwards and Z away from
+ * the sensor along the floor, so the voxel with coordinates (x, y, z) spans
+ * from x * #GFreenectOccupancyGrid:voxel-size to
+ * (x + 1) * #GFreenectOccupancyGrid:voxel-size millimeters along X, and so
+ * on.
+ *
+ * Only voxels that have been seen occupied at least once are stored, in a
+ * hash table of fixed size, so memory use is bounded by
+ * #GFreenectOccupancyGrid:max-voxels regardless of the size of the scene.
+ * When the table is full, newly seen voxels are not recorded until
+ * gfreenect_occupancy_grid_reset() is called.
+ *
+ * The state of the grid is exported with gfreenect_occupancy_grid_get_counts()
+ * and gfreenect_occupancy_grid_get_slice().
+ **/
+
+#include <string.h>
+#include <math.h>
+
+#include "gfreenect-occupancy-grid.h"
+#include "gfreenect-parallel.h"
+
+#define GFREENECT_OCCUPANCY_GRID_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), \
+                                                   GFREENECT_TYPE_OCCUPANCY_GRID, \
+                                                   GFreenectOccupancyGridPrivate))
+
+#define WIDTH                 GFREENECT_REGISTRATION_WIDTH
+#define HEIGHT                GFREENECT_REGISTRATION_HEIGHT
+#define PIXELS                (WIDTH * HEIGHT)
+
+#define DEFAULT_VOXEL_SIZE    50.0
+#define DEFAULT_MAX_VOXELS    262144
+#define DEFAULT_HIT_LOG_ODDS  0.85
+#define DEFAULT_MISS_LOG_ODDS -0.4
+
+/* log-odds are stored in 8.8 fixed point */
+#define LOG_ODDS_ONE          256
+#define LOG_ODDS_MIN          (-2 * LOG_ODDS_ONE)
+#define LOG_ODDS_MAX          (7 * LOG_ODDS_ONE / 2)
+
+/* depth beyond this, in millimeters, is too noisy to be fused */
+#define MAX_RANGE             8000.0
+
+/* one free space ray is cast per RAY_STEP x RAY_STEP pixels */
+#define RAY_STEP              8
+#define RAYS_PER_ROW          (WIDTH / RAY_STEP)
+#define RAY_ROWS              (HEIGHT / RAY_STEP)
+
+/* the table is split in shards, updated concurrently */
+#define SHARD_BITS            6
+#define N_SHARDS              (1 << SHARD_BITS)
+
+/* voxel coordinates are packed in 21 bits each, zero is the empty key */
+#define COORD_BITS            21
+#define COORD_OFFSET          (1 << (COORD_BITS - 1))
+#define MISS_FLAG             (G_GUINT64_CONSTANT (1) << 63)
+
+#define MIN_ROWS_PER_CHUNK    16
+#define MIN_SHARDS_PER_CHUNK  4
+
+typedef struct
+{
+  guint64 key;
+  guint32 stamp;
+  gint16 log_odds;
+} Voxel;
+
+typedef struct
+{
+  guint count;
+  guint occupied;
+  guint free;
+} ShardStats;
+
+/* private data */
+struct _GFreenectOccupancyGridPrivate
+{
+  GFreenectRegistration *registration;
+
+  gdouble voxel_size;
+  guint max_voxels;
+  gdouble hit_log_odds;
+  gdouble miss_log_odds;
+  gint hit;
+  gint miss;
+
+  gdouble tilt_angle;
+  gfloat cos_tilt;
+  gfloat sin_tilt;
+
+  Voxel *voxels;
+  guint shard_size;
+  guint shard_capacity;
+  ShardStats shards[N_SHARDS];
+  guint32 frame;
+
+  gfloat *points;
+  guint64 *hits;
+  guint hit_count[HEIGHT];
+  guint64 *misses;
+  guint miss_count[RAY_ROWS];
+  guint ray_capacity;
+  guint64 *sorted;
+  guint shard_offset[N_SHARDS + 1];
+};
+
+/* properties */
+enum
+{
+  PROP_0,
+  PROP_REGISTRATION,
+  PROP_VOXEL_SIZE,
+  PROP_MAX_VOXELS,
+  PROP_HIT_LOG_ODDS,
+  PROP_MISS_LOG_ODDS,
+  PROP_TILT_ANGLE
+};
+
+static void     gfreenect_occupancy_grid_class_init         (GFreenectOccupancyGridClass *class);
+static void     gfreenect_occupancy_grid_init               (GFreenectOccupancyGrid *self);
+static void     gfreenect_occupancy_grid_finalize           (GObject *obj);
+
+static void     gfreenect_occupancy_grid_set_property       (GObject      *obj,
+                                                             guint         prop_id,
+                                                             const GValue *value,
+                                                             GParamSpec   *pspec);
+static void     gfreenect_occupancy_grid_get_property       (GObject    *obj,
+                                                             guint       prop_id,
+                                                             GValue     *value,
+                                                             GParamSpec *pspec);
+
+G_DEFINE_TYPE (GFreenectOccupancyGrid, gfreenect_occupancy_grid, G_TYPE_OBJECT);
+
+static void
+gfreenect_occupancy_grid_class_init (GFreenectOccupancyGridClass *class)
+{
+  GObjectClass *obj_class;
+
+  obj_class = G_OBJECT_CLASS (class);
+
+  obj_class->finalize = gfreenect_occupancy_grid_finalize;
+  obj_class->get_property = gfreenect_occupancy_grid_get_property;
+  obj_class->set_property = gfreenect_occupancy_grid_set_property;
+
+  /* install properties */
+
+  /**
+   * GFreenectOccupancyGrid:registration
+   *
+   * The #GFreenectRegistration used to project depth frames to world
+   * coordinates.
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_REGISTRATION,
+                                   g_param_spec_boxed ("registration",
+                                                       "Registration",
+                                                       "Registration used to compute world coordinates",
+                                                       GFREENECT_TYPE_REGISTRATION,
+                                                       G_PARAM_READWRITE |
+                                                       G_PARAM_CONSTRUCT_ONLY |
+                                                       G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GFreenectOccupancyGrid:voxel-size
+   *
+   * The length, in millimeters, of the side of each voxel.
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_VOXEL_SIZE,
+                                   g_param_spec_double ("voxel-size",
+                                                        "Voxel size",
+                                                        "Length of the side of each voxel",
+                                                        20.0,
+                                                        1000.0,
+                                                        DEFAULT_VOXEL_SIZE,
+                                                        G_PARAM_READWRITE |
+                                                        G_PARAM_CONSTRUCT_ONLY |
+                                                        G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GFreenectOccupancyGrid:max-voxels
+   *
+   * The largest number of voxels the grid stores. Each voxel takes 32 bytes
+   * of memory, allocated when the first frame is processed.
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_MAX_VOXELS,
+                                   g_param_spec_uint ("max-voxels",
+                                                      "Maximum voxels",
+                                                      "Largest number of voxels stored",
+                                                      N_SHARDS,
+                                                      1 << 24,
+                                                      DEFAULT_MAX_VOXELS,
+                                                      G_PARAM_READWRITE |
+                                                      G_PARAM_CONSTRUCT_ONLY |
+                                                      G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GFreenectOccupancyGrid:hit-log-odds
+   *
+   * The log-odds added to a voxel each frame a pixel falls into it.
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_HIT_LOG_ODDS,
+                                   g_param_spec_double ("hit-log-odds",
+                                                        "Hit log-odds",
+                                                        "Log-odds added to voxels seen occupied",
+                                                        0.0,
+                                                        4.0,
+                                                        DEFAULT_HIT_LOG_ODDS,
+                                                        G_PARAM_READWRITE |
+                                                        G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GFreenectOccupancyGrid:miss-log-odds
+   *
+   * The log-odds added to a voxel each frame the sensor sees through it.
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_MISS_LOG_ODDS,
+                                   g_param_spec_double ("miss-log-odds",
+                                                        "Miss log-odds",
+                                                        "Log-odds added to voxels seen free",
+                                                        -4.0,
+                                                        0.0,
+                                                        DEFAULT_MISS_LOG_ODDS,
+                                                        G_PARAM_READWRITE |
+                                                        G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GFreenectOccupancyGrid:tilt-angle
+   *
+   * The angle of the sensor relative to the horizon, in degrees, as given
+   * by #GFreenectDevice:tilt-angle.
+   **/
+  g_object_class_install_property (obj_class,
+                                   PROP_TILT_ANGLE,
+                                   g_param_spec_double ("tilt-angle",
+                                                        "Tilt angle",
+                                                        "Vertical angle relative to the horizon",
+                                                        -90.0,
+                                                        90.0,
+                                                        0.0,
+                                                        G_PARAM_READWRITE |
+                                                        G_PARAM_STATIC_STRINGS));
+
+  /* add private structure */
+  g_type_class_add_private (obj_class, sizeof (GFreenectOccupancyGridPrivate));
+}
+
+static void
+gfreenect_occupancy_grid_init (GFreenectOccupancyGrid *self)
+{
+  GFreenectOccupancyGridPrivate *priv;
+
+  priv = GFREENECT_OCCUPANCY_GRID_GET_PRIVATE (self);
+  self->priv = priv;
+
+  priv->registration = NULL;
+
+  priv->voxel_size = DEFAULT_VOXEL_SIZE;
+  priv->max_voxels = DEFAULT_MAX_VOXELS;
+  priv->hit_log_odds = DEFAULT_HIT_LOG_ODDS;
+  priv->hit = DEFAULT_HIT_LOG_ODDS * LOG_ODDS_ONE;
+  priv->miss_log_odds = DEFAULT_MISS_LOG_ODDS;
+  priv->miss = DEFAULT_MISS_LOG_ODDS * LOG_ODDS_ONE;
+
+  priv->tilt_angle = 0.0;
+  priv->cos_tilt = 1.0f;
+  priv->sin_tilt = 0.0f;
+
+  /* the table and frame buffers depend on construct-only properties, and
+     are allocated by the first call to process() */
+  priv->voxels = NULL;
+  priv->shard_size = 0;
+  priv->shard_capacity = 0;
+  memset (priv->shards, 0, sizeof (priv->shards));
+  priv->frame = 0;
+
+  priv->points = NULL;
+  priv->hits = NULL;
+  priv->misses = NULL;
+  priv->ray_capacity = 0;
+  priv->sorted = NULL;
+}
+
+static void
+gfreenect_occupancy_grid_finalize (GObject *obj)
+{
+  GFreenectOccupancyGrid *self = GFREENECT_OCCUPANCY_GRID (obj);
+
+  if (self->priv->registration != NULL)
+    gfreenect_registration_unref (self->priv->registration);
+
+  g_free (self->priv->voxels);
+  g_free (self->priv->points);
+  g_free (self->priv->hits);
+  g_free (self->priv->misses);
+  g_free (self->priv->sorted);
+
+  G_OBJECT_CLASS (gfreenect_occupancy_grid_parent_class)->finalize (obj);
+}
+
+static void
+set_tilt_angle (GFreenectOccupancyGridPrivate *priv, gdouble tilt_angle)
+{
+  priv->tilt_angle = tilt_angle;
+  priv->cos_tilt = cos (tilt_angle * G_PI / 180.0);
+  priv->sin_tilt = sin (tilt_angle * G_PI / 180.0);
+}
+
+static void
+gfreenect_occupancy_grid_set_property (GObject      *obj,
+                                       guint         prop_id,
+                                       const GValue *value,
+                                       GParamSpec   *pspec)
+{
+  GFreenectOccupancyGrid *self;
+
+  self = GFREENECT_OCCUPANCY_GRID (obj);
+
+  switch (prop_id)
+    {
+    case PROP_REGISTRATION:
+      self->priv->registration = g_value_dup_boxed (value);
+      break;
+
+    case PROP_VOXEL_SIZE:
+      self->priv->voxel_size = g_value_get_double (value);
+      break;
+
+    case PROP_MAX_VOXELS:
+      self->priv->max_voxels = g_value_get_uint (value);
+      break;
+
+    case PROP_HIT_LOG_ODDS:
+      self->priv->hit_log_odds = g_value_get_double (value);
+      self->priv->hit = self->priv->hit_log_odds * LOG_ODDS_ONE;
+      break;
+
+    case PROP_MISS_LOG_ODDS:
+      self->priv->miss_log_odds = g_value_get_double (value);
+      self->priv->miss = self->priv->miss_log_odds * LOG_ODDS_ONE;
+      break;
+
+    case PROP_TILT_ANGLE:
+      set_tilt_angle (self->priv, g_value_get_double (value));
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (obj, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+gfreenect_occupancy_grid_get_property (GObject    *obj,
+                                       guint       prop_id,
+                                       GValue     *value,
+                                       GParamSpec *pspec)
+{
+  GFreenectOccupancyGrid *self;
+
+  self = GFREENECT_OCCUPANCY_GRID (obj);
+
+  switch (prop_id)
+    {
+    case PROP_REGISTRATION:
+      g_value_set_boxed (value, self->priv->registration);
+      break;
+
+    case PROP_VOXEL_SIZE:
+      g_value_set_double (value, self->priv->voxel_size);
+      break;
+
+    case PROP_MAX_VOXELS:
+      g_value_set_uint (value, self->priv->max_voxels);
+      break;
+
+    case PROP_HIT_LOG_ODDS:
+      g_value_set_double (value, self->priv->hit_log_odds);
+      break;
+
+    case PROP_MISS_LOG_ODDS:
+      g_value_set_double (value, self->priv->miss_log_odds);
+      break;
+
+    case PROP_TILT_ANGLE:
+      g_value_set_double (value, self->priv->tilt_angle);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (obj, prop_id, pspec);
+      break;
+    }
+}
+
+static inline guint64
+make_key (gint x, gint y, gint z)
+{
+  return ((guint64) (x + COORD_OFFSET) << (2 * COORD_BITS)) |
+    ((guint64) (y + COORD_OFFSET) << COORD_BITS) |
+    (guint64) (z + COORD_OFFSET);
+}
+
+/* 64-bit finalizer of MurmurHash3, spreads neighbouring voxels across the
+   whole table */
+static inline guint64
+hash_key (guint64 key)
+{
+  key ^= key >> 33;
+  key *= G_GUINT64_CONSTANT (0xff51afd7ed558ccd);
+  key ^= key >> 33;
+  key *= G_GUINT64_CONSTANT (0xc4ceb9fe1a85ec53);
+  key ^= key >> 33;
+
+  return key;
+}
+
+static inline guint
+shard_of (guint64 hash)
+{
+  return hash >> (64 - SHARD_BITS);
+}
+
+static void
+ensure_buffers (GFreenectOccupancyGridPrivate *priv)
+{
+  guint ray_length;
+
+  if (priv->voxels != NULL)
+    return;
+
+  /* keep the load factor of each shard at or below one half, so probe
+     sequences stay short */
+  priv->shard_capacity = (priv->max_voxels + N_SHARDS - 1) / N_SHARDS;
+  priv->shard_size = 1 << g_bit_storage (2 * priv->shard_capacity - 1);
+  priv->voxels = g_new0 (Voxel, N_SHARDS * priv->shard_size);
+
+  ray_length = MAX_RANGE / priv->voxel_size + 1;
+  priv->ray_capacity = RAYS_PER_ROW * ray_length;
+
+  priv->points = g_new (gfloat, PIXELS * 3);
+  priv->hits = g_new (guint64, PIXELS);
+  priv->misses = g_new (guint64, RAY_ROWS * priv->ray_capacity);
+  priv->sorted = g_new (guint64, PIXELS + RAY_ROWS * priv->ray_capacity);
+}
+
+/* Computes the keys of the voxels hit by each row, and of the voxels
+   crossed by the free space rays cast from the rows that have them.
+   Consecutive repeated keys are dropped here already, which removes most
+   of the duplicates since neighbouring pixels usually share a voxel. */
+static void
+collect_rows (guint first, guint last, gpointer user_data)
+{
+  GFreenectOccupancyGridPrivate *priv = user_data;
+  gfloat scale = 1.0f / priv->voxel_size;
+  guint x, y;
+
+  for (y = first; y < last; y++)
+    {
+      const gfloat *p = priv->points + y * WIDTH * 3;
+      guint64 *hits = priv->hits + y * WIDTH;
+      gboolean cast_rays = y % RAY_STEP == RAY_STEP / 2;
+      guint64 *misses = NULL;
+      guint64 prev = 0;
+      guint n_hits = 0;
+      guint n_misses = 0;
+
+      if (cast_rays)
+        misses = priv->misses + (y / RAY_STEP) * priv->ray_capacity;
+
+      for (x = 0; x < WIDTH; x++, p += 3)
+        {
+          gfloat right, up, forward;
+          guint64 key;
+
+          if (p[2] <= 0.0f || p[2] > MAX_RANGE)
+            continue;
+
+          /* rotate by the tilt around the X axis, camera Y points down */
+          right = p[0];
+          up = p[2] * priv->sin_tilt - p[1] * priv->cos_tilt;
+          forward = p[2] * priv->cos_tilt + p[1] * priv->sin_tilt;
+
+          key = make_key (floorf (right * scale),
+                          floorf (up * scale),
+                          floorf (forward * scale));
+          if (key != prev)
+            hits[n_hits++] = key;
+          prev = key;
+
+          if (cast_rays && x % RAY_STEP == RAY_STEP / 2)
+            {
+              guint64 prev_miss = 0;
+              gfloat length;
+              guint steps;
+              guint i;
+
+              /* sample the ray at voxel size intervals, stopping one voxel
+                 short of the surface */
+              length = sqrtf (right * right + up * up + forward * forward) * scale;
+              steps = MIN (length, MAX_RANGE * scale);
+
+              for (i = 0; i + 1 < steps; i++)
+                {
+                  gfloat t = i / length;
+
+                  key = make_key (floorf (right * scale * t),
+                                  floorf (up * scale * t),
+                                  floorf (forward * scale * t));
+                  if (key != prev_miss)
+                    misses[n_misses++] = key | MISS_FLAG;
+                  prev_miss = key;
+                }
+            }
+        }
+
+      priv->hit_count[y] = n_hits;
+      if (cast_rays)
+        priv->miss_count[y / RAY_STEP] = n_misses;
+    }
+}
+
+/* Counting sort of all the keys of the frame by shard, hits before misses
+   so that a voxel both hit and crossed in the same frame counts as hit */
+static void
+sort_keys (GFreenectOccupancyGridPrivate *priv)
+{
+  guint pos[N_SHARDS];
+  guint y, i;
+
+  memset (pos, 0, sizeof (pos));
+
+  for (y = 0; y < HEIGHT; y++)
+    for (i = 0; i < priv->hit_count[y]; i++)
+      pos[shard_of (hash_key (priv->hits[y * WIDTH + i]))]++;
+
+  for (y = 0; y < RAY_ROWS; y++)
+    for (i = 0; i < priv->miss_count[y]; i++)
+      pos[shard_of (hash_key (priv->misses[y * priv->ray_capacity + i] & ~MISS_FLAG))]++;
+
+  priv->shard_offset[0] = 0;
+  for (i = 0; i < N_SHARDS; i++)
+    {
+      priv->shard_offset[i + 1] = priv->shard_offset[i] + pos[i];
+      pos[i] = priv->shard_offset[i];
+    }
+
+  for (y = 0; y < HEIGHT; y++)
+    for (i = 0; i < priv->hit_count[y]; i++)
+      {
+        guint64 key = priv->hits[y * WIDTH + i];
+
+        priv->sorted[pos[shard_of (hash_key (key))]++] = key;
+      }
+
+  for (y = 0; y < RAY_ROWS; y++)
+    for (i = 0; i < priv->miss_count[y]; i++)
+      {
+        guint64 key = priv->misses[y * priv->ray_capacity + i];
+
+        priv->sorted[pos[shard_of (hash_key (key & ~MISS_FLAG))]++] = key;
+      }
+}
+
+static Voxel *
+lookup (GFreenectOccupancyGridPrivate *priv, guint64 key, guint64 hash)
+{
+  Voxel *table = priv->voxels + shard_of (hash) * priv->shard_size;
+  guint mask = priv->shard_size - 1;
+  guint i;
+
+  for (i = hash & mask; table[i].key != 0; i = (i + 1) & mask)
+    if (table[i].key == key)
+      return &table[i];
+
+  return &table[i];
+}
+
+static void
+update_shards (guint first, guint last, gpointer user_data)
+{
+  GFreenectOccupancyGridPrivate *priv = user_data;
+  guint s, i;
+
+  for (s = first; s < last; s++)
+    {
+      ShardStats *stats = &priv->shards[s];
+
+      for (i = priv->shard_offset[s]; i < priv->shard_offset[s + 1]; i++)
+        {
+          guint64 key = priv->sorted[i] & ~MISS_FLAG;
+          gboolean miss = (priv->sorted[i] & MISS_FLAG) != 0;
+          Voxel *voxel;
+          gint old, new;
+
+          voxel = lookup (priv, key, hash_key (key));
+
+          if (voxel->key == 0)
+            {
+              /* free space only refines voxels already known */
+              if (miss || stats->count >= priv->shard_capacity)
+                continue;
+
+              voxel->key = key;
+              voxel->stamp = 0;
+              voxel->log_odds = 0;
+              stats->count++;
+            }
+
+          /* update each voxel at most once per frame */
+          if (voxel->stamp == priv->frame)
+            continue;
+          voxel->stamp = priv->frame;
+
+          old = voxel->log_odds;
+          new = CLAMP (old + (miss ? priv->miss : priv->hit),
+                       LOG_ODDS_MIN,
+                       LOG_ODDS_MAX);
+          voxel->log_odds = new;
+
+          stats->occupied += (new > 0) - (old > 0);
+          stats->free += (new < 0) - (old < 0);
+        }
+    }
+}
+
+/* public methods */
+
+/**
+ * gfreenect_occupancy_grid_new:
+ * @registration: The #GFreenectRegistration of the device the frames come
+ * from
+ * @voxel_size: The length of the side of each voxel, in millimeters
+ * @max_voxels: The largest number of voxels to store
+ *
+ * Creates a new #GFreenectOccupancyGrid. See
+ * gfreenect_device_get_registration() to obtain @registration.
+ *
+ * Returns: (transfer full): A newly created #GFreenectOccupancyGrid. Use
+ * g_object_unref() to free it.
+ **/
+GFreenectOccupancyGrid *
+gfreenect_occupancy_grid_new (GFreenectRegistration *registration,
+                              gdouble                voxel_size,
+                              guint                  max_voxels)
+{
+  g_return_val_if_fail (registration != NULL, NULL);
+
+  return g_object_new (GFREENECT_TYPE_OCCUPANCY_GRID,
+                       "registration", registration,
+                       "voxel-size", voxel_size,
+                       "max-voxels", max_voxels,
+                       NULL);
+}
+
+/**
+ * gfreenect_occupancy_grid_set_tilt_angle:
+ * @self: The #GFreenectOccupancyGrid
+ * @tilt_angle: The angle of the sensor relative to the horizon, in degrees
+ *
+ * Sets the tilt of the sensor used to level the frames given to
+ * gfreenect_occupancy_grid_process(), as the
+ * #GFreenectOccupancyGrid:tilt-angle property does.
+ **/
+void
+gfreenect_occupancy_grid_set_tilt_angle (GFreenectOccupancyGrid *self,
+                                         gdouble                 tilt_angle)
+{
+  g_return_if_fail (GFREENECT_IS_OCCUPANCY_GRID (self));
+
+  g_object_set (self, "tilt-angle", tilt_angle, NULL);
+}
+
+/**
+ * gfreenect_occupancy_grid_process:
+ * @self: The #GFreenectOccupancyGrid
+ * @depth_mm: (array fixed-size=307200): A 640x480 unregistered depth frame,
+ * in millimeters
+ *
+ * Fuses a new depth frame into the grid. Every voxel is updated at most
+ * once per frame: voxels containing pixels of the frame are marked as hit,
+ * and known voxels crossed by the line of sight of a subset of the pixels
+ * are marked as missed.
+ **/
+void
+gfreenect_occupancy_grid_process (GFreenectOccupancyGrid *self,
+                                  const guint16          *depth_mm)
+{
+  GFreenectOccupancyGridPrivate *priv;
+
+  g_return_if_fail (GFREENECT_IS_OCCUPANCY_GRID (self));
+  g_return_if_fail (depth_mm != NULL);
+
+  priv = self->priv;
+
+  ensure_buffers (priv);
+
+  priv->frame++;
+  if (priv->frame == 0)
+    priv->frame = 1;
+
+  gfreenect_registration_depth_to_points (priv->registration,
+                                          depth_mm,
+                                          priv->points);
+
+  gfreenect_parallel_for (HEIGHT, MIN_ROWS_PER_CHUNK, collect_rows, priv);
+
+  sort_keys (priv);
+
+  gfreenect_parallel_for (N_SHARDS, MIN_SHARDS_PER_CHUNK, update_shards, priv);
+}
+
+/**
+ * gfreenect_occupancy_grid_get_counts:
+ * @self: The #GFreenectOccupancyGrid
+ * @n_occupied: (out) (allow-none): Location to store the number of voxels
+ * more likely occupied than not, or %NULL
+ * @n_free: (out) (allow-none): Location to store the number of voxels more
+ * likely free than not, or %NULL
+ * @n_total: (out) (allow-none): Location to store the number of voxels
+ * stored, or %NULL
+ *
+ * Retrieves the number of voxels in the grid. Free voxels are those that
+ * were seen occupied and have been seen through since, such as the space
+ * left by objects that moved away. @n_total reaching
+ * #GFreenectOccupancyGrid:max-voxels means the grid is full.
+ **/
+void
+gfreenect_occupancy_grid_get_counts (GFreenectOccupancyGrid *self,
+                                     guint                  *n_occupied,
+                                     guint                  *n_free,
+                                     guint                  *n_total)
+{
+  guint occupied = 0;
+  guint free_voxels = 0;
+  guint total = 0;
+  guint i;
+
+  g_return_if_fail (GFREENECT_IS_OCCUPANCY_GRID (self));
+
+  for (i = 0; i < N_SHARDS; i++)
+    {
+      occupied += self->priv->shards[i].occupied;
+      free_voxels += self->priv->shards[i].free;
+      total += self->priv->shards[i].count;
+    }
+
+  if (n_occupied != NULL)
+    *n_occupied = occupied;
+  if (n_free != NULL)
+    *n_free = free_voxels;
+  if (n_total != NULL)
+    *n_total = total;
+}
+
+/**
+ * gfreenect_occupancy_grid_get_slice:
+ * @self: The #GFreenectOccupancyGrid
+ * @level: The Y coordinate of the voxels of the slice
+ * @x: The X coordinate of the first voxel of the slice
+ * @z: The Z coordinate of the first voxel of the slice
+ * @width: The number of voxels of the slice along X
+ * @depth: The number of voxels of the slice along Z
+ * @dest: (out caller-allocates) (array): Location to store @width x @depth
+ * bytes
+ *
+ * Exports a horizontal slice of the grid, as the probability of each voxel
+ * of being occupied scaled to the range 0 to 255. The slice is stored row
+ * by row, one row per Z coordinate starting at @z, each row holding @width
+ * voxels starting at @x. Voxels never seen occupied have a probability of
+ * one half, stored as 128.
+ **/
+void
+gfreenect_occupancy_grid_get_slice (GFreenectOccupancyGrid *self,
+                                    gint                    level,
+                                    gint                    x,
+                                    gint                    z,
+                                    guint                   width,
+                                    guint                   depth,
+                                    guint8                 *dest)
+{
+  GFreenectOccupancyGridPrivate *priv;
+  guint8 probability[LOG_ODDS_MAX - LOG_ODDS_MIN + 1];
+  gint i, j;
+
+  g_return_if_fail (GFREENECT_IS_OCCUPANCY_GRID (self));
+  g_return_if_fail (dest != NULL || width * depth == 0);
+
+  priv = self->priv;
+
+  for (i = LOG_ODDS_MIN; i <= LOG_ODDS_MAX; i++)
+    probability[i - LOG_ODDS_MIN] =
+      255.0 / (1.0 + exp (- (gdouble) i / LOG_ODDS_ONE)) + 0.5;
+
+  for (j = 0; j < (gint) depth; j++)
+    for (i = 0; i < (gint) width; i++)
+      {
+        gint vx = x + i;
+        gint vz = z + j;
+        const Voxel *voxel = NULL;
+        guint64 key;
+
+        dest[j * width + i] = probability[- LOG_ODDS_MIN];
+
+        if (priv->voxels == NULL ||
+            ABS (vx) >= COORD_OFFSET ||
+            ABS (level) >= COORD_OFFSET ||
+            ABS (vz) >= COORD_OFFSET)
+          {
+            continue;
+          }
+
+        key = make_key (vx, level, vz);
+        voxel = lookup (priv, key, hash_key (key));
+        if (voxel->key != 0)
+          dest[j * width + i] = probability[voxel->log_odds - LOG_ODDS_MIN];
+      }
+}
+
+/**
+ * gfreenect_occupancy_grid_reset:
+ * @self: The #GFreenectOccupancyGrid
+ *
+ * Removes all the voxels from the grid.
+ **/
+void
+gfreenect_occupancy_grid_reset (GFreenectOccupancyGrid *self)
+{
+  GFreenectOccupancyGridPrivate *priv;
+
+  g_return_if_fail (GFREENECT_IS_OCCUPANCY_GRID (self));
+
+  priv = self->priv;
+
+  if (priv->voxels != NULL)
+    memset (priv->voxels, 0, N_SHARDS * priv->shard_size * sizeof (Voxel));
+
+  memset (priv->shards, 0, sizeof (priv->shards));
+}
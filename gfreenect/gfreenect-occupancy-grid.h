@@ -0,0 +1,85 @@
+/*
+ * gfreenect-occupancy-grid.h
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+
+#ifndef __GFREENECT_OCCUPANCY_GRID_H__
+#define __GFREENECT_OCCUPANCY_GRID_H__
+
+#include <glib.h>
+#include <glib-object.h>
+
+#include <gfreenect-registration.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GFreenectOccupancyGrid GFreenectOccupancyGrid;
+typedef struct _GFreenectOccupancyGridClass GFreenectOccupancyGridClass;
+typedef struct _GFreenectOccupancyGridPrivate GFreenectOccupancyGridPrivate;
+
+struct _GFreenectOccupancyGrid
+{
+  GObject parent;
+
+  GFreenectOccupancyGridPrivate *priv;
+};
+
+struct _GFreenectOccupancyGridClass
+{
+  GObjectClass parent_class;
+};
+
+#define GFREENECT_TYPE_OCCUPANCY_GRID           (gfreenect_occupancy_grid_get_type ())
+#define GFREENECT_OCCUPANCY_GRID(obj)           (G_TYPE_CHECK_INSTANCE_CAST ((obj), GFREENECT_TYPE_OCCUPANCY_GRID, GFreenectOccupancyGrid))
+#define GFREENECT_OCCUPANCY_GRID_CLASS(obj)     (G_TYPE_CHECK_CLASS_CAST ((obj), GFREENECT_TYPE_OCCUPANCY_GRID, GFreenectOccupancyGridClass))
+#define GFREENECT_IS_OCCUPANCY_GRID(obj)        (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GFREENECT_TYPE_OCCUPANCY_GRID))
+#define GFREENECT_IS_OCCUPANCY_GRID_CLASS(obj)  (G_TYPE_CHECK_CLASS_TYPE ((obj), GFREENECT_TYPE_OCCUPANCY_GRID))
+#define GFREENECT_OCCUPANCY_GRID_GET_CLASS(obj) (G_TYPE_INSTANCE_GET_CLASS ((obj), GFREENECT_TYPE_OCCUPANCY_GRID, GFreenectOccupancyGridClass))
+
+GType                    gfreenect_occupancy_grid_get_type       (void) G_GNUC_CONST;
+
+GFreenectOccupancyGrid * gfreenect_occupancy_grid_new            (GFreenectRegistration *registration,
+                                                                  gdouble                voxel_size,
+                                                                  guint                  max_voxels);
+
+void                     gfreenect_occupancy_grid_set_tilt_angle (GFreenectOccupancyGrid *self,
+                                                                  gdouble                 tilt_angle);
+
+void                     gfreenect_occupancy_grid_process        (GFreenectOccupancyGrid *self,
+                                                                  const guint16          *depth_mm);
+
+void                     gfreenect_occupancy_grid_get_counts     (GFreenectOccupancyGrid *self,
+                                                                  guint                  *n_occupied,
+                                                                  guint                  *n_free,
+                                                                  guint                  *n_total);
+
+void                     gfreenect_occupancy_grid_get_slice      (GFreenectOccupancyGrid *self,
+                                                                  gint                    level,
+                                                                  gint                    x,
+                                                                  gint                    z,
+                                                                  guint                   width,
+                                                                  guint                   depth,
+                                                                  guint8                 *dest);
+
+void                     gfreenect_occupancy_grid_reset          (GFreenectOccupancyGrid *self);
+
+G_END_DECLS
+
+#endif /* __GFREENECT_OCCUPANCY_GRID_H__ */
@@ -0,0 +1,318 @@
+/*
+ * gfreenect-parallel.c
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#ifdef HAVE_PTHREAD_SETAFFINITY_NP
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <string.h>
+#include <gio/gio.h>
+
+#include "gfreenect-parallel.h"
+
+/* chunks per participating thread, so that threads finishing early take
+   over the remaining chunks of slower ones */
+#define CHUNKS_PER_THREAD 4
+
+typedef struct
+{
+  gint ref_count;
+
+  GFreenectParallelFunc func;
+  gpointer user_data;
+
+  guint n_items;
+  guint chunk_size;
+  guint n_chunks;
+  gint next_chunk;
+
+  GMutex mutex;
+  GCond cond;
+  guint pending;
+} ParallelJob;
+
+static GMutex pool_mutex;
+static GThreadPool *pool = NULL;
+static guint n_threads = 0;
+
+/* set on pool threads, to run nested calls serially instead of deadlocking */
+static GPrivate in_worker;
+
+#ifdef HAVE_PTHREAD_SETAFFINITY_NP
+static cpu_set_t affinity;
+static gint affinity_serial = 0;
+
+/* the affinity serial last applied by each pool thread, plus one */
+static GPrivate applied_serial;
+#endif
+
+static ParallelJob *
+job_ref (ParallelJob *job)
+{
+  g_atomic_int_inc (&job->ref_count);
+
+  return job;
+}
+
+static void
+job_unref (ParallelJob *job)
+{
+  if (! g_atomic_int_dec_and_test (&job->ref_count))
+    return;
+
+  g_mutex_clear (&job->mutex);
+  g_cond_clear (&job->cond);
+  g_slice_free (ParallelJob, job);
+}
+
+/* Claims chunks of the job until there are none left. Each thread taking
+   part in a job runs this, the calling thread included. */
+static void
+run_chunks (ParallelJob *job)
+{
+  guint done = 0;
+  guint chunk;
+
+  while ((chunk = g_atomic_int_add (&job->next_chunk, 1)) < job->n_chunks)
+    {
+      guint first = chunk * job->chunk_size;
+
+      job->func (first, MIN (first + job->chunk_size, job->n_items),
+                 job->user_data);
+      done++;
+    }
+
+  if (done == 0)
+    return;
+
+  g_mutex_lock (&job->mutex);
+
+  job->pending -= done;
+  if (job->pending == 0)
+    g_cond_signal (&job->cond);
+
+  g_mutex_unlock (&job->mutex);
+}
+
+#ifdef HAVE_PTHREAD_SETAFFINITY_NP
+static void
+apply_affinity (void)
+{
+  gint serial;
+  cpu_set_t set;
+
+  serial = g_atomic_int_get (&affinity_serial);
+  if (GPOINTER_TO_INT (g_private_get (&applied_serial)) == serial + 1)
+    return;
+
+  g_mutex_lock (&pool_mutex);
+  memcpy (&set, &affinity, sizeof (set));
+  g_mutex_unlock (&pool_mutex);
+
+  pthread_setaffinity_np (pthread_self (), sizeof (set), &set);
+
+  g_private_set (&applied_serial, GINT_TO_POINTER (serial + 1));
+}
+#endif
+
+static void
+worker_func (gpointer data, gpointer user_data)
+{
+  ParallelJob *job = data;
+
+  g_private_set (&in_worker, GINT_TO_POINTER (TRUE));
+
+#ifdef HAVE_PTHREAD_SETAFFINITY_NP
+  if (g_atomic_int_get (&affinity_serial) > 0)
+    apply_affinity ();
+#endif
+
+  run_chunks (job);
+  job_unref (job);
+}
+
+/* returns the number of threads taking part in jobs, with the pool mutex
+   held */
+static guint
+ensure_pool (void)
+{
+  if (n_threads == 0)
+    n_threads = g_get_num_processors ();
+
+  if (pool == NULL && n_threads > 1)
+    pool = g_thread_pool_new (worker_func,
+                              NULL,
+                              n_threads - 1,
+                              TRUE,
+                              NULL);
+
+  return pool != NULL ? n_threads : 1;
+}
+
+/* Splits the range [0, @n_items) in contiguous chunks, several per
+   available thread, and runs @func on all of them concurrently. The
+   calling thread takes part in processing the chunks, and the call returns
+   once all of them have been processed. @min_chunk is the minimum number
+   of items worth handing to another thread.
+ */
+void
+gfreenect_parallel_for (guint                 n_items,
+                        guint                 min_chunk,
+                        GFreenectParallelFunc func,
+                        gpointer              user_data)
+{
+  ParallelJob *job;
+  guint threads = 1;
+  guint n_chunks;
+  guint i;
+
+  if (n_items == 0)
+    return;
+
+  if (g_private_get (&in_worker) == NULL)
+    {
+      g_mutex_lock (&pool_mutex);
+      threads = ensure_pool ();
+      g_mutex_unlock (&pool_mutex);
+    }
+
+  n_chunks = MIN (threads * CHUNKS_PER_THREAD, n_items / MAX (min_chunk, 1));
+
+  if (threads <= 1 || n_chunks <= 1)
+    {
+      func (0, n_items, user_data);
+      return;
+    }
+
+  job = g_slice_new (ParallelJob);
+  job->ref_count = 1;
+  job->func = func;
+  job->user_data = user_data;
+  job->n_items = n_items;
+  job->chunk_size = (n_items + n_chunks - 1) / n_chunks;
+  job->n_chunks = (n_items + job->chunk_size - 1) / job->chunk_size;
+  job->next_chunk = 0;
+  job->pending = job->n_chunks;
+  g_mutex_init (&job->mutex);
+  g_cond_init (&job->cond);
+
+  /* helpers that start after all chunks were claimed just drop their
+     reference, so the job outlives this call if needed */
+  for (i = 1; i < MIN (threads, job->n_chunks); i++)
+    g_thread_pool_push (pool, job_ref (job), NULL);
+
+  run_chunks (job);
+
+  g_mutex_lock (&job->mutex);
+  while (job->pending > 0)
+    g_cond_wait (&job->cond, &job->mutex);
+  g_mutex_unlock (&job->mutex);
+
+  job_unref (job);
+}
+
+/* Sets the number of threads taking part in each call to
+   gfreenect_parallel_for(), the calling thread included, or 0 to use one
+   per processor. */
+void
+gfreenect_parallel_set_n_threads (guint threads)
+{
+  g_mutex_lock (&pool_mutex);
+
+  n_threads = threads > 0 ? threads : g_get_num_processors ();
+
+  if (pool != NULL && n_threads > 1)
+    g_thread_pool_set_max_threads (pool, n_threads - 1, NULL);
+
+  g_mutex_unlock (&pool_mutex);
+}
+
+guint
+gfreenect_parallel_get_n_threads (void)
+{
+  guint threads;
+
+  g_mutex_lock (&pool_mutex);
+  threads = n_threads > 0 ? n_threads : g_get_num_processors ();
+  g_mutex_unlock (&pool_mutex);
+
+  return threads;
+}
+
+/* Restricts the pool threads to the given CPUs, or lifts the restriction
+   if @n_cpus is 0. Threads pick up the change the next time they run a
+   chunk. */
+gboolean
+gfreenect_parallel_set_cpus (const guint  *cpus,
+                             guint         n_cpus,
+                             GError      **error)
+{
+#ifdef HAVE_PTHREAD_SETAFFINITY_NP
+  cpu_set_t set;
+  guint n_processors;
+  guint i;
+
+  n_processors = g_get_num_processors ();
+
+  CPU_ZERO (&set);
+
+  if (n_cpus == 0)
+    {
+      for (i = 0; i < n_processors && i < CPU_SETSIZE; i++)
+        CPU_SET (i, &set);
+    }
+
+  for (i = 0; i < n_cpus; i++)
+    {
+      if (cpus[i] >= CPU_SETSIZE)
+        {
+          g_set_error (error,
+                       G_IO_ERROR,
+                       G_IO_ERROR_INVALID_ARGUMENT,
+                       "CPU %u is out of range",
+                       cpus[i]);
+          return FALSE;
+        }
+
+      CPU_SET (cpus[i], &set);
+    }
+
+  g_mutex_lock (&pool_mutex);
+  memcpy (&affinity, &set, sizeof (set));
+  g_mutex_unlock (&pool_mutex);
+
+  g_atomic_int_inc (&affinity_serial);
+
+  return TRUE;
+#else
+  g_set_error (error,
+               G_IO_ERROR,
+               G_IO_ERROR_NOT_SUPPORTED,
+               "Setting the CPU affinity of threads is not supported on this platform");
+  return FALSE;
+#endif
+}
@@ -0,0 +1,48 @@
+/*
+ * gfreenect-parallel.h
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+#ifndef __GFREENECT_PARALLEL_H__
+#define __GFREENECT_PARALLEL_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* Processes the items in the range [first, last) */
+typedef void (* GFreenectParallelFunc) (guint    first,
+                                        guint    last,
+                                        gpointer user_data);
+
+void gfreenect_parallel_for (guint                 n_items,
+                             guint                 min_chunk,
+                             GFreenectParallelFunc func,
+                             gpointer              user_data);
+
+void     gfreenect_parallel_set_n_threads (guint threads);
+guint    gfreenect_parallel_get_n_threads (void);
+
+gboolean gfreenect_parallel_set_cpus      (const guint  *cpus,
+                                           guint         n_cpus,
+                                           GError      **error);
+
+G_END_DECLS
+
+#endif /* __GFREENECT_PARALLEL_H__ */
@@ -0,0 +1,160 @@
+/*
+ * gfreenect-region.c
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+/**
+ * SECTION:gfreenect-region
+ * @short_description: Data structure describing a rectangular area of a
+ * frame.
+ *
+ * A #GFreenectRegion is a rectangle within a frame, in pixel coordinates. It
+ * is used to restrict the area of the frames #GFreenectDevice delivers (see
+ * #GFreenectDevice:depth-roi) and to report the bounding boxes of detected
+ * features.
+ *
+ * Use gfreenect_region_copy() to create an exact copy of the object and
+ * gfreenect_region_free() to free it.
+ **/
+
+#include <string.h>
+
+#include "gfreenect-region.h"
+
+/**
+ * gfreenect_region_get_type:
+ *
+ * Returns: The registered #GType for #GFreenectRegion boxed type
+ **/
+GType
+gfreenect_region_get_type (void)
+{
+  static GType type = 0;
+
+  if (G_UNLIKELY (type == 0))
+    type = g_boxed_type_register_static ("GFreenectRegion",
+                                    (GBoxedCopyFunc) gfreenect_region_copy,
+                                    (GBoxedFreeFunc) gfreenect_region_free);
+  return type;
+}
+
+/**
+ * gfreenect_region_new:
+ * @x: The horizontal coordinate of the top-left corner
+ * @y: The vertical coordinate of the top-left corner
+ * @width: The width of the region
+ * @height: The height of the region
+ *
+ * Creates a new #GFreenectRegion.
+ *
+ * Returns: (transfer full): A newly created #GFreenectRegion. Use
+ * gfreenect_region_free() to free it.
+ **/
+GFreenectRegion *
+gfreenect_region_new (guint x, guint y, guint width, guint height)
+{
+  GFreenectRegion *region;
+
+  region = g_slice_new (GFreenectRegion);
+
+  region->x = x;
+  region->y = y;
+  region->width = width;
+  region->height = height;
+
+  return region;
+}
+
+/**
+ * gfreenect_region_copy:
+ * @region: The #GFreenectRegion to copy
+ *
+ * Makes an exact copy of a #GFreenectRegion object.
+ *
+ * Returns: (transfer full): A newly created #GFreenectRegion. Use
+ * gfreenect_region_free() to free it.
+ **/
+gpointer
+gfreenect_region_copy (GFreenectRegion *region)
+{
+  GFreenectRegion *copy;
+
+  copy = g_slice_new (GFreenectRegion);
+
+  memcpy (copy, region, sizeof (GFreenectRegion));
+
+  return copy;
+}
+
+/**
+ * gfreenect_region_free:
+ * @region: The #GFreenectRegion to free
+ *
+ * Frees a #GFreenectRegion object.
+ **/
+void
+gfreenect_region_free (GFreenectRegion *region)
+{
+  g_slice_free (GFreenectRegion, region);
+}
+
+/**
+ * gfreenect_region_intersect:
+ * @region: A #GFreenectRegion
+ * @other: Another #GFreenectRegion
+ * @dest: (out caller-allocates) (allow-none): Location to store the
+ * intersection, or %NULL
+ *
+ * Computes the intersection of two regions. @dest can be the same as
+ * @region or @other.
+ *
+ * Returns: %TRUE if the regions intersect, %FALSE otherwise.
+ **/
+gboolean
+gfreenect_region_intersect (const GFreenectRegion *region,
+                            const GFreenectRegion *other,
+                            GFreenectRegion       *dest)
+{
+  guint x1, y1, x2, y2;
+
+  g_return_val_if_fail (region != NULL && other != NULL, FALSE);
+
+  x1 = MAX (region->x, other->x);
+  y1 = MAX (region->y, other->y);
+  x2 = MIN (region->x + region->width, other->x + other->width);
+  y2 = MIN (region->y + region->height, other->y + other->height);
+
+  if (x2 <= x1 || y2 <= y1)
+    {
+      if (dest != NULL)
+        memset (dest, 0, sizeof (GFreenectRegion));
+
+      return FALSE;
+    }
+
+  if (dest != NULL)
+    {
+      dest->x = x1;
+      dest->y = y1;
+      dest->width = x2 - x1;
+      dest->height = y2 - y1;
+    }
+
+  return TRUE;
+}
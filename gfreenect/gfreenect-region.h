@@ -0,0 +1,63 @@
+/*
+ * gfreenect-region.h
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+#ifndef __GFREENECT_REGION_H__
+#define __GFREENECT_REGION_H__
+
+#include <glib.h>
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+#define GFREENECT_TYPE_REGION (gfreenect_region_get_type ())
+
+typedef struct _GFreenectRegion GFreenectRegion;
+
+/**
+ * GFreenectRegion:
+ * @x: The horizontal coordinate of the top-left corner, in pixels
+ * @y: The vertical coordinate of the top-left corner, in pixels
+ * @width: The width of the region, in pixels
+ * @height: The height of the region, in pixels
+ **/
+struct _GFreenectRegion
+{
+  guint x;
+  guint y;
+  guint width;
+  guint height;
+};
+
+GType             gfreenect_region_get_type       (void);
+GFreenectRegion * gfreenect_region_new            (guint x,
+                                                   guint y,
+                                                   guint width,
+                                                   guint height);
+gpointer          gfreenect_region_copy           (GFreenectRegion *region);
+void              gfreenect_region_free           (GFreenectRegion *region);
+
+gboolean          gfreenect_region_intersect      (const GFreenectRegion *region,
+                                                   const GFreenectRegion *other,
+                                                   GFreenectRegion       *dest);
+
+G_END_DECLS
+
+#endif /* __GFREENECT_REGION_H__ */
@@ -0,0 +1,479 @@
+/*
+ * gfreenect-registration.c
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+/**
+ * SECTION:gfreenect-registration
+ * @short_description: Software registration of depth frames to the RGB
+ * camera.
+ *
+ * A #GFreenectRegistration holds the per-pixel tables needed to convert raw
+ * 11 bit depth frames into millimeters, and to align them with the 640x480
+ * image of the RGB camera. The tables are specific to each sensor and are
+ * obtained from a #GFreenectDevice with gfreenect_device_get_registration().
+ * Once obtained, a #GFreenectRegistration does not need the device anymore,
+ * so raw depth frames recorded earlier can be registered at any time using
+ * gfreenect_registration_apply().
+ *
+ * gfreenect_registration_raw_to_mm() converts a raw depth frame to
+ * millimeters without aligning it, and
+ * gfreenect_registration_camera_to_world() and
+ * gfreenect_registration_depth_to_points() project depth values in
+ * millimeters to world coordinates. gfreenect_registration_depth_to_normals()
+ * goes one step further and estimates the surface normal at every pixel.
+ *
+ * gfreenect_registration_new_from_native() is used internally by
+ * #GFreenectDevice and should not normally be called in user code.
+ **/
+
+#include <string.h>
+#include <libfreenect.h>
+#include <libfreenect_registration.h>
+
+#include "gfreenect-registration.h"
+#include "gfreenect-parallel.h"
+#include "gfreenect-normals.h"
+
+#define DEPTH_X_RES             GFREENECT_REGISTRATION_WIDTH
+#define DEPTH_Y_RES             GFREENECT_REGISTRATION_HEIGHT
+#define DEPTH_PIXELS            (DEPTH_X_RES * DEPTH_Y_RES)
+
+/* these must match the values libfreenect builds its tables with */
+#define DEPTH_RAW_VALUES        2048
+#define DEPTH_MAX_METRIC_VALUE  10000
+#define REG_X_VAL_SCALE         256
+
+/* rows handed to each thread at least, when running in parallel */
+#define MIN_ROWS_PER_CHUNK      32
+
+#define ZBUF_EMPTY              G_MAXINT
+
+struct _GFreenectRegistration
+{
+  volatile gint ref_count;
+
+  guint16 *raw_to_mm;
+  gint32 *depth_to_rgb_shift;
+  gint32 (*registration_table)[2];
+  gint target_offset;
+
+  gdouble world_factor;
+
+  /* scratch z-buffer for gfreenect_registration_apply(), always left
+     filled with ZBUF_EMPTY between calls */
+  GMutex zbuf_mutex;
+  gint *zbuf;
+
+  /* scratch buffers for gfreenect_registration_depth_to_normals(), allocated
+     on first use */
+  GMutex normals_mutex;
+  gfloat *normals_points;
+  gpointer normals_scratch;
+};
+
+typedef struct
+{
+  GFreenectRegistration *registration;
+  const guint16 *src;
+  gpointer dst;
+} KernelData;
+
+/**
+ * gfreenect_registration_get_type:
+ *
+ * Returns: The registered #GType for #GFreenectRegistration boxed type
+ **/
+GType
+gfreenect_registration_get_type (void)
+{
+  static GType type = 0;
+
+  if (G_UNLIKELY (type == 0))
+    type = g_boxed_type_register_static ("GFreenectRegistration",
+                                 (GBoxedCopyFunc) gfreenect_registration_ref,
+                                 (GBoxedFreeFunc) gfreenect_registration_unref);
+  return type;
+}
+
+/**
+ * gfreenect_registration_new_from_native:
+ * @native: Pointer to a #freenect_registration structure
+ *
+ * Creates a new #GFreenectRegistration copying the tables of a native
+ * #freenect_registration structure. This is a low level method that a user
+ * would rarely use.
+ *
+ * Returns: (transfer full): A newly created #GFreenectRegistration. Use
+ * gfreenect_registration_unref() to free it.
+ **/
+GFreenectRegistration *
+gfreenect_registration_new_from_native (gpointer native)
+{
+  freenect_registration *_reg = native;
+  GFreenectRegistration *reg;
+  gint i;
+
+  g_return_val_if_fail (native != NULL, NULL);
+
+  reg = g_slice_new0 (GFreenectRegistration);
+  reg->ref_count = 1;
+
+  reg->raw_to_mm = g_memdup (_reg->raw_to_mm_shift,
+                             DEPTH_RAW_VALUES * sizeof (guint16));
+  reg->depth_to_rgb_shift = g_memdup (_reg->depth_to_rgb_shift,
+                                      DEPTH_MAX_METRIC_VALUE * sizeof (gint32));
+  reg->registration_table = g_memdup (_reg->registration_table,
+                                      DEPTH_PIXELS * 2 * sizeof (gint32));
+
+  reg->target_offset = _reg->reg_pad_info.start_lines * DEPTH_Y_RES;
+
+  reg->world_factor = 2.0 * _reg->zero_plane_info.reference_pixel_size /
+    _reg->zero_plane_info.reference_distance;
+
+  g_mutex_init (&reg->normals_mutex);
+
+  g_mutex_init (&reg->zbuf_mutex);
+  reg->zbuf = g_new (gint, DEPTH_PIXELS);
+  for (i = 0; i < DEPTH_PIXELS; i++)
+    reg->zbuf[i] = ZBUF_EMPTY;
+
+  return reg;
+}
+
+/**
+ * gfreenect_registration_ref:
+ * @registration: A #GFreenectRegistration
+ *
+ * Increases the reference count of @registration.
+ *
+ * Returns: (transfer full): The same @registration
+ **/
+GFreenectRegistration *
+gfreenect_registration_ref (GFreenectRegistration *registration)
+{
+  g_return_val_if_fail (registration != NULL, NULL);
+
+  g_atomic_int_inc (&registration->ref_count);
+
+  return registration;
+}
+
+/**
+ * gfreenect_registration_unref:
+ * @registration: A #GFreenectRegistration
+ *
+ * Decreases the reference count of @registration, freeing it when it drops
+ * to zero.
+ **/
+void
+gfreenect_registration_unref (GFreenectRegistration *registration)
+{
+  g_return_if_fail (registration != NULL);
+
+  if (! g_atomic_int_dec_and_test (&registration->ref_count))
+    return;
+
+  g_free (registration->raw_to_mm);
+  g_free (registration->depth_to_rgb_shift);
+  g_free (registration->registration_table);
+
+  g_mutex_clear (&registration->zbuf_mutex);
+  g_free (registration->zbuf);
+
+  g_mutex_clear (&registration->normals_mutex);
+  g_free (registration->normals_points);
+  g_free (registration->normals_scratch);
+
+  g_slice_free (GFreenectRegistration, registration);
+}
+
+/**
+ * gfreenect_registration_raw_to_mm:
+ * @registration: A #GFreenectRegistration
+ * @raw_depth: (array length=pixels): Raw 11 bit depth values
+ * @depth_mm: (out caller-allocates) (array length=pixels): Location to store
+ * the depth values in millimeters
+ * @pixels: The number of depth values to convert
+ *
+ * Converts raw 11 bit depth values to millimeters using the sensor specific
+ * conversion table, without aligning them to the RGB image. Pixels with no
+ * depth information are set to 0. @raw_depth and @depth_mm can point to the
+ * same buffer.
+ **/
+void
+gfreenect_registration_raw_to_mm (GFreenectRegistration *registration,
+                                  const guint16         *raw_depth,
+                                  guint16               *depth_mm,
+                                  gsize                  pixels)
+{
+  const guint16 *table;
+  gsize i;
+
+  g_return_if_fail (registration != NULL);
+
+  table = registration->raw_to_mm;
+
+  for (i = 0; i < pixels; i++)
+    depth_mm[i] = table[raw_depth[i] & (DEPTH_RAW_VALUES - 1)];
+}
+
+static void
+scatter_rows (guint first, guint last, gpointer user_data)
+{
+  KernelData *data = user_data;
+  GFreenectRegistration *reg = data->registration;
+  gint *zbuf = reg->zbuf;
+  guint x, y;
+
+  for (y = first; y < last; y++)
+    {
+      const guint16 *row = data->src + y * DEPTH_X_RES;
+      gint32 (*table)[2] = reg->registration_table + y * DEPTH_X_RES;
+
+      for (x = 0; x < DEPTH_X_RES; x++)
+        {
+          gint mm;
+          gint nx;
+          gint target;
+          gint current;
+
+          mm = reg->raw_to_mm[row[x] & (DEPTH_RAW_VALUES - 1)];
+          if (mm == 0 || mm >= DEPTH_MAX_METRIC_VALUE)
+            continue;
+
+          nx = table[x][0] + reg->depth_to_rgb_shift[mm];
+          if (nx < 0)
+            continue;
+
+          nx /= REG_X_VAL_SCALE;
+          if (nx >= DEPTH_X_RES)
+            continue;
+
+          target = table[x][1] * DEPTH_X_RES + nx - reg->target_offset;
+          if (target < 0 || target >= DEPTH_PIXELS)
+            continue;
+
+          /* keep the closest depth landing on each target pixel; rows are
+             scattered from several threads, hence the atomic minimum */
+          current = g_atomic_int_get (&zbuf[target]);
+          while (mm < current &&
+                 ! g_atomic_int_compare_and_exchange (&zbuf[target],
+                                                      current,
+                                                      mm))
+            {
+              current = g_atomic_int_get (&zbuf[target]);
+            }
+        }
+    }
+}
+
+static void
+gather_rows (guint first, guint last, gpointer user_data)
+{
+  KernelData *data = user_data;
+  gint *zbuf = data->registration->zbuf;
+  guint16 *dst = data->dst;
+  guint i;
+
+  for (i = first * DEPTH_X_RES; i < last * DEPTH_X_RES; i++)
+    {
+      dst[i] = zbuf[i] == ZBUF_EMPTY ? 0 : zbuf[i];
+      zbuf[i] = ZBUF_EMPTY;
+    }
+}
+
+/**
+ * gfreenect_registration_apply:
+ * @registration: A #GFreenectRegistration
+ * @raw_depth: (array fixed-size=307200): A 640x480 raw 11 bit depth frame
+ * @registered_mm: (out caller-allocates) (array fixed-size=307200): Location
+ * to store the 640x480 registered depth frame
+ *
+ * Registers a raw depth frame to the coordinates of the RGB camera, as
+ * %GFREENECT_DEPTH_FORMAT_REGISTERED does in the sensor. Every depth pixel
+ * is converted to millimeters and moved to its location in the RGB image;
+ * when several pixels land on the same location the closest one wins.
+ * Locations with no depth information are set to 0.
+ *
+ * The rows of the frame are processed in parallel on all available CPUs.
+ **/
+void
+gfreenect_registration_apply (GFreenectRegistration *registration,
+                              const guint16         *raw_depth,
+                              guint16               *registered_mm)
+{
+  KernelData data;
+
+  g_return_if_fail (registration != NULL);
+  g_return_if_fail (raw_depth != NULL && registered_mm != NULL);
+
+  data.registration = registration;
+  data.src = raw_depth;
+  data.dst = registered_mm;
+
+  g_mutex_lock (&registration->zbuf_mutex);
+
+  gfreenect_parallel_for (DEPTH_Y_RES, MIN_ROWS_PER_CHUNK, scatter_rows, &data);
+  gfreenect_parallel_for (DEPTH_Y_RES, MIN_ROWS_PER_CHUNK, gather_rows, &data);
+
+  g_mutex_unlock (&registration->zbuf_mutex);
+}
+
+/**
+ * gfreenect_registration_camera_to_world:
+ * @registration: A #GFreenectRegistration
+ * @x: The horizontal coordinate of the depth pixel
+ * @y: The vertical coordinate of the depth pixel
+ * @depth_mm: The depth of the pixel, in millimeters
+ * @world_x: (out): Location to store the horizontal world coordinate
+ * @world_y: (out): Location to store the vertical world coordinate
+ *
+ * Projects a pixel of an unregistered depth frame to world coordinates, in
+ * millimeters, relative to the depth camera. The world Z coordinate is
+ * @depth_mm itself.
+ **/
+void
+gfreenect_registration_camera_to_world (GFreenectRegistration *registration,
+                                        gint                   x,
+                                        gint                   y,
+                                        gint                   depth_mm,
+                                        gdouble               *world_x,
+                                        gdouble               *world_y)
+{
+  gdouble factor;
+
+  g_return_if_fail (registration != NULL);
+
+  factor = registration->world_factor * depth_mm;
+
+  *world_x = (x - DEPTH_X_RES / 2) * factor;
+  *world_y = (y - DEPTH_Y_RES / 2) * factor;
+}
+
+static void
+project_rows (guint first, guint last, gpointer user_data)
+{
+  KernelData *data = user_data;
+  gfloat factor = data->registration->world_factor;
+  gfloat *points = data->dst;
+  guint x, y;
+
+  for (y = first; y < last; y++)
+    {
+      const guint16 *row = data->src + y * DEPTH_X_RES;
+      gfloat *p = points + y * DEPTH_X_RES * 3;
+      gfloat fy = ((gint) y - DEPTH_Y_RES / 2) * factor;
+
+      for (x = 0; x < DEPTH_X_RES; x++)
+        {
+          gfloat z = row[x];
+
+          p[x * 3 + 0] = ((gint) x - DEPTH_X_RES / 2) * factor * z;
+          p[x * 3 + 1] = fy * z;
+          p[x * 3 + 2] = z;
+        }
+    }
+}
+
+/**
+ * gfreenect_registration_depth_to_points:
+ * @registration: A #GFreenectRegistration
+ * @depth_mm: (array fixed-size=307200): A 640x480 unregistered depth frame,
+ * in millimeters
+ * @points: (out caller-allocates) (array fixed-size=921600): Location to
+ * store 640x480 triplets of X, Y and Z world coordinates
+ *
+ * Projects a whole depth frame to world coordinates, in millimeters, as
+ * gfreenect_registration_camera_to_world() does for a single pixel. Pixels
+ * with no depth information produce the point (0, 0, 0).
+ **/
+void
+gfreenect_registration_depth_to_points (GFreenectRegistration *registration,
+                                        const guint16         *depth_mm,
+                                        gfloat                *points)
+{
+  KernelData data;
+
+  g_return_if_fail (registration != NULL);
+  g_return_if_fail (depth_mm != NULL && points != NULL);
+
+  data.registration = registration;
+  data.src = depth_mm;
+  data.dst = points;
+
+  gfreenect_parallel_for (DEPTH_Y_RES, MIN_ROWS_PER_CHUNK, project_rows, &data);
+}
+
+/**
+ * gfreenect_registration_depth_to_normals:
+ * @registration: A #GFreenectRegistration
+ * @depth_mm: (array fixed-size=307200): A 640x480 unregistered depth frame,
+ * in millimeters
+ * @window: The half size, in pixels, of the smoothing window for surfaces
+ * at one meter
+ * @normals: (out caller-allocates) (array fixed-size=921600): Location to
+ * store 640x480 unit normal vectors, as triplets of X, Y and Z components
+ *
+ * Estimates the surface normal at every pixel of a depth frame, in the world
+ * coordinates of gfreenect_registration_depth_to_points(). Normals point
+ * towards the camera.
+ *
+ * The normal of a pixel is the cross product of the horizontal and vertical
+ * gradients of the surface, measured as the difference between the mean
+ * points at each side of a square window. The mean points are looked up in
+ * summed-area tables, so the cost does not depend on the window size, which
+ * grows linearly with the depth to smooth out the noise of the sensor.
+ *
+ * Pixels with no depth information, those too close to the frame border for
+ * their window, and those whose window has no valid points on any side, get
+ * a NaN normal.
+ **/
+void
+gfreenect_registration_depth_to_normals (GFreenectRegistration *registration,
+                                         const guint16         *depth_mm,
+                                         guint                  window,
+                                         gfloat                *normals)
+{
+  g_return_if_fail (registration != NULL);
+  g_return_if_fail (depth_mm != NULL && normals != NULL);
+  g_return_if_fail (window > 0);
+
+  g_mutex_lock (&registration->normals_mutex);
+
+  if (registration->normals_points == NULL)
+    {
+      registration->normals_points = g_new (gfloat, DEPTH_PIXELS * 3);
+      registration->normals_scratch =
+        g_malloc (gfreenect_normals_get_scratch_size (DEPTH_X_RES, DEPTH_Y_RES));
+    }
+
+  gfreenect_registration_depth_to_points (registration,
+                                          depth_mm,
+                                          registration->normals_points);
+
+  gfreenect_normals_compute (registration->normals_points,
+                             DEPTH_X_RES,
+                             DEPTH_Y_RES,
+                             window,
+                             registration->normals_scratch,
+                             normals);
+
+  g_mutex_unlock (&registration->normals_mutex);
+}
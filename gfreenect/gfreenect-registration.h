@@ -0,0 +1,84 @@
+/*
+ * gfreenect-registration.h
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+#ifndef __GFREENECT_REGISTRATION_H__
+#define __GFREENECT_REGISTRATION_H__
+
+#include <glib.h>
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+#define GFREENECT_TYPE_REGISTRATION (gfreenect_registration_get_type ())
+
+/**
+ * GFREENECT_REGISTRATION_WIDTH:
+ *
+ * The width, in pixels, of the depth frames a #GFreenectRegistration
+ * operates on.
+ **/
+#define GFREENECT_REGISTRATION_WIDTH  640
+
+/**
+ * GFREENECT_REGISTRATION_HEIGHT:
+ *
+ * The height, in pixels, of the depth frames a #GFreenectRegistration
+ * operates on.
+ **/
+#define GFREENECT_REGISTRATION_HEIGHT 480
+
+typedef struct _GFreenectRegistration GFreenectRegistration;
+
+GType                   gfreenect_registration_get_type         (void);
+
+GFreenectRegistration * gfreenect_registration_new_from_native  (gpointer native);
+
+GFreenectRegistration * gfreenect_registration_ref              (GFreenectRegistration *registration);
+void                    gfreenect_registration_unref            (GFreenectRegistration *registration);
+
+void                    gfreenect_registration_raw_to_mm        (GFreenectRegistration *registration,
+                                                                 const guint16         *raw_depth,
+                                                                 guint16               *depth_mm,
+                                                                 gsize                  pixels);
+
+void                    gfreenect_registration_apply            (GFreenectRegistration *registration,
+                                                                 const guint16         *raw_depth,
+                                                                 guint16               *registered_mm);
+
+void                    gfreenect_registration_camera_to_world  (GFreenectRegistration *registration,
+                                                                 gint                   x,
+                                                                 gint                   y,
+                                                                 gint                   depth_mm,
+                                                                 gdouble               *world_x,
+                                                                 gdouble               *world_y);
+
+void                    gfreenect_registration_depth_to_points  (GFreenectRegistration *registration,
+                                                                 const guint16         *depth_mm,
+                                                                 gfloat                *points);
+
+void                    gfreenect_registration_depth_to_normals (GFreenectRegistration *registration,
+                                                                 const guint16         *depth_mm,
+                                                                 guint                  window,
+                                                                 gfloat                *normals);
+
+G_END_DECLS
+
+#endif /* __GFREENECT_REGISTRATION_H__ */
@@ -0,0 +1,279 @@
+/*
+ * gfreenect-spatial-filter.c
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+#include <string.h>
+#include <math.h>
+
+#include "gfreenect-spatial-filter.h"
+#include "gfreenect-parallel.h"
+
+/* square tiles whose input, halo included, fits comfortably in L1 */
+#define TILE_SIZE          64
+
+#define MIN_ROWS_PER_CHUNK 32
+
+typedef struct
+{
+  GFreenectSpatialFilterState *filter;
+  const guint16 *depth;
+  const guint8 *guide_rgb;
+  gboolean joint;
+  gint radius;
+  guint tiles_x;
+} FilterJob;
+
+void
+gfreenect_spatial_filter_init (GFreenectSpatialFilterState *filter)
+{
+  memset (filter, 0, sizeof (GFreenectSpatialFilterState));
+
+  filter->mode = GFREENECT_SPATIAL_FILTER_NONE;
+  filter->radius = 2;
+  filter->sigma = 30;
+  filter->color_sigma = 12;
+}
+
+void
+gfreenect_spatial_filter_clear (GFreenectSpatialFilterState *filter)
+{
+  g_free (filter->guide);
+  filter->guide = NULL;
+
+  g_free (filter->output);
+  filter->output = NULL;
+
+  filter->width = 0;
+  filter->height = 0;
+  filter->has_output = FALSE;
+}
+
+static void
+fill_range_weights (guint16 *table, guint size, guint sigma)
+{
+  gdouble s2;
+  guint i;
+
+  s2 = 2.0 * sigma * sigma;
+  for (i = 0; i < size; i++)
+    table[i] = floor (256.0 * exp (- (gdouble) (i * i) / s2) + 0.5);
+
+  /* differences are clamped to the last entry, which must not count */
+  table[size - 1] = 0;
+}
+
+static void
+ensure_weights (GFreenectSpatialFilterState *filter,
+                guint                        radius,
+                guint                        sigma,
+                guint                        color_sigma)
+{
+  if (filter->built_radius != radius)
+    {
+      gint r = radius;
+      gdouble s2;
+      gint dx, dy;
+
+      s2 = 2.0 * ((r + 1) / 2.0) * ((r + 1) / 2.0);
+      for (dy = -r; dy <= r; dy++)
+        for (dx = -r; dx <= r; dx++)
+          filter->spatial_weight[(dy + r) * (2 * r + 1) + dx + r] =
+            floor (256.0 * exp (- (dx * dx + dy * dy) / s2) + 0.5);
+
+      filter->built_radius = radius;
+    }
+
+  if (filter->built_sigma != sigma)
+    {
+      fill_range_weights (filter->depth_weight,
+                          GFREENECT_SPATIAL_FILTER_DEPTH_LUT_SIZE,
+                          sigma);
+      filter->built_sigma = sigma;
+    }
+
+  if (filter->built_color_sigma != color_sigma)
+    {
+      fill_range_weights (filter->color_weight,
+                          GFREENECT_SPATIAL_FILTER_COLOR_LUT_SIZE,
+                          color_sigma);
+      filter->built_color_sigma = color_sigma;
+    }
+}
+
+static void
+compute_guide_rows (guint first, guint last, gpointer user_data)
+{
+  FilterJob *job = user_data;
+  gsize width = job->filter->width;
+  const guint8 *rgb = job->guide_rgb + first * width * 3;
+  guint8 *guide = job->filter->guide + first * width;
+  gsize i;
+
+  for (i = 0; i < (last - first) * width; i++)
+    guide[i] = (77 * rgb[i * 3] + 150 * rgb[i * 3 + 1] + 29 * rgb[i * 3 + 2]) >> 8;
+}
+
+/* Weights are products of 8-bit fixed point factors renormalized to
+   1/256 units, so that the weighted sum of a 9x9 kernel over 16-bit depths
+   still fits in 32 bits. Neighbours with no depth get a zero weight, so the
+   inner loop has no branches. */
+static void
+filter_tile (FilterJob *job, guint x0, guint y0, guint x1, guint y1)
+{
+  GFreenectSpatialFilterState *filter = job->filter;
+  const guint16 *depth = job->depth;
+  const guint8 *guide = filter->guide;
+  guint16 *output = filter->output;
+  gint width = filter->width;
+  gint height = filter->height;
+  gint r = job->radius;
+  gint stride = 2 * r + 1;
+  guint16 invalid = filter->invalid;
+  gint x, y;
+
+  for (y = y0; y < (gint) y1; y++)
+    for (x = x0; x < (gint) x1; x++)
+      {
+        gint idx = y * width + x;
+        gint center = depth[idx];
+        gboolean center_valid = center != invalid;
+        gint dy_min = MAX (-r, -y), dy_max = MIN (r, height - 1 - y);
+        gint dx_min = MAX (-r, -x), dx_max = MIN (r, width - 1 - x);
+        guint32 sum = 0;
+        guint32 weight_sum = 0;
+        gint dx, dy;
+
+        if (! job->joint && ! center_valid)
+          {
+            output[idx] = invalid;
+            continue;
+          }
+
+        for (dy = dy_min; dy <= dy_max; dy++)
+          {
+            const guint16 *row = depth + (y + dy) * width + x;
+            const guint16 *spatial = filter->spatial_weight + (dy + r) * stride + r;
+
+            for (dx = dx_min; dx <= dx_max; dx++)
+              {
+                gint d = row[dx];
+                guint diff = ABS (d - center);
+                guint32 w;
+
+                diff = MIN (diff, GFREENECT_SPATIAL_FILTER_DEPTH_LUT_SIZE - 1);
+                w = spatial[dx] * (center_valid ? filter->depth_weight[diff] : 256);
+
+                if (job->joint)
+                  {
+                    gint g = guide[idx + dy * width + dx];
+                    w = (w >> 8) * filter->color_weight[ABS (g - guide[idx])];
+                  }
+
+                w = d == invalid ? 0 : w >> 8;
+
+                sum += w * d;
+                weight_sum += w;
+              }
+          }
+
+        output[idx] = weight_sum > 0 ?
+          (sum + weight_sum / 2) / weight_sum : invalid;
+      }
+}
+
+static void
+filter_tiles (guint first, guint last, gpointer user_data)
+{
+  FilterJob *job = user_data;
+  guint t;
+
+  for (t = first; t < last; t++)
+    {
+      guint x0 = (t % job->tiles_x) * TILE_SIZE;
+      guint y0 = (t / job->tiles_x) * TILE_SIZE;
+
+      filter_tile (job,
+                   x0,
+                   y0,
+                   MIN (x0 + TILE_SIZE, job->filter->width),
+                   MIN (y0 + TILE_SIZE, job->filter->height));
+    }
+}
+
+/* Filters a depth frame into 'output'. When 'guide_rgb' is a RGB frame of
+   the same size as the depth, aligned to it, the joint bilateral filter
+   uses its intensity to weight the neighbours; without it the joint filter
+   degrades to the plain bilateral one. */
+void
+gfreenect_spatial_filter_process (GFreenectSpatialFilterState *filter,
+                                  const guint16               *depth,
+                                  gsize                        width,
+                                  gsize                        height,
+                                  guint16                      invalid,
+                                  const guint8                *guide_rgb)
+{
+  FilterJob job;
+  guint radius;
+  guint tiles_y;
+
+  if (filter->mode == GFREENECT_SPATIAL_FILTER_NONE)
+    return;
+
+  if (filter->width != width || filter->height != height)
+    {
+      gfreenect_spatial_filter_clear (filter);
+
+      filter->width = width;
+      filter->height = height;
+    }
+
+  filter->invalid = invalid;
+  radius = CLAMP (filter->radius, 1, GFREENECT_SPATIAL_FILTER_MAX_RADIUS);
+
+  ensure_weights (filter,
+                  radius,
+                  MAX (filter->sigma, 1),
+                  MAX (filter->color_sigma, 1));
+
+  if (filter->output == NULL)
+    filter->output = g_new (guint16, width * height);
+
+  job.filter = filter;
+  job.depth = depth;
+  job.guide_rgb = guide_rgb;
+  job.radius = radius;
+  job.joint = filter->mode == GFREENECT_SPATIAL_FILTER_JOINT_BILATERAL &&
+    guide_rgb != NULL;
+
+  if (job.joint)
+    {
+      if (filter->guide == NULL)
+        filter->guide = g_new (guint8, width * height);
+
+      gfreenect_parallel_for (height, MIN_ROWS_PER_CHUNK, compute_guide_rows, &job);
+    }
+
+  job.tiles_x = (width + TILE_SIZE - 1) / TILE_SIZE;
+  tiles_y = (height + TILE_SIZE - 1) / TILE_SIZE;
+
+  gfreenect_parallel_for (job.tiles_x * tiles_y, 1, filter_tiles, &job);
+
+  filter->has_output = TRUE;
+}
@@ -0,0 +1,79 @@
+/*
+ * gfreenect-spatial-filter.h
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+#ifndef __GFREENECT_SPATIAL_FILTER_H__
+#define __GFREENECT_SPATIAL_FILTER_H__
+
+#include <glib.h>
+
+#include "gfreenect-decls.h"
+
+G_BEGIN_DECLS
+
+#define GFREENECT_SPATIAL_FILTER_MAX_RADIUS 4
+
+/* weights are in 1/256 units */
+#define GFREENECT_SPATIAL_FILTER_DEPTH_LUT_SIZE 1024
+#define GFREENECT_SPATIAL_FILTER_COLOR_LUT_SIZE 256
+
+#define GFREENECT_SPATIAL_FILTER_KERNEL_SIZE \
+  ((2 * GFREENECT_SPATIAL_FILTER_MAX_RADIUS + 1) * \
+   (2 * GFREENECT_SPATIAL_FILTER_MAX_RADIUS + 1))
+
+typedef struct
+{
+  /* parameters */
+  GFreenectSpatialFilter mode;
+  guint radius;
+  guint sigma;                  /* range sigma, in depth units */
+  guint color_sigma;            /* range sigma of the guide intensity */
+
+  /* weight tables, and the parameters they were built for */
+  guint built_radius;
+  guint built_sigma;
+  guint built_color_sigma;
+  guint16 spatial_weight[GFREENECT_SPATIAL_FILTER_KERNEL_SIZE];
+  guint16 depth_weight[GFREENECT_SPATIAL_FILTER_DEPTH_LUT_SIZE];
+  guint16 color_weight[GFREENECT_SPATIAL_FILTER_COLOR_LUT_SIZE];
+
+  /* state */
+  gsize width;
+  gsize height;
+  guint16 invalid;
+
+  guint8 *guide;
+  guint16 *output;
+  gboolean has_output;
+} GFreenectSpatialFilterState;
+
+void gfreenect_spatial_filter_init    (GFreenectSpatialFilterState *filter);
+void gfreenect_spatial_filter_clear   (GFreenectSpatialFilterState *filter);
+
+void gfreenect_spatial_filter_process (GFreenectSpatialFilterState *filter,
+                                       const guint16               *depth,
+                                       gsize                        width,
+                                       gsize                        height,
+                                       guint16                      invalid,
+                                       const guint8                *guide_rgb);
+
+G_END_DECLS
+
+#endif /* __GFREENECT_SPATIAL_FILTER_H__ */
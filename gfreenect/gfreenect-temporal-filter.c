@@ -0,0 +1,245 @@
+/*
+ * gfreenect-temporal-filter.c
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+#include <string.h>
+
+#include "gfreenect-temporal-filter.h"
+#include "gfreenect-parallel.h"
+
+/* pixels handed to each thread at least, when running in parallel */
+#define MIN_PIXELS_PER_CHUNK 16384
+
+/* age of a pixel that has never had a valid sample */
+#define AGE_NONE             G_MAXUINT8
+
+typedef struct
+{
+  GFreenectTemporalFilterState *filter;
+  const guint16 *depth;
+} FilterJob;
+
+void
+gfreenect_temporal_filter_init (GFreenectTemporalFilterState *filter)
+{
+  memset (filter, 0, sizeof (GFreenectTemporalFilterState));
+
+  filter->mode = GFREENECT_TEMPORAL_FILTER_NONE;
+  filter->alpha = 64;
+  filter->threshold = 32;
+  filter->frames = 5;
+}
+
+void
+gfreenect_temporal_filter_clear (GFreenectTemporalFilterState *filter)
+{
+  g_free (filter->average);
+  filter->average = NULL;
+
+  g_free (filter->age);
+  filter->age = NULL;
+
+  g_free (filter->history);
+  filter->history = NULL;
+
+  g_free (filter->output);
+  filter->output = NULL;
+
+  filter->pixels = 0;
+  filter->has_output = FALSE;
+}
+
+/* forgets all previous frames, keeping the parameters */
+void
+gfreenect_temporal_filter_reset (GFreenectTemporalFilterState *filter)
+{
+  if (filter->age != NULL)
+    memset (filter->age, AGE_NONE, filter->pixels);
+
+  filter->history_pos = 0;
+  filter->history_len = 0;
+  filter->has_output = FALSE;
+}
+
+/* The per-pixel logic is written without branches, as selects over
+   fixed-point integers, so that the compiler vectorizes the loop. A valid
+   sample is blended into the average, or restarts it if the depth moved by
+   more than 'threshold' (something moved in front of the sensor) or if the
+   pixel had no value. An invalid sample keeps the previous average for up
+   to 'frames' frames, filling short-lived holes. */
+static void
+average_chunk (guint first, guint last, gpointer user_data)
+{
+  FilterJob *job = user_data;
+  GFreenectTemporalFilterState *filter = job->filter;
+  const guint16 *depth = job->depth;
+  gint32 *average = filter->average;
+  guint8 *age = filter->age;
+  guint16 *output = filter->output;
+  gint32 alpha = filter->alpha;
+  gint32 threshold = filter->threshold << 8;
+  guint8 hold = filter->frames;
+  guint16 invalid = filter->invalid;
+  guint i;
+
+  for (i = first; i < last; i++)
+    {
+      gint32 sample = (gint32) depth[i] << 8;
+      gint32 delta = sample - average[i];
+      gboolean valid = depth[i] != invalid;
+      gboolean restart = age[i] > hold || delta > threshold || -delta > threshold;
+      gint32 blended = restart ? sample : average[i] + ((delta * alpha) >> 8);
+      guint8 new_age = age[i] == AGE_NONE ? AGE_NONE : age[i] + 1;
+
+      average[i] = valid ? blended : average[i];
+      age[i] = valid ? 0 : new_age;
+      output[i] = age[i] <= hold ? (average[i] + 128) >> 8 : invalid;
+    }
+}
+
+/* Median of the valid samples of each pixel over the frames in the history.
+   Invalid samples are skipped, so holes lasting less than the window are
+   filled with the surrounding frames. */
+static void
+median_chunk (guint first, guint last, gpointer user_data)
+{
+  FilterJob *job = user_data;
+  GFreenectTemporalFilterState *filter = job->filter;
+  const guint16 *history = filter->history;
+  guint16 *output = filter->output;
+  guint16 invalid = filter->invalid;
+  gsize pixels = filter->pixels;
+  guint frames = filter->history_len;
+  guint i;
+
+  for (i = first; i < last; i++)
+    {
+      guint16 v[GFREENECT_TEMPORAL_FILTER_MAX_FRAMES];
+      guint n = 0;
+      guint k;
+
+      for (k = 0; k < frames; k++)
+        {
+          guint16 sample = history[k * pixels + i];
+          guint j;
+
+          if (sample == invalid)
+            continue;
+
+          /* insertion sort, there are at most a handful of samples */
+          for (j = n; j > 0 && v[j - 1] > sample; j--)
+            v[j] = v[j - 1];
+          v[j] = sample;
+          n++;
+        }
+
+      output[i] = n > 0 ? v[n / 2] : invalid;
+    }
+}
+
+static void
+ensure_buffers (GFreenectTemporalFilterState *filter,
+                gsize                         pixels,
+                guint16                       invalid)
+{
+  if (filter->pixels != pixels || filter->invalid != invalid)
+    {
+      gfreenect_temporal_filter_clear (filter);
+
+      filter->pixels = pixels;
+      filter->invalid = invalid;
+    }
+
+  if (filter->output == NULL)
+    filter->output = g_new (guint16, pixels);
+
+  if (filter->mode == GFREENECT_TEMPORAL_FILTER_AVERAGE &&
+      filter->average == NULL)
+    {
+      filter->average = g_new0 (gint32, pixels);
+      filter->age = g_new (guint8, pixels);
+      memset (filter->age, AGE_NONE, pixels);
+    }
+
+  if (filter->mode == GFREENECT_TEMPORAL_FILTER_MEDIAN &&
+      filter->history == NULL)
+    {
+      filter->history = g_new (guint16,
+                               pixels * GFREENECT_TEMPORAL_FILTER_MAX_FRAMES);
+      filter->history_pos = 0;
+      filter->history_len = 0;
+    }
+}
+
+/* Feeds a new depth frame to the filter, updating its state and the filtered
+   frame in 'output'. The cost is linear in the number of pixels. */
+void
+gfreenect_temporal_filter_process (GFreenectTemporalFilterState *filter,
+                                   const guint16                *depth,
+                                   gsize                         pixels,
+                                   guint16                       invalid)
+{
+  FilterJob job;
+
+  if (filter->mode == GFREENECT_TEMPORAL_FILTER_NONE)
+    return;
+
+  ensure_buffers (filter, pixels, invalid);
+
+  job.filter = filter;
+  job.depth = depth;
+
+  switch (filter->mode)
+    {
+    case GFREENECT_TEMPORAL_FILTER_AVERAGE:
+      gfreenect_parallel_for (pixels, MIN_PIXELS_PER_CHUNK, average_chunk, &job);
+      break;
+
+    case GFREENECT_TEMPORAL_FILTER_MEDIAN:
+      {
+        guint frames;
+
+        frames = CLAMP (filter->frames, 1, GFREENECT_TEMPORAL_FILTER_MAX_FRAMES);
+
+        /* the window changed, the ring no longer matches it: start over */
+        if (filter->history_size != frames)
+          {
+            filter->history_len = 0;
+            filter->history_pos = 0;
+            filter->history_size = frames;
+          }
+
+        memcpy (filter->history + filter->history_pos * pixels,
+                depth,
+                pixels * sizeof (guint16));
+
+        filter->history_pos = (filter->history_pos + 1) % frames;
+        filter->history_len = MIN (filter->history_len + 1, frames);
+
+        gfreenect_parallel_for (pixels, MIN_PIXELS_PER_CHUNK, median_chunk, &job);
+        break;
+      }
+
+    default:
+      return;
+    }
+
+  filter->has_output = TRUE;
+}
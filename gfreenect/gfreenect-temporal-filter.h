@@ -0,0 +1,68 @@
+/*
+ * gfreenect-temporal-filter.h
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+#ifndef __GFREENECT_TEMPORAL_FILTER_H__
+#define __GFREENECT_TEMPORAL_FILTER_H__
+
+#include <glib.h>
+
+#include "gfreenect-decls.h"
+
+G_BEGIN_DECLS
+
+#define GFREENECT_TEMPORAL_FILTER_MAX_FRAMES 9
+
+typedef struct
+{
+  /* parameters */
+  GFreenectTemporalFilter mode;
+  guint alpha;                  /* weight of a new sample, in 1/256 units */
+  guint threshold;              /* depth change that restarts the average */
+  guint frames;                 /* median window, and frames a hole is filled */
+
+  /* state */
+  gsize pixels;
+  guint16 invalid;
+
+  gint32 *average;              /* in 1/256 depth units */
+  guint8 *age;                  /* frames since the last valid sample */
+
+  guint16 *history;
+  guint history_pos;
+  guint history_len;
+  guint history_size;           /* window the history was filled with */
+
+  guint16 *output;
+  gboolean has_output;
+} GFreenectTemporalFilterState;
+
+void gfreenect_temporal_filter_init    (GFreenectTemporalFilterState *filter);
+void gfreenect_temporal_filter_clear   (GFreenectTemporalFilterState *filter);
+void gfreenect_temporal_filter_reset   (GFreenectTemporalFilterState *filter);
+
+void gfreenect_temporal_filter_process (GFreenectTemporalFilterState *filter,
+                                        const guint16                *depth,
+                                        gsize                         pixels,
+                                        guint16                       invalid);
+
+G_END_DECLS
+
+#endif /* __GFREENECT_TEMPORAL_FILTER_H__ */
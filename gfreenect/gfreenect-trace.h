@@ -0,0 +1,93 @@
+/*
+ * gfreenect-trace.h
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+
+#ifndef __GFREENECT_TRACE_H__
+#define __GFREENECT_TRACE_H__
+
+/* sources including this header include config.h first, since the probes
+   depend on ENABLE_TRACING */
+
+#include <glib.h>
+
+#ifdef ENABLE_TRACING
+#ifdef HAVE_SYS_SDT_H
+#include <sys/sdt.h>
+#endif
+#ifdef HAVE_SYSPROF
+#include <sysprof-capture.h>
+#endif
+#endif
+
+G_BEGIN_DECLS
+
+/* Tracepoints on the lifecycle of frames and motor commands, compiled in
+   with --enable-tracing.
+
+   GFREENECT_TRACE() and GFREENECT_TRACE1() are single USDT probes of the
+   "gfreenect" provider, e.g. sdt_gfreenect:depth_frame__locked for perf.
+
+   Spans wrap a piece of work: GFREENECT_TRACE_BEGIN() fires the
+   <probe>__begin probe and records the time, GFREENECT_TRACE_END() fires
+   <probe>__end and, with sysprof, adds a mark named @name covering the
+   span to the capture. */
+
+typedef gint64 GFreenectTraceSpan;
+
+#if defined (ENABLE_TRACING) && defined (HAVE_SYS_SDT_H)
+#define GFREENECT_TRACE_PROBE(probe)         DTRACE_PROBE (gfreenect, probe)
+#define GFREENECT_TRACE_PROBE1(probe, arg)   DTRACE_PROBE1 (gfreenect, probe, arg)
+#else
+#define GFREENECT_TRACE_PROBE(probe)         G_STMT_START { } G_STMT_END
+#define GFREENECT_TRACE_PROBE1(probe, arg)   G_STMT_START { } G_STMT_END
+#endif
+
+#if defined (ENABLE_TRACING) && defined (HAVE_SYSPROF)
+#define GFREENECT_TRACE_NOW()                SYSPROF_CAPTURE_CURRENT_TIME
+#define GFREENECT_TRACE_MARK(span, name)                                   \
+  sysprof_collector_mark ((span),                                         \
+                          SYSPROF_CAPTURE_CURRENT_TIME - (span),           \
+                          "gfreenect",                                     \
+                          (name),                                          \
+                          NULL)
+#else
+#define GFREENECT_TRACE_NOW()                0
+#define GFREENECT_TRACE_MARK(span, name)     ((void) (span))
+#endif
+
+#define GFREENECT_TRACE(probe)               GFREENECT_TRACE_PROBE (probe)
+#define GFREENECT_TRACE1(probe, arg)         GFREENECT_TRACE_PROBE1 (probe, arg)
+
+#define GFREENECT_TRACE_BEGIN(span, probe)                                 \
+  G_STMT_START {                                                           \
+    GFREENECT_TRACE_PROBE (probe##__begin);                                \
+    (span) = GFREENECT_TRACE_NOW ();                                       \
+  } G_STMT_END
+
+#define GFREENECT_TRACE_END(span, probe, name)                             \
+  G_STMT_START {                                                           \
+    GFREENECT_TRACE_PROBE (probe##__end);                                  \
+    GFREENECT_TRACE_MARK (span, name);                                     \
+  } G_STMT_END
+
+G_END_DECLS
+
+#endif /* __GFREENECT_TRACE_H__ */
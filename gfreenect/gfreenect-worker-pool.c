@@ -0,0 +1,243 @@
+/*
+ * gfreenect-worker-pool.c
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+
+/**
+ * SECTION:gfreenect-worker-pool
+ * @short_description: Library-wide pool of threads processing frames
+ *
+ * GFreenect splits the per-frame work of its conversions, filters and
+ * detectors into bands of rows, which a single pool of threads shared by the
+ * whole library processes concurrently. The thread requesting the work
+ * takes part in it too, and threads that finish their bands early take
+ * over the pending bands of slower ones.
+ *
+ * By default the pool uses as many threads as there are processors. The
+ * number can be changed with gfreenect_worker_pool_set_size(), for example
+ * to leave processors free for other work, and the threads can be
+ * restricted to a set of processors with
+ * gfreenect_worker_pool_set_affinity().
+ *
+ * Applications can run their own kernels on the pool too, with
+ * gfreenect_worker_pool_run(), or run a chain of kernels on a frame without
+ * blocking with gfreenect_worker_pool_run_chain_async(). Frame getters like
+ * gfreenect_device_get_depth_frame_raw() return buffers that are only valid
+ * within the frame signal handlers, so frames must be copied before being
+ * processed asynchronously.
+ **/
+
+#include "gfreenect-worker-pool.h"
+#include "gfreenect-parallel.h"
+
+#define MIN_ROWS_PER_CHUNK 16
+
+typedef struct
+{
+  guint n_rows;
+  GFreenectKernelFunc *kernels;
+  guint n_kernels;
+  gpointer frame_data;
+} ChainData;
+
+static void
+chain_data_free (gpointer _data)
+{
+  ChainData *data = _data;
+
+  g_free (data->kernels);
+  g_slice_free (ChainData, data);
+}
+
+static void
+run_chain_in_thread (GSimpleAsyncResult *res,
+                     GObject            *object,
+                     GCancellable       *cancellable)
+{
+  ChainData *data;
+  GError *error = NULL;
+  guint i;
+
+  data = g_simple_async_result_get_op_res_gpointer (res);
+
+  for (i = 0; i < data->n_kernels; i++)
+    {
+      if (g_cancellable_set_error_if_cancelled (cancellable, &error))
+        {
+          g_simple_async_result_take_error (res, error);
+          return;
+        }
+
+      gfreenect_parallel_for (data->n_rows,
+                              MIN_ROWS_PER_CHUNK,
+                              data->kernels[i],
+                              data->frame_data);
+    }
+}
+
+/* public methods */
+
+/**
+ * gfreenect_worker_pool_set_size:
+ * @n_threads: The number of threads, or 0 to use one per processor
+ *
+ * Sets the number of threads that take part in processing each frame, the
+ * thread requesting the work included. A value of 1 makes all processing
+ * run on the requesting thread.
+ **/
+void
+gfreenect_worker_pool_set_size (guint n_threads)
+{
+  gfreenect_parallel_set_n_threads (n_threads);
+}
+
+/**
+ * gfreenect_worker_pool_get_size:
+ *
+ * Retrieves the number of threads that take part in processing each frame.
+ * See gfreenect_worker_pool_set_size().
+ *
+ * Returns: The number of threads.
+ **/
+guint
+gfreenect_worker_pool_get_size (void)
+{
+  return gfreenect_parallel_get_n_threads ();
+}
+
+/**
+ * gfreenect_worker_pool_set_affinity:
+ * @cpus: (array length=n_cpus) (allow-none): The processors to run the pool
+ * threads on
+ * @n_cpus: The number of processors in @cpus, or 0 to allow all of them
+ * @error: (out) (allow-none): A pointer to a #GError, or %NULL
+ *
+ * Restricts the threads of the pool to the processors in @cpus. Threads
+ * requesting work, like the stream threads of the devices, are not
+ * affected.
+ *
+ * Returns: %TRUE on success, %FALSE if a processor is out of range or the
+ * platform does not support setting the affinity of threads, in which case
+ * @error is set.
+ **/
+gboolean
+gfreenect_worker_pool_set_affinity (const guint  *cpus,
+                                    guint         n_cpus,
+                                    GError      **error)
+{
+  g_return_val_if_fail (cpus != NULL || n_cpus == 0, FALSE);
+
+  return gfreenect_parallel_set_cpus (cpus, n_cpus, error);
+}
+
+/**
+ * gfreenect_worker_pool_run:
+ * @n_rows: The number of rows of the frame
+ * @kernel: (scope call): The #GFreenectKernelFunc to run
+ * @frame_data: (allow-none): Data to pass to @kernel
+ *
+ * Runs @kernel on all the rows of a frame, split in bands processed
+ * concurrently by the pool, and returns when all of them are done.
+ **/
+void
+gfreenect_worker_pool_run (guint               n_rows,
+                           GFreenectKernelFunc kernel,
+                           gpointer            frame_data)
+{
+  g_return_if_fail (kernel != NULL);
+
+  gfreenect_parallel_for (n_rows, MIN_ROWS_PER_CHUNK, kernel, frame_data);
+}
+
+/**
+ * gfreenect_worker_pool_run_chain_async:
+ * @n_rows: The number of rows of the frame
+ * @kernels: (array length=n_kernels): The #GFreenectKernelFunc to run, in
+ * order
+ * @n_kernels: The number of kernels in @kernels
+ * @frame_data: (allow-none): Data to pass to each kernel
+ * @cancellable: (allow-none): A #GCancellable, or %NULL
+ * @callback: (scope async): A #GAsyncReadyCallback to call when the chain
+ * is done
+ * @user_data: (closure): Data to pass to @callback
+ *
+ * Runs a chain of kernels on a frame without blocking. Each kernel runs on
+ * all the rows of the frame, as gfreenect_worker_pool_run() does, and starts
+ * once the previous kernel has finished with all of them, so it can read
+ * any row written by the previous ones. @frame_data must stay valid until
+ * @callback is called. Use gfreenect_worker_pool_run_chain_finish() to get
+ * the result of the operation.
+ **/
+void
+gfreenect_worker_pool_run_chain_async (guint                      n_rows,
+                                       const GFreenectKernelFunc *kernels,
+                                       guint                      n_kernels,
+                                       gpointer                   frame_data,
+                                       GCancellable              *cancellable,
+                                       GAsyncReadyCallback        callback,
+                                       gpointer                   user_data)
+{
+  GSimpleAsyncResult *res;
+  ChainData *data;
+
+  g_return_if_fail (kernels != NULL || n_kernels == 0);
+
+  data = g_slice_new (ChainData);
+  data->n_rows = n_rows;
+  data->kernels = g_memdup (kernels, n_kernels * sizeof (GFreenectKernelFunc));
+  data->n_kernels = n_kernels;
+  data->frame_data = frame_data;
+
+  res = g_simple_async_result_new (NULL,
+                                   callback,
+                                   user_data,
+                                   gfreenect_worker_pool_run_chain_async);
+  g_simple_async_result_set_op_res_gpointer (res, data, chain_data_free);
+
+  g_simple_async_result_run_in_thread (res,
+                                       run_chain_in_thread,
+                                       G_PRIORITY_DEFAULT,
+                                       cancellable);
+  g_object_unref (res);
+}
+
+/**
+ * gfreenect_worker_pool_run_chain_finish:
+ * @result: The #GAsyncResult object passed to the callback
+ * @error: (out) (allow-none): A pointer to a #GError, or %NULL
+ *
+ * Collects the result of a chain started with
+ * gfreenect_worker_pool_run_chain_async().
+ *
+ * Returns: %TRUE if all the kernels ran, %FALSE if the chain was cancelled,
+ * in which case @error is set.
+ **/
+gboolean
+gfreenect_worker_pool_run_chain_finish (GAsyncResult  *result,
+                                        GError       **error)
+{
+  g_return_val_if_fail (g_simple_async_result_is_valid (result,
+                                                      NULL,
+                                                      gfreenect_worker_pool_run_chain_async),
+                        FALSE);
+
+  return ! g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (result),
+                                                  error);
+}
@@ -0,0 +1,68 @@
+/*
+ * gfreenect-worker-pool.h
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+
+#ifndef __GFREENECT_WORKER_POOL_H__
+#define __GFREENECT_WORKER_POOL_H__
+
+#include <glib.h>
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+/**
+ * GFreenectKernelFunc:
+ * @first_row: The first row of the band to process
+ * @last_row: The row after the last one of the band to process
+ * @frame_data: The data passed along with the kernel
+ *
+ * Processes the rows in the range [@first_row, @last_row) of a frame. The
+ * same kernel runs concurrently on other bands of the frame, so it should
+ * only write to the rows of its band.
+ */
+typedef void (* GFreenectKernelFunc) (guint    first_row,
+                                      guint    last_row,
+                                      gpointer frame_data);
+
+void     gfreenect_worker_pool_set_size         (guint n_threads);
+guint    gfreenect_worker_pool_get_size         (void);
+
+gboolean gfreenect_worker_pool_set_affinity     (const guint  *cpus,
+                                                 guint         n_cpus,
+                                                 GError      **error);
+
+void     gfreenect_worker_pool_run              (guint               n_rows,
+                                                 GFreenectKernelFunc kernel,
+                                                 gpointer            frame_data);
+
+void     gfreenect_worker_pool_run_chain_async  (guint                      n_rows,
+                                                 const GFreenectKernelFunc *kernels,
+                                                 guint                      n_kernels,
+                                                 gpointer                   frame_data,
+                                                 GCancellable              *cancellable,
+                                                 GAsyncReadyCallback        callback,
+                                                 gpointer                   user_data);
+gboolean gfreenect_worker_pool_run_chain_finish (GAsyncResult  *result,
+                                                 GError       **error);
+
+G_END_DECLS
+
+#endif /* __GFREENECT_WORKER_POOL_H__ */
@@ -23,7 +23,19 @@
 #ifndef __GFREENECT_H__
 #define __GFREENECT_H__
 
+#include <gfreenect-context.h>
 #include <gfreenect-device.h>
 #include <gfreenect-frame-mode.h>
+#include <gfreenect-depth-stats.h>
+#include <gfreenect-device-stats.h>
+#include <gfreenect-region.h>
+#include <gfreenect-motion-state.h>
+#include <gfreenect-registration.h>
+#include <gfreenect-blob-detector.h>
+#include <gfreenect-floor-estimator.h>
+#include <gfreenect-occupancy-grid.h>
+#include <gfreenect-worker-pool.h>
+#include <gfreenect-beamformer.h>
+#include <gfreenect-metrics-exporter.h>
 
 #endif /* __GFREENECT_H__ */
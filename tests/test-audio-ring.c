@@ -0,0 +1,317 @@
+/*
+ * test-audio-ring.c
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+
+/* Tests of the audio history shared by the audio stream of the device and
+   its readers. They run without a device: the frames are produced by a
+   synthetic source that hands blocks to the ring as the audio callback of
+   the device does, one array per microphone. */
+
+#include <glib.h>
+
+#include "gfreenect-audio-ring.h"
+
+#define CHANNELS GFREENECT_AUDIO_CHANNELS
+
+/* microseconds per frame at the nominal sample rate */
+#define FRAME_TIME(n) ((gint64) (n) * G_USEC_PER_SEC / GFREENECT_AUDIO_SAMPLE_RATE)
+
+/* every sample of frame @index is derived from it, so that readers can
+   tell which frame they got and whether it is torn */
+static gint32
+sample_value (guint index, guint channel)
+{
+  if (channel == CHANNELS - 1)
+    return (gint16) (index & 0x7fff);
+
+  return (gint32) (index * 8 + channel);
+}
+
+/* writes the frames [@first, @first + @n_frames), the last of which
+   arrived at @time, the way on_audio_in() does */
+static void
+write_frames (GFreenectAudioRing *ring,
+              guint               first,
+              guint               n_frames,
+              gint64              time)
+{
+  gint32 *mic[4];
+  gint16 *reference;
+  guint i, c;
+
+  for (c = 0; c < 4; c++)
+    mic[c] = g_new (gint32, n_frames);
+  reference = g_new (gint16, n_frames);
+
+  for (i = 0; i < n_frames; i++)
+    {
+      for (c = 0; c < 4; c++)
+        mic[c][i] = sample_value (first + i, c);
+      reference[i] = sample_value (first + i, CHANNELS - 1);
+    }
+
+  gfreenect_audio_ring_write (ring,
+                              n_frames,
+                              mic[0], mic[1], mic[2], mic[3],
+                              reference,
+                              time);
+
+  for (c = 0; c < 4; c++)
+    g_free (mic[c]);
+  g_free (reference);
+}
+
+/* checks that @frames holds the @n_frames frames from @first on */
+static void
+assert_frames (const gint32 *frames, guint first, guint n_frames)
+{
+  guint i, c;
+
+  for (i = 0; i < n_frames; i++)
+    for (c = 0; c < CHANNELS; c++)
+      g_assert_cmpint (frames[i * CHANNELS + c], ==,
+                       sample_value (first + i, c));
+}
+
+/* the writer never waits for readers: once the ring is full, each block
+   replaces the oldest frames */
+static void
+test_overwrite (void)
+{
+  GFreenectAudioRing ring;
+  gint32 frames[8 * CHANNELS];
+  guint cursor = 0;
+  guint n;
+
+  gfreenect_audio_ring_init (&ring, 8);
+
+  write_frames (&ring, 0, 5, 1000);
+  write_frames (&ring, 5, 6, 2000);
+
+  n = gfreenect_audio_ring_read (&ring, &cursor, frames, 8, NULL);
+  g_assert_cmpuint (n, ==, 8);
+  g_assert_cmpuint (cursor, ==, 11);
+  assert_frames (frames, 3, 8);
+
+  /* a block larger than the ring keeps its last frames only */
+  write_frames (&ring, 11, 20, 3000);
+
+  n = gfreenect_audio_ring_read (&ring, &cursor, frames, 8, NULL);
+  g_assert_cmpuint (n, ==, 8);
+  g_assert_cmpuint (cursor, ==, 31);
+  assert_frames (frames, 23, 8);
+
+  gfreenect_audio_ring_clear (&ring);
+}
+
+/* a reader the writer lapped skips to the oldest frame still held, and
+   other readers are not affected by it */
+static void
+test_skip_on_lap (void)
+{
+  GFreenectAudioRing ring;
+  gint32 frames[8 * CHANNELS];
+  guint slow = 0;
+  guint fast = 0;
+  guint n;
+
+  gfreenect_audio_ring_init (&ring, 8);
+
+  write_frames (&ring, 0, 6, 1000);
+
+  n = gfreenect_audio_ring_read (&ring, &slow, frames, 4, NULL);
+  g_assert_cmpuint (n, ==, 4);
+  assert_frames (frames, 0, 4);
+
+  n = gfreenect_audio_ring_read (&ring, &fast, frames, 8, NULL);
+  g_assert_cmpuint (n, ==, 6);
+  assert_frames (frames, 0, 6);
+
+  write_frames (&ring, 6, 4, 2000);
+
+  n = gfreenect_audio_ring_read (&ring, &fast, frames, 8, NULL);
+  g_assert_cmpuint (n, ==, 4);
+  assert_frames (frames, 6, 4);
+
+  write_frames (&ring, 10, 14, 3000);
+
+  /* frames 4 to 15 were lost to the slow reader */
+  n = gfreenect_audio_ring_read (&ring, &slow, frames, 8, NULL);
+  g_assert_cmpuint (n, ==, 8);
+  g_assert_cmpuint (slow, ==, 24);
+  assert_frames (frames, 16, 8);
+
+  n = gfreenect_audio_ring_read (&ring, &fast, frames, 8, NULL);
+  g_assert_cmpuint (n, ==, 8);
+  assert_frames (frames, 16, 8);
+
+  /* nothing new */
+  n = gfreenect_audio_ring_read (&ring, &slow, frames, 8, NULL);
+  g_assert_cmpuint (n, ==, 0);
+  g_assert_cmpuint (slow, ==, 24);
+
+  gfreenect_audio_ring_clear (&ring);
+}
+
+/* every read returns the arrival time of its own first frame, from the
+   arrival time of the last block and the sample rate */
+static void
+test_timestamp (void)
+{
+  GFreenectAudioRing ring;
+  gint32 frames[16 * CHANNELS];
+  guint cursor = 0;
+  gint64 timestamp = 0;
+  guint n;
+
+  gfreenect_audio_ring_init (&ring, 16);
+
+  write_frames (&ring, 0, 4, 1000000);
+  write_frames (&ring, 4, 4, 1000250);
+
+  n = gfreenect_audio_ring_read (&ring, &cursor, frames, 2, &timestamp);
+  g_assert_cmpuint (n, ==, 2);
+  g_assert_cmpint (timestamp, ==, 1000250 - FRAME_TIME (7));
+
+  n = gfreenect_audio_ring_read (&ring, &cursor, frames, 2, &timestamp);
+  g_assert_cmpuint (n, ==, 2);
+  g_assert_cmpint (timestamp, ==, 1000250 - FRAME_TIME (5));
+
+  write_frames (&ring, 8, 4, 1000600);
+
+  n = gfreenect_audio_ring_read (&ring, &cursor, frames, 16, &timestamp);
+  g_assert_cmpuint (n, ==, 8);
+  g_assert_cmpint (timestamp, ==, 1000600 - FRAME_TIME (7));
+
+  /* a read with nothing new leaves the timestamp alone */
+  timestamp = -1;
+  n = gfreenect_audio_ring_read (&ring, &cursor, frames, 16, &timestamp);
+  g_assert_cmpuint (n, ==, 0);
+  g_assert_cmpint (timestamp, ==, -1);
+
+  gfreenect_audio_ring_clear (&ring);
+}
+
+/* a synthetic audio source streaming into the ring from its own thread,
+   in blocks of the size libfreenect delivers, while a reader that is
+   sometimes lapped pulls frames from another one */
+
+#define STREAM_BLOCK  256
+#define STREAM_FRAMES (1 << 20)
+
+typedef struct
+{
+  GFreenectAudioRing ring;
+  gint done;
+} Stream;
+
+static gpointer
+producer_func (gpointer data)
+{
+  Stream *stream = data;
+  guint first;
+
+  for (first = 0; first < STREAM_FRAMES; first += STREAM_BLOCK)
+    write_frames (&stream->ring,
+                  first,
+                  STREAM_BLOCK,
+                  FRAME_TIME (first + STREAM_BLOCK - 1));
+
+  g_atomic_int_set (&stream->done, TRUE);
+
+  return NULL;
+}
+
+static void
+test_synthetic_source (void)
+{
+  Stream stream;
+  GThread *producer;
+  gint32 *frames;
+  guint cursor = 0;
+  guint next = 0;
+  guint received = 0;
+  guint max_frames = 1;
+
+  gfreenect_audio_ring_init (&stream.ring, 4096);
+  stream.done = FALSE;
+
+  frames = g_new (gint32, 4096 * CHANNELS);
+
+  producer = g_thread_new ("audio-source", producer_func, &stream);
+
+  while (TRUE)
+    {
+      gboolean done = g_atomic_int_get (&stream.done);
+      gint64 timestamp;
+      guint first;
+      guint n;
+
+      n = gfreenect_audio_ring_read (&stream.ring,
+                                     &cursor,
+                                     frames,
+                                     max_frames,
+                                     &timestamp);
+      if (n == 0)
+        {
+          if (done)
+            break;
+
+          g_thread_yield ();
+          continue;
+        }
+
+      /* frames come in order, skipping only what the writer overwrote,
+         and none of them is torn */
+      first = (guint) frames[0] / 8;
+      g_assert_cmpuint (first, >=, next);
+      g_assert_cmpuint (cursor, ==, first + n);
+      assert_frames (frames, first, n);
+      g_assert_cmpint (timestamp, ==, FRAME_TIME (first));
+
+      next = first + n;
+      received += n;
+
+      /* vary the size of the reads, up to the size of the ring */
+      max_frames = max_frames * 2 % 4097;
+    }
+
+  g_thread_join (producer);
+
+  g_assert_cmpuint (next, ==, STREAM_FRAMES);
+  g_assert_cmpuint (received, >, 0);
+
+  g_free (frames);
+  gfreenect_audio_ring_clear (&stream.ring);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/audio-ring/overwrite", test_overwrite);
+  g_test_add_func ("/audio-ring/skip-on-lap", test_skip_on_lap);
+  g_test_add_func ("/audio-ring/timestamp", test_timestamp);
+  g_test_add_func ("/audio-ring/synthetic-source", test_synthetic_source);
+
+  return g_test_run ();
+}
@@ -0,0 +1,184 @@
+/*
+ * test-metrics-exporter.c
+ *
+ * gfreenect - A GObject wrapper of the libfreenect library
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Authors:
+ *  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License at http://www.gnu.org/licenses/lgpl-3.0.txt
+ * for more details.
+ */
+
+
+/* Tests of the text served by the metrics exporter. They render statistics
+   made up here rather than taken from a device, the way the exporter
+   renders the ones it takes from its devices. */
+
+#include <string.h>
+#include <glib.h>
+
+#include "gfreenect-metrics-exporter-private.h"
+
+/* whether @text has a line that is exactly @line */
+static gboolean
+has_line (const gchar *text, const gchar *line)
+{
+  gchar **lines;
+  gboolean found = FALSE;
+  guint i;
+
+  lines = g_strsplit (text, "\n", -1);
+
+  for (i = 0; lines[i] != NULL && ! found; i++)
+    found = g_strcmp0 (lines[i], line) == 0;
+
+  g_strfreev (lines);
+
+  return found;
+}
+
+#define assert_has_line(text, line)                                     \
+  G_STMT_START {                                                        \
+    if (! has_line ((text), (line)))                                    \
+      g_error ("line not rendered: %s\n%s", (line), (text));            \
+  } G_STMT_END
+
+/* the le label of latency bucket @bucket, as the exporter formats it */
+static gchar *
+bucket_bound (guint bucket)
+{
+  gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+  if (bucket == GFREENECT_LATENCY_BUCKETS - 1)
+    return g_strdup ("+Inf");
+
+  return g_strdup (g_ascii_formatd (buf, sizeof (buf), "%.15g",
+                                    gfreenect_latency_histogram_get_bound (bucket) /
+                                    (gdouble) G_USEC_PER_SEC));
+}
+
+static void
+test_label_escaping (void)
+{
+  const gchar *names[] = { "kinect \"front\"", "C:\\kinect\nback" };
+  GFreenectDeviceStats stats[2];
+  gchar *text;
+
+  memset (stats, 0, sizeof (stats));
+  stats[0].depth.frames_received = 30;
+  stats[1].video.frames_received = 15;
+
+  text = gfreenect_metrics_exporter_render_stats (2, names, stats);
+
+  /* quotes and backslashes are escaped, and newlines written as \n */
+  assert_has_line (text,
+                   "gfreenect_frames_received_total"
+                   "{device=\"kinect \\\"front\\\"\",stream=\"depth\"} 30");
+  assert_has_line (text,
+                   "gfreenect_frames_received_total"
+                   "{device=\"C:\\\\kinect\\nback\",stream=\"video\"} 15");
+  assert_has_line (text,
+                   "gfreenect_pending_queries"
+                   "{device=\"C:\\\\kinect\\nback\"} 0");
+
+  /* no raw newline leaked out of a label into a line of its own */
+  g_assert (! has_line (text, "back\",stream=\"video\"} 15"));
+  g_assert (strstr (text, "\nback") == NULL);
+
+  g_free (text);
+}
+
+static void
+test_cumulative_buckets (void)
+{
+  const gchar *names[] = { "kinect0" };
+  GFreenectDeviceStats stats;
+  guint64 cumulative = 0;
+  gchar *text;
+  guint i;
+
+  memset (&stats, 0, sizeof (stats));
+  stats.depth.latency.counts[0] = 2;
+  stats.depth.latency.counts[3] = 5;
+  stats.depth.latency.counts[GFREENECT_LATENCY_BUCKETS - 1] = 1;
+  stats.depth.latency.sum = 2500000;
+
+  text = gfreenect_metrics_exporter_render_stats (1, names, &stats);
+
+  assert_has_line (text, "# TYPE gfreenect_frame_latency_seconds histogram");
+
+  /* each bucket counts the samples of the buckets below it too */
+  for (i = 0; i < GFREENECT_LATENCY_BUCKETS; i++)
+    {
+      gchar *bound;
+      gchar *line;
+
+      cumulative += stats.depth.latency.counts[i];
+
+      bound = bucket_bound (i);
+      line = g_strdup_printf ("gfreenect_frame_latency_seconds_bucket"
+                              "{device=\"kinect0\",stream=\"depth\",le=\"%s\"} "
+                              "%" G_GUINT64_FORMAT,
+                              bound, cumulative);
+      assert_has_line (text, line);
+      g_free (line);
+
+      line = g_strdup_printf ("gfreenect_frame_latency_seconds_bucket"
+                              "{device=\"kinect0\",stream=\"video\",le=\"%s\"} 0",
+                              bound);
+      assert_has_line (text, line);
+      g_free (line);
+
+      g_free (bound);
+    }
+
+  g_assert_cmpuint (cumulative, ==, 8);
+
+  /* the +Inf bucket and the count agree, and the sum is in seconds */
+  assert_has_line (text,
+                   "gfreenect_frame_latency_seconds_count"
+                   "{device=\"kinect0\",stream=\"depth\"} 8");
+  assert_has_line (text,
+                   "gfreenect_frame_latency_seconds_sum"
+                   "{device=\"kinect0\",stream=\"depth\"} 2.5");
+
+  g_free (text);
+}
+
+static void
+test_no_devices (void)
+{
+  gchar *text;
+
+  text = gfreenect_metrics_exporter_render_stats (0, NULL, NULL);
+
+  /* the families are described even with nothing to sample */
+  assert_has_line (text, "# TYPE gfreenect_frames_received_total counter");
+  assert_has_line (text, "# TYPE gfreenect_conversion_seconds_total counter");
+  g_assert (strstr (text, "{") == NULL);
+
+  g_free (text);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/metrics-exporter/label-escaping", test_label_escaping);
+  g_test_add_func ("/metrics-exporter/cumulative-buckets",
+                   test_cumulative_buckets);
+  g_test_add_func ("/metrics-exporter/no-devices", test_no_devices);
+
+  return g_test_run ();
+}